@@ -0,0 +1,504 @@
+/*
+ * cm_bench.c - PDS cache manager replay benchmark
+ *
+ * Links the PDS cache and stable storage managers standalone and replays
+ * a synthetic read trace against the cache, reporting hit ratios and the
+ * number of data blocks read from stable storage.
+ *
+ * The scan trace is a sequential scan of a large file, whose blocks are
+ * not soon read again, interleaved with random reads of a hot set of data
+ * blocks that fits in the cache.  Without the admission filter, hot blocks
+ * read once may be evicted from the probationary segment by the scan before
+ * they are read again and promoted.  The trace is replayed with and without
+ * the filter.
+ *
+ * The append trace appends records to a set of files via the cache, each
+ * append followed by a read of the record appended, as for a log reader.
+ * Such reads hit the incomplete tail data block of the file; these are
+ * served from the cache if the file size is known to the cache, rather
+ * than re-read from stable storage.
+ *
+ * Data files are placed in directory 'dir', which must exist.
+ *
+ * Usage: cm_bench dir [round count]
+ */
+
+
+#ifdef __STDC__
+#include <stddef.h>
+#include <stdlib.h>
+#else
+#include "nonansi.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gpmacro.h"
+
+#include "pious_types.h"
+#include "pious_errno.h"
+#include "pious_std.h"
+
+#include "gputil.h"
+
+#include "pds_fhandlet.h"
+#include "pds_sstorage_manager.h"
+#include "pds_cache_manager.h"
+
+
+
+#define ROUNDCNT       50   /* default trace round count */
+#define CACHESZ       256   /* cache size in data blocks */
+#define DBLKSZ      16384   /* data block size */
+#define HOTBLKS       128   /* hot set size in data blocks */
+#define HOTSTEP         4   /* data blocks scanned per hot set read */
+#define SCANBLKS     1024   /* data blocks scanned per round */
+#define SCANFILE     4096   /* scan file size in data blocks */
+
+#define APPFILES        8   /* number of files appended */
+#define APPSZ         512   /* bytes appended per record */
+#define APPCNT       2048   /* records appended per round */
+
+#define HOTNAME  "cm_bench.hot"
+#define SCANNAME "cm_bench.scan"
+#define APPNAME  "cm_bench.app"
+
+#define Pct(a, b) ((b) == 0 ? 0.0 : 100.0 * (double)(a) / (double)(b))
+
+
+/* Reference counts for a trace phase */
+
+struct bench_refs{
+  unsigned long hits;         /* read hits */
+  unsigned long refs;         /* read references */
+  unsigned long loads;        /* data blocks read from stable storage */
+};
+
+
+#ifdef __STDC__
+static void bench_scan(pds_fhandlet hot, pds_fhandlet scan, long rounds,
+		       int admit);
+static void bench_append(pds_fhandlet *app, long rounds);
+static void bench_refs(struct bench_refs *refs);
+static void bench_fill(pds_fhandlet fhandle, long nblk);
+static void bench_read(pds_fhandlet fhandle, pious_offt offset,
+		       pious_sizet nbyte);
+static long bench_random(void);
+#else
+static void bench_scan();
+static void bench_append();
+static void bench_refs();
+static void bench_fill();
+static void bench_read();
+static long bench_random();
+#endif
+
+
+static char bench_buf[DBLKSZ];
+static unsigned long bench_seed;
+
+
+
+#ifdef __STDC__
+int main(int argc, char **argv)
+#else
+int main(argc, argv)
+     int argc;
+     char **argv;
+#endif
+{
+  int acode, status, admit, f;
+  long rounds;
+  char hotpath[1024], scanpath[1024], path[1024];
+  pds_fhandlet hot, scan, app[APPFILES];
+
+  rounds = ROUNDCNT;
+
+  if (argc < 2 || strlen(argv[1]) > 1000 ||
+      (argc > 2 && (rounds = atol(argv[2])) < 1))
+    {
+      printf("usage: cm_bench dir [round count >= 1]\n");
+      exit(1);
+    }
+
+  /* initialize stable storage and create data files */
+  sprintf(hotpath, "%s/%s", argv[1], HOTNAME);
+  sprintf(scanpath, "%s/%s", argv[1], SCANNAME);
+
+  if ((acode = SS_init(argv[1])) != PIOUS_OK ||
+      (acode = SS_lookup(hotpath, &hot, PIOUS_CREAT | PIOUS_TRUNC,
+			 (pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR))) !=
+      PIOUS_OK ||
+      (acode = SS_lookup(scanpath, &scan, PIOUS_CREAT | PIOUS_TRUNC,
+			 (pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR))) !=
+      PIOUS_OK)
+    {
+      printf("cm_bench: unable to initialize stable storage in %s\n",
+	     argv[1]);
+      exit(1);
+    }
+
+  for (f = 0; f < APPFILES; f++)
+    {
+      sprintf(path, "%s/%s.%d", argv[1], APPNAME, f);
+
+      if (SS_lookup(path, &app[f], PIOUS_CREAT | PIOUS_TRUNC,
+		    (pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR)) != PIOUS_OK)
+	{
+	  printf("cm_bench: unable to create data file %s\n", path);
+	  exit(1);
+	}
+    }
+
+  bench_fill(hot, (long)HOTBLKS);
+  bench_fill(scan, (long)SCANFILE);
+
+  /* replay scan trace; each run in a child process with its own cache */
+  printf("\nCM_BENCH - scan trace: %d block hot set read every %d scanned "
+	 "blocks, %d block cache\n\n", HOTBLKS, HOTSTEP, CACHESZ);
+  printf("%10s %12s %12s %12s %12s\n", "admission",
+	 "hot hit %", "hit %", "loads", "rejected");
+
+  for (admit = FALSE; admit <= TRUE; admit++)
+    {
+      fflush(stdout);
+
+      if (fork() == 0)
+	bench_scan(hot, scan, rounds, admit);
+
+      if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+	exit(1);
+    }
+
+  printf("\n");
+
+  /* replay append trace */
+  printf("CM_BENCH - append trace: %d byte records appended to %d files, "
+	 "each read back\n\n", APPSZ, APPFILES);
+  printf("%10s %12s %12s %12s %12s\n", "appends",
+	 "tail hits", "served", "re-read", "loads");
+
+  fflush(stdout);
+
+  if (fork() == 0)
+    bench_append(app, rounds);
+
+  if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+    exit(1);
+
+  printf("\n");
+
+  SS_unlink(hotpath);
+  SS_unlink(scanpath);
+
+  for (f = 0; f < APPFILES; f++)
+    {
+      sprintf(path, "%s/%s.%d", argv[1], APPNAME, f);
+      SS_unlink(path);
+    }
+
+  exit(0);
+}
+
+
+
+
+/*
+ * bench_scan()
+ *
+ * Parameters:
+ *
+ *   hot    - hot set file handle
+ *   scan   - scan file handle
+ *   rounds - trace round count
+ *   admit  - admission filter flag
+ *
+ * Replay 'rounds' rounds of the scan trace against a cache with the
+ * admission filter as specified by 'admit', report results, and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void bench_scan(pds_fhandlet hot,
+		       pds_fhandlet scan,
+		       long rounds,
+		       int admit)
+#else
+static void bench_scan(hot, scan, rounds, admit)
+     pds_fhandlet hot;
+     pds_fhandlet scan;
+     long rounds;
+     int admit;
+#endif
+{
+  long r, i, scanblk;
+  struct CM_param param;
+  struct CM_stats stats;
+  struct bench_refs start, stop, hotrefs;
+
+  CM_defparam(&param);
+
+  param.cache_sz = CACHESZ;
+  param.dblk_sz  = DBLKSZ;
+  param.admit    = admit;
+
+  if (CM_init(&param) != PIOUS_OK)
+    {
+      printf("cm_bench: unable to initialize cache\n");
+      exit(1);
+    }
+
+  bench_seed      = 1;
+  scanblk         = 0;
+  hotrefs.hits    = 0;
+  hotrefs.refs    = 0;
+
+  for (r = 0; r < rounds; r++)
+    for (i = 0; i < SCANBLKS; i++)
+      {
+	/* random read of the hot set */
+	if (i % HOTSTEP == 0)
+	  {
+	    bench_refs(&start);
+
+	    bench_read(hot, (pious_offt)(bench_random() % HOTBLKS) * DBLKSZ,
+		       (pious_sizet)DBLKSZ);
+
+	    bench_refs(&stop);
+
+	    hotrefs.hits += stop.hits - start.hits;
+	    hotrefs.refs += stop.refs - start.refs;
+	  }
+
+	/* sequential scan */
+	bench_read(scan, (pious_offt)scanblk * DBLKSZ, (pious_sizet)DBLKSZ);
+	scanblk = (scanblk + 1) % SCANFILE;
+      }
+
+  bench_refs(&stop);
+  CM_stats(&stats);
+
+  printf("%10s %12.1f %12.1f %12lu %12lu\n", (admit ? "on" : "off"),
+	 Pct(hotrefs.hits, hotrefs.refs), Pct(stop.hits, stop.refs),
+	 stop.loads, stats.adm_reject);
+
+  exit(0);
+}
+
+
+
+
+/*
+ * bench_append()
+ *
+ * Parameters:
+ *
+ *   app    - appended file handles
+ *   rounds - trace round count
+ *
+ * Replay 'rounds' rounds of the append trace against a cache, report
+ * results, and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void bench_append(pds_fhandlet *app,
+			 long rounds)
+#else
+static void bench_append(app, rounds)
+     pds_fhandlet *app;
+     long rounds;
+#endif
+{
+  int f;
+  long r, i;
+  pious_offt fsize[APPFILES];
+  struct CM_param param;
+  struct CM_stats stats;
+  struct bench_refs refs;
+
+  CM_defparam(&param);
+
+  param.cache_sz = CACHESZ;
+  param.dblk_sz  = DBLKSZ;
+
+  if (CM_init(&param) != PIOUS_OK)
+    {
+      printf("cm_bench: unable to initialize cache\n");
+      exit(1);
+    }
+
+  bench_seed = 1;
+
+  for (f = 0; f < APPFILES; f++)
+    fsize[f] = 0;
+
+  memset(bench_buf, 'a', APPSZ);
+
+  for (r = 0; r < rounds; r++)
+    for (i = 0; i < APPCNT; i++)
+      {
+	/* append a record to a file and read it back */
+	f = bench_random() % APPFILES;
+
+	if (CM_write(app[f], fsize[f], (pious_sizet)APPSZ, bench_buf,
+		     PIOUS_VOLATILE) != PIOUS_OK)
+	  {
+	    printf("cm_bench: cache write failed\n");
+	    exit(1);
+	  }
+
+	bench_read(app[f], fsize[f], (pious_sizet)APPSZ);
+
+	fsize[f] += APPSZ;
+      }
+
+  bench_refs(&refs);
+  CM_stats(&stats);
+
+  printf("%10ld %12lu %12lu %12lu %12lu\n", rounds * APPCNT,
+	 stats.eof_hit + stats.eof_reload, stats.eof_hit, stats.eof_reload,
+	 refs.loads);
+
+  exit(0);
+}
+
+
+
+
+/*
+ * bench_refs()
+ *
+ * Parameters:
+ *
+ *   refs - reference counts
+ *
+ * Set 'refs' to the cache reference counts accumulated thus far.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void bench_refs(struct bench_refs *refs)
+#else
+static void bench_refs(refs)
+     struct bench_refs *refs;
+#endif
+{
+  struct CM_stats stats;
+
+  CM_stats(&stats);
+
+  refs->hits  = (stats.hit_pt + stats.hit_pb + stats.hit_ra +
+		 stats.hit_sm + stats.hit_lg);
+  refs->refs  = refs->hits + stats.miss + stats.lg_blks;
+  refs->loads = (stats.miss + stats.ra_blks + stats.lr_blks +
+		 stats.lg_blks);
+}
+
+
+
+
+/*
+ * bench_fill()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   nblk    - file size in data blocks
+ *
+ * Write 'nblk' data blocks to file 'fhandle', bypassing the cache.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void bench_fill(pds_fhandlet fhandle,
+		       long nblk)
+#else
+static void bench_fill(fhandle, nblk)
+     pds_fhandlet fhandle;
+     long nblk;
+#endif
+{
+  long i;
+
+  memset(bench_buf, 'c', DBLKSZ);
+
+  for (i = 0; i < nblk; i++)
+    if (SS_write(fhandle, (pious_offt)i * DBLKSZ, (pious_sizet)DBLKSZ,
+		 bench_buf, PIOUS_VOLATILE) != DBLKSZ)
+      {
+	printf("cm_bench: unable to write data file\n");
+	exit(1);
+      }
+}
+
+
+
+
+/*
+ * bench_read()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   offset  - starting offset
+ *   nbyte   - byte count
+ *
+ * Read 'nbyte' bytes of file 'fhandle' starting at 'offset' via the cache.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void bench_read(pds_fhandlet fhandle,
+		       pious_offt offset,
+		       pious_sizet nbyte)
+#else
+static void bench_read(fhandle, offset, nbyte)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+#endif
+{
+  if (CM_read(fhandle, offset, nbyte, bench_buf) < 0)
+    {
+      printf("cm_bench: cache read failed\n");
+      exit(1);
+    }
+}
+
+
+
+
+/*
+ * bench_random()
+ *
+ * Parameters:
+ *
+ * Generate a pseudo-random number from the seed bench_seed, so that each
+ * replay of a trace is the same.
+ *
+ * Returns:
+ *
+ *   long - pseudo-random number in the range [0, 32767]
+ */
+
+#ifdef __STDC__
+static long bench_random(void)
+#else
+static long bench_random()
+#endif
+{
+  bench_seed = bench_seed * 1103515245 + 12345;
+
+  return ((long)((bench_seed / 65536) % 32768));
+}
@@ -0,0 +1,260 @@
+/*
+ * gc_bench.c - PDS group commit benchmark
+ *
+ * Links the PDS data, cache, recovery, and stable storage managers
+ * standalone and measures stable transaction commits per second versus
+ * the number of concurrent clients, with and without group commit.
+ *
+ * Each client runs one stable transaction at a time, writing a block to
+ * its own region of a shared file.  All clients prepare within the group
+ * commit window, as when the PDS receives their prepare requests together;
+ * with group commit their log records are forced by a single RM_logsync(),
+ * without it each prepare forces its own.  Each transaction then commits.
+ *
+ * Log and data files are placed in directory 'dir', which must exist.
+ *
+ * Usage: gc_bench dir [transactions per client count]
+ */
+
+
+#ifdef __STDC__
+#include <stddef.h>
+#include <stdlib.h>
+#else
+#include "nonansi.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gpmacro.h"
+
+#include "pious_types.h"
+#include "pious_errno.h"
+#include "pious_std.h"
+
+#include "gputil.h"
+
+#include "pds_transidt.h"
+#include "pds_fhandlet.h"
+#include "pds_sstorage_manager.h"
+#include "pds_cache_manager.h"
+#include "pds_recovery_manager.h"
+#include "pds_data_manager.h"
+
+
+
+#define CLIENTMAX    64   /* maximum client count */
+#define TRANSCNT    512   /* default transactions per client count */
+#define WRITESZ    4096   /* bytes written per transaction */
+#define FILENAME "gc_bench.dat"
+
+
+#ifdef __STDC__
+static double bench_run(pds_fhandlet fhandle, int clients, long transcnt,
+			int group);
+static pds_transidt bench_transid(long n);
+#else
+static double bench_run();
+static pds_transidt bench_transid();
+#endif
+
+
+
+#ifdef __STDC__
+int main(int argc, char **argv)
+#else
+int main(argc, argv)
+     int argc;
+     char **argv;
+#endif
+{
+  int clients, acode;
+  long transcnt;
+  double syncrate, grouprate;
+  char path[1024];
+  pds_fhandlet fhandle;
+
+  transcnt = TRANSCNT;
+
+  if (argc < 2 || strlen(argv[1]) + sizeof(FILENAME) + 1 > sizeof(path) ||
+      (argc > 2 && (transcnt = atol(argv[2])) < CLIENTMAX))
+    {
+      printf("usage: gc_bench dir [transactions per client count >= %d]\n",
+	     CLIENTMAX);
+      exit(1);
+    }
+
+  /* initialize stable storage, recovering a log left by a prior run */
+  if ((acode = SS_init(argv[1])) == PIOUS_ERECOV)
+    acode = RM_recover();
+
+  sprintf(path, "%s/%s", argv[1], FILENAME);
+
+  if (acode != PIOUS_OK ||
+      SS_lookup(path, &fhandle, PIOUS_CREAT | PIOUS_TRUNC,
+		(pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR)) != PIOUS_OK)
+    {
+      printf("gc_bench: unable to initialize stable storage in %s\n",
+	     argv[1]);
+      exit(1);
+    }
+
+  printf("\nGC_BENCH - stable transactions of one %d byte write\n\n",
+	 WRITESZ);
+  printf("%10s %18s %18s\n", "clients", "commits/sec", "commits/sec");
+  printf("%10s %18s %18s\n", "", "(sync per prepare)", "(group commit)");
+
+  for (clients = 1; clients <= CLIENTMAX; clients *= 2)
+    {
+      syncrate  = bench_run(fhandle, clients, transcnt, FALSE);
+      grouprate = bench_run(fhandle, clients, transcnt, TRUE);
+
+      printf("%10d %18.0f %18.0f\n", clients, syncrate, grouprate);
+    }
+
+  printf("\n");
+
+  SS_unlink(path);
+  exit(0);
+}
+
+
+
+
+/*
+ * bench_run()
+ *
+ * Parameters:
+ *
+ *   fhandle  - file handle
+ *   clients  - client count
+ *   transcnt - transaction count
+ *   group    - group commit flag
+ *
+ * Run 'transcnt' stable transactions writing file 'fhandle' in rounds of
+ * 'clients' concurrent transactions, with group commit if 'group' is TRUE.
+ * The cache is then flushed and invalidated and the transaction log
+ * truncated, as for a PDS reset.
+ *
+ * Returns:
+ *
+ *   double - transactions committed per second
+ */
+
+#ifdef __STDC__
+static double bench_run(pds_fhandlet fhandle,
+			int clients,
+			long transcnt,
+			int group)
+#else
+static double bench_run(fhandle, clients, transcnt, group)
+     pds_fhandlet fhandle;
+     int clients;
+     long transcnt;
+     int group;
+#endif
+{
+  int i;
+  long rounds, r;
+  unsigned long usec;
+  char *buf;
+  util_clockt clock;
+
+  RM_logdefer(group);
+
+  rounds = transcnt / clients;
+
+  UTIL_clock_mark(&clock);
+
+  for (r = 0; r < rounds; r++)
+    {
+      /* each client writes and prepares */
+      for (i = 0; i < clients; i++)
+	{
+	  if ((buf = malloc((unsigned)WRITESZ)) == NULL)
+	    {
+	      printf("gc_bench: insufficient memory\n");
+	      exit(1);
+	    }
+
+	  memset(buf, (int)(r + i), WRITESZ);
+
+	  if (DM_write(bench_transid(r * clients + i), fhandle,
+		       (pious_offt)(i * WRITESZ),
+		       (pious_sizet)WRITESZ, buf) != PIOUS_OK ||
+	      DM_prepare(bench_transid(r * clients + i)) != PIOUS_OK)
+	    {
+	      printf("gc_bench: transaction prepare failed\n");
+	      exit(1);
+	    }
+	}
+
+      /* force the group's log records; prepare replies would now be sent */
+      if (group && RM_logsync() != PIOUS_OK)
+	{
+	  printf("gc_bench: log sync failed\n");
+	  exit(1);
+	}
+
+      /* each client commits */
+      for (i = 0; i < clients; i++)
+	if (DM_commit(bench_transid(r * clients + i)) != PIOUS_OK)
+	  {
+	    printf("gc_bench: transaction commit failed\n");
+	    exit(1);
+	  }
+    }
+
+  usec = UTIL_clock_delta(&clock, UTIL_USEC);
+
+  if (CM_flush() != PIOUS_OK)
+    {
+      printf("gc_bench: cache flush failed\n");
+      exit(1);
+    }
+
+  CM_invalidate();
+
+  if (RM_logtrunc() != PIOUS_OK)
+    {
+      printf("gc_bench: log truncation failed\n");
+      exit(1);
+    }
+
+  return ((double)(rounds * clients) * 1000000.0 / (double)Max(usec, 1));
+}
+
+
+
+
+/*
+ * bench_transid()
+ *
+ * Parameters:
+ *
+ *   n - transaction number
+ *
+ * Form a transaction id that is unique for 'n'.
+ *
+ * Returns:
+ *
+ *   pds_transidt - transaction id
+ */
+
+#ifdef __STDC__
+static pds_transidt bench_transid(long n)
+#else
+static pds_transidt bench_transid(n)
+     long n;
+#endif
+{
+  pds_transidt transid;
+
+  transid.hostid = 1;
+  transid.procid = n;
+  transid.sec    = 0;
+  transid.usec   = 0;
+
+  return transid;
+}
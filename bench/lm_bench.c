@@ -0,0 +1,380 @@
+/*
+ * lm_bench.c - PDS lock manager microbenchmark
+ *
+ * Links the PDS lock manager standalone and measures the rate at which
+ * byte-range locks are granted, denied, and freed as the number of locks
+ * held on a single file grows.
+ *
+ * Each of 'n' transactions write locks a small disjoint range of one file,
+ * in an order scattered over the file, as SPMD processes sharing a segment
+ * would.  A further transaction then requests write locks on held ranges,
+ * which are denied, and finally each transaction frees its lock.
+ *
+ * Contention is then measured with 'n' requests queued on the file behind
+ * a lock held by one transaction over the whole range.  New requests are
+ * checked against the queue, so as not to overtake queued requests, as the
+ * PDS does on admission; the lock is then freed, waking every request.
+ *
+ * Usage: lm_bench [max lock count]
+ */
+
+
+#ifdef __STDC__
+#include <stddef.h>
+#include <stdlib.h>
+#else
+#include "nonansi.h"
+#endif
+
+#include <stdio.h>
+
+#include "gpmacro.h"
+
+#include "pious_types.h"
+#include "pious_errno.h"
+
+#include "gputil.h"
+
+#include "pds_transidt.h"
+#include "pds_fhandlet.h"
+#include "pds_lock_manager.h"
+
+
+
+#define LOCKMIN      16   /* initial lock count */
+#define LOCKMAX   16384   /* default maximum lock count */
+#define RANGESZ      64   /* bytes locked per transaction */
+#define PROBECNT 100000   /* lock requests probed per lock count */
+#define SCATTER    7919   /* prime stride scattering lock order */
+
+
+#ifdef __STDC__
+static void bench_locks(long lockmax);
+static void bench_queue(long lockmax);
+static pds_transidt bench_transid(long n);
+static double bench_rate(long ops, util_clockt *clock);
+#else
+static void bench_locks();
+static void bench_queue();
+static pds_transidt bench_transid();
+static double bench_rate();
+#endif
+
+
+
+#ifdef __STDC__
+int main(int argc, char **argv)
+#else
+int main(argc, argv)
+     int argc;
+     char **argv;
+#endif
+{
+  long lockmax;
+
+  lockmax = LOCKMAX;
+
+  if (argc > 1 && (lockmax = atol(argv[1])) < LOCKMIN)
+    {
+      printf("usage: lm_bench [max lock count >= %d]\n", LOCKMIN);
+      exit(1);
+    }
+
+  bench_locks(lockmax);
+  bench_queue(lockmax);
+
+  exit(0);
+}
+
+
+
+
+/*
+ * bench_locks()
+ *
+ * Parameters:
+ *
+ *   lockmax - maximum lock count
+ *
+ * Measure lock grant, denial, and free rates for lock counts from LOCKMIN
+ * to 'lockmax'.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void bench_locks(long lockmax)
+#else
+static void bench_locks(lockmax)
+     long lockmax;
+#endif
+{
+  long n, i, slot, denied;
+  double lockrate, denyrate, freerate;
+  pds_fhandlet fhandle;
+  util_clockt clock;
+
+  fhandle.dev = 1;
+  fhandle.ino = 1;
+
+  printf("\nLM_BENCH - %d byte write locks held on a single file\n\n",
+	 RANGESZ);
+  printf("%10s %14s %14s %14s\n", "locks", "grants/sec", "denials/sec",
+	 "frees/sec");
+
+  for (n = LOCKMIN; n <= lockmax; n *= 4)
+    {
+      /* grant a disjoint lock to each of 'n' transactions, scattered */
+      UTIL_clock_mark(&clock);
+
+      for (i = 0; i < n; i++)
+	{
+	  slot = (i * SCATTER) % n;
+
+	  if (LM_wlock(bench_transid(i), fhandle,
+		       (pious_offt)(slot * 2 * RANGESZ),
+		       (pious_sizet)RANGESZ) != LM_GRANT)
+	    {
+	      printf("lm_bench: disjoint write lock denied\n");
+	      exit(1);
+	    }
+	}
+
+      lockrate = bench_rate(n, &clock);
+
+      /* request locks on held ranges; each conflicts and is denied */
+      denied = 0;
+
+      UTIL_clock_mark(&clock);
+
+      for (i = 0; i < PROBECNT; i++)
+	{
+	  slot = (i * SCATTER) % n;
+
+	  if (LM_wlock(bench_transid(n), fhandle,
+		       (pious_offt)(slot * 2 * RANGESZ + RANGESZ / 2),
+		       (pious_sizet)RANGESZ) == LM_DENY)
+	    denied++;
+	}
+
+      denyrate = bench_rate(PROBECNT, &clock);
+
+      if (denied != PROBECNT)
+	{
+	  printf("lm_bench: conflicting write lock granted\n");
+	  exit(1);
+	}
+
+      /* free each transaction's lock */
+      UTIL_clock_mark(&clock);
+
+      for (i = 0; i < n; i++)
+	LM_wfree(bench_transid(i));
+
+      freerate = bench_rate(n, &clock);
+
+      printf("%10ld %14.0f %14.0f %14.0f\n",
+	     n, lockrate, denyrate, freerate);
+    }
+
+  printf("\n");
+}
+
+
+
+
+/*
+ * bench_queue()
+ *
+ * Parameters:
+ *
+ *   lockmax - maximum queued request count
+ *
+ * Measure request queueing, admission check, and wake rates for queued
+ * request counts from LOCKMIN to 'lockmax'.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void bench_queue(long lockmax)
+#else
+static void bench_queue(lockmax)
+     long lockmax;
+#endif
+{
+  long n, i, slot, conflicts, woken;
+  double waitrate, checkrate, wakerate;
+  pds_fhandlet fhandle;
+  pds_transidt transid, holder;
+  util_clockt clock;
+
+  fhandle.dev = 1;
+  fhandle.ino = 2;
+
+  printf("LM_BENCH - %d byte write lock requests queued on a single file\n\n",
+	 RANGESZ);
+  printf("%10s %14s %14s %14s\n", "queued", "queues/sec", "checks/sec",
+	 "wakes/sec");
+
+  for (n = LOCKMIN; n <= lockmax; n *= 4)
+    {
+      /* hold a write lock over the whole range */
+      holder = bench_transid(n);
+
+      if (LM_wlock(holder, fhandle,
+		   (pious_offt)0, (pious_sizet)(n * 2 * RANGESZ)) != LM_GRANT)
+	{
+	  printf("lm_bench: write lock denied\n");
+	  exit(1);
+	}
+
+      /* queue a disjoint request for each of 'n' transactions, scattered */
+      UTIL_clock_mark(&clock);
+
+      for (i = 0; i < n; i++)
+	{
+	  slot = (i * SCATTER) % n;
+
+	  if (LM_wwait(bench_transid(i), fhandle,
+		       (pious_offt)(slot * 2 * RANGESZ),
+		       (pious_sizet)RANGESZ) != PIOUS_OK)
+	    {
+	      printf("lm_bench: write lock request not queued\n");
+	      exit(1);
+	    }
+	}
+
+      waitrate = bench_rate(n, &clock);
+
+      /* check new requests against the queue; half conflict */
+      conflicts = 0;
+
+      UTIL_clock_mark(&clock);
+
+      for (i = 0; i < PROBECNT; i++)
+	{
+	  slot = (i * SCATTER) % n;
+
+	  if (LM_wconflict(fhandle,
+			   (pious_offt)((slot * 2 + i % 2) * RANGESZ),
+			   (pious_sizet)RANGESZ))
+	    conflicts++;
+	}
+
+      checkrate = bench_rate(PROBECNT, &clock);
+
+      if (conflicts != PROBECNT / 2)
+	{
+	  printf("lm_bench: improper queued request conflict check\n");
+	  exit(1);
+	}
+
+      /* free the lock, waking and retrieving every queued request */
+      woken = 0;
+
+      UTIL_clock_mark(&clock);
+
+      LM_wfree(holder);
+
+      while (LM_woken(&transid))
+	woken++;
+
+      wakerate = bench_rate(n, &clock);
+
+      if (woken != n)
+	{
+	  printf("lm_bench: queued requests not woken\n");
+	  exit(1);
+	}
+
+      /* grant each woken request, as re-tried, and free it */
+      for (i = 0; i < n; i++)
+	{
+	  slot = (i * SCATTER) % n;
+
+	  if (LM_wlock(bench_transid(i), fhandle,
+		       (pious_offt)(slot * 2 * RANGESZ),
+		       (pious_sizet)RANGESZ) != LM_GRANT)
+	    {
+	      printf("lm_bench: woken write lock request denied\n");
+	      exit(1);
+	    }
+
+	  LM_wfree(bench_transid(i));
+	}
+
+      printf("%10ld %14.0f %14.0f %14.0f\n",
+	     n, waitrate, checkrate, wakerate);
+    }
+
+  printf("\n");
+}
+
+
+
+
+/*
+ * bench_transid()
+ *
+ * Parameters:
+ *
+ *   n - transaction number
+ *
+ * Form a transaction id that is unique for 'n'.
+ *
+ * Returns:
+ *
+ *   pds_transidt - transaction id
+ */
+
+#ifdef __STDC__
+static pds_transidt bench_transid(long n)
+#else
+static pds_transidt bench_transid(n)
+     long n;
+#endif
+{
+  pds_transidt transid;
+
+  transid.hostid = 1;
+  transid.procid = n;
+  transid.sec    = 0;
+  transid.usec   = 0;
+
+  return transid;
+}
+
+
+
+
+/*
+ * bench_rate()
+ *
+ * Parameters:
+ *
+ *   ops   - operation count
+ *   clock - clock timer marked at start of operations
+ *
+ * Compute operations per second for 'ops' operations timed by 'clock'.
+ *
+ * Returns:
+ *
+ *   double - operations per second
+ */
+
+#ifdef __STDC__
+static double bench_rate(long ops,
+			 util_clockt *clock)
+#else
+static double bench_rate(ops, clock)
+     long ops;
+     util_clockt *clock;
+#endif
+{
+  unsigned long usec;
+
+  usec = UTIL_clock_delta(clock, UTIL_USEC);
+
+  return ((double)ops * 1000000.0 / (double)Max(usec, 1));
+}
@@ -0,0 +1,274 @@
+/*
+ * rec_bench.c - PDS recovery benchmark
+ *
+ * Links the PDS recovery and stable storage managers standalone and
+ * measures the time for RM_recover() to replay synthetic transaction logs
+ * of various sizes.
+ *
+ * For each log size a child process logs 'n' transactions, each of one to
+ * four random writes to a set of files, and then exits without writing
+ * the data or truncating the log, as though the data server had failed.
+ * Three of four transactions are logged as committed and the remainder as
+ * aborted.  A second child process then initializes stable storage and
+ * recovers, redoing the writes of committed transactions.
+ *
+ * Log and data files are placed in directory 'dir', which must exist.
+ *
+ * Usage: rec_bench dir [max transaction count]
+ */
+
+
+#ifdef __STDC__
+#include <stddef.h>
+#include <stdlib.h>
+#else
+#include "nonansi.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gpmacro.h"
+
+#include "pious_types.h"
+#include "pious_errno.h"
+#include "pious_std.h"
+
+#include "gputil.h"
+
+#include "pds_transidt.h"
+#include "pds_fhandlet.h"
+#include "pds_sstorage_manager.h"
+#include "pds_recovery_manager.h"
+
+
+
+#define TRANSMIN     2500   /* initial transaction count */
+#define TRANSMAX    40000   /* default maximum transaction count */
+#define FILECNT         8   /* number of files written */
+#define FILESZ    8388608   /* size of region written in each file */
+#define WRITECNT        4   /* maximum writes per transaction */
+#define WRITEMAX     4096   /* maximum write size */
+
+
+#ifdef __STDC__
+static void bench_log(char *dir, long transcnt);
+static void bench_recover(char *dir);
+#else
+static void bench_log();
+static void bench_recover();
+#endif
+
+
+
+#ifdef __STDC__
+int main(int argc, char **argv)
+#else
+int main(argc, argv)
+     int argc;
+     char **argv;
+#endif
+{
+  long transmax, n;
+  int status, f;
+  char path[1024];
+
+  transmax = TRANSMAX;
+
+  if (argc < 2 || strlen(argv[1]) > 1000 ||
+      (argc > 2 && (transmax = atol(argv[2])) < TRANSMIN))
+    {
+      printf("usage: rec_bench dir [max transaction count >= %d]\n",
+	     TRANSMIN);
+      exit(1);
+    }
+
+  printf("\nREC_BENCH - recovery of transactions of 1 to %d writes\n\n",
+	 WRITECNT);
+  printf("%14s %14s %14s\n", "transactions", "log data MB",
+	 "recovery sec");
+
+  for (n = TRANSMIN; n <= transmax; n *= 2)
+    {
+      /* log transactions and fail; logging child outputs the first columns
+       * and recovering child the remainder
+       */
+      fflush(stdout);
+
+      if (fork() == 0)
+	bench_log(argv[1], n);
+
+      if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+	exit(1);
+
+      /* recover */
+      fflush(stdout);
+
+      if (fork() == 0)
+	bench_recover(argv[1]);
+
+      if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+	exit(1);
+    }
+
+  printf("\n");
+
+  for (f = 0; f < FILECNT; f++)
+    {
+      sprintf(path, "%s/rec_bench.%d", argv[1], f);
+      remove(path);
+    }
+
+  exit(0);
+}
+
+
+
+
+/*
+ * bench_log()
+ *
+ * Parameters:
+ *
+ *   dir      - log and data file directory
+ *   transcnt - transaction count
+ *
+ * Create data files in 'dir' and log 'transcnt' transactions writing them,
+ * then exit without truncating the log.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void bench_log(char *dir,
+		      long transcnt)
+#else
+static void bench_log(dir, transcnt)
+     char *dir;
+     long transcnt;
+#endif
+{
+  int acode, f, i, nwrite;
+  long t;
+  double logsz;
+  char path[1024], *buf;
+  pious_offt lhandle;
+  pds_fhandlet fhandle[FILECNT];
+  pds_transidt transid;
+  struct RM_wbuf wbuf[WRITECNT];
+
+  /* initialize stable storage, recovering a log left by a prior run */
+  if ((acode = SS_init(dir)) == PIOUS_ERECOV)
+    acode = RM_recover();
+
+  for (f = 0; f < FILECNT && acode == PIOUS_OK; f++)
+    {
+      sprintf(path, "%s/rec_bench.%d", dir, f);
+
+      acode = SS_lookup(path, &fhandle[f], PIOUS_CREAT | PIOUS_TRUNC,
+			(pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR));
+    }
+
+  if (acode != PIOUS_OK ||
+      (buf = malloc((unsigned)(WRITECNT * WRITEMAX))) == NULL)
+    {
+      printf("rec_bench: unable to initialize stable storage in %s\n", dir);
+      exit(1);
+    }
+
+  for (i = 0; i < WRITECNT * WRITEMAX; i++)
+    buf[i] = (char)rand();
+
+  /* log transactions */
+  srand(1);
+  logsz = 0.0;
+
+  transid.hostid = 1;
+  transid.sec    = 0;
+  transid.usec   = 0;
+
+  for (t = 0; t < transcnt; t++)
+    {
+      nwrite = 1 + rand() % WRITECNT;
+
+      for (i = 0; i < nwrite; i++)
+	{
+	  wbuf[i].fhandle = fhandle[rand() % FILECNT];
+	  wbuf[i].nbyte   = 1 + rand() % WRITEMAX;
+	  wbuf[i].offset  = ((pious_offt)(rand() % (FILESZ / WRITEMAX - 1)) *
+			     WRITEMAX + rand() % WRITEMAX);
+	  wbuf[i].buf     = buf + i * WRITEMAX;
+	  wbuf[i].next    = ((i + 1 < nwrite) ? &wbuf[i + 1] : NULL);
+
+	  logsz += wbuf[i].nbyte;
+	}
+
+      transid.procid = t;
+
+      if ((lhandle = RM_trans_log(transid, wbuf)) < 0)
+	{
+	  printf("rec_bench: unable to log transaction\n");
+	  exit(1);
+	}
+
+      if (t % 4 != 3)
+	acode = RM_trans_state(lhandle, RM_TRANS_COMMIT);
+      else
+	acode = RM_trans_state(lhandle, RM_TRANS_ABORT);
+
+      if (acode != PIOUS_OK)
+	{
+	  printf("rec_bench: unable to log transaction state\n");
+	  exit(1);
+	}
+    }
+
+  printf("%14ld %14.1f", transcnt, logsz / 1048576.0);
+  exit(0);
+}
+
+
+
+
+/*
+ * bench_recover()
+ *
+ * Parameters:
+ *
+ *   dir - log and data file directory
+ *
+ * Initialize stable storage with log directory 'dir' and recover, reporting
+ * the time taken, then exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void bench_recover(char *dir)
+#else
+static void bench_recover(dir)
+     char *dir;
+#endif
+{
+  int acode;
+  unsigned long usec;
+  util_clockt clock;
+
+  UTIL_clock_mark(&clock);
+
+  if ((acode = SS_init(dir)) != PIOUS_ERECOV ||
+      (acode = RM_recover()) != PIOUS_OK)
+    {
+      printf("\nrec_bench: recovery failed (%d)\n", acode);
+      exit(1);
+    }
+
+  usec = UTIL_clock_delta(&clock, UTIL_USEC);
+
+  printf(" %14.2f\n", (double)usec / 1000000.0);
+  exit(0);
+}
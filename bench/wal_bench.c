@@ -0,0 +1,203 @@
+/*
+ * wal_bench.c - PDS transaction log benchmark
+ *
+ * Links the PDS recovery and stable storage managers standalone and
+ * measures the rate at which transactions are prepared, i.e. their write
+ * operations logged via RM_trans_log(), and the corresponding rate at
+ * which write data is logged, for a range of write sizes.
+ *
+ * Each transaction logs a single write.  Log records are either forced
+ * as each transaction prepares, or are forced once for each group of
+ * GROUPSZ transactions via RM_logsync(), as with group commit.
+ *
+ * Log files are placed in directory 'dir', which must exist.
+ *
+ * Usage: wal_bench dir
+ */
+
+
+#ifdef __STDC__
+#include <stddef.h>
+#include <stdlib.h>
+#else
+#include "nonansi.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gpmacro.h"
+
+#include "pious_types.h"
+#include "pious_errno.h"
+#include "pious_std.h"
+
+#include "gputil.h"
+
+#include "pds_transidt.h"
+#include "pds_fhandlet.h"
+#include "pds_sstorage_manager.h"
+#include "pds_recovery_manager.h"
+
+
+
+#define WRITEMIN      256   /* minimum write size */
+#define WRITEMAX  1048576   /* maximum write size */
+#define PREPMAX      2048   /* maximum transactions per write size */
+#define LOGMAX   67108864   /* maximum write data logged per write size */
+#define GROUPSZ        16   /* transactions per log sync, when deferred */
+
+
+#ifdef __STDC__
+static double bench_run(long writesz, long transcnt, char *buf, int defer);
+#else
+static double bench_run();
+#endif
+
+
+
+#ifdef __STDC__
+int main(int argc, char **argv)
+#else
+int main(argc, argv)
+     int argc;
+     char **argv;
+#endif
+{
+  int acode;
+  long writesz, transcnt;
+  double syncrate, deferrate;
+  char *buf;
+
+  if (argc != 2)
+    {
+      printf("usage: wal_bench dir\n");
+      exit(1);
+    }
+
+  /* initialize stable storage, recovering a log left by a prior run */
+  if ((acode = SS_init(argv[1])) == PIOUS_ERECOV)
+    acode = RM_recover();
+
+  if (acode != PIOUS_OK)
+    {
+      printf("wal_bench: unable to initialize stable storage in %s\n",
+	     argv[1]);
+      exit(1);
+    }
+
+  if ((buf = malloc((unsigned)WRITEMAX)) == NULL)
+    {
+      printf("wal_bench: insufficient memory\n");
+      exit(1);
+    }
+
+  memset(buf, 'w', WRITEMAX);
+
+  printf("\nWAL_BENCH - transactions of one write\n\n");
+  printf("%10s %14s %12s %14s %12s\n", "write",
+	 "prepares/sec", "MB/sec", "prepares/sec", "MB/sec");
+  printf("%10s %27s %27s\n", "bytes",
+	 "(sync per prepare)", "(sync per group)");
+
+  for (writesz = WRITEMIN; writesz <= WRITEMAX; writesz *= 4)
+    {
+      transcnt = Min(PREPMAX, LOGMAX / writesz);
+
+      syncrate  = bench_run(writesz, transcnt, buf, FALSE);
+      deferrate = bench_run(writesz, transcnt, buf, TRUE);
+
+      printf("%10ld %14.0f %12.1f %14.0f %12.1f\n", writesz,
+	     syncrate, syncrate * writesz / 1048576.0,
+	     deferrate, deferrate * writesz / 1048576.0);
+    }
+
+  printf("\n");
+  exit(0);
+}
+
+
+
+
+/*
+ * bench_run()
+ *
+ * Parameters:
+ *
+ *   writesz  - write size
+ *   transcnt - transaction count
+ *   buf      - write data
+ *   defer    - defer log synchronization flag
+ *
+ * Prepare 'transcnt' transactions each logging a single write of 'writesz'
+ * bytes from 'buf', with log synchronization deferred to each group of
+ * GROUPSZ transactions if 'defer' is TRUE.  The transaction log is
+ * truncated on completion.
+ *
+ * Returns:
+ *
+ *   double - transactions prepared per second
+ */
+
+#ifdef __STDC__
+static double bench_run(long writesz,
+			long transcnt,
+			char *buf,
+			int defer)
+#else
+static double bench_run(writesz, transcnt, buf, defer)
+     long writesz;
+     long transcnt;
+     char *buf;
+     int defer;
+#endif
+{
+  long i;
+  unsigned long usec;
+  pds_transidt transid;
+  struct RM_wbuf wbuf;
+  util_clockt clock;
+
+  RM_logdefer(defer);
+
+  transid.hostid = 1;
+  transid.sec    = 0;
+  transid.usec   = 0;
+
+  wbuf.fhandle.dev = 1;
+  wbuf.fhandle.ino = 1;
+  wbuf.nbyte       = writesz;
+  wbuf.buf         = buf;
+  wbuf.next        = NULL;
+
+  UTIL_clock_mark(&clock);
+
+  for (i = 0; i < transcnt; i++)
+    {
+      transid.procid = i;
+      wbuf.offset    = i * writesz;
+
+      if (RM_trans_log(transid, &wbuf) < 0 ||
+	  (defer && (i + 1) % GROUPSZ == 0 && RM_logsync() != PIOUS_OK))
+	{
+	  printf("wal_bench: unable to log transaction\n");
+	  exit(1);
+	}
+    }
+
+  if (defer && RM_logsync() != PIOUS_OK)
+    {
+      printf("wal_bench: log sync failed\n");
+      exit(1);
+    }
+
+  usec = UTIL_clock_delta(&clock, UTIL_USEC);
+
+  if (RM_logtrunc() != PIOUS_OK)
+    {
+      printf("wal_bench: log truncation failed\n");
+      exit(1);
+    }
+
+  return ((double)transcnt * 1000000.0 / (double)Max(usec, 1));
+}
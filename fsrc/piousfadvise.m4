@@ -0,0 +1,21 @@
+/*
+ * pious_advise() Fortran interface - See src/plib/plib.h for description.
+ *
+ * @(#)piousfadvise.m4	2.2  28 Apr 1995  Moyer
+ */
+
+#include "pious_types.h"
+#include "pious_errno.h"
+#include "pious_std.h"
+#include "plib.h"
+
+#include "fdefs.h"
+#include "fcstrcnvt.h"
+
+void
+FUNCTION(piousfadvise) ARGS(`fd, offset, len, advice, rc')
+  int *fd, *offset, *len, *advice, *rc;
+{
+  *rc = pious_advise(*fd,
+		     (pious_offt)(*offset), (pious_sizet)(*len), *advice);
+}
@@ -78,10 +78,15 @@
  *----------------------------------------------------------------------*/
 
 /* PDS cache management parameters (pds/pds_cache_manager.c):
+ *
+ * The following are DEFAULT values; each may be overridden when a PDS is
+ * started, either via the PDS command line or via the 'op=' option list
+ * of the PSC configuration file (see pds/pds_daemon.c and
+ * psc/psc_cfparse.c, respectively).
  *
  * PDS_CM_DBLK_SZ  - data block size in bytes; a data block is the unit
  *                   of caching. PDS_CM_DBLK_SZ *must* be greater than
- *                   zero (> 0) for compilation.
+ *                   zero (> 0).
  *
  * PDS_CM_CACHE_SZ - cache size in number of data blocks. PDS_CM_CACHE_SZ must
  *                   be greater than or equal to zero (>= 0); a value of zero
@@ -91,10 +96,101 @@
  *                         comprised of a protected and a probationary segment,
  *                         if PDS_CM_CACHE_SZ is set to one (1) then a cache
  *                         size of two (2) will be used.
+ *
+ * PDS_CM_SM_CNT   - number of small data blocks, in a slab apart from the
+ *                   cache proper, that hold incomplete data blocks of no
+ *                   more than PDS_CM_SM_SZ bytes, such as those of small
+ *                   files, when read (>= 0); a value of zero disables.
+ *
+ * PDS_CM_SM_SZ    - small data block size in bytes
+ *                   (0 < PDS_CM_SM_SZ < PDS_CM_DBLK_SZ).
+ *
+ * PDS_CM_LG_CNT   - number of large data blocks, in a slab apart from the
+ *                   cache proper, that hold the data of large files, such
+ *                   as multi-gigabyte file segments (>= 0); a value of zero
+ *                   disables.
+ *
+ * PDS_CM_LG_SZ    - large data block size in bytes
+ *                   (PDS_CM_DBLK_SZ < PDS_CM_LG_SZ).
+ *
+ * PDS_CM_LG_MIN   - minimum size in bytes, when looked up, of a file cached
+ *                   in large data blocks (>= 0); a value of zero caches only
+ *                   files so hinted by path prefix (see pds/pds_daemon.c).
+ *
+ * PDS_CM_PROT_PCT - size of the protected cache segment as a percentage of
+ *                   the full cache size (0 < PDS_CM_PROT_PCT < 100).
+ *
+ * PDS_CM_HUGEPAGE - back the cache with huge pages, if available on the
+ *                   host; TRUE (1) or FALSE (0).
+ *
+ * PDS_CM_DIRECT   - transfer data blocks via direct I/O, if available on the
+ *                   host, so that data is cached by the PDS only and not
+ *                   also by the host file system; TRUE (1) or FALSE (0).
+ *                   PDS_CM_DBLK_SZ must be a multiple of FS_DIRECT_ALIGN
+ *                   (see pfs/pfs.h) to enable.
+ *
+ * PDS_CM_RA_MAX   - maximum sequential readahead window in number of data
+ *                   blocks (>= 0); a value of zero disables readahead.
+ *
+ * PDS_CM_LR_MIN   - minimum number of data blocks spanned by a read for it to
+ *                   be performed by extent, with non-cached data read
+ *                   directly into the reply buffer and not cached (>= 0);
+ *                   a value of zero disables.
+ *
+ * PDS_CM_POLICY   - cache replacement policy; segmented LRU with fixed
+ *                   segment sizes (0), or with segment sizes adapted to
+ *                   the workload in the manner of ARC (1).
+ *
+ * PDS_CM_ADMIT    - admit a missed data block to the cache only if it has
+ *                   been referenced more frequently than the data block it
+ *                   would replace, as estimated by a frequency sketch, such
+ *                   that scans do not displace cached data; TRUE (1) or
+ *                   FALSE (0).
+ *
+ * PDS_CM_WRITEBACK - cache volatile writes under a write-back, rather than
+ *                    write-through, policy; TRUE (1) or FALSE (0).
+ *
+ * PDS_CM_WB_DIRTY_PCT - in write-back mode, the percentage of the cache that
+ *                       may hold dirty volatile data before the background
+ *                       flusher writes blocks to stable storage
+ *                       (0 < PDS_CM_WB_DIRTY_PCT <= 100).
+ *
+ * PDS_CM_WB_AGE   - in write-back mode, the maximum time (in milliseconds)
+ *                   that volatile data remains dirty before the background
+ *                   flusher writes it to stable storage (>= 0).
  */
 
 #define PDS_CM_DBLK_SZ     16384
 #define PDS_CM_CACHE_SZ       64
+#define PDS_CM_SM_CNT          0
+#define PDS_CM_SM_SZ        2048
+#define PDS_CM_LG_CNT          0
+#define PDS_CM_LG_SZ    1048576
+#define PDS_CM_LG_MIN  67108864
+#define PDS_CM_PROT_PCT       70
+#define PDS_CM_HUGEPAGE        0
+#define PDS_CM_DIRECT          0
+#define PDS_CM_RA_MAX         32
+#define PDS_CM_LR_MIN          8
+#define PDS_CM_POLICY          0
+#define PDS_CM_ADMIT           0
+#define PDS_CM_WRITEBACK       0
+#define PDS_CM_WB_DIRTY_PCT   20
+#define PDS_CM_WB_AGE       5000   /* milliseconds */
+
+
+/* PDS lock manager parameter (pds/pds_lock_manager.c):
+ *
+ * PDS_LM_ESCALATE - number of locks of a type that a transaction may hold on
+ *                   a file before a further lock of that type is escalated
+ *                   to a whole-file lock (>= 0); escalation takes place only
+ *                   if no other transaction holds or awaits a conflicting
+ *                   lock on the file.  a value of zero disables escalation.
+ *                   adjacent and overlapping locks of a type held by a
+ *                   transaction on a file are always merged.
+ */
+
+#define PDS_LM_ESCALATE        0
 
 
 /* PDS daemon timeout parameter (pds/pds_daemon.c):
@@ -102,12 +198,49 @@
  * PDS_TDEADLOCK - time-out period for deadlock avoidance (in milliseconds).
  *                 once an operation has remained blocked for a time
  *                 period greater than PDS_TDEADLOCK, it is a candidate
- *                 for abortion.
+ *                 for abortion.  local deadlocks are detected, and
+ *                 broken, when an operation blocks; the time-out
+ *                 recovers from deadlocks spanning data servers.
  */
 
 #define PDS_TDEADLOCK    250   /* milliseconds */
 
 
+/* PDS daemon group commit parameters (pds/pds_daemon.c):
+ *
+ * The following are DEFAULT values; each may be overridden when a PDS is
+ * started, as for the cache management parameters.
+ *
+ * PDS_GC_WAIT - group commit window (in milliseconds).  a stable transaction
+ *               that prepares while other transactions are active has its
+ *               log records forced, and its prepare reply sent, together
+ *               with those of transactions that prepare within PDS_GC_WAIT
+ *               of it (>= 0); a value of zero forces the log at each prepare.
+ *
+ * PDS_GC_MAX  - maximum number of transactions whose log records are forced
+ *               together (> 0).
+ */
+
+#define PDS_GC_WAIT        2   /* milliseconds */
+#define PDS_GC_MAX        32
+
+
+/* PDS daemon checkpoint parameter (pds/pds_daemon.c):
+ *
+ * The following is a DEFAULT value; it may be overridden when a PDS is
+ * started, as for the cache management parameters.
+ *
+ * PDS_CKPT_SZ - transaction log size (in bytes) at which the log is
+ *               checkpointed, i.e. the cache flushed and the log truncated,
+ *               once no transaction is prepared (> 0).  should transactions
+ *               remain prepared until the log reaches four times this size,
+ *               prepare requests vote to abort until the checkpoint is taken,
+ *               bounding the size of the log.
+ */
+
+#define PDS_CKPT_SZ 67108864
+
+
 
 
 /*----------------------------------------------------------------------*
@@ -102,6 +102,16 @@
 #define PIOUS_SEGMENTED    2
 
 
+/* Symbolic constants for advising expected file access pattern */
+
+#define PIOUS_ADV_NORMAL      0
+#define PIOUS_ADV_SEQUENTIAL  1
+#define PIOUS_ADV_RANDOM      2
+#define PIOUS_ADV_WILLNEED    3
+#define PIOUS_ADV_DONTNEED    4
+#define PIOUS_ADV_NOREUSE     5
+
+
 /* Symbolic constants for querying system configuration parameters */
 
 #define PIOUS_DS_DFLT    0
@@ -36,6 +36,7 @@
  *   UTIL_errno2errtxt();
  *   UTIL_clock_mark();
  *   UTIL_clock_delta();
+ *   UTIL_crc32c();
  */
 
 
@@ -50,6 +51,23 @@
 
 
 
+/*
+ * Private Variable Definitions
+ */
+
+
+/* CRC-32C table, for the reflected Castagnoli polynomial; initialized by
+ * UTIL_crc32c() on first use.
+ */
+
+#define CRC32C_POLY 0x82f63b78UL
+
+static unsigned long crc32c_table[256];
+static int crc32c_init = 0;
+
+
+
+
 /*
  * UTIL_errno2errtxt() - See gputil.h for description.
  */
@@ -248,3 +266,56 @@ unsigned long UTIL_clock_delta(clock, resolution)
 
   return c_delta;
 }
+
+
+
+
+/*
+ * UTIL_crc32c() - See gputil.h for description.
+ */
+
+#ifdef __STDC__
+unsigned long UTIL_crc32c(unsigned long crc,
+			  char *buf,
+			  unsigned long nbyte)
+#else
+unsigned long UTIL_crc32c(crc, buf, nbyte)
+     unsigned long crc;
+     char *buf;
+     unsigned long nbyte;
+#endif
+{
+  unsigned long entry;
+  int i, j;
+
+  /* compute table entry for each byte value on first use */
+
+  if (!crc32c_init)
+    {
+      for (i = 0; i < 256; i++)
+	{
+	  entry = (unsigned long)i;
+
+	  for (j = 0; j < 8; j++)
+	    if (entry & 1)
+	      entry = (entry >> 1) ^ CRC32C_POLY;
+	    else
+	      entry = entry >> 1;
+
+	  crc32c_table[i] = entry;
+	}
+
+      crc32c_init = 1;
+    }
+
+  /* compute CRC a byte at a time; the CRC is complemented before and after
+   * so that CRCs of successive buffers combine.
+   */
+
+  crc = (~crc) & 0xffffffffUL;
+
+  while (nbyte-- > 0)
+    crc = (crc32c_table[(crc ^ (unsigned char)*buf++) & 0xff] ^ (crc >> 8));
+
+  return ((~crc) & 0xffffffffUL);
+}
@@ -36,6 +36,7 @@
  *   UTIL_errno2errtxt();
  *   UTIL_clock_mark();
  *   UTIL_clock_delta();
+ *   UTIL_crc32c();
  */
 
 
@@ -134,3 +135,32 @@ unsigned long UTIL_clock_delta(util_clockt *clock,
 #else
 unsigned long UTIL_clock_delta();
 #endif
+
+
+
+
+/*
+ * UTIL_crc32c()
+ *
+ * Parameters:
+ *
+ *   crc   - CRC of preceding data; zero (0) initially
+ *   buf   - buffer
+ *   nbyte - byte count
+ *
+ * Compute the CRC-32C (Castagnoli) of 'nbyte' bytes of data in buffer
+ * 'buf', continuing from 'crc', the CRC of any data that precedes it.
+ * Thus the CRC of data in several buffers is computed by successive calls.
+ *
+ * Returns:
+ *
+ *   unsigned long - CRC-32C of data, including preceding data
+ */
+
+#ifdef __STDC__
+unsigned long UTIL_crc32c(unsigned long crc,
+			  char *buf,
+			  unsigned long nbyte);
+#else
+unsigned long UTIL_crc32c();
+#endif
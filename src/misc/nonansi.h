@@ -50,6 +50,10 @@ extern void free();                 /* memory deallocate */
 
 extern char *getenv();              /* get environment variable value */
 
+extern long strtol();               /* convert string to long integer */
+
+extern void qsort();                /* sort array */
+
 /* time() is declared (often indirectly) in <sys/time.h> on most systems.
  * if this is NOT the case then uncomment the following declaration and
  * check to be sure that the return type of time() is correct.
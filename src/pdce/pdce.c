@@ -43,6 +43,7 @@
  *   DCE_mksendbuf();
  *   DCE_pk*();
  *   DCE_pkbyte_blk();
+ *   DCE_pkbytev();
  *   DCE_send();
  *   DCE_freesendbuf();
  *
@@ -99,6 +100,8 @@
  *
  *     DCE_pkbyte_blk() - same as basic DCE_pk*()
  *
+ *     DCE_pkbytev() - same as basic DCE_pk*()
+ *
  *     DCE_send() - commit derived data type and send message.
  *
  *     DCE_freesendbuf() - free the (potentially uncommited) derived data type.
@@ -147,8 +150,11 @@
 #include <stdlib.h>
 #else
 #include "nonansi.h"
+#include <memory.h>
 #endif
 
+#include <string.h>
+
 #include <pvm3.h>
 
 #include "gpmacro.h"
@@ -557,6 +563,86 @@ int DCE_pkbyte_blk(addr, blksz, blkstride, nitem)
 
 
 
+/*
+ * DCE_pkbytev() - See pdce.h for description
+ *
+ * PVM packs each byte array as a unit; under the default (XDR) encoding
+ * the packed array is padded to a multiple of four bytes, whereas under
+ * the raw encoding it is not.  Hence byte arrays are packed in place, each
+ * with a separate PVM call, only if the result is identical to packing a
+ * single contiguous byte array; otherwise byte arrays are gathered into a
+ * temporary buffer and packed with a single PVM call.
+ */
+
+#ifdef __STDC__
+int DCE_pkbytev(struct DCE_iovec *iov,
+		int iovcnt)
+#else
+int DCE_pkbytev(iov, iovcnt)
+     struct DCE_iovec *iov;
+     int iovcnt;
+#endif
+{
+  int rcode, pvmcode, inplace, nbyte, i;
+  char *gbuf, *gpos;
+
+  /* check that send buf alloced */
+  if (!sendbuf_alloced)
+    rcode = PIOUS_EPERM;
+
+  /* pack data */
+  else
+    { /* determine if byte arrays can be packed in place */
+      inplace = TRUE;
+      nbyte   = 0;
+
+      for (i = 0; i < iovcnt; i++)
+	{
+#ifndef USEPVMRAW
+	  if (i < iovcnt - 1 && iov[i].len % 4 != 0)
+	    inplace = FALSE;
+#endif
+	  nbyte += iov[i].len;
+	}
+
+      /* case: pack each byte array in place */
+
+      if (inplace)
+	{
+	  pvmcode = PvmOk;
+
+	  for (i = 0; i < iovcnt && pvmcode == PvmOk; i++)
+	    pvmcode = pvm_pkbyte(iov[i].base, iov[i].len, 1);
+	}
+
+      /* case: gather byte arrays and pack as a single array */
+
+      else if ((gbuf = malloc((unsigned)nbyte)) == NULL)
+	pvmcode = PvmNoMem;
+
+      else
+	{
+	  for (gpos = gbuf, i = 0; i < iovcnt; gpos += iov[i].len, i++)
+	    memcpy(gpos, iov[i].base, iov[i].len);
+
+	  pvmcode = pvm_pkbyte(gbuf, nbyte, 1);
+
+	  free(gbuf);
+	}
+
+      if (pvmcode == PvmOk)
+	rcode = PIOUS_OK;
+      else if (pvmcode == PvmNoMem)
+	rcode = PIOUS_EINSUF;
+      else
+	rcode = PIOUS_ETPORT;
+    }
+
+  return rcode;
+}
+
+
+
 
 /*
  * DCE_send() - See pdce.h for description
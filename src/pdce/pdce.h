@@ -43,6 +43,7 @@
  *   DCE_mksendbuf();
  *   DCE_pk*();
  *   DCE_pkbyte_blk();
+ *   DCE_pkbytev();
  *   DCE_send();
  *   DCE_freesendbuf();
  *
@@ -214,6 +215,51 @@ int DCE_pkbyte_blk(char *addr,
 #else
 int DCE_pkbyte_blk();
 #endif
+
+
+
+
+/*
+ * DCE_pkbytev()
+ *
+ * Parameters:
+ *
+ *   iov    - byte array I/O vector
+ *   iovcnt - I/O vector entry count
+ *
+ * Pack the 'iovcnt' byte arrays described by I/O vector 'iov' into allocated
+ * send buffer, in order, as a single byte array; i.e. the data packed may be
+ * unpacked via a single DCE_upkbyte() of the total byte count.  Byte arrays
+ * are packed "raw"; i.e. not interpretted.
+ *
+ * Byte arrays are packed directly from the memory described by 'iov', such
+ * that data need not first be gathered into a contiguous buffer by the
+ * caller; memory must remain unaltered until DCE_send() completes.
+ *
+ * NOTE: for performance, presumes arguments to be correct; in particular,
+ *       it must be true that the total byte count <= PIOUS_INT_MAX
+ *
+ * Returns:
+ *
+ *   PIOUS_OK(0) - DCE_pkbytev() completed without error
+ *   <  0        - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EPERM  - no send buffer allocated; operation not permitted
+ *       PIOUS_EINSUF - insufficient system resources to complete
+ *       PIOUS_ETPORT - error in underlying transport system
+ */
+
+struct DCE_iovec{
+  char *base;             /* byte array address */
+  int len;                /* byte array length */
+};
+
+#ifdef __STDC__
+int DCE_pkbytev(struct DCE_iovec *iov,
+		int iovcnt);
+#else
+int DCE_pkbytev();
+#endif
 		    
 
 
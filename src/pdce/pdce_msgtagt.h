@@ -70,7 +70,7 @@ typedef int dce_msgtagt;
  *          DCE_MSGTAGT_MAX == Max(PDS_OPCODE_MAX, PSC_OPCODE_MAX)
  */
 
-#define DCE_MSGTAGT_MAX 17
+#define DCE_MSGTAGT_MAX 19
 
 #define DCE_MSGTAGT_BASE (PIOUS_INT_MAX - DCE_MSGTAGT_MAX)
 
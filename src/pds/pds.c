@@ -53,6 +53,8 @@
  * PDS_chmod{_send, _recv}();
  * PDS_stat{_send, _recv}();
  * PDS_ping{_send, _recv}();
+ * PDS_cachestat{_send, _recv}();
+ * PDS_advise{_send, _recv}();
  * PDS_reset{_send, _recv}();
  * PDS_shutdown{_send, _recv}();
  *
@@ -97,6 +99,8 @@
 
 #include "pds_transidt.h"
 #include "pds_fhandlet.h"
+#include "pds_sstorage_manager.h"
+#include "pds_cache_manager.h"
 #include "pds.h"
 #include "pds_msg_exchange.h"
 
@@ -2287,6 +2291,282 @@ int PDS_ping_recv(pdsid, cmsgid)
 
 
 
+/*
+ * PDS_cachestat() - See pds.h for description.
+ */
+
+#ifdef __STDC__
+int PDS_cachestat(dce_srcdestt pdsid,
+		  int cmsgid,
+		  struct CM_stats *stats,
+		  struct SS_stats *ss_stats,
+		  struct PDS_abortstats *abort_stats)
+#else
+int PDS_cachestat(pdsid, cmsgid, stats, ss_stats, abort_stats)
+     dce_srcdestt pdsid;
+     int cmsgid;
+     struct CM_stats *stats;
+     struct SS_stats *ss_stats;
+     struct PDS_abortstats *abort_stats;
+#endif
+{
+  int rcode;
+
+  /* validate 'stats', 'ss_stats', and 'abort_stats' arguments */
+  if (stats == NULL || ss_stats == NULL || abort_stats == NULL)
+    rcode = PIOUS_EINVAL;
+
+  /* send PDS cachestat request */
+  else if ((rcode = PDS_cachestat_send(pdsid, cmsgid)) == PIOUS_OK)
+
+    /* receive PDS cachestat result */
+    rcode = PDS_cachestat_recv(pdsid, cmsgid, stats, ss_stats, abort_stats);
+
+  return rcode;
+}
+
+
+#ifdef __STDC__
+int PDS_cachestat_send(dce_srcdestt pdsid,
+		       int cmsgid)
+#else
+int PDS_cachestat_send(pdsid, cmsgid)
+     dce_srcdestt pdsid;
+     int cmsgid;
+#endif
+{
+  int mcode, rcode;
+  pdsmsg_reqt reqmsg;
+
+  /* set request message fields */
+  reqmsg.CachestatHead.cmsgid = cmsgid;
+
+  /* send request message to PDS */
+  mcode = PDSMSG_req_send(pdsid,
+			  PDS_CACHESTAT_OP,
+			  &reqmsg, (struct PDS_vbuf_dscrp *)NULL);
+
+  /* set result code appropriately */
+  switch(mcode)
+    {
+    case PIOUS_OK:
+    case PIOUS_ESRCDEST:
+    case PIOUS_EINSUF:
+    case PIOUS_ETPORT:
+      rcode = mcode;
+      break;
+    default:
+      /* PIOUS_EINVAL or other error indicates a bug in the PIOUS code */
+      rcode = PIOUS_EUNXP;
+      break;
+    }
+
+  return rcode;
+}
+
+
+#ifdef __STDC__
+int PDS_cachestat_recv(dce_srcdestt pdsid,
+		       int cmsgid,
+		       struct CM_stats *stats,
+		       struct SS_stats *ss_stats,
+		       struct PDS_abortstats *abort_stats)
+#else
+int PDS_cachestat_recv(pdsid, cmsgid, stats, ss_stats, abort_stats)
+     dce_srcdestt pdsid;
+     int cmsgid;
+     struct CM_stats *stats;
+     struct SS_stats *ss_stats;
+     struct PDS_abortstats *abort_stats;
+#endif
+{
+  int rcode, mcode;
+  pdsmsg_replyt replymsg;
+
+  /* validate 'stats', 'ss_stats', and 'abort_stats' arguments */
+  if (stats == NULL || ss_stats == NULL || abort_stats == NULL)
+    rcode = PIOUS_EINVAL;
+
+  /* receive PDS reply */
+  else
+    {
+      mcode = PDSMSG_reply_recv(pdsid,
+				PDS_CACHESTAT_OP,
+				&replymsg, (struct PDS_vbuf_dscrp *)NULL);
+
+      /* set result code */
+      switch(mcode)
+	{
+	case PIOUS_OK:
+	  /* reply msg received without error; check (cmsgid) */
+	  if (cmsgid != replymsg.CachestatHead.cmsgid)
+	    rcode = PIOUS_EUNXP;
+
+	  /* extract statistics and PDS result code */
+	  else if ((rcode = replymsg.CachestatHead.rcode) == PIOUS_OK)
+	    {
+	      *stats       = replymsg.CachestatBody.stats;
+	      *ss_stats    = replymsg.CachestatBody.ss_stats;
+	      *abort_stats = replymsg.CachestatBody.abort_stats;
+	    }
+
+	  break;
+
+	case PIOUS_ESRCDEST:
+	case PIOUS_EINSUF:
+	case PIOUS_ETPORT:
+	  /* error receiving PDS reply */
+	  rcode = mcode;
+	  break;
+
+	default:
+	  /* PIOUS_EINVAL or other error indicates a bug in the PIOUS code */
+	  rcode = PIOUS_EUNXP;
+	  break;
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * PDS_advise() - See pds.h for description.
+ */
+
+#ifdef __STDC__
+int PDS_advise(dce_srcdestt pdsid,
+	       int cmsgid,
+	       pds_fhandlet fhandle,
+	       pious_offt offset,
+	       pious_sizet nbyte,
+	       int advice)
+#else
+int PDS_advise(pdsid, cmsgid, fhandle, offset, nbyte, advice)
+     dce_srcdestt pdsid;
+     int cmsgid;
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     int advice;
+#endif
+{
+  int rcode;
+
+  /* send PDS advise request */
+  if ((rcode = PDS_advise_send(pdsid, cmsgid,
+			       fhandle, offset, nbyte, advice)) == PIOUS_OK)
+
+    /* receive PDS advise result */
+    rcode = PDS_advise_recv(pdsid, cmsgid);
+
+  return rcode;
+}
+
+
+#ifdef __STDC__
+int PDS_advise_send(dce_srcdestt pdsid,
+		    int cmsgid,
+		    pds_fhandlet fhandle,
+		    pious_offt offset,
+		    pious_sizet nbyte,
+		    int advice)
+#else
+int PDS_advise_send(pdsid, cmsgid, fhandle, offset, nbyte, advice)
+     dce_srcdestt pdsid;
+     int cmsgid;
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     int advice;
+#endif
+{
+  int mcode, rcode;
+  pdsmsg_reqt reqmsg;
+
+  /* set request message fields */
+  reqmsg.AdviseHead.cmsgid = cmsgid;
+
+  reqmsg.AdviseBody.fhandle = fhandle;
+  reqmsg.AdviseBody.offset  = offset;
+  reqmsg.AdviseBody.nbyte   = nbyte;
+  reqmsg.AdviseBody.advice  = advice;
+
+  /* send request message to PDS */
+  mcode = PDSMSG_req_send(pdsid,
+			  PDS_ADVISE_OP,
+			  &reqmsg, (struct PDS_vbuf_dscrp *)NULL);
+
+  /* set result code appropriately */
+  switch(mcode)
+    {
+    case PIOUS_OK:
+    case PIOUS_ESRCDEST:
+    case PIOUS_EINSUF:
+    case PIOUS_ETPORT:
+      rcode = mcode;
+      break;
+    default:
+      /* PIOUS_EINVAL or other error indicates a bug in the PIOUS code */
+      rcode = PIOUS_EUNXP;
+      break;
+    }
+
+  return rcode;
+}
+
+
+#ifdef __STDC__
+int PDS_advise_recv(dce_srcdestt pdsid,
+		    int cmsgid)
+#else
+int PDS_advise_recv(pdsid, cmsgid)
+     dce_srcdestt pdsid;
+     int cmsgid;
+#endif
+{
+  int mcode, rcode;
+  pdsmsg_replyt replymsg;
+
+  /* receive reply message from PDS */
+  mcode = PDSMSG_reply_recv(pdsid,
+			    PDS_ADVISE_OP,
+			    &replymsg, (struct PDS_vbuf_dscrp *)NULL);
+
+  /* set result code */
+  switch(mcode)
+    {
+    case PIOUS_OK:
+      /* reply msg received without error; check (cmsgid) */
+      if (cmsgid != replymsg.AdviseHead.cmsgid)
+	rcode = PIOUS_EUNXP;
+
+      /* extract PDS result code */
+      else
+	rcode = replymsg.AdviseHead.rcode;
+      break;
+
+    case PIOUS_ESRCDEST:
+    case PIOUS_EINSUF:
+    case PIOUS_ETPORT:
+      /* error receiving PDS reply */
+      rcode = mcode;
+      break;
+
+    default:
+      /* PIOUS_EINVAL or other error indicates a bug in the PIOUS code */
+      rcode = PIOUS_EUNXP;
+      break;
+    }
+
+  return rcode;
+}
+
+
+
+
 /*
  * PDS_reset() - See pds.h for description.
  */
@@ -279,6 +279,8 @@
  * PDS_chmod{_send, _recv}();
  * PDS_stat{_send, _recv}();
  * PDS_ping{_send, _recv}();
+ * PDS_cachestat{_send, _recv}();
+ * PDS_advise{_send, _recv}();
  * PDS_reset{_send, _recv}();
  * PDS_shutdown{_send, _recv}();
  *
@@ -307,6 +309,16 @@ struct PDS_vbuf_dscrp{
 };
 
 
+/* Transaction abort counts, by cause; see PDS_cachestat() */
+
+struct PDS_abortstats{
+  unsigned long deadlock;       /* blocked in wait-for graph cycle */
+  unsigned long timeout;        /* blocked beyond PDS_TDEADLOCK */
+  unsigned long prepare;        /* unable to prepare */
+  unsigned long client;         /* by client request */
+};
+
+
 
 
 /*
@@ -1464,6 +1476,151 @@ int PDS_ping_recv();
 
 
 
+/*
+ * PDS_cachestat()
+ *
+ * Parameters:
+ *
+ *   pdsid       - PDS id
+ *   cmsgid      - control message id
+ *   stats       - cache statistics
+ *   ss_stats    - stable storage statistics
+ *   abort_stats - transaction abort counts
+ *
+ * Obtains statistics describing the configuration, state, and activity of
+ * the data server cache and places them in 'stats'; see CM_stats() in
+ * pds/pds_cache_manager.h for a description.  The cache is not altered.
+ * Statistics describing the file information cache and file descriptor
+ * pool of the stable storage manager are placed in 'ss_stats'; see
+ * SS_stats() in pds/pds_sstorage_manager.h for a description.
+ * Counts of transactions aborted by the data server since initialization,
+ * by cause, are placed in 'abort_stats'.
+ *
+ *
+ * Returns: PDS_cachestat(), PDS_cachestat_recv()
+ *
+ *   PIOUS_OK (0) - cache statistics successfully obtained
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_ESRCDEST     - invalid 'pdsid' argument
+ *       PIOUS_EINVAL       - invalid 'stats', 'ss_stats', or 'abort_stats'
+ *                            argument
+ *       PIOUS_EINSUF       - insufficient system resources to complete; retry
+ *       PIOUS_ETPORT       - error condition in underlying transport system
+ *       PIOUS_EUNXP        - unexpected error condition encountered
+ *
+ * Returns: PDS_cachestat_send()
+ *
+ *   PIOUS_OK (0) - PDS_cachestat_send() completed successfully
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_ESRCDEST - invalid 'pdsid' argument
+ *       PIOUS_EINSUF   - insufficient system resources to complete; retry
+ *       PIOUS_ETPORT   - error condition in underlying transport system
+ *       PIOUS_EUNXP    - unexpected error condition encountered
+ */
+
+struct CM_stats;           /* see pds/pds_cache_manager.h */
+struct SS_stats;           /* see pds/pds_sstorage_manager.h */
+
+#ifdef __STDC__
+int PDS_cachestat(dce_srcdestt pdsid,
+		  int cmsgid,
+		  struct CM_stats *stats,
+		  struct SS_stats *ss_stats,
+		  struct PDS_abortstats *abort_stats);
+
+int PDS_cachestat_send(dce_srcdestt pdsid,
+		       int cmsgid);
+
+int PDS_cachestat_recv(dce_srcdestt pdsid,
+		       int cmsgid,
+		       struct CM_stats *stats,
+		       struct SS_stats *ss_stats,
+		       struct PDS_abortstats *abort_stats);
+#else
+int PDS_cachestat();
+
+int PDS_cachestat_send();
+
+int PDS_cachestat_recv();
+#endif
+
+
+
+
+/*
+ * PDS_advise()
+ *
+ * Parameters:
+ *
+ *   pdsid   - PDS id
+ *   cmsgid  - control message id
+ *   fhandle - file handle
+ *   offset  - starting offset
+ *   nbyte   - byte count; zero (0) specifies through end of file
+ *   advice  - expected access pattern
+ *
+ * Advise the PDS of the expected pattern of access to file 'fhandle',
+ * starting at 'offset' bytes from the beginning and proceeding for 'nbyte'
+ * bytes, such that the PDS can manage its cache accordingly.  Valid values
+ * of 'advice' are the PIOUS_ADV_* constants defined in pious_std.h; see
+ * CM_advise() in pds/pds_cache_manager.h for a description.
+ *
+ * Advice does not alter file contents, and is not subject to transaction
+ * semantics.
+ *
+ * Returns: PDS_advise(), PDS_advise_recv()
+ *
+ *   PIOUS_OK (0) - advice successfully applied
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_ESRCDEST - invalid 'pdsid' argument
+ *       PIOUS_EINVAL   - 'offset', 'nbyte', or 'advice' is not a proper value
+ *       PIOUS_EINSUF   - insufficient system resources to complete; retry
+ *       PIOUS_ETPORT   - error condition in underlying transport system
+ *       PIOUS_EUNXP    - unexpected error condition encountered
+ *       PIOUS_EFATAL   - fatal error; check PDS error log
+ *
+ * Returns: PDS_advise_send()
+ *
+ *   PIOUS_OK (0) - PDS_advise_send() completed successfully
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_ESRCDEST - invalid 'pdsid' argument
+ *       PIOUS_EINSUF   - insufficient system resources to complete; retry
+ *       PIOUS_ETPORT   - error condition in underlying transport system
+ *       PIOUS_EUNXP    - unexpected error condition encountered
+ */
+
+#ifdef __STDC__
+int PDS_advise(dce_srcdestt pdsid,
+	       int cmsgid,
+	       pds_fhandlet fhandle,
+	       pious_offt offset,
+	       pious_sizet nbyte,
+	       int advice);
+
+int PDS_advise_send(dce_srcdestt pdsid,
+		    int cmsgid,
+		    pds_fhandlet fhandle,
+		    pious_offt offset,
+		    pious_sizet nbyte,
+		    int advice);
+
+int PDS_advise_recv(dce_srcdestt pdsid,
+		    int cmsgid);
+#else
+int PDS_advise();
+
+int PDS_advise_send();
+
+int PDS_advise_recv();
+#endif
+
+
+
+
 /*
  * PDS_reset()
  *
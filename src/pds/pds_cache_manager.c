@@ -63,11 +63,33 @@
  * given sufficient space, to prevent the cache from being flooded when such
  * lines comprise a sizeable fraction of the workload.
  *
+ * The size of the PROTECTED segment is fixed under the SLRU policy
+ * (CM_POLICY_SLRU).  Under the adaptive policy (CM_POLICY_ARC) the segment
+ * sizes are instead tuned online in the manner of ARC: the identities of
+ * lines discarded from the cache are retained in two ghost lists, one for
+ * lines that were only ever in the PROBATIONARY segment and one for lines
+ * that had been in the PROTECTED segment.  A cache-miss on a line in the
+ * former indicates that the PROBATIONARY segment is too small, and on a line
+ * in the latter that the PROTECTED segment is too small; the target size of
+ * the PROTECTED segment is adjusted accordingly, in proportion to the
+ * relative sizes of the ghost lists.  The PROTECTED segment grows toward its
+ * target as lines are promoted, and shrinks toward its target as lines are
+ * allocated.
+ *
  * The pds_cache_manager also implements a dual write policy: volatile
  * writes operate under a write-through policy while stable writes operate
  * under a write-back (delayed write) policy.  Write operations do not
  * allocate cache blocks.
  *
+ * Optionally, volatile writes may instead operate under a write-back policy
+ * (see CM_init()).  In this mode a volatile write allocates a cache block,
+ * reading any existing block data on a cache-miss, and successive writes to
+ * a block are coalesced in cache.  Dirty volatile blocks are kept on a list
+ * in the order in which they became dirty, and are written to stable storage
+ * by CM_bgflush() when their number exceeds a configured percentage of the
+ * cache or the oldest exceeds a configured age, as well as by CM_flush(),
+ * CM_fflush(), and block replacement.
+ *
  * The dual write policy insures data integrity for volatile mode access
  * when client processes fail to properly close files before shutting
  * down the PIOUS system.  Since volatile writes are asynchronous (effectively
@@ -97,23 +119,191 @@
  * read_dblk() operations that cache-hit, if the cached block is incomplete
  * it must be (possibly flushed and) re-read.
  *
+ * To avoid re-reading the tail block of a growing file on every access, the
+ * pds_cache_manager records the size of recently accessed files.  A file
+ * size is recorded when an incomplete data block, or run of data blocks, is
+ * read from stable storage, and is maintained by CM_write().  An incomplete
+ * cached block that ends at the recorded file size is current; one that
+ * ends before it was extended only by an implied write of zeros, since all
+ * writes to a cached block update the block.  In either case the cache-hit
+ * is satisfied from cache.  Only when the file size is not recorded must
+ * the incomplete block be re-read.
+ *
+ * Under the volatile write-back policy a write past EOF may also reside only
+ * in cache, such that stable storage reports an EOF that precedes data
+ * blocks not yet flushed.  Thus, when a data block read from stable storage
+ * is incomplete, any dirty blocks beyond it in the same file are flushed and
+ * the block re-read.
+ *
+ *
+ * The data block cache is sized at PDS start-up via CM_init().  Data blocks
+ * are allocated from a single page-aligned arena, optionally backed by huge
+ * pages, and the data block and file handle hash tables are sized in
+ * proportion to the cache so that hash chains remain short for large caches.
+ *
+ * The pds_cache_manager performs sequential readahead on a per-file basis.
+ * A CM_read() that begins where the previous CM_read() of the same file
+ * ended is considered sequential; sequential access opens a readahead window
+ * that doubles with each subsequent sequential access, up to a configured
+ * maximum, and collapses on non-sequential access.  Data blocks within the
+ * window that are not cached are loaded with a single vectored read
+ * (SS_readv()) and placed in the PROBATIONARY segment.  A prefetched block
+ * is not considered to have been referenced until first read, so that
+ * prefetching does not promote blocks to the PROTECTED segment.
+ *
+ * A CM_read() spanning at least a configured number of data blocks is
+ * performed by read_extent() rather than block by block.  Cached data blocks
+ * are read via read_dblk() as usual, while each run of non-cached data
+ * blocks is read from stable storage with a single SS_read() directly into
+ * the caller's buffer.  Data blocks so read are not cached, such that large
+ * transfers, which are typically streaming in nature, do not flood the cache.
+ *
+ * CM_readv() performs a read as for CM_read(), but rather than copying data
+ * out of the cache returns references to the cached data blocks, such that
+ * a reply may be sent to the client directly from the cache.  Referenced
+ * cache entries are pinned, and hence not replaced, until CM_release().
+ * The number of pinned entries is limited to less than the minimum size of
+ * the PROBATIONARY segment so that cache_alloc() can always locate an entry
+ * to replace.  The limit is set from the configured PROBATIONARY segment
+ * size, up to PIN_MAX, and under the adaptive policy the PROBATIONARY segment
+ * is never reduced below it; thus references remain available regardless
+ * of the readahead window limit.
+ *
+ * So that a restarted PDS does not begin with a cold cache, CM_warmsave()
+ * records the data blocks of the PROTECTED segment in a manifest kept by the
+ * stable storage manager.  On start-up CM_warmload() reads the manifest, and
+ * the PDS daemon calls CM_warmup() when otherwise idle to load the listed
+ * data blocks, in file order and a bounded run at a time, via the vectored
+ * read used for readahead.  Warmed data blocks are placed directly in the
+ * PROTECTED segment, where they resided prior to the restart.
+ *
+ * Clients may advise the pds_cache_manager of the expected pattern of access
+ * to a file via CM_advise().  Advice that describes the file as a whole
+ * (SEQUENTIAL, RANDOM, NOREUSE) is retained with the sequential access
+ * state of the file, and is consulted on each access only when advice is
+ * in effect for some file.  SEQUENTIAL advice
+ * opens the readahead window fully and RANDOM advice keeps it closed.  Data
+ * blocks of a NOREUSE file are placed at the LRU position of the
+ * PROBATIONARY segment rather than being promoted, such that a scan does not
+ * displace the PROTECTED segment.  WILLNEED and DONTNEED advice act at once,
+ * prefetching or discarding the data blocks spanned by the advised range.
+ *
+ * Optionally, admission to the cache may be filtered by reference frequency
+ * in the manner of TinyLFU (see CM_init()).  The frequency of reference of
+ * each data block is estimated by a count-min sketch of small saturating
+ * counters, all of which are halved periodically so that estimates reflect
+ * recent history.  A data block that is read on a cache-miss, or read for
+ * the first time after being prefetched, is admitted only if its estimated
+ * frequency exceeds that of the data block next to be replaced.  A data
+ * block not admitted is still loaded and referenced, but is placed at the
+ * LRU position of the PROBATIONARY segment, such that it is the first entry
+ * re-allocated; a scan of infrequently accessed data thus replaces a single
+ * cache entry rather than the PROBATIONARY segment as a whole.  Warm-up,
+ * readahead, and writes are not subject to the filter.
+ *
+ * Optionally, a slab of small data blocks is kept apart from the cache
+ * proper, such that small files, and the tails of larger files, do not
+ * each occupy a full data block.  A data block read on a cache-miss that
+ * holds fewer bytes than a small data block is moved to the least recently
+ * used small data block, releasing its cache entry; if known beforehand
+ * from the recorded file size to be so small, the data block is loaded
+ * directly into a small data block instead.  Small data blocks are never
+ * dirty: a write to a data block held in a small data block, or an
+ * allocation of a cache entry for it, first discards the small data block,
+ * as does any change in the recorded file size that might extend it.  Small
+ * data blocks are replaced in LRU order, are located via the same hash
+ * tables as cache entries, and are otherwise not subject to the SLRU
+ * policy, readahead, the admission filter, or partitioning.
+ *
+ * Optionally, a slab of large data blocks is likewise kept apart from the
+ * cache proper, such that a large file is cached in few large transfers.
+ * A file is assigned a data block class via CM_fclass() when looked up: the
+ * large class if so hinted, or if the file is at least a configured size,
+ * and otherwise the standard class.  Reads of a large class file are
+ * satisfied from large data blocks, each loaded with a single SS_read() into
+ * the least recently used large data block that is not referenced.  Large
+ * data blocks are subject to the admission filter and to partitioning as
+ * are cache entries: references are recorded in the same frequency sketch,
+ * a large data block not admitted is made least recently used, and each
+ * valid large data block is charged to the partition of its file, with
+ * partition shares applied to the slab in large data blocks.  A large data
+ * block that can not be loaded within partition shares is read directly
+ * from stable storage.  Reads of a large class file are deliberately not
+ * subject to readahead or reads by extent, as each large data block is
+ * itself a large transfer.  Writes of a large class file are written through
+ * to stable storage, as for a cache-miss, and update the large data blocks
+ * spanned, such that large data blocks are never dirty; an incomplete large
+ * data block is served per the recorded file size as for a cache entry.
+ * Large data blocks are located via a hash table of their own, by large
+ * data block number.  The data of a file is cached in one class only, such
+ * that standard and large data block numbers of a file do not share
+ * frequency counts: a file entering the large class is flushed and its
+ * cache entries invalidated, and a file leaving it has its large data blocks
+ * and cache entries discarded.
+ *
+ * The cache may be divided into partitions to which files are assigned via
+ * CM_fpartition(), such that the working set of one class of files does not
+ * displace that of another.  Each partition has a reserved and a maximum
+ * share of the cache, and each valid cache entry is charged to the
+ * partition of its file at the time the entry is validated.  When
+ * allocating an entry for a partition at its maximum share, cache_alloc()
+ * replaces an entry of that partition; otherwise it does not replace an
+ * entry of another partition at or below its reserved share.  Should no
+ * entry of the PROBATIONARY segment satisfy these constraints, an entry of
+ * the PROTECTED segment that does is demoted and replaced.  Should no entry
+ * at all satisfy them, the data block is accessed without caching: read
+ * directly from stable storage, or written through, as for a cache-miss.
+ * The constraints are never relaxed, such that the reserved share of a
+ * partition survives a scan of files in another.  So that a partition at
+ * its maximum share can replace its own entries, its data blocks are not
+ * promoted to the PROTECTED segment.  CM_readv() of a data block not cached
+ * within partition shares returns PIOUS_EBUSY, such that it is read via
+ * CM_read().
+ *
+ * The sequential access state, recorded size, retained advice, partition,
+ * and data block class of a file are kept together in a single file entry,
+ * located via a hash table by file handle.  The file entry pool grows as
+ * files are accessed, up to the number of files for which the stable
+ * storage manager retains file information, so that the state of every
+ * file in use is retained.  Only beyond that limit are entries re-allocated
+ * in LRU order; the file of an entry re-allocated reverts to the default
+ * partition and the standard class, having its large data blocks and cache
+ * entries discarded if of the large class.
+ *
  *
  * Function Summary:
  *
+ * CM_defparam();
+ * CM_init();
  * CM_read();
  * CM_write();
  * CM_flush();
  * CM_fflush();
+ * CM_bgflush();
  * CM_invalidate();
  * CM_finvalidate();
+ * CM_advise();
+ * CM_fpartition();
+ * CM_fclass();
+ * CM_warmsave();
+ * CM_warmload();
+ * CM_warmup();
+ * CM_stats();
  *
  *
  *
  * ----------------------------------------------------------------------------
  * Implementation Notes:
  *
- *   1) Can increase disk efficiency of CM_flush() if performed on a
- *      per-file basis.
+ *   1) CM_flush() and CM_fflush() gather dirty data blocks, sort them by
+ *      file and data block number, and write each run of contiguous blocks
+ *      with a single vectored write (SS_writev()), such that a flush
+ *      proceeds in file order with few, large writes.  A PIOUS_STABLE run
+ *      is forced to disk once rather than once per data block.
+ *
+ *   2) Cache activity counters are maintained in 'cm_stat' at the point of
+ *      each event and are reported, with the cache state scanned at the time
+ *      of the request, by CM_stats().  Counters are never reset.
  */
 
 /* Include Files */
@@ -129,12 +319,17 @@
 #include <string.h>
 
 #include "gpmacro.h"
+#include "gputil.h"
 
 #include "pious_types.h"
 #include "pious_errno.h"
 #include "pious_std.h"
 #include "pious_sysconfig.h"
 
+#include "psys.h"
+
+#include "pfs.h"
+
 #include "pds_fhandlet.h"
 #include "pds_sstorage_manager.h"
 
@@ -147,23 +342,19 @@
  */
 
 
-/* Data Block, Cache, and Data Block and File Handle Hash Table Sizes */
-
-/* data block size in bytes; see config/pious_sysconfig.h */
-#define DBLK_SZ    PDS_CM_DBLK_SZ
-
-/* cache size in number of data blocks; see config/pious_sysconfig.h */
-#if PDS_CM_CACHE_SZ == 1
-#define CACHE_SZ   2
-#else
-#define CACHE_SZ   PDS_CM_CACHE_SZ
-#endif
+/* Data Block and File Handle Hash Table Sizes
+ *
+ *   hash table sizes are determined when the cache is initialized; the
+ *   data block hash table has approximately one bucket per cache entry,
+ *   and the file handle hash table approximately one bucket per
+ *   FH_TABLE_LOAD cache entries.  see table_size().
+ */
 
-/* data block hash table size; choose prime not near a power of 2 */
-#define DBLK_TABLE_SZ     103
+/* minimum hash table size; choose prime not near a power of 2 */
+#define TABLE_SZ_MIN      103
 
-/* file handle hash table size; choose prime not near a power of 2 */
-#define FH_TABLE_SZ       103
+/* cache entries per file handle hash table bucket */
+#define FH_TABLE_LOAD     8
 
 
 /* Segmented LRU parameters */
@@ -171,9 +362,69 @@
 /* cache segment in which data block resides */
 #define PROTECTED     0
 #define PROBATIONARY  1
+#define SMALL         2     /* small data block slab; neither segment */
+#define LARGE         3     /* large data block slab; neither segment */
+
+/* adaptive policy ghost list in which data block identity resides */
+#define GHOST_PB      0     /* discarded from probationary segment only */
+#define GHOST_PT      1     /* discarded after residing in protected seg */
+#define GHOST_FREE    2     /* ghost entry not in use */
+
+
+/* File state parameters */
+
+/* file entry pool initial size, and size limit to which the pool grows
+ * rather than re-allocate entries, in number of entries; the limit is that
+ * of the stable storage manager file information cache (FIC).
+ * (0 < FILE_POOL_SZ <= FILE_POOL_MAX)
+ */
+#define FILE_POOL_SZ      512
+#define FILE_POOL_MAX     65536
+
+
+/* Sequential readahead parameters */
 
-/* ratio of protected segment size to full cache size (0 < ratio < 1) */
-#define PROT_SEG_RATIO    0.70
+/* initial readahead window in data blocks */
+#define RA_WINDOW_INIT    4
+
+
+/* Admission filter parameters */
+
+/* frequency sketch rows; each row is indexed by a distinct hash function */
+#define ADM_DEPTH         4
+
+/* frequency sketch row width per cache entry; rounded up to a power of 2 */
+#define ADM_WIDTH_FACTOR  4
+
+/* maximum frequency count; counts saturate */
+#define ADM_COUNT_MAX     15
+
+/* references per cache entry after which all frequency counts are halved */
+#define ADM_SAMPLE_FACTOR 10
+
+
+/* Flush parameters */
+
+/* maximum number of data blocks written per vectored write */
+#define FLUSH_RUN_MAX     64
+
+
+/* Volatile write-back parameters */
+
+/* maximum number of data blocks written per CM_bgflush() call */
+#define WB_FLUSH_MAX      64
+
+
+/* Data block reference parameters */
+
+/* maximum number of cache entries pinned by CM_readv() */
+#define PIN_MAX           64
+
+
+/* Cache warm-up parameters */
+
+/* maximum number of data blocks read per CM_warmup() call */
+#define WARM_RUN_MAX      32
 
 
 /* Cache Entry: A cache container for a data block */
@@ -183,42 +434,215 @@ typedef struct cache_entry{
   int dirty;                  /* cache entry dirty flag */
   int segment;                /* cache segment in which entry resides */
   int faultmode;              /* PIOUS_STABLE or PIOUS_VOLATILE */
+  int prefetched;             /* loaded by readahead; not yet referenced */
+  int promoted;               /* resided in protected seg since allocated */
+  int wbdirty;                /* on volatile write-back dirty list flag */
+  int pinned;                 /* referenced via CM_readv(); not replaced */
+  int part;                   /* cache partition charged for valid entry */
+  util_clockt wbtime;         /* time at which entry became wbdirty */
   pds_fhandlet fhandle;       /* data block file handle */
   pious_offt db_nmbr;         /* data block number */
   pious_sizet db_nbyte;       /* data block valid byte count */
-  char dblk[DBLK_SZ];         /* data block */
+  char *dblk;                 /* data block (in cache arena) */
   struct cache_entry *cnext;  /* next cache entry in list (towards LRU) */
   struct cache_entry *cprev;  /* prev cache entry in list (towards MRU) */
   struct cache_entry *dbnext; /* next cache entry in data block hash chain */
   struct cache_entry *dbprev; /* prev cache entry in data block hash chain */
   struct cache_entry *fhnext; /* next cache entry in file handle hash chain */
   struct cache_entry *fhprev; /* prev cache entry in file handle hash chain */
+  struct cache_entry *wbnext; /* next cache entry in write-back dirty list */
+  struct cache_entry *wbprev; /* prev cache entry in write-back dirty list */
 } cache_entryt;
 
 
+/* Ghost Entry: identity of a data block discarded from the cache */
+
+typedef struct ghost_entry{
+  int list;                   /* GHOST_PB, GHOST_PT, or GHOST_FREE */
+  pds_fhandlet fhandle;       /* data block file handle */
+  pious_offt db_nmbr;         /* data block number */
+  struct ghost_entry *gnext;  /* next ghost entry in list (towards LRU) */
+  struct ghost_entry *gprev;  /* prev ghost entry in list (towards MRU) */
+  struct ghost_entry *hnext;  /* next ghost entry in hash chain */
+  struct ghost_entry *hprev;  /* prev ghost entry in hash chain */
+} ghost_entryt;
+
+
+/* File Entry: state retained for a file; sequential access state, file
+ * size, access advice, cache partition, and data block class
+ */
+
+typedef struct file_entry{
+  int valid;                  /* file entry allocated flag */
+  pds_fhandlet fhandle;       /* file handle */
+  pious_offt next_offset;     /* offset at which next sequential read begins */
+  pious_offt ra_nmbr;         /* first data block not yet prefetched */
+  long window;                /* readahead window in data blocks */
+  int fsize_known;            /* file size recorded flag */
+  pious_offt fsize;           /* file size in bytes */
+  int advice;                 /* retained advice; PIOUS_ADV_NORMAL if none */
+  int part;                   /* cache partition; 0 through part_cnt */
+  int large;                  /* large data block class flag */
+  struct file_entry *enext;   /* next file entry in list (towards LRU) */
+  struct file_entry *eprev;   /* prev file entry in list (towards MRU) */
+  struct file_entry *hnext;   /* next file entry in hash chain */
+  struct file_entry *hprev;   /* prev file entry in hash chain */
+} file_entryt;
+
+
 /*
  * Private Variable Definitions
  */
 
 
+/* data block cache configuration; set by cachemanager_init() */
+
+static long cache_sz;                   /* cache size in data blocks */
+static pious_sizet dblk_sz;             /* data block size in bytes */
+static int cache_hugepage;              /* arena backed by huge pages flag */
+
 /* data block cache */
 
-#if CACHE_SZ == 0
-/* for compilation purposes, declare cache even if it will not be used */
-static cache_entryt cache[1];
-#else
-static cache_entryt cache[CACHE_SZ];
-#endif
+static cache_entryt *cache;             /* cache entries */
+static char *cache_arena;               /* cache data block arena */
 
 static cache_entryt *cache_mru_pt;      /* MRU protected seg cache entry */
 static cache_entryt *cache_mru_pb;      /* MRU probationary seg cache entry */
 static cache_entryt *cache_lru_pb;      /* LRU probationary seg cache entry */
 
+static int cache_policy;                /* cache replacement policy */
+static long prot_sz;                    /* protected segment size */
+static long prot_target;                /* protected segment target size */
+static long prot_max;                   /* protected segment maximum size */
+
+/* small data block slab; entries are listed from MRU to LRU, and are never
+ * dirty.  sm_cnt is zero if the slab is off.
+ */
+
+static long sm_cnt;                     /* small data block count */
+static pious_sizet sm_sz;               /* small data block size in bytes */
+static cache_entryt *sm_cache;          /* small data block cache entries */
+static char *sm_arena;                  /* small data block arena */
+static cache_entryt *sm_mru, *sm_lru;   /* MRU/LRU small data block entries */
+
+/* large data block slab; entries are listed from MRU to LRU, are never
+ * dirty, and are hashed by large data block number.  lg_cnt is zero if the
+ * slab is off.
+ */
+
+static long lg_cnt;                     /* large data block count */
+static pious_sizet lg_sz;               /* large data block size in bytes */
+static pious_offt lg_min;               /* large class minimum file size */
+static cache_entryt *lg_cache;          /* large data block cache entries */
+static char *lg_arena;                  /* large data block arena */
+static cache_entryt *lg_mru, *lg_lru;   /* MRU/LRU large data block entries */
+static cache_entryt **lg_table;         /* large data block hash table */
+static long lg_table_sz;
+
 /* data block hash table - for general location of data blocks */
-static cache_entryt *dblk_table[DBLK_TABLE_SZ];
+static cache_entryt **dblk_table;
+static long dblk_table_sz;
 
 /* file handle hash table - for locating data blocks associated with fhandle */
-static cache_entryt *fh_table[FH_TABLE_SZ];
+static cache_entryt **fh_table;
+static long fh_table_sz;
+
+
+/* large read threshold in data blocks; 0 is off */
+
+static long lr_min;
+
+
+/* data block references returned by CM_readv(); pinned until CM_release() */
+
+static long pin_max;                    /* maximum pinned cache entries */
+static long pin_cnt;                    /* pinned cache entry count */
+static cache_entryt **pin_vec;          /* pinned cache entries */
+
+
+/* sequential readahead state */
+
+static long ra_cap;                     /* readahead window limit; 0 is off */
+static struct FS_iovec *ra_iov;         /* readahead/warm-up I/O vector */
+static cache_entryt **ra_vec;           /* readahead/warm-up I/O vector entries */
+
+
+/* file state; sequential access state, file size, access advice, cache
+ * partition, and data block class of recently accessed files
+ */
+
+static file_entryt file_pool[FILE_POOL_SZ];   /* initial file entries */
+static long file_sz;                          /* file entry count */
+static file_entryt *file_mru, *file_lru;      /* MRU/LRU file entries */
+static file_entryt **file_table;              /* file entry hash table */
+static long file_table_sz;
+static long adv_cnt;                          /* files with retained advice */
+
+
+/* cache partition state; partition 0 is the default partition, data block
+ * counts are of valid cache entries, and large data block counts are of
+ * valid large data blocks.
+ */
+
+static int part_cnt;                       /* configured partition count */
+static long part_min[CM_PART_MAX + 1];     /* reserved data blocks */
+static long part_max[CM_PART_MAX + 1];     /* maximum data blocks */
+static long part_nblk[CM_PART_MAX + 1];    /* valid data block count */
+static long part_lgmin[CM_PART_MAX + 1];   /* reserved large data blocks */
+static long part_lgmax[CM_PART_MAX + 1];   /* maximum large data blocks */
+static long part_lgnblk[CM_PART_MAX + 1];  /* valid large data block count */
+
+
+/* admission filter frequency sketch; ADM_DEPTH rows of adm_width counters,
+ * or NULL if the admission filter is off.
+ */
+
+static unsigned char *adm_sketch;       /* frequency sketch counters */
+static unsigned long adm_width;         /* sketch row width; a power of 2 */
+static long adm_sample;                 /* references between count halving */
+static long adm_nref;                   /* references since count halving */
+
+
+/* cache warm-up state; data blocks pending warm-up are warm_vec[warm_pos]
+ * through warm_vec[warm_cnt - 1].
+ */
+
+static long warm_cap;                   /* warm-up run limit; 0 is off */
+static struct SS_warmblk *warm_vec;     /* data blocks pending warm-up */
+static long warm_cnt;                   /* warm_vec element count */
+static long warm_pos;                   /* next pending warm_vec element */
+
+
+/* adaptive policy ghost lists; a ghost entry pool of cache_sz entries
+ * shared by both lists, and a hash table of dblk_table_sz buckets.
+ */
+
+static ghost_entryt *ghost;             /* ghost entries */
+static ghost_entryt **ghost_table;      /* ghost entry hash table */
+static ghost_entryt *ghost_free;        /* free ghost entries */
+static ghost_entryt *ghost_mru[2];      /* MRU ghost entry of each list */
+static ghost_entryt *ghost_lru[2];      /* LRU ghost entry of each list */
+static long ghost_len[2];               /* ghost entry count of each list */
+
+
+/* flush I/O vector and dirty cache entry vector */
+
+static struct FS_iovec *fl_iov;         /* flush I/O vector */
+static cache_entryt **fl_vec;           /* dirty cache entries to flush */
+
+
+/* volatile write-back state */
+
+static int cache_writeback;             /* volatile write-back policy flag */
+static long wb_dirty_max;               /* write-back dirty block threshold */
+static long wb_age;                     /* write-back dirty age threshold */
+static long wb_ndirty;                  /* write-back dirty block count */
+static cache_entryt *wb_head, *wb_tail; /* oldest/newest wbdirty entries */
+
+
+/* Cache statistics; activity counters only, state determined by CM_stats() */
+
+static struct CM_stats cm_stat;
 
 
 /* data block cache initilization flag */
@@ -235,6 +659,12 @@ static pious_ssizet read_dblk(pds_fhandlet fhandle,
 			      pious_sizet nbyte,
 			      char *buf);
 
+static pious_ssizet ref_dblk(pds_fhandlet fhandle,
+			     pious_offt db_nmbr,
+			     pious_offt offset,
+			     pious_sizet nbyte,
+			     cache_entryt **cache_entry);
+
 static int write_dblk(pds_fhandlet fhandle,
 		      pious_offt db_nmbr,
 		      pious_offt offset,
@@ -244,8 +674,81 @@ static int write_dblk(pds_fhandlet fhandle,
 
 static int cache_alloc(pds_fhandlet fhandle,
 		       pious_offt db_nmbr,
+		       int advisory,
 		       cache_entryt **cache_entry);
 
+static pious_ssizet load_dblk(cache_entryt *cache_entry);
+
+static pious_ssizet read_extent(pds_fhandlet fhandle,
+				pious_offt offset,
+				pious_sizet nbyte,
+				char *buf);
+
+static cache_entryt *cache_lookup(pds_fhandlet fhandle,
+				  pious_offt db_nmbr);
+
+static void readahead(pds_fhandlet fhandle,
+		      pious_offt offset,
+		      pious_sizet nbyte,
+		      int prefetch);
+
+static void prefetch_dblk(pds_fhandlet fhandle,
+			  pious_offt db_nmbr,
+			  long db_cnt,
+			  int warm);
+
+static cache_entryt *small_ref(pds_fhandlet fhandle,
+			       pious_offt db_nmbr);
+
+static cache_entryt *small_move(cache_entryt *cache_entry);
+
+static void small_discard(cache_entryt *cache_entry);
+
+static void small_place(cache_entryt *cache_entry,
+			int mru);
+
+static void small_reset(void);
+
+static pious_ssizet large_read(pds_fhandlet fhandle,
+			       pious_offt offset,
+			       pious_sizet nbyte,
+			       char *buf);
+
+static pious_ssizet large_readv(pds_fhandlet fhandle,
+				pious_offt offset,
+				pious_sizet nbyte,
+				struct FS_iovec *iov,
+				int *iovcnt);
+
+static int large_write(pds_fhandlet fhandle,
+		       pious_offt offset,
+		       pious_sizet nbyte,
+		       char *buf,
+		       int faultmode);
+
+static pious_ssizet large_ref(pds_fhandlet fhandle,
+			      pious_offt lg_nmbr,
+			      int filter,
+			      cache_entryt **entry);
+
+static cache_entryt *large_lookup(pds_fhandlet fhandle,
+				  pious_offt lg_nmbr);
+
+static void large_validate(cache_entryt *cache_entry);
+
+static void large_invalidate(cache_entryt *cache_entry);
+
+static void large_discard(cache_entryt *cache_entry);
+
+static void large_fdiscard(pds_fhandlet fhandle);
+
+static void large_place(cache_entryt *cache_entry,
+			int mru);
+
+static void large_reset(void);
+
+static void file_discard(pds_fhandlet fhandle);
+
 static void entry_validate(cache_entryt *cache_entry);
 
 static void entry_invalidate(cache_entryt *cache_entry);
@@ -254,16 +757,140 @@ static void make_mru_pt(cache_entryt *cache_entry);
 
 static void make_mru_pb(cache_entryt *cache_entry);
 
-static void cachemanager_init(void);
+static void make_lru_pb(cache_entryt *cache_entry);
+
+static void ghost_insert(cache_entryt *cache_entry);
+
+static void ghost_hit(pds_fhandlet fhandle,
+		      pious_offt db_nmbr);
+
+static void ghost_unlink(ghost_entryt *ghost_entry);
+
+static void ghost_reset(void);
+
+static file_entryt *file_lookup(pds_fhandlet fhandle,
+				int alloc);
+
+static void file_reset(void);
+
+static void file_grow(void);
+
+static void file_clear(void);
+
+static file_entryt *eof_lookup(pds_fhandlet fhandle,
+			       int alloc);
+
+static void eof_discard(pds_fhandlet fhandle);
+
+static int adv_lookup(pds_fhandlet fhandle);
+
+static void adv_set(pds_fhandlet fhandle,
+		    int advice);
+
+static void adm_index(pds_fhandlet fhandle,
+		      pious_offt db_nmbr,
+		      unsigned long *idx);
+
+static void adm_record(pds_fhandlet fhandle,
+		       pious_offt db_nmbr);
+
+static int adm_estimate(pds_fhandlet fhandle,
+			pious_offt db_nmbr);
+
+static int adm_admit(pds_fhandlet fhandle,
+		     pious_offt db_nmbr);
+
+static int part_lookup(pds_fhandlet fhandle);
+
+static void part_set(pds_fhandlet fhandle,
+		     int part);
+
+static int part_victim(cache_entryt *cache_entry,
+		       int part);
+
+static int part_promote(cache_entryt *cache_entry);
+
+static int class_lookup(pds_fhandlet fhandle);
+
+static void class_set(pds_fhandlet fhandle,
+		      int large);
+
+static void wb_insert(cache_entryt *cache_entry);
+
+static void wb_remove(cache_entryt *cache_entry);
+
+static int flush_file(pds_fhandlet fhandle,
+		      pious_offt db_nmbr);
+
+static int flush_dblks(long nentry);
+
+static int dblk_cmp(const void *entry_1,
+		    const void *entry_2);
+
+static long table_size(long nentry);
+
+static int cachemanager_init(struct CM_param *param);
 #else
 static pious_ssizet read_dblk();
+static pious_ssizet ref_dblk();
 static int write_dblk();
 static int cache_alloc();
+static pious_ssizet load_dblk();
+static pious_ssizet read_extent();
+static cache_entryt *cache_lookup();
+static void readahead();
+static void prefetch_dblk();
+static cache_entryt *small_ref();
+static cache_entryt *small_move();
+static void small_discard();
+static void small_place();
+static void small_reset();
+static pious_ssizet large_read();
+static pious_ssizet large_readv();
+static int large_write();
+static pious_ssizet large_ref();
+static cache_entryt *large_lookup();
+static void large_validate();
+static void large_invalidate();
+static void large_discard();
+static void large_fdiscard();
+static void large_place();
+static void large_reset();
+static void file_discard();
 static void entry_validate();
 static void entry_invalidate();
 static void make_mru_pt();
 static void make_mru_pb();
-static void cachemanager_init();
+static void make_lru_pb();
+static void ghost_insert();
+static void ghost_hit();
+static void ghost_unlink();
+static void ghost_reset();
+static file_entryt *file_lookup();
+static void file_reset();
+static void file_grow();
+static void file_clear();
+static file_entryt *eof_lookup();
+static void eof_discard();
+static int adv_lookup();
+static void adv_set();
+static void adm_index();
+static void adm_record();
+static int adm_estimate();
+static int adm_admit();
+static int part_lookup();
+static void part_set();
+static int part_victim();
+static int part_promote();
+static int class_lookup();
+static void class_set();
+static void wb_insert();
+static void wb_remove();
+static int flush_file();
+static int flush_dblks();
+static int dblk_cmp();
+static long table_size();
+static int cachemanager_init();
 #endif
 
 
@@ -273,310 +900,281 @@ static void cachemanager_init();
 
 
 /*
- * CM_read() - See pds_cache_manager.h for description
+ * CM_defparam() - See pds_cache_manager.h for description
  */
 
 #ifdef __STDC__
-pious_ssizet CM_read(pds_fhandlet fhandle,
-		     pious_offt offset,
-		     pious_sizet nbyte,
-		     char *buf)
+void CM_defparam(struct CM_param *param)
 #else
-pious_ssizet CM_read(fhandle, offset, nbyte, buf)
-     pds_fhandlet fhandle;
-     pious_offt offset;
-     pious_sizet nbyte;
-     char *buf;
+void CM_defparam(param)
+     struct CM_param *param;
 #endif
 {
-  int done;
-  pious_ssizet rcode, acode;
-  pious_sizet readcount, db_nbyte;
-  pious_offt db_nmbr, db_offset;
+  /* set system default configuration; see config/pious_sysconfig.h */
+  param->cache_sz = PDS_CM_CACHE_SZ;
+  param->dblk_sz  = PDS_CM_DBLK_SZ;
+  param->sm_cnt   = PDS_CM_SM_CNT;
+  param->sm_sz    = PDS_CM_SM_SZ;
+  param->lg_cnt   = PDS_CM_LG_CNT;
+  param->lg_sz    = PDS_CM_LG_SZ;
+  param->lg_min   = PDS_CM_LG_MIN;
+  param->prot_pct = PDS_CM_PROT_PCT;
+  param->hugepage = PDS_CM_HUGEPAGE;
+  param->direct   = PDS_CM_DIRECT;
+  param->ra_max   = PDS_CM_RA_MAX;
+  param->lr_min   = PDS_CM_LR_MIN;
+  param->policy   = PDS_CM_POLICY;
+  param->admit    = PDS_CM_ADMIT;
+
+  param->writeback    = PDS_CM_WRITEBACK;
+  param->wb_dirty_pct = PDS_CM_WB_DIRTY_PCT;
+  param->wb_age       = PDS_CM_WB_AGE;
+
+  /* no cache partitions by default */
+  param->part_cnt = 0;
+}
 
-  /* check for previous fatal error and recover flags */
-  if (SS_fatalerror)
-    rcode = PIOUS_EFATAL;
 
-  else if (SS_recover)
-    rcode = PIOUS_ERECOV;
 
-  /* validate 'offset' and 'nbyte' arguments */
-  else if (offset < 0 || nbyte < 0)
-    rcode = PIOUS_EINVAL;
+/*
+ * wb_insert()
+ *
+ * Parameters:
+ *
+ *   cache_entry - valid, dirty cache entry
+ *
+ * Append 'cache_entry' to the volatile write-back dirty list, marking the
+ * time at which it became dirty; if 'cache_entry' is already on the list
+ * then wb_insert() does nothing.
+ *
+ * Returns:
+ */
 
-  /* if CACHE_SZ == 0 (no cache), access stable storage directly */
-  else if (CACHE_SZ == 0)
+#ifdef __STDC__
+static void wb_insert(cache_entryt *cache_entry)
+#else
+static void wb_insert(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  if (!cache_entry->wbdirty)
     {
-      acode = SS_read(fhandle, offset, nbyte, buf);
+      UTIL_clock_mark(&(cache_entry->wbtime));
 
-      if (acode >= 0)
-	/* data read successfully */
-	rcode = acode;
+      cache_entry->wbnext = NULL;
+      cache_entry->wbprev = wb_tail;
+
+      if (wb_tail != NULL)
+	wb_tail->wbnext = cache_entry;
       else
-	/* data read unsuccessful; set return code */
-	switch(acode)
-	  {
-	  case PIOUS_EBADF:
-	  case PIOUS_EACCES:
-	  case PIOUS_EINVAL:
-	  case PIOUS_EINSUF:
-	  case PIOUS_EFATAL:
-	    rcode = acode;
-	    break;
-	  default:
-	    rcode = PIOUS_EUNXP;
-	    break;
-	  }
-    }
+	wb_head = cache_entry;
 
-  /* read data from cache */
-  else
-    { /* initialize cache, if required */
-      if (!cache_initialized)
-	cachemanager_init();
+      wb_tail = cache_entry;
 
-      /* calculate first data block number, offset, and byte count */
-  
-      db_nmbr   = offset / DBLK_SZ;
-      db_offset = offset % DBLK_SZ;
-      db_nbyte  = Min(DBLK_SZ - db_offset, nbyte);
+      cache_entry->wbdirty = TRUE;
+      wb_ndirty++;
+    }
+}
 
-      readcount = 0;
-      done      = FALSE;
 
-      /* read data blocks from cache, one block at a time */
 
-      while (!done)
-	{
-	  /* read appropriate (portion of) data block */
-	  acode = read_dblk(fhandle, db_nmbr, db_offset, db_nbyte, buf);
 
-	  if (acode < 0)
-	    { /* error, set return code appropriately and exit */
-	      rcode = acode;
-	      done  = TRUE;
-	    }
+/*
+ * wb_remove()
+ *
+ * Parameters:
+ *
+ *   cache_entry - cache entry
+ *
+ * Remove 'cache_entry' from the volatile write-back dirty list; if
+ * 'cache_entry' is not on the list then wb_remove() does nothing.
+ *
+ * Returns:
+ */
 
-	  else
-	    { /* read next data block, if required */
-	      readcount += acode;
-	      nbyte     -= acode;
+#ifdef __STDC__
+static void wb_remove(cache_entryt *cache_entry)
+#else
+static void wb_remove(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  if (cache_entry->wbdirty)
+    {
+      if (cache_entry->wbprev != NULL)
+	cache_entry->wbprev->wbnext = cache_entry->wbnext;
+      else
+	wb_head = cache_entry->wbnext;
 
-	      if (nbyte == 0 || acode < db_nbyte)
-		{ /* transfer complete or hit EOF */
-		  rcode = readcount;
-		  done  = TRUE;
-		}
-
-	      else
-		{ /* transfer incomplete; set next data block/offset to read */
-		  db_nmbr++;
-		  db_offset = 0;
-		  db_nbyte  = Min(DBLK_SZ, nbyte);
+      if (cache_entry->wbnext != NULL)
+	cache_entry->wbnext->wbprev = cache_entry->wbprev;
+      else
+	wb_tail = cache_entry->wbprev;
 
-		  /* increment read buffer pointer for next transfer */
-		  buf += acode;
-		}
-	    }
-	}
+      cache_entry->wbdirty = FALSE;
+      wb_ndirty--;
     }
-
-  return rcode;
 }
 
 
 
 
 /*
- * CM_write() - See pds_cache_manager.h for description
+ * flush_file()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   db_nmbr - data block number
+ *
+ * Flush all dirty cache entries associated with file 'fhandle' having a
+ * data block number greater than or equal to 'db_nmbr'.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of data blocks flushed
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EUNXP  - unexpected error condition encountered;
+ *                      flush incomplete
+ *       PIOUS_EFATAL - fatal error; check PDS error log
  */
 
 #ifdef __STDC__
-int CM_write(pds_fhandlet fhandle,
-	     pious_offt offset,
-	     pious_sizet nbyte,
-	     char *buf,
-	     int faultmode)
+static int flush_file(pds_fhandlet fhandle,
+		      pious_offt db_nmbr)
 #else
-int CM_write(fhandle, offset, nbyte, buf, faultmode)
+static int flush_file(fhandle, db_nmbr)
      pds_fhandlet fhandle;
-     pious_offt offset;
-     pious_sizet nbyte;
-     char *buf;
-     int faultmode;
+     pious_offt db_nmbr;
 #endif
 {
-  int done, rcode, acode;
-  pious_sizet writecount, db_nbyte;
-  pious_offt db_nmbr, db_offset;
-
-  /* validate 'faultmode' argument; if invalid set to PIOUS_STABLE */
-  if (faultmode != PIOUS_STABLE && faultmode != PIOUS_VOLATILE)
-    faultmode = PIOUS_STABLE;
-
-  /* check for previous fatal error and recover flags */
-  if (SS_fatalerror)
-    rcode = PIOUS_EFATAL;
-
-  else if (SS_recover)
-    rcode = PIOUS_ERECOV;
+  long nentry;
+  register cache_entryt *cache_entry;
 
-  /* validate 'offset' and 'nbyte' arguments; if invalid specify recovery */
-  else if (offset < 0 || nbyte < 0)
-    { /* note: should NEVER happen if write args validated upon receipt */
-      SS_recover = TRUE;
-      rcode      = PIOUS_ERECOV;
-    }
+  /* gather dirty 'fhandle' data blocks from file handle hash chain */
+  nentry      = 0;
+  cache_entry = fh_table[fhandle_hash(fhandle, fh_table_sz)];
 
-  /* if CACHE_SZ == 0 (no cache), access stable storage directly */
-  else if (CACHE_SZ == 0)
+  while (cache_entry != NULL)
     {
-      acode = SS_write(fhandle, offset, nbyte, buf, faultmode);
+      if (fhandle_eq(cache_entry->fhandle, fhandle) &&
+	  cache_entry->dirty && cache_entry->db_nmbr >= db_nmbr)
+	/* block belongs to 'fhandle' and is dirty */
+	fl_vec[nentry++] = cache_entry;
 
-      if (acode == nbyte)
-	{ /* write completed successfully */
-	  rcode = PIOUS_OK;
-	}
-      else
-	{ /* write error, or incomplete transfer of data */
-	  if (acode == PIOUS_EFATAL)
-	    {
-	      rcode = PIOUS_EFATAL;
-	    }
-	  else
-	    {
-	      SS_recover = TRUE;
-	      rcode      = PIOUS_ERECOV;
-	    }
-	}
-    }
-
-  /* write data to cache */
-  else
-    { /* initialize cache, if required */
-      if (!cache_initialized)
-	cachemanager_init();
-
-      /* calculate first data block number, offset, and byte count */
-  
-      db_nmbr    = offset / DBLK_SZ;
-      db_offset  = offset % DBLK_SZ;
-      db_nbyte   = Min(DBLK_SZ - db_offset, nbyte);
-
-      writecount = 0;
-      done       = FALSE;
-
-      /* write data blocks to cache, one block at a time */
-
-      while (!done)
-	{
-	  /* write appropriate (portion of) data block */
-	  acode = write_dblk(fhandle, db_nmbr, db_offset, db_nbyte, buf,
-			     faultmode);
-
-	  if (acode != PIOUS_OK)
-	    { /* error, set return code appropriately and exit */
-	      rcode = acode;
-	      done  = TRUE;
-	    }
-
-	  else
-	    { /* write next data block, if required */
-	      writecount += db_nbyte;
-	      nbyte      -= db_nbyte;
-
-	      if (nbyte == 0)
-		{ /* transfer complete */
-		  rcode = PIOUS_OK;
-		  done  = TRUE;
-		}
-
-	      else
-		{ /* transfer incomplete; increment write buffer pointer */
-		  buf += db_nbyte;
-
-		  /* compute next data block/offset to write */
-		  db_nmbr++;
-		  db_offset = 0;
-		  db_nbyte  = Min(DBLK_SZ, nbyte);
-		}
-	    }
-	}
+      cache_entry = cache_entry->fhnext;
     }
 
-  return rcode;
+  /* flush in file order */
+  return flush_dblks(nentry);
 }
 
 
 
-
 /*
- * CM_flush() - See pds_cache_manager.h for description.
+ * flush_dblks()
+ *
+ * Parameters:
+ *
+ *   nentry - number of cache entries in 'fl_vec'
+ *
+ * Flush the 'nentry' valid, dirty cache entries in 'fl_vec' to stable
+ * storage, in order of file and data block number.  Each run of up to
+ * FLUSH_RUN_MAX contiguous data blocks of a file is written with a single
+ * vectored write; a run terminates at an incomplete data block.  A run is
+ * written in PIOUS_STABLE mode if any of its data blocks is stable.
+ *
+ * Note: the order of entries in 'fl_vec' is altered.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of data blocks flushed
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EUNXP  - unexpected error condition encountered;
+ *                      flush incomplete
+ *       PIOUS_EFATAL - fatal error; check PDS error log
  */
 
 #ifdef __STDC__
-int CM_flush(void)
+static int flush_dblks(long nentry)
 #else
-int CM_flush()
+static int flush_dblks(nentry)
+     long nentry;
 #endif
 {
-  int rcode;
+  int rcode, faultmode;
+  long i, runcnt;
+  pious_sizet runbyte;
   pious_ssizet acode;
-  register cache_entryt *cache_pos;
+  register cache_entryt *cache_entry;
 
-  /* check for previous fatal error and recover flags */
+  /* sort dirty cache entries into file order */
+  if (nentry > 1)
+    qsort((char *)fl_vec, (size_t)nentry, sizeof(cache_entryt *), dblk_cmp);
 
-  if (SS_fatalerror)
-    rcode = PIOUS_EFATAL;
+  rcode = 0;
+  i     = 0;
 
-  else if (SS_recover)
-    rcode = PIOUS_ERECOV;
+  while (i < nentry && rcode >= 0)
+    { /* form run of contiguous data blocks starting with fl_vec[i] */
+      runcnt    = 0;
+      runbyte   = 0;
+      faultmode = PIOUS_VOLATILE;
 
-  /* flush cached data blocks */
+      do
+	{
+	  cache_entry = fl_vec[i + runcnt];
 
-  else if (CACHE_SZ == 0)
-    /* if no cache then flushed by definition */
-    rcode = PIOUS_OK;
+	  fl_iov[runcnt].base = cache_entry->dblk;
+	  fl_iov[runcnt].len  = cache_entry->db_nbyte;
 
-  else if (!cache_initialized)
-    { /* newly initialized cache is flushed by definition */
-      cachemanager_init();
-      rcode = PIOUS_OK;
-    }
+	  runbyte += cache_entry->db_nbyte;
 
-  else
-    { /* search through entire cache flushing dirty entries */
-      rcode     = PIOUS_OK;
-      cache_pos = cache_mru_pt;
+	  if (cache_entry->faultmode == PIOUS_STABLE)
+	    faultmode = PIOUS_STABLE;
 
-      do
-	{
-	  if (cache_pos->valid && cache_pos->dirty)
-	    { /* flush cache block */
-	      acode = SS_write(cache_pos->fhandle,
-			       (pious_offt)(cache_pos->db_nmbr * DBLK_SZ),
-			       cache_pos->db_nbyte,
-			       cache_pos->dblk,
-			       cache_pos->faultmode);
+	  runcnt++;
+	}
+      while (i + runcnt < nentry &&
+	     runcnt < FLUSH_RUN_MAX &&
+	     cache_entry->db_nbyte == dblk_sz &&
+	     fhandle_eq(fl_vec[i + runcnt]->fhandle, cache_entry->fhandle) &&
+	     fl_vec[i + runcnt]->db_nmbr == cache_entry->db_nmbr + 1);
 
-	      if (acode < cache_pos->db_nbyte)
-		{ /* error, or incomplete transfer of data */
-		  if (acode == PIOUS_EFATAL)
-		    rcode = PIOUS_EFATAL;
-		  else
-		    rcode = PIOUS_EUNXP;
-		}
-	      else
-		{ /* block flushed; mark as clean */
-		  cache_pos->dirty     = FALSE;
-		  cache_pos->faultmode = PIOUS_VOLATILE;
-		}
-	    }
+      /* write run */
+      cache_entry = fl_vec[i];
+
+      acode = SS_writev(cache_entry->fhandle,
+			(pious_offt)(cache_entry->db_nmbr * dblk_sz),
+			fl_iov, (int)runcnt, faultmode);
+
+      if (acode < 0 || (pious_sizet)acode < runbyte)
+	{ /* error, or incomplete transfer of data */
+	  if (acode == PIOUS_EFATAL)
+	    rcode = PIOUS_EFATAL;
+	  else
+	    rcode = PIOUS_EUNXP;
+	}
+      else
+	{ /* run flushed; mark blocks as clean */
+	  cm_stat.flush_ops++;
+	  cm_stat.flush_blks  += runcnt;
+	  cm_stat.flush_bytes += runbyte;
 
-	  cache_pos = cache_pos->cnext;
+	  for (; runcnt > 0; runcnt--, i++)
+	    {
+	      cache_entry = fl_vec[i];
+
+	      cache_entry->dirty     = FALSE;
+	      cache_entry->faultmode = PIOUS_VOLATILE;
+
+	      wb_remove(cache_entry);
+
+	      rcode++;
+	    }
 	}
-      while (cache_pos != cache_mru_pt && rcode == PIOUS_OK);
     }
 
   return rcode;
@@ -586,74 +1184,48 @@ int CM_flush()
 
 
 /*
- * CM_fflush() - See pds_cache_manager.h for description.
+ * dblk_cmp()
+ *
+ * Parameters:
+ *
+ *   entry_1 - pointer to cache entry pointer
+ *   entry_2 - pointer to cache entry pointer
+ *
+ * Compare cache entries by file handle and data block number, for qsort().
+ *
+ * Returns:
+ *
+ *   < 0 - entry_1 precedes entry_2
+ *   = 0 - entry_1 and entry_2 are the same data block
+ *   > 0 - entry_1 follows entry_2
  */
 
 #ifdef __STDC__
-int CM_fflush(pds_fhandlet fhandle)
+static int dblk_cmp(const void *entry_1,
+		    const void *entry_2)
 #else
-int CM_fflush(fhandle)
-     pds_fhandlet fhandle;
+static int dblk_cmp(entry_1, entry_2)
+     char *entry_1;
+     char *entry_2;
 #endif
 {
+  register cache_entryt *e1, *e2;
   int rcode;
-  pious_ssizet acode;
-  register cache_entryt *cache_entry;
-
-  /* check for previous fatal error and recover flags */
 
-  if (SS_fatalerror)
-    rcode = PIOUS_EFATAL;
-
-  else if (SS_recover)
-    rcode = PIOUS_ERECOV;
+  e1 = *((cache_entryt **)entry_1);
+  e2 = *((cache_entryt **)entry_2);
 
-  /* flush cached data blocks associated with 'fhandle' */
+  if (e1->fhandle.dev != e2->fhandle.dev)
+    rcode = ((e1->fhandle.dev < e2->fhandle.dev) ? -1 : 1);
 
-  else if (CACHE_SZ == 0)
-    /* if no cache then flushed by definition */
-    rcode = PIOUS_OK;
+  else if (e1->fhandle.ino != e2->fhandle.ino)
+    rcode = ((e1->fhandle.ino < e2->fhandle.ino) ? -1 : 1);
 
-  else if (!cache_initialized)
-    { /* newly initialized cache is flushed by definition */
-      cachemanager_init();
-      rcode = PIOUS_OK;
-    }
+  else if (e1->db_nmbr != e2->db_nmbr)
+    rcode = ((e1->db_nmbr < e2->db_nmbr) ? -1 : 1);
 
   else
-    { /* search file handle hash chain for 'fhandle' data blocks */
-      rcode       = PIOUS_OK;
-      cache_entry = fh_table[fhandle_hash(fhandle, FH_TABLE_SZ)];
-
-      while (cache_entry != NULL && rcode == PIOUS_OK)
-	{
-	  if (fhandle_eq(cache_entry->fhandle, fhandle) &&
-	      cache_entry->dirty)
-	    { /* block belongs to 'fhandle' and is dirty; flush */
-
-	      acode = SS_write(cache_entry->fhandle,
-			       (pious_offt)(cache_entry->db_nmbr * DBLK_SZ),
-			       cache_entry->db_nbyte,
-			       cache_entry->dblk,
-			       cache_entry->faultmode);
-
-	      if (acode < cache_entry->db_nbyte)
-		{ /* error, or incomplete transfer of data */
-		  if (acode == PIOUS_EFATAL)
-		    rcode = PIOUS_EFATAL;
-		  else
-		    rcode = PIOUS_EUNXP;
-		}
-	      else
-		{ /* block flushed; mark as clean */
-		  cache_entry->dirty     = FALSE;
-		  cache_entry->faultmode = PIOUS_VOLATILE;
-		}
-	    }
-
-	  cache_entry = cache_entry->fhnext;
-	}
-    }
+    rcode = 0;
 
   return rcode;
 }
@@ -662,604 +1234,5272 @@ int CM_fflush(fhandle)
 
 
 /*
- * CM_invalidate() - See pds_cache_manager.h for description.
+ * CM_init() - See pds_cache_manager.h for description
  */
 
 #ifdef __STDC__
-void CM_invalidate(void)
+int CM_init(struct CM_param *param)
 #else
-void CM_invalidate()
+int CM_init(param)
+     struct CM_param *param;
 #endif
 {
-  int i;
+  int rcode, partok, min_sum, i;
 
-  if (CACHE_SZ != 0)
-    {
-      if (!cache_initialized)
-	{ /* newly initialized cache is invalidated by definition */
-	  cachemanager_init();
-	}
+  /* validate cache partitions; reserved shares may not exceed the cache */
+  partok  = (param->part_cnt >= 0 && param->part_cnt <= CM_PART_MAX);
+  min_sum = 0;
 
-      else
-	{ /* scan cache, invalidating all entries */
-	  for (i = 0; i < CACHE_SZ; i++)
-	    cache[i].valid = FALSE;
+  for (i = 0; partok && i < param->part_cnt; i++)
+    if (param->part_min[i] < 0 ||
+	param->part_min[i] > param->part_max[i] ||
+	param->part_max[i] > 100)
+      partok = FALSE;
+    else
+      min_sum += param->part_min[i];
 
-	  /* reset data block and file handle hash tables */
-	  for (i = 0; i < DBLK_TABLE_SZ; i++)
-	    dblk_table[i] = NULL;
+  if (min_sum > 100)
+    partok = FALSE;
 
-	  for (i = 0; i < FH_TABLE_SZ; i++)
-	    fh_table[i] = NULL;
-	}
-    }
+  /* cache configuration can only be set prior to cache initialization */
+  if (cache_initialized)
+    rcode = PIOUS_EPERM;
+
+  /* validate configuration parameters; block size must be representable as
+   * an int byte count, and arena size must be representable as a size.
+   */
+  else if (param->cache_sz < 0 ||
+	   param->dblk_sz <= 0 || param->dblk_sz > PIOUS_INT_MAX ||
+	   (param->direct && param->dblk_sz % FS_DIRECT_ALIGN != 0) ||
+	   param->sm_cnt < 0 ||
+	   (param->sm_cnt > 0 &&
+	    (param->sm_sz == 0 || param->sm_sz >= param->dblk_sz ||
+	     (param->direct && param->sm_sz % FS_DIRECT_ALIGN != 0) ||
+	     param->sm_sz > ((unsigned long)~0L) / param->sm_cnt)) ||
+	   param->lg_cnt < 0 ||
+	   (param->lg_cnt > 0 &&
+	    (param->lg_sz <= param->dblk_sz || param->lg_sz > PIOUS_INT_MAX ||
+	     (param->direct && param->lg_sz % FS_DIRECT_ALIGN != 0) ||
+	     param->lg_sz > ((unsigned long)~0L) / param->lg_cnt)) ||
+	   param->lg_min < 0 ||
+	   param->prot_pct <= 0 || param->prot_pct >= 100 ||
+	   param->ra_max < 0 || param->lr_min < 0 ||
+	   (param->policy != CM_POLICY_SLRU &&
+	    param->policy != CM_POLICY_ARC) ||
+	   param->wb_dirty_pct <= 0 || param->wb_dirty_pct > 100 ||
+	   param->wb_age < 0 || !partok ||
+	   (param->cache_sz > 0 &&
+	    param->dblk_sz > ((unsigned long)~0L) / param->cache_sz))
+    rcode = PIOUS_EINVAL;
+
+  /* allocate and initialize cache */
+  else
+    rcode = cachemanager_init(param);
+
+  return rcode;
 }
 
 
 
 
 /*
- * CM_finvalidate() - See pds_cache_manager.h for description.
+ * CM_read() - See pds_cache_manager.h for description
  */
 
 #ifdef __STDC__
-void CM_finvalidate(pds_fhandlet fhandle)
+pious_ssizet CM_read(pds_fhandlet fhandle,
+		     pious_offt offset,
+		     pious_sizet nbyte,
+		     char *buf)
 #else
-void CM_finvalidate(fhandle)
+pious_ssizet CM_read(fhandle, offset, nbyte, buf)
      pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     char *buf;
 #endif
 {
-  register cache_entryt *cache_entry, *next_entry;
+  int done;
+  pious_ssizet rcode, acode;
+  pious_sizet readcount, db_nbyte;
+  pious_offt db_nmbr, db_offset;
 
-  if (CACHE_SZ != 0)
-    {
-      if (!cache_initialized)
-	{ /* newly initialized cache is invalidated by definition */
-	  cachemanager_init();
-	}
+  /* initialize cache, if required */
+  if (!cache_initialized)
+    cachemanager_init((struct CM_param *)NULL);
+
+  /* check for previous fatal error and recover flags */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  else if (SS_recover)
+    rcode = PIOUS_ERECOV;
+
+  /* validate 'offset' and 'nbyte' arguments */
+  else if (offset < 0 || nbyte < 0)
+    rcode = PIOUS_EINVAL;
+
+  /* if cache_sz == 0 (no cache), access stable storage directly */
+  else if (cache_sz == 0)
+    {
+      acode = SS_read(fhandle, offset, nbyte, buf);
+
+      if (acode >= 0)
+	/* data read successfully */
+	rcode = acode;
+      else
+	/* data read unsuccessful; set return code */
+	switch(acode)
+	  {
+	  case PIOUS_EBADF:
+	  case PIOUS_EACCES:
+	  case PIOUS_EINVAL:
+	  case PIOUS_EINSUF:
+	  case PIOUS_EFATAL:
+	    rcode = acode;
+	    break;
+	  default:
+	    rcode = PIOUS_EUNXP;
+	    break;
+	  }
+    }
+
+  /* if file of large data block class, read data from large data blocks */
+  else if (lg_cnt > 0 && class_lookup(fhandle))
+    rcode = large_read(fhandle, offset, nbyte, buf);
+
+  /* read data from cache */
+  else
+    { /* calculate first data block number, offset, and byte count */
+  
+      db_nmbr   = offset / dblk_sz;
+      db_offset = offset % dblk_sz;
+      db_nbyte  = Min(dblk_sz - db_offset, nbyte);
+
+      readcount = 0;
+      done      = FALSE;
+
+      /* a read spanning at least lr_min data blocks is read by extent */
+      if (lr_min > 0 && nbyte > 0 &&
+	  (offset + (nbyte - 1)) / dblk_sz - db_nmbr + 1 >= lr_min)
+	{
+	  /* detect sequential access; large reads do not prefetch */
+	  if (ra_cap > 0)
+	    readahead(fhandle, offset, nbyte, FALSE);
+
+	  rcode = read_extent(fhandle, offset, nbyte, buf);
+	  done  = TRUE;
+	}
+
+      /* detect sequential access and prefetch data blocks, if enabled */
+      else if (ra_cap > 0 && nbyte > 0)
+	readahead(fhandle, offset, nbyte, TRUE);
+
+      /* read data blocks from cache, one block at a time */
+
+      while (!done)
+	{
+	  /* read appropriate (portion of) data block */
+	  acode = read_dblk(fhandle, db_nmbr, db_offset, db_nbyte, buf);
+
+	  if (acode < 0)
+	    { /* error, set return code appropriately and exit */
+	      rcode = acode;
+	      done  = TRUE;
+	    }
+
+	  else
+	    { /* read next data block, if required */
+	      readcount += acode;
+	      nbyte     -= acode;
+
+	      if (nbyte == 0 || acode < db_nbyte)
+		{ /* transfer complete or hit EOF */
+		  rcode = readcount;
+		  done  = TRUE;
+		}
+
+	      else
+		{ /* transfer incomplete; set next data block/offset to read */
+		  db_nmbr++;
+		  db_offset = 0;
+		  db_nbyte  = Min(dblk_sz, nbyte);
+
+		  /* increment read buffer pointer for next transfer */
+		  buf += acode;
+		}
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+/*
+ * CM_readv() - See pds_cache_manager.h for description
+ */
+
+#ifdef __STDC__
+pious_ssizet CM_readv(pds_fhandlet fhandle,
+		      pious_offt offset,
+		      pious_sizet nbyte,
+		      struct FS_iovec *iov,
+		      int *iovcnt)
+#else
+pious_ssizet CM_readv(fhandle, offset, nbyte, iov, iovcnt)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     struct FS_iovec *iov;
+     int *iovcnt;
+#endif
+{
+  int done;
+  pious_ssizet rcode, acode;
+  pious_sizet readcount, db_nbyte;
+  pious_offt db_nmbr, db_offset, db_span;
+  cache_entryt *cache_entry;
+
+  /* initialize cache, if required */
+  if (!cache_initialized)
+    cachemanager_init((struct CM_param *)NULL);
+
+  /* check for previous fatal error and recover flags */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  else if (SS_recover)
+    rcode = PIOUS_ERECOV;
+
+  /* validate 'offset', 'nbyte', and 'iovcnt' arguments */
+  else if (offset < 0 || nbyte < 0 || *iovcnt < 0)
+    rcode = PIOUS_EINVAL;
+
+  /* a null read always succeeds without perturbing cache */
+  else if (nbyte == 0)
+    {
+      *iovcnt = 0;
+      rcode   = 0;
+    }
+
+  /* if file of large data block class, reference large data blocks */
+  else if (lg_cnt > 0 && class_lookup(fhandle))
+    rcode = large_readv(fhandle, offset, nbyte, iov, iovcnt);
+
+  /* references outstanding, or read not suited to reference by block */
+  else if (pin_cnt > 0 ||
+	   (db_span = ((offset + (nbyte - 1)) / dblk_sz -
+		       offset / dblk_sz + 1)) > *iovcnt ||
+	   db_span > pin_max ||
+	   (lr_min > 0 && db_span >= lr_min))
+    rcode = PIOUS_EBUSY;
+
+  /* read data from cache, referencing data blocks in place */
+  else
+    { /* calculate first data block number, offset, and byte count */
+
+      db_nmbr   = offset / dblk_sz;
+      db_offset = offset % dblk_sz;
+      db_nbyte  = Min(dblk_sz - db_offset, nbyte);
+
+      readcount = 0;
+      done      = FALSE;
+
+      /* detect sequential access and prefetch data blocks, if enabled */
+      if (ra_cap > 0)
+	readahead(fhandle, offset, nbyte, TRUE);
+
+      /* reference data blocks in cache, one block at a time */
+
+      while (!done)
+	{
+	  /* reference appropriate (portion of) data block */
+	  acode = ref_dblk(fhandle, db_nmbr, db_offset, db_nbyte, &cache_entry);
+
+	  if (acode < 0)
+	    { /* error, release references, set return code and exit; a data
+	       * block not cached within partition shares is PIOUS_EBUSY, and
+	       * is read via CM_read()
+	       */
+	      CM_release();
+
+	      rcode = acode;
+	      done  = TRUE;
+	    }
+
+	  else
+	    { /* pin referenced data, if any, and read next data block */
+	      if (acode > 0)
+		{
+		  cache_entry->pinned = TRUE;
+
+		  iov[pin_cnt].base = cache_entry->dblk + db_offset;
+		  iov[pin_cnt].len  = acode;
+
+		  pin_vec[pin_cnt++] = cache_entry;
+		}
+
+	      readcount += acode;
+	      nbyte     -= acode;
+
+	      if (nbyte == 0 || acode < db_nbyte)
+		{ /* transfer complete or hit EOF */
+		  *iovcnt = pin_cnt;
+		  rcode   = readcount;
+		  done    = TRUE;
+		}
+
+	      else
+		{ /* transfer incomplete; set next data block/offset to read */
+		  db_nmbr++;
+		  db_offset = 0;
+		  db_nbyte  = Min(dblk_sz, nbyte);
+		}
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * CM_release() - See pds_cache_manager.h for description
+ */
+
+#ifdef __STDC__
+void CM_release(void)
+#else
+void CM_release()
+#endif
+{
+  /* unpin all cache entries referenced by CM_readv() */
+
+  while (pin_cnt > 0)
+    pin_vec[--pin_cnt]->pinned = FALSE;
+}
+
+
+
+
+/*
+ * CM_write() - See pds_cache_manager.h for description
+ */
+
+#ifdef __STDC__
+int CM_write(pds_fhandlet fhandle,
+	     pious_offt offset,
+	     pious_sizet nbyte,
+	     char *buf,
+	     int faultmode)
+#else
+int CM_write(fhandle, offset, nbyte, buf, faultmode)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     char *buf;
+     int faultmode;
+#endif
+{
+  int done, rcode, acode;
+  pious_sizet writecount, db_nbyte;
+  pious_offt db_nmbr, db_offset;
+  file_entryt *eof_entry;
+
+  /* validate 'faultmode' argument; if invalid set to PIOUS_STABLE */
+  if (faultmode != PIOUS_STABLE && faultmode != PIOUS_VOLATILE)
+    faultmode = PIOUS_STABLE;
+
+  /* initialize cache, if required */
+  if (!cache_initialized)
+    cachemanager_init((struct CM_param *)NULL);
+
+  /* check for previous fatal error and recover flags */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  else if (SS_recover)
+    rcode = PIOUS_ERECOV;
+
+  /* validate 'offset' and 'nbyte' arguments; if invalid specify recovery */
+  else if (offset < 0 || nbyte < 0)
+    { /* note: should NEVER happen if write args validated upon receipt */
+      SS_recover = TRUE;
+      rcode      = PIOUS_ERECOV;
+    }
+
+  /* if cache_sz == 0 (no cache), access stable storage directly */
+  else if (cache_sz == 0)
+    {
+      acode = SS_write(fhandle, offset, nbyte, buf, faultmode);
+
+      if (acode == nbyte)
+	{ /* write completed successfully */
+	  rcode = PIOUS_OK;
+	}
+      else
+	{ /* write error, or incomplete transfer of data */
+	  if (acode == PIOUS_EFATAL)
+	    {
+	      rcode = PIOUS_EFATAL;
+	    }
+	  else
+	    {
+	      SS_recover = TRUE;
+	      rcode      = PIOUS_ERECOV;
+	    }
+	}
+    }
+
+  /* if file of large data block class, write through large data blocks */
+  else if (lg_cnt > 0 && class_lookup(fhandle))
+    rcode = large_write(fhandle, offset, nbyte, buf, faultmode);
+
+  /* write data to cache */
+  else
+    { /* calculate first data block number, offset, and byte count */
+  
+      db_nmbr    = offset / dblk_sz;
+      db_offset  = offset % dblk_sz;
+      db_nbyte   = Min(dblk_sz - db_offset, nbyte);
+
+      writecount = 0;
+      done       = FALSE;
+
+      /* write data blocks to cache, one block at a time */
+
+      while (!done)
+	{
+	  /* write appropriate (portion of) data block */
+	  acode = write_dblk(fhandle, db_nmbr, db_offset, db_nbyte, buf,
+			     faultmode);
+
+	  if (acode != PIOUS_OK)
+	    { /* error, set return code appropriately and exit */
+	      rcode = acode;
+	      done  = TRUE;
+
+	      /* file size no longer known */
+	      eof_discard(fhandle);
+	    }
+
+	  else
+	    { /* write next data block, if required */
+	      writecount += db_nbyte;
+	      nbyte      -= db_nbyte;
+
+	      if (nbyte == 0)
+		{ /* transfer complete; update file size, if recorded */
+		  rcode = PIOUS_OK;
+		  done  = TRUE;
+
+		  if (writecount > 0 &&
+		      (eof_entry = eof_lookup(fhandle, FALSE)) != NULL)
+		    eof_entry->fsize = Max(eof_entry->fsize,
+					   offset + writecount);
+		}
+
+	      else
+		{ /* transfer incomplete; increment write buffer pointer */
+		  buf += db_nbyte;
+
+		  /* compute next data block/offset to write */
+		  db_nmbr++;
+		  db_offset = 0;
+		  db_nbyte  = Min(dblk_sz, nbyte);
+		}
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * CM_flush() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+int CM_flush(void)
+#else
+int CM_flush()
+#endif
+{
+  int rcode;
+  long nentry;
+  register cache_entryt *cache_pos;
+
+  /* check for previous fatal error and recover flags */
+
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  else if (SS_recover)
+    rcode = PIOUS_ERECOV;
+
+  /* flush cached data blocks */
+
+  else if (!cache_initialized)
+    { /* newly initialized cache is flushed by definition */
+      cachemanager_init((struct CM_param *)NULL);
+      rcode = PIOUS_OK;
+    }
+
+  else if (cache_sz == 0)
+    /* if no cache then flushed by definition */
+    rcode = PIOUS_OK;
+
+  else
+    { /* gather dirty entries from entire cache and flush in file order */
+      nentry = 0;
+
+      for (cache_pos = cache; cache_pos < cache + cache_sz; cache_pos++)
+	if (cache_pos->valid && cache_pos->dirty)
+	  fl_vec[nentry++] = cache_pos;
+
+      if ((rcode = flush_dblks(nentry)) > 0)
+	/* flushed data blocks; flush_dblks() returns count */
+	rcode = PIOUS_OK;
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * CM_fflush() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+int CM_fflush(pds_fhandlet fhandle)
+#else
+int CM_fflush(fhandle)
+     pds_fhandlet fhandle;
+#endif
+{
+  int rcode;
+
+  /* check for previous fatal error and recover flags */
+
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  else if (SS_recover)
+    rcode = PIOUS_ERECOV;
+
+  /* flush cached data blocks associated with 'fhandle' */
+
+  else if (!cache_initialized)
+    { /* newly initialized cache is flushed by definition */
+      cachemanager_init((struct CM_param *)NULL);
+      rcode = PIOUS_OK;
+    }
+
+  else if (cache_sz == 0)
+    /* if no cache then flushed by definition */
+    rcode = PIOUS_OK;
+
+  else if ((rcode = flush_file(fhandle, (pious_offt)0)) > 0)
+    /* flushed data blocks; flush_file() returns count */
+    rcode = PIOUS_OK;
+
+  return rcode;
+}
+
+
+
+/*
+ * CM_bgflush() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+int CM_bgflush(void)
+#else
+int CM_bgflush()
+#endif
+{
+  int rcode;
+  long nflush;
+  pious_ssizet acode;
+  register cache_entryt *cache_entry;
+
+  /* check for previous fatal error and recover flags */
+
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  else if (SS_recover)
+    rcode = PIOUS_ERECOV;
+
+  /* flush oldest dirty volatile data blocks as required */
+
+  else
+    {
+      rcode  = PIOUS_OK;
+      nflush = 0;
+
+      while ((cache_entry = wb_head) != NULL && rcode == PIOUS_OK &&
+	     nflush < WB_FLUSH_MAX &&
+	     (wb_ndirty > wb_dirty_max ||
+	      UTIL_clock_delta(&(cache_entry->wbtime), UTIL_MSEC) >= wb_age))
+	{ /* flush cache block */
+	  acode = SS_write(cache_entry->fhandle,
+			   (pious_offt)(cache_entry->db_nmbr * dblk_sz),
+			   cache_entry->db_nbyte,
+			   cache_entry->dblk,
+			   cache_entry->faultmode);
+
+	  if (acode < 0 || (pious_sizet)acode < cache_entry->db_nbyte)
+	    { /* error, or incomplete transfer of data */
+	      if (acode == PIOUS_EFATAL)
+		rcode = PIOUS_EFATAL;
+	      else
+		rcode = PIOUS_EUNXP;
+	    }
+	  else
+	    { /* block flushed; mark as clean */
+	      cache_entry->dirty     = FALSE;
+	      cache_entry->faultmode = PIOUS_VOLATILE;
+
+	      wb_remove(cache_entry);
+
+	      cm_stat.flush_ops++;
+	      cm_stat.flush_blks++;
+	      cm_stat.flush_bytes += cache_entry->db_nbyte;
+	    }
+
+	  nflush++;
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * CM_invalidate() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+void CM_invalidate(void)
+#else
+void CM_invalidate()
+#endif
+{
+  register long i;
+
+  if (!cache_initialized)
+    { /* newly initialized cache is invalidated by definition */
+      cachemanager_init((struct CM_param *)NULL);
+    }
+
+  else if (cache_sz != 0)
+    { /* scan cache, invalidating all entries */
+      for (i = 0; i < cache_sz; i++)
+	cache[i].valid = cache[i].wbdirty = cache[i].pinned = FALSE;
+
+      /* reset partition data block counts; assignments are retained */
+      for (i = 0; i <= CM_PART_MAX; i++)
+	part_nblk[i] = 0;
+
+      /* discard data block references */
+      pin_cnt = 0;
+
+      /* reset volatile write-back dirty list */
+      wb_ndirty = 0;
+      wb_head   = wb_tail = NULL;
+
+      /* reset adaptive policy ghost lists */
+      if (cache_policy == CM_POLICY_ARC)
+	ghost_reset();
+
+      /* reset data block and file handle hash tables */
+      for (i = 0; i < dblk_table_sz; i++)
+	dblk_table[i] = NULL;
+
+      for (i = 0; i < fh_table_sz; i++)
+	fh_table[i] = NULL;
+
+      /* invalidate small data blocks */
+      if (sm_cnt > 0)
+	small_reset();
+
+      /* invalidate large data blocks; class assignments are retained */
+      if (lg_cnt > 0)
+	large_reset();
+
+      /* discard sequential access state, file sizes, and retained access
+       * advice; partition and class assignments are retained
+       */
+      file_clear();
+
+      /* discard pending warm-up */
+      if (warm_vec != NULL)
+	{
+	  free((char *)warm_vec);
+	  warm_vec = NULL;
+	}
+
+      warm_cnt = warm_pos = 0;
+    }
+}
+
+
+
+
+/*
+ * CM_finvalidate() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+void CM_finvalidate(pds_fhandlet fhandle)
+#else
+void CM_finvalidate(fhandle)
+     pds_fhandlet fhandle;
+#endif
+{
+  file_entryt *file_entry;
+
+  if (!cache_initialized)
+    { /* newly initialized cache is invalidated by definition */
+      cachemanager_init((struct CM_param *)NULL);
+    }
+
+  else if (cache_sz != 0)
+    { /* invalidate all 'fhandle' entries */
+      file_discard(fhandle);
+
+      /* invalidate all 'fhandle' large data blocks */
+      if (lg_cnt > 0)
+	large_fdiscard(fhandle);
+
+      /* restart sequential access detection for 'fhandle' */
+      if ((file_entry = file_lookup(fhandle, FALSE)) != NULL)
+	{
+	  file_entry->next_offset = 0;
+	  file_entry->ra_nmbr     = 0;
+	  file_entry->window      = 0;
+	}
+
+      /* discard file size; file may have been truncated */
+      eof_discard(fhandle);
+
+      /* discard retained access advice */
+      adv_set(fhandle, PIOUS_ADV_NORMAL);
+    }
+}
+
+
+
+
+/*
+ * CM_advise() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+int CM_advise(pds_fhandlet fhandle,
+	      pious_offt offset,
+	      pious_sizet nbyte,
+	      int advice)
+#else
+int CM_advise(fhandle, offset, nbyte, advice)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     int advice;
+#endif
+{
+  int rcode;
+  long nentry, db_cap, db_cnt, i;
+  pious_offt first_nmbr, last_nmbr, db_nmbr, lg_first, lg_last;
+  file_entryt *file_entry;
+  cache_entryt *lg_entry;
+  register cache_entryt *cache_entry, *next_entry;
+
+  /* initialize cache, if required */
+  if (!cache_initialized)
+    cachemanager_init((struct CM_param *)NULL);
+
+  /* check for previous fatal error and recover flags */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  else if (SS_recover)
+    rcode = PIOUS_ERECOV;
+
+  /* validate 'offset' and 'advice' arguments */
+  else if (offset < 0 ||
+	   advice < PIOUS_ADV_NORMAL || advice > PIOUS_ADV_NOREUSE)
+    rcode = PIOUS_EINVAL;
+
+  /* if cache_sz == 0 (no cache), advice has no effect */
+  else if (cache_sz == 0)
+    rcode = PIOUS_OK;
+
+  else
+    { /* determine data blocks spanned by advised range */
+      first_nmbr = offset / dblk_sz;
+
+      if (nbyte == 0 || nbyte > (pious_sizet)(PIOUS_OFFT_MAX - offset))
+	last_nmbr = -1;
+      else
+	last_nmbr = (offset + (nbyte - 1)) / dblk_sz;
+
+      /* determine large data blocks spanned likewise, if slab is on */
+      lg_first = 0;
+      lg_last  = -1;
+
+      if (lg_cnt > 0)
+	{
+	  lg_first = offset / lg_sz;
+
+	  if (last_nmbr >= 0)
+	    lg_last = (offset + (nbyte - 1)) / lg_sz;
+	}
+
+      rcode = PIOUS_OK;
+
+      switch(advice)
+	{
+	case PIOUS_ADV_NORMAL:
+	case PIOUS_ADV_SEQUENTIAL:
+	case PIOUS_ADV_RANDOM:
+	case PIOUS_ADV_NOREUSE:
+	  /* retain advice for file as a whole */
+	  adv_set(fhandle, advice);
+
+	  /* restart sequential access detection for 'fhandle' */
+	  if ((file_entry = file_lookup(fhandle, FALSE)) != NULL)
+	    {
+	      file_entry->window  = 0;
+	      file_entry->ra_nmbr = 0;
+	    }
+	  break;
+
+	case PIOUS_ADV_WILLNEED:
+	  if (lg_cnt > 0 && class_lookup(fhandle))
+	    { /* load large data blocks, to at most half the slab so that
+	       * loaded blocks are not replaced by subsequent loading prior to
+	       * being read; loading stops at end of file.  errors are ignored.
+	       */
+	      db_cap = Max(lg_cnt / 2, 1);
+
+	      if (lg_last >= 0)
+		db_cap = Min(db_cap, lg_last - lg_first + 1);
+
+	      db_nmbr = lg_first;
+
+	      while (db_cap-- > 0 &&
+		     large_ref(fhandle, db_nmbr++, FALSE, &lg_entry) ==
+		     (pious_ssizet)lg_sz);
+	    }
+
+	  else
+	    { /* prefetch data blocks a run at a time, to at most half the
+	       * probationary segment so that prefetched blocks are not
+	       * replaced by subsequent prefetching prior to being read.  a
+	       * range through end of file is bounded by the recorded file
+	       * size, if any.
+	       */
+	      db_cap = (cache_sz - prot_sz) / 2;
+
+	      if (last_nmbr >= 0)
+		db_cap = Min(db_cap, last_nmbr - first_nmbr + 1);
+
+	      else if ((file_entry = eof_lookup(fhandle, FALSE)) != NULL)
+		db_cap = Min(db_cap,
+			     (pious_offt)((file_entry->fsize + (dblk_sz - 1)) /
+					  dblk_sz) - first_nmbr);
+
+	      db_nmbr = first_nmbr;
+
+	      while (db_cap > 0 && Max(ra_cap, warm_cap) > 0 &&
+		     !SS_fatalerror && !SS_recover)
+		{
+		  db_cnt = Min(db_cap, Max(ra_cap, warm_cap));
+
+		  prefetch_dblk(fhandle, db_nmbr, db_cnt, FALSE);
+
+		  db_nmbr += db_cnt;
+		  db_cap  -= db_cnt;
+		}
+	    }
+	  break;
+
+	case PIOUS_ADV_DONTNEED:
+	  /* flush dirty data blocks in range; not discarded if flush fails */
+	  nentry      = 0;
+	  cache_entry = fh_table[fhandle_hash(fhandle, fh_table_sz)];
+
+	  while (cache_entry != NULL)
+	    {
+	      if (fhandle_eq(cache_entry->fhandle, fhandle) &&
+		  cache_entry->dirty &&
+		  cache_entry->db_nmbr >= first_nmbr &&
+		  (last_nmbr < 0 || cache_entry->db_nmbr <= last_nmbr))
+		fl_vec[nentry++] = cache_entry;
+
+	      cache_entry = cache_entry->fhnext;
+	    }
+
+	  if (nentry > 0 && (rcode = flush_dblks(nentry)) > 0)
+	    rcode = PIOUS_OK;
+
+	  /* discard clean data blocks in range that are not referenced,
+	   * making each entry the first to be re-allocated
+	   */
+	  cache_entry = fh_table[fhandle_hash(fhandle, fh_table_sz)];
+
+	  while (cache_entry != NULL)
+	    {
+	      next_entry = cache_entry->fhnext;
+
+	      if (fhandle_eq(cache_entry->fhandle, fhandle) &&
+		  !cache_entry->dirty && !cache_entry->pinned &&
+		  cache_entry->db_nmbr >= first_nmbr &&
+		  (last_nmbr < 0 || cache_entry->db_nmbr <= last_nmbr))
+		{
+		  if (cache_entry->segment == SMALL)
+		    small_discard(cache_entry);
+		  else
+		    {
+		      entry_invalidate(cache_entry);
+		      make_lru_pb(cache_entry);
+		    }
+		}
+
+	      cache_entry = next_entry;
+	    }
+
+	  /* discard large data blocks in range that are not referenced */
+	  for (i = 0; i < lg_cnt; i++)
+	    if (lg_cache[i].valid && !lg_cache[i].pinned &&
+		fhandle_eq(lg_cache[i].fhandle, fhandle) &&
+		lg_cache[i].db_nmbr >= lg_first &&
+		(lg_last < 0 || lg_cache[i].db_nmbr <= lg_last))
+	      large_discard(lg_cache + i);
+	  break;
+
+	default:
+	  rcode = PIOUS_EUNXP;
+	  break;
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * CM_fpartition() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+int CM_fpartition(pds_fhandlet fhandle,
+		  int part)
+#else
+int CM_fpartition(fhandle, part)
+     pds_fhandlet fhandle;
+     int part;
+#endif
+{
+  int rcode;
+
+  if (!cache_initialized)
+    cachemanager_init((struct CM_param *)NULL);
+
+  if (part < 0 || part > part_cnt)
+    rcode = PIOUS_EINVAL;
+
+  else
+    { /* retain assignment; default partition discards entry, if any */
+      if (cache_sz != 0)
+	part_set(fhandle, part);
+
+      rcode = PIOUS_OK;
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * CM_fclass() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+int CM_fclass(pds_fhandlet fhandle,
+	      int large)
+#else
+int CM_fclass(fhandle, large)
+     pds_fhandlet fhandle;
+     int large;
+#endif
+{
+  int rcode;
+  pious_offt fsize;
+
+  /* initialize cache, if required */
+  if (!cache_initialized)
+    cachemanager_init((struct CM_param *)NULL);
+
+  /* check for previous fatal error and recover flags */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  else if (SS_recover)
+    rcode = PIOUS_ERECOV;
+
+  /* if large data block slab is off, all files are of the standard class */
+  else if (lg_cnt == 0)
+    rcode = PIOUS_OK;
+
+  else
+    { /* large class if hinted, or if file is at least lg_min bytes */
+      rcode = PIOUS_OK;
+
+      if (!large && lg_min > 0 &&
+	  (rcode = SS_fsize(fhandle, &fsize)) == PIOUS_OK)
+	large = (fsize >= lg_min);
+
+      /* file entering large class; flush and invalidate cache entries, such
+       * that file data is cached only in large data blocks
+       */
+      if (rcode == PIOUS_OK && large && !class_lookup(fhandle) &&
+	  (rcode = CM_fflush(fhandle)) == PIOUS_OK)
+	file_discard(fhandle);
+
+      /* retain assignment; standard class discards entry, if any */
+      if (rcode == PIOUS_OK)
+	class_set(fhandle, large);
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * CM_warmsave() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+int CM_warmsave(void)
+#else
+int CM_warmsave()
+#endif
+{
+  int rcode;
+  long nentry, i;
+  struct SS_warmblk *blk;
+  register cache_entryt *cache_pos;
+
+  blk = NULL;
+
+  /* check for previous fatal error */
+
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  /* record protected segment data blocks */
+
+  else if (!cache_initialized || cache_sz == 0)
+    /* no cached data blocks; record empty manifest */
+    rcode = SS_warmsave((struct SS_warmblk *)NULL, 0L, dblk_sz);
+
+  else
+    { /* gather protected segment entries and sort in file order */
+      nentry = 0;
+
+      for (cache_pos = cache; cache_pos < cache + cache_sz; cache_pos++)
+	if (cache_pos->valid && cache_pos->segment == PROTECTED)
+	  fl_vec[nentry++] = cache_pos;
+
+      qsort((char *)fl_vec, (size_t)nentry, sizeof(cache_entryt *), dblk_cmp);
+
+      if (nentry > 0 &&
+	  (blk = (struct SS_warmblk *)
+	   malloc((unsigned)(nentry * sizeof(struct SS_warmblk)))) == NULL)
+	rcode = PIOUS_EINSUF;
+
+      else
+	{ /* write manifest */
+	  for (i = 0; i < nentry; i++)
+	    {
+	      blk[i].fhandle = fl_vec[i]->fhandle;
+	      blk[i].db_nmbr = fl_vec[i]->db_nmbr;
+	    }
+
+	  rcode = SS_warmsave(blk, nentry, dblk_sz);
+	}
+    }
+
+  if (blk != NULL)
+    free((char *)blk);
+
+  return rcode;
+}
+
+
+
+
+/*
+ * CM_warmload() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+long CM_warmload(void)
+#else
+long CM_warmload()
+#endif
+{
+  long rcode;
+
+  if (!cache_initialized)
+    { /* initialize cache; newly initialized cache is empty */
+      cachemanager_init((struct CM_param *)NULL);
+    }
+
+  /* discard any pending warm-up */
+
+  if (warm_vec != NULL)
+    free((char *)warm_vec);
+
+  warm_vec = NULL;
+  warm_cnt = warm_pos = 0;
+
+  /* read manifest; at most as many data blocks as protected segment holds */
+
+  if (cache_sz == 0 || warm_cap == 0 || SS_fatalerror || SS_recover)
+    rcode = 0;
+
+  else if ((rcode = SS_warmload(dblk_sz, prot_sz, &warm_vec)) > 0)
+    warm_cnt = rcode;
+
+  else
+    rcode = 0;
+
+  return rcode;
+}
+
+
+
+
+/*
+ * CM_warmup() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+int CM_warmup(void)
+#else
+int CM_warmup()
+#endif
+{
+  long runcnt;
+
+  /* load next run of contiguous data blocks of a single file */
+
+  if (warm_pos < warm_cnt && !SS_fatalerror && !SS_recover)
+    {
+      runcnt = 1;
+
+      while (warm_pos + runcnt < warm_cnt && runcnt < warm_cap &&
+	     fhandle_eq(warm_vec[warm_pos + runcnt].fhandle,
+			warm_vec[warm_pos].fhandle) &&
+	     warm_vec[warm_pos + runcnt].db_nmbr ==
+	     warm_vec[warm_pos].db_nmbr + runcnt)
+	runcnt++;
+
+      prefetch_dblk(warm_vec[warm_pos].fhandle,
+		    warm_vec[warm_pos].db_nmbr, runcnt, TRUE);
+
+      warm_pos += runcnt;
+    }
+
+  /* discard warm-up state when complete */
+
+  if (warm_pos >= warm_cnt || SS_fatalerror || SS_recover)
+    {
+      if (warm_vec != NULL)
+	free((char *)warm_vec);
+
+      warm_vec = NULL;
+      warm_cnt = warm_pos = 0;
+    }
+
+  return (warm_cnt > 0);
+}
+
+
+
+
+/*
+ * CM_stats() - See pds_cache_manager.h for description.
+ */
+
+#ifdef __STDC__
+void CM_stats(struct CM_stats *stats)
+#else
+void CM_stats(stats)
+     struct CM_stats *stats;
+#endif
+{
+  long i, j, nentry, nblk, ndirty;
+  register cache_entryt *cache_entry;
+
+  if (!cache_initialized)
+    cachemanager_init((struct CM_param *)NULL);
+
+  /* activity counters */
+  *stats = cm_stat;
+
+  /* configuration and state */
+  stats->cache_sz    = cache_sz;
+  stats->dblk_sz     = dblk_sz;
+  stats->sm_cnt      = sm_cnt;
+  stats->sm_sz       = sm_sz;
+  stats->policy      = cache_policy;
+  stats->admit       = (adm_sketch != NULL);
+  stats->writeback   = cache_writeback;
+  stats->prot_sz     = prot_sz;
+  stats->prot_target = prot_target;
+  stats->wb_ndirty   = wb_ndirty;
+  stats->sm_nvalid   = 0;
+
+  for (i = 0; i < sm_cnt; i++)
+    if (sm_cache[i].valid)
+      stats->sm_nvalid++;
+
+  stats->lg_cnt    = lg_cnt;
+  stats->lg_sz     = lg_sz;
+  stats->lg_nvalid = 0;
+
+  for (i = 0; i < lg_cnt; i++)
+    if (lg_cache[i].valid)
+      stats->lg_nvalid++;
+
+  stats->part_cnt = part_cnt;
+
+  for (i = 0; i <= CM_PART_MAX; i++)
+    {
+      stats->part_nblk[i]   = part_nblk[i];
+      stats->part_min[i]    = part_min[i];
+      stats->part_max[i]    = part_max[i];
+      stats->part_lgnblk[i] = part_lgnblk[i];
+    }
+  stats->ndirty      = 0;
+  stats->nfile       = 0;
+
+  /* gather valid cache entries */
+  nentry = 0;
+
+  for (i = 0; i < cache_sz; i++)
+    if (cache[i].valid)
+      {
+	fl_vec[nentry++] = cache + i;
+
+	if (cache[i].dirty)
+	  stats->ndirty++;
+      }
+
+  stats->nvalid = nentry;
+
+  /* sort valid cache entries into file order; count the data blocks of each
+   * file, retaining the files with the most cached data blocks
+   */
+  if (nentry > 1)
+    qsort((char *)fl_vec, (size_t)nentry, sizeof(cache_entryt *), dblk_cmp);
+
+  i = 0;
+
+  while (i < nentry)
+    {
+      cache_entry = fl_vec[i];
+      nblk        = ndirty = 0;
+
+      do
+	{
+	  if (fl_vec[i]->dirty)
+	    ndirty++;
+
+	  nblk++;
+	  i++;
+	}
+      while (i < nentry &&
+	     fhandle_eq(fl_vec[i]->fhandle, cache_entry->fhandle));
+
+      /* insert file in order of decreasing cached data block count */
+      for (j = stats->nfile; j > 0 && stats->file[j - 1].nblk < nblk; j--)
+	if (j < CM_STAT_TOPN)
+	  stats->file[j] = stats->file[j - 1];
+
+      if (j < CM_STAT_TOPN)
+	{
+	  stats->file[j].fhandle = cache_entry->fhandle;
+	  stats->file[j].nblk    = nblk;
+	  stats->file[j].ndirty  = ndirty;
+
+	  if (stats->nfile < CM_STAT_TOPN)
+	    stats->nfile++;
+	}
+    }
+}
+
+
+
+
+/* Function Defintions - Local Functions */
+
+
+
+
+/*
+ * hash_dblk()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   db_nmbr - data block number
+ *
+ * Calculates data block hash value in range 0..(dblk_table_sz - 1).
+ *
+ * The file handle is incorporated so that low numbered data blocks of
+ * distinct files do not collide; with a large cache of many small files
+ * this would otherwise concentrate entries in the first few hash chains.
+ *
+ * Returns:
+ *
+ *   0..(dblk_table_sz - 1)
+ */
+
+/*
+static long hash_dblk(pds_fhandlet fhandle,
+		      pious_offt db_nmbr)
+*/
+
+#define hash_dblk(fhandle, db_nmbr) \
+((long)(((unsigned long)(db_nmbr) + ((fhandle).ino * 257)) % \
+	(unsigned long)dblk_table_sz))
+
+
+
+
+/*
+ * read_dblk()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   db_nmbr - data block number
+ *   offset  - data block offset (offset from start of data block)
+ *   nbyte   - byte count
+ *   buf     - buffer
+ *
+ * Read data block 'db_nmbr' of file 'fhandle' starting at 'offset' bytes
+ * from the beginning of the block and proceeding for 'nbyte' bytes; place
+ * result in buffer 'buf'.  A data block that can not be cached within
+ * partition shares is read directly from stable storage.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes read and placed in buffer (<= nbyte)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - file offset or nbyte is not a proper value
+ *                      or exceeds SYSTEM constraints
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static pious_ssizet read_dblk(pds_fhandlet fhandle,
+			      pious_offt db_nmbr,
+			      pious_offt offset,
+			      pious_sizet nbyte,
+			      char *buf)
+#else
+static pious_ssizet read_dblk(fhandle, db_nmbr, offset, nbyte, buf)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
+     pious_offt offset;
+     pious_sizet nbyte;
+     char *buf;
+#endif
+{
+  pious_ssizet rcode;
+  cache_entryt *cache_entry;
+
+  /* reference appropriate (portion of) data block and copy out data */
+
+  rcode = ref_dblk(fhandle, db_nmbr, offset, nbyte, &cache_entry);
+
+  if (rcode > 0)
+    memcpy(buf, (cache_entry->dblk) + offset, (int)rcode);
+
+  else if (rcode == PIOUS_EBUSY)
+    { /* data block not cached within partition shares; read directly */
+      rcode = SS_read(fhandle, (pious_offt)((db_nmbr * dblk_sz) + offset),
+		      nbyte, buf);
+
+      if (rcode < 0)
+	switch(rcode)
+	  {
+	  case PIOUS_EBADF:
+	  case PIOUS_EACCES:
+	  case PIOUS_EINVAL:
+	  case PIOUS_EINSUF:
+	  case PIOUS_EFATAL:
+	    break;
+	  default:
+	    rcode = PIOUS_EUNXP;
+	    break;
+	  }
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * ref_dblk()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   db_nmbr - data block number
+ *   offset  - data block offset (offset from start of data block)
+ *   nbyte   - byte count
+ *   entry   - cache entry
+ *
+ * Reference data block 'db_nmbr' of file 'fhandle' starting at 'offset'
+ * bytes from the beginning of the block and proceeding for 'nbyte' bytes,
+ * loading the data block into cache as required.  If data is referenced
+ * then a pointer to the cache entry containing the data block is placed in
+ * 'entry'; the data referenced starts at offset 'offset' of entry->dblk.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes referenced (<= nbyte)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - file offset or nbyte is not a proper value
+ *                      or exceeds SYSTEM constraints
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static pious_ssizet ref_dblk(pds_fhandlet fhandle,
+			     pious_offt db_nmbr,
+			     pious_offt offset,
+			     pious_sizet nbyte,
+			     cache_entryt **entry)
+#else
+static pious_ssizet ref_dblk(fhandle, db_nmbr, offset, nbyte, entry)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
+     pious_offt offset;
+     pious_sizet nbyte;
+     cache_entryt **entry;
+#endif
+{
+  int copyout, badflush, cachehit, eofstale, admit;
+  pious_ssizet rcode, acode;
+  pious_offt db_end;
+  cache_entryt *cache_entry, *small_entry;
+  file_entryt *eof_entry;
+
+  /* a null read always succeeds without perturbing cache */
+  if (nbyte == 0)
+    {
+      rcode = 0;
+    }
+
+  else if (sm_cnt > 0 && (cache_entry = small_ref(fhandle, db_nmbr)) != NULL)
+    { /* data block held in small data block; reference available data */
+      if (offset >= cache_entry->db_nbyte)
+	rcode = 0;
+      else
+	rcode = Min(nbyte, cache_entry->db_nbyte - offset);
+
+      *entry = cache_entry;
+    }
+
+  else
+    { /* record reference with admission filter; a data block not cached,
+       * or prefetched and not yet referenced, is admitted only if more
+       * frequently referenced than the entry next to be replaced.
+       * see discussion at top.
+       */
+
+      admit = TRUE;
+
+      if (adm_sketch != NULL)
+	{
+	  adm_record(fhandle, db_nmbr);
+
+	  cache_entry = cache_lookup(fhandle, db_nmbr);
+
+	  if (cache_entry == NULL || cache_entry->prefetched)
+	    admit = adm_admit(fhandle, db_nmbr);
+	}
+
+      /* allocate a cache entry for (fhandle, db_nmbr) */
+
+      acode = cache_alloc(fhandle, db_nmbr, FALSE, &cache_entry);
+
+      if (acode != PIOUS_OK)
+	{ /* alloc failed; acode == PIOUS_EFATAL || acode == PIOUS_ERECOV,
+	   * or PIOUS_EBUSY if not cached within partition shares
+	   */
+	  rcode = acode;
+	}
+
+      else
+	{ /* cache entry allocated; read data block and/or reference data */
+
+	  /* a prefetched block is not referenced until first read, and hence
+	   * is placed as for a cache-miss
+	   */
+
+	  if (cache_entry->valid && !cache_entry->prefetched)
+	    cachehit = TRUE;
+	  else
+	    cachehit = FALSE;
+
+	  if (cachehit)
+	    {
+	      if (cache_entry->segment == PROTECTED)
+		cm_stat.hit_pt++;
+	      else
+		cm_stat.hit_pb++;
+	    }
+	  else if (cache_entry->valid)
+	    cm_stat.hit_ra++;
+	  else
+	    cm_stat.miss++;
+
+	  cache_entry->prefetched = FALSE;
+
+	  copyout  = TRUE;
+	  eofstale = FALSE;
+
+	  if (cache_entry->valid && cache_entry->db_nbyte < dblk_sz)
+	    { /* cache entry contains a potentially stale EOF resulting from
+	       * an implied write; current if file size is recorded, and
+	       * extended by the zeros implied if it precedes the file size.
+	       * see discussion at top.
+	       */
+	      eof_entry = eof_lookup(fhandle, FALSE);
+	      db_end    = (db_nmbr * dblk_sz) + cache_entry->db_nbyte;
+
+	      if (eof_entry == NULL || eof_entry->fsize < db_end)
+		{
+		  eofstale = TRUE;
+		  cm_stat.eof_reload++;
+		}
+
+	      else
+		{
+		  if (eof_entry->fsize > db_end)
+		    {
+		      db_end = Min(eof_entry->fsize,
+				   (db_nmbr + 1) * dblk_sz);
+
+		      memset((cache_entry->dblk) + (cache_entry->db_nbyte), 0,
+			     (int)(db_end - (db_nmbr * dblk_sz) -
+				   cache_entry->db_nbyte));
+
+		      cache_entry->db_nbyte = db_end - (db_nmbr * dblk_sz);
+		    }
+
+		  cm_stat.eof_hit++;
+		}
+	    }
+
+	  if (!cache_entry->valid || eofstale)
+	    { /* cache entry invalid or contains a stale EOF; (re)read data
+	       * from file in either case; if valid and dirty, must flush
+	       * first.
+	       */
+
+	      badflush = FALSE;
+
+	      if (cache_entry->valid && cache_entry->dirty)
+		{ /* cache entry is valid and dirty; attempt to flush */
+		  acode = SS_write(fhandle,
+				   (pious_offt)(db_nmbr * dblk_sz),
+				   cache_entry->db_nbyte,
+				   cache_entry->dblk,
+				   cache_entry->faultmode);
+
+		  if (acode != cache_entry->db_nbyte)
+		    { /* block flush unsuccessful */
+		      badflush = TRUE;
+		      copyout  = FALSE;
+		      rcode    = PIOUS_EUNXP;
+		    }
+		  else
+		    {
+		      cm_stat.flush_ops++;
+		      cm_stat.flush_blks++;
+		      cm_stat.flush_bytes += cache_entry->db_nbyte;
+		    }
+		}
+
+	      if (!badflush)
+		{ /* read data block from stable storage; at this point the
+                   * alloced cache entry is either invalid, or valid and clean
+                   */
+
+		  acode = load_dblk(cache_entry);
+
+		  if (acode > 0)
+		    { /* data block read successful; set cache entry fields */
+		      cache_entry->db_nbyte  = acode;
+		      cache_entry->dirty     = FALSE;
+		      cache_entry->faultmode = PIOUS_VOLATILE;
+
+		      wb_remove(cache_entry);
+
+		      if (!cache_entry->valid)
+			/* mark valid, put on data block/fhandle hash chains */
+			entry_validate(cache_entry);
+		    }
+
+		  else
+		    { /* data block read unsuccessful; set return code */
+		      copyout = FALSE;
+
+		      switch(acode)
+			{
+			case 0: /* data block read at/past EOF */
+			case PIOUS_EBADF:
+			case PIOUS_EACCES:
+			case PIOUS_EINVAL:
+			case PIOUS_EINSUF:
+			case PIOUS_EFATAL:
+			  rcode = acode;
+			  break;
+			default:
+			  rcode = PIOUS_EUNXP;
+			  break;
+			}
+
+		      if (cache_entry->valid)
+			/* invalidate cache entry, if valid */
+			entry_invalidate(cache_entry);
+		    }
+		}
+	    }
+
+	  if (copyout)
+	    { /* reference requested data as available */
+
+	      if (offset >= cache_entry->db_nbyte)
+		{ /* request starts at/past EOF; no data transfered */
+		  rcode = 0;
+		}
+
+	      else
+		{ /* request starts within valid data; transfer */
+		  rcode = Min(nbyte, cache_entry->db_nbyte - offset);
+		}
+
+	      *entry = cache_entry;
+
+	      /* move cache entry to MRU position of appropriate segment; an
+	       * entry not admitted by the admission filter, or of a file
+	       * advised NOREUSE, is instead not promoted, and is made the
+	       * first to be re-allocated.  a cache-miss small enough is
+	       * instead moved to a small data block, if one is available.
+	       */
+	      if (!cachehit && sm_cnt > 0 && cache_entry->db_nbyte < sm_sz &&
+		  (small_entry = small_move(cache_entry)) != NULL)
+		*entry = small_entry;
+	      else if (!admit && !cachehit)
+		{
+		  cm_stat.adm_reject++;
+		  make_lru_pb(cache_entry);
+		}
+	      else if (adv_cnt > 0 && cache_entry->segment == PROBATIONARY &&
+		       adv_lookup(fhandle) == PIOUS_ADV_NOREUSE)
+		make_lru_pb(cache_entry);
+	      else if (cachehit && part_promote(cache_entry))
+		make_mru_pt(cache_entry);
+	      else
+		make_mru_pb(cache_entry);
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+/*
+ * read_extent()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   offset  - starting offset
+ *   nbyte   - byte count
+ *   buf     - buffer
+ *
+ * Read file 'fhandle' starting at 'offset' bytes from the beginning
+ * and proceeding for 'nbyte' bytes; place results in buffer 'buf'.
+ *
+ * Cached data blocks are read via read_dblk().  Each run of non-cached data
+ * blocks is read from stable storage directly into 'buf' with a single
+ * SS_read(), without allocating cache entries.
+ *
+ * Under the volatile write-back policy, if a run read is incomplete then any
+ * dirty blocks beyond the run start are flushed and the run re-read; see
+ * discussion at top.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes read and placed in buffer (<= nbyte)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - file offset or nbyte is not a proper value
+ *                      or exceeds SYSTEM constraints
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static pious_ssizet read_extent(pds_fhandlet fhandle,
+				pious_offt offset,
+				pious_sizet nbyte,
+				char *buf)
+#else
+static pious_ssizet read_extent(fhandle, offset, nbyte, buf)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     char *buf;
+#endif
+{
+  int done, fcode;
+  pious_ssizet rcode, acode;
+  pious_sizet readcount, db_nbyte;
+  pious_offt db_nmbr, db_offset, next_nmbr;
+
+  /* calculate first data block number, offset, and byte count */
+
+  db_nmbr   = offset / dblk_sz;
+  db_offset = offset % dblk_sz;
+  db_nbyte  = Min(dblk_sz - db_offset, nbyte);
+
+  readcount = 0;
+  done      = FALSE;
+
+  while (!done)
+    {
+      if (cache_lookup(fhandle, db_nmbr) != NULL)
+	{ /* data block cached; read appropriate (portion of) data block */
+	  acode     = read_dblk(fhandle, db_nmbr, db_offset, db_nbyte, buf);
+	  next_nmbr = db_nmbr + 1;
+	}
+
+      else
+	{ /* data block not cached; extend run over non-cached data blocks */
+	  next_nmbr = db_nmbr + 1;
+
+	  while (db_nbyte < nbyte && cache_lookup(fhandle, next_nmbr) == NULL)
+	    {
+	      db_nbyte += Min(dblk_sz, nbyte - db_nbyte);
+	      next_nmbr++;
+	    }
+
+	  /* read run directly into buffer */
+	  cm_stat.lr_blks += next_nmbr - db_nmbr;
+
+	  acode = SS_read(fhandle,
+			  (pious_offt)((db_nmbr * dblk_sz) + db_offset),
+			  db_nbyte,
+			  buf);
+
+	  if (cache_writeback && acode >= 0 && acode < db_nbyte)
+	    { /* incomplete run; flush dirty blocks beyond and re-read */
+	      fcode = flush_file(fhandle, db_nmbr);
+
+	      if (fcode > 0)
+		acode = SS_read(fhandle,
+				(pious_offt)((db_nmbr * dblk_sz) + db_offset),
+				db_nbyte,
+				buf);
+
+	      else if (fcode < 0)
+		acode = fcode;
+	    }
+
+	  /* an incomplete run determines the file size */
+	  if (acode > 0 && acode < db_nbyte)
+	    eof_lookup(fhandle, TRUE)->fsize =
+	      (db_nmbr * dblk_sz) + db_offset + acode;
+
+	  if (acode < 0)
+	    switch(acode)
+	      {
+	      case PIOUS_EBADF:
+	      case PIOUS_EACCES:
+	      case PIOUS_EINVAL:
+	      case PIOUS_EINSUF:
+	      case PIOUS_EFATAL:
+		break;
+	      default:
+		acode = PIOUS_EUNXP;
+		break;
+	      }
+	}
+
+      if (acode < 0)
+	{ /* error, set return code appropriately and exit */
+	  rcode = acode;
+	  done  = TRUE;
+	}
+
+      else
+	{ /* read next data block(s), if required */
+	  readcount += acode;
+	  nbyte     -= acode;
+
+	  if (nbyte == 0 || acode < db_nbyte)
+	    { /* transfer complete or hit EOF */
+	      rcode = readcount;
+	      done  = TRUE;
+	    }
+
+	  else
+	    { /* transfer incomplete; set next data block/offset to read */
+	      db_nmbr   = next_nmbr;
+	      db_offset = 0;
+	      db_nbyte  = Min(dblk_sz, nbyte);
+
+	      /* increment read buffer pointer for next transfer */
+	      buf += acode;
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * cache_lookup()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   db_nmbr - data block number
+ *
+ * Locate the valid cache entry for data block 'db_nmbr' of file 'fhandle'.
+ * The cache is not altered.
+ *
+ * Returns:
+ *
+ *   cache_entryt * - cache entry, or NULL if data block is not cached
+ */
+
+#ifdef __STDC__
+static cache_entryt *cache_lookup(pds_fhandlet fhandle,
+				  pious_offt db_nmbr)
+#else
+static cache_entryt *cache_lookup(fhandle, db_nmbr)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
+#endif
+{
+  register cache_entryt *cache_entry;
+
+  /* search cache via data block hash chain for (fhandle, db_nmbr) pair */
+
+  cache_entry = dblk_table[hash_dblk(fhandle, db_nmbr)];
+
+  while (cache_entry != NULL &&
+	 (cache_entry->db_nmbr != db_nmbr ||
+	  !fhandle_eq(cache_entry->fhandle, fhandle)))
+    cache_entry = cache_entry->dbnext;
+
+  return cache_entry;
+}
+
+
+
+
+/*
+ * write_dblk()
+ *
+ * Parameters:
+ *
+ *   fhandle   - file handle
+ *   db_nmbr   - data block number
+ *   offset    - data block offset (offset from start of data block)
+ *   nbyte     - byte count
+ *   buf       - buffer
+ *   faultmode - PIOUS_STABLE or PIOUS_VOLATILE
+ *
+ * Write to data block 'db_nmbr' of file 'fhandle' starting at 'offset' bytes
+ * from the beginning of the block and proceeding for 'nbyte' bytes the data
+ * in buffer 'buf'.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - file data block successfully written
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static int write_dblk(pds_fhandlet fhandle,
+		      pious_offt db_nmbr,
+		      pious_offt offset,
+		      pious_sizet nbyte,
+		      char *buf,
+		      int faultmode)
+#else
+static int write_dblk(fhandle, db_nmbr, offset, nbyte, buf, faultmode)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
+     pious_offt offset;
+     pious_sizet nbyte;
+     char *buf;
+     int faultmode;
+#endif
+{
+  int rcode, cachehit;
+  pious_ssizet acode;
+  cache_entryt *cache_entry;
+
+  /* a null write always succeeds without perturbing cache */
+  if (nbyte == 0)
+    {
+      rcode = PIOUS_OK;
+    }
+
+  else
+    { /* search cache via data block hash chain for (fhandle, db_nmbr) pair */
+
+      cache_entry = dblk_table[hash_dblk(fhandle, db_nmbr)];
+
+      while (cache_entry != NULL &&
+	     (cache_entry->db_nmbr != db_nmbr ||
+	      !fhandle_eq(cache_entry->fhandle, fhandle)))
+	cache_entry = cache_entry->dbnext;
+
+      if (cache_entry != NULL && cache_entry->segment == SMALL)
+	{ /* small data blocks are never written; discard as for a miss */
+	  small_discard(cache_entry);
+	  cache_entry = NULL;
+	}
+
+      rcode    = PIOUS_OK;
+      cachehit = (cache_entry != NULL);
+
+      /* if volatile write-back cache-miss then allocate cache entry; if not
+       * writing a full data block then must first read existing data.
+       */
+
+      if (!cachehit && faultmode == PIOUS_VOLATILE && cache_writeback)
+	{
+	  rcode = cache_alloc(fhandle, db_nmbr, FALSE, &cache_entry);
+
+	  if (rcode == PIOUS_EBUSY)
+	    { /* not cached within partition shares; write-through instead */
+	      rcode       = PIOUS_OK;
+	      cache_entry = NULL;
+	    }
+
+	  else if (rcode != PIOUS_OK)
+	    { /* alloc failed; rcode == PIOUS_EFATAL || rcode == PIOUS_ERECOV */
+	      cache_entry = NULL;
+	    }
+
+	  else
+	    {
+	      if (offset == 0 && nbyte == dblk_sz)
+		acode = 0;
+	      else
+		acode = load_dblk(cache_entry);
+
+	      if (acode >= 0)
+		{ /* data block read successful; set cache entry fields */
+		  cache_entry->db_nbyte  = acode;
+		  cache_entry->dirty     = FALSE;
+		  cache_entry->faultmode = PIOUS_VOLATILE;
+
+		  entry_validate(cache_entry);
+		}
+
+	      else
+		{ /* data block read unsuccessful; write-through instead */
+		  make_lru_pb(cache_entry);
+
+		  cache_entry = NULL;
+		}
+	    }
+	}
+
+      /* if cache-miss or volatile write-through then write-through w/o
+       * allocation
+       */
+
+      if (rcode == PIOUS_OK &&
+	  (cache_entry == NULL ||
+	   (faultmode == PIOUS_VOLATILE && !cache_writeback)))
+	{
+	  if ((acode = SS_write(fhandle,
+				(pious_offt)((db_nmbr * dblk_sz) + offset),
+				nbyte,
+				buf,
+				faultmode)) != nbyte)
+	    { /* write error, or incomplete transfer of data */
+	      if (acode == PIOUS_EFATAL)
+		{ /* fatal error occured */
+		  rcode = PIOUS_EFATAL;
+		}
+	      else
+		{ /* non-fatal error; mark for recovery */
+		  SS_recover = TRUE;
+		  rcode      = PIOUS_ERECOV;
+		}
+	    }
+	}
+
+      /* if cache-hit, or allocated, then update cached block */
+
+      if (cache_entry != NULL && rcode == PIOUS_OK)
+	{ /* fill void between last valid byte and start of write */
+	  if (offset > cache_entry->db_nbyte)
+	    memset((cache_entry->dblk) + (cache_entry->db_nbyte), 0,
+		   (int)(offset - cache_entry->db_nbyte));
+
+	  /* copy updated data into cached block */
+	  memcpy((cache_entry->dblk) + offset, buf, (int)nbyte);
+
+	  /* reset data block byte count */
+	  cache_entry->db_nbyte = Max(cache_entry->db_nbyte,
+				      offset + nbyte);
+
+	  /* if write faultmode is stable, mark block as dirty and stable */
+	  if (faultmode == PIOUS_STABLE)
+	    {
+	      cache_entry->dirty     = TRUE;
+	      cache_entry->faultmode = PIOUS_STABLE;
+
+	      wb_remove(cache_entry);
+	    }
+
+	  /* if volatile write-back, mark block as dirty unless already dirty
+	   * with stable data, which is not subject to background flushing
+	   */
+	  else if (cache_writeback &&
+		   !(cache_entry->dirty &&
+		     cache_entry->faultmode == PIOUS_STABLE))
+	    {
+	      cache_entry->dirty     = TRUE;
+	      cache_entry->faultmode = PIOUS_VOLATILE;
+
+	      wb_insert(cache_entry);
+	    }
+
+	  /* move cache entry to MRU position of appropriate segment, or to
+	   * LRU position of probationary segment if file advised NOREUSE
+	   */
+	  cache_entry->prefetched = FALSE;
+
+	  if (adv_cnt > 0 && cache_entry->segment == PROBATIONARY &&
+	      adv_lookup(fhandle) == PIOUS_ADV_NOREUSE)
+	    make_lru_pb(cache_entry);
+	  else if (cachehit && part_promote(cache_entry))
+	    make_mru_pt(cache_entry);
+	  else
+	    make_mru_pb(cache_entry);
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * cache_alloc()
+ *
+ * Parameters:
+ *
+ *   fhandle     - file handle
+ *   db_nmbr     - data block number
+ *   advisory    - advisory allocation flag; TRUE/FALSE
+ *   cache_entry - allocated cache entry
+ *
+ * Allocate a cache entry for data block 'db_nmbr' of file 'fhandle', placing
+ * a pointer to the cache entry in 'cache_entry'.
+ *
+ * If no cache entry can be located to replace, recovery is required unless
+ * 'advisory' is TRUE, as for prefetching, or cache partitions are
+ * configured, in which case PIOUS_EBUSY is returned and neither SS_recover
+ * nor SS_checkpoint is altered.  With cache partitions, an entry of the
+ * PROTECTED segment may be replaced, and is first demoted to the
+ * PROBATIONARY segment; see discussion at top.
+ *
+ * If the requested data block resided in the cache prior to calling
+ * cache_alloc(), then 'cache_entry' contains valid data.  Otherwise,
+ * a cache entry is allocated from the PROBATIONARY segment of the
+ * cache (cache_lru_pb in all but exceptional circumstances) and
+ * 'cache_entry' is marked invalid.
+ *
+ * NOTE: if successful then upon return:
+ *         1) cache_entry->fhandle == fhandle and
+ *         2) cache_entry->db_nmbr == db_nmbr
+ *       even if cache_entry->valid == FALSE
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - data block successfully allocated
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBUSY  - no cache entry available for advisory allocation, or
+ *                      within partition shares
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static int cache_alloc(pds_fhandlet fhandle,
+		       pious_offt db_nmbr,
+		       int advisory,
+		       cache_entryt **cache_entry)
+#else
+static int cache_alloc(fhandle, db_nmbr, advisory, cache_entry)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
+     int advisory;
+     cache_entryt **cache_entry;
+#endif
+{
+  int rcode, done, found, part, constrain, segment;
+  pious_ssizet fcode;
+  register cache_entryt* cache_pos;
+
+  /* search cache via data block hash chain for (fhandle, db_nmbr) pair */
+
+  cache_pos = dblk_table[hash_dblk(fhandle, db_nmbr)];
+
+  while (cache_pos != NULL && (cache_pos->db_nmbr != db_nmbr ||
+			       !fhandle_eq(cache_pos->fhandle, fhandle)))
+    cache_pos = cache_pos->dbnext;
+
+  if (cache_pos != NULL && cache_pos->segment == SMALL)
+    { /* located in small data block; discard, as cache entry required */
+      small_discard(cache_pos);
+      cache_pos = NULL;
+    }
+
+  if (cache_pos != NULL)
+    { /* located (fhandle, db_nmbr) pair in cache */
+      *cache_entry = cache_pos;
+      rcode        = PIOUS_OK;
+    }
+  else
+    { /* did NOT locate (fhandle, db_nmbr) pair in cache; allocate entry */
+
+      if (cache_policy == CM_POLICY_ARC)
+	{ /* adapt protected segment target size on ghost list hit */
+	  ghost_hit(fhandle, db_nmbr);
+
+	  /* shrink protected segment toward target size by demoting LRU
+	   * entry of protected seg to MRU entry of probationary seg
+	   */
+	  if (prot_sz > prot_target)
+	    {
+	      cache_mru_pb          = cache_mru_pb->cprev;
+	      cache_mru_pb->segment = PROBATIONARY;
+	      prot_sz--;
+	    }
+	}
+
+      done  = FALSE;
+      found = FALSE;
+
+      /* determine partition for which entry is allocated, and constrain
+       * the entry replaced accordingly.  see discussion at top.
+       */
+
+      part      = ((part_cnt > 0) ? part_lookup(fhandle) : 0);
+      constrain = (part_cnt > 0);
+
+      segment   = PROBATIONARY;
+      cache_pos = cache_lru_pb;
+
+      do
+	{ /* working from LRU to MRU entry of probationary segment, find
+	   * the first cache entry that is not pinned, that satisfies
+	   * partition constraints if so required, and such that:
+	   *   1) entry is not valid, or
+	   *   2) entry is valid but not dirty, or
+	   *   3) entry is valid and dirty but can be successfully
+	   *      flushed to stable storage.
+	   * if partition constraints are required, then the protected
+	   * segment is likewise searched should the probationary segment
+	   * not contain such an entry.  if no such entry can be found then
+	   * the data block is not cached if partition constraints are
+	   * required, and otherwise PDS can not continue and recovery will
+	   * be required.
+	   */
+
+	  if (cache_pos->pinned ||
+	      (constrain && !part_victim(cache_pos, part)))
+	    { /* cache entry referenced via CM_readv(), or in a partition
+	       * not to be replaced; go to next block
+	       */
+	      cache_pos = cache_pos->cprev;
+	    }
+
+	  else if (cache_pos->valid == FALSE || cache_pos->dirty == FALSE)
+	    { /* cache entry is not valid, or is valid but not dirty */
+	      found = done = TRUE;
+	    }
+
+	  else
+	    { /* cache entry is valid and dirty; attempt to flush */
+	      fcode = SS_write(cache_pos->fhandle,
+			       (pious_offt)(cache_pos->db_nmbr * dblk_sz),
+			       cache_pos->db_nbyte,
+			       cache_pos->dblk,
+			       cache_pos->faultmode);
+
+	      if (fcode == cache_pos->db_nbyte)
+		{ /* block flush successful */
+		  found = done = TRUE;
+
+		  cm_stat.evict_dirty++;
+		  cm_stat.flush_ops++;
+		  cm_stat.flush_blks++;
+		  cm_stat.flush_bytes += cache_pos->db_nbyte;
+		}
+
+	      else if (fcode == PIOUS_EFATAL)
+		/* PDS can not continue; SS_fatalerror set by Stable Storage
+		 * Manager.
+		 */
+		done = TRUE;
+	      else
+		/* block flush unsuccessful but not fatal, go to next block */
+		cache_pos = cache_pos->cprev;
+	    }
+
+	  if (!done && cache_pos->segment != segment)
+	    { /* segment searched; search protected segment from LRU entry
+	       * if partition constraints are required, provided that the
+	       * segment is not emptied by replacing an entry
+	       */
+	      if (segment == PROBATIONARY && constrain && prot_sz > 1)
+		segment = PROTECTED;
+	      else
+		done = TRUE;
+	    }
+	}
+      while (!done);
+
+      if (SS_fatalerror)
+	{ /* indicate that a fatal error occured */
+	  rcode = PIOUS_EFATAL;
+	}
+
+      else if (!found && (advisory || constrain))
+	{ /* indicate that no cache entry is available; no recovery */
+	  if (!advisory)
+	    cm_stat.part_bypass++;
+
+	  rcode = PIOUS_EBUSY;
+	}
+
+      else if (!found)
+	{ /* indicate that a cache entry can not be successfully allocated */
+	  SS_recover = TRUE;
+	  rcode      = PIOUS_ERECOV;
+	}
+
+      else
+	{ /* successfully located/flushed a cache entry to allocate */
+
+	  /* if cache entry to replace is in the protected segment, demote
+	   * it to LRU position of probationary segment
+	   */
+	  if (cache_pos->segment == PROTECTED)
+	    {
+	      if (cache_pos == cache_mru_pt)
+		cache_mru_pt = cache_pos->cnext;
+
+	      /* remove *cache_pos from cache block list */
+	      cache_pos->cprev->cnext = cache_pos->cnext;
+	      cache_pos->cnext->cprev = cache_pos->cprev;
+
+	      /* set *cache_pos pointers appropriately for LRU entry */
+	      cache_pos->cprev   = cache_lru_pb;
+	      cache_pos->cnext   = cache_mru_pt;
+	      cache_pos->segment = PROBATIONARY;
+
+	      /* set *cache_lru_pb and *cache_mru_pt ptrs to new LRU entry */
+	      cache_lru_pb->cnext = cache_pos;
+	      cache_mru_pt->cprev = cache_pos;
+
+	      cache_lru_pb = cache_pos;
+	      prot_sz--;
+	    }
+
+	  /* if cache entry to replace is valid, invalidate it; retain
+	   * identity in ghost list under adaptive policy
+	   */
+	  if (cache_pos->valid)
+	    {
+	      cm_stat.evict++;
+
+	      if (cache_policy == CM_POLICY_ARC)
+		ghost_insert(cache_pos);
+
+	      entry_invalidate(cache_pos);
+	    }
+
+	  /* update relevant cache entry fields */
+	  cache_pos->fhandle    = fhandle;
+	  cache_pos->db_nmbr    = db_nmbr;
+	  cache_pos->prefetched = FALSE;
+	  cache_pos->promoted   = FALSE;
+
+	  /* set return values */
+	  *cache_entry = cache_pos;
+	  rcode        = PIOUS_OK;
+	}
+    }
+
+  return rcode;
+}
+
+
+
+/*
+ * load_dblk()
+ *
+ * Parameters:
+ *
+ *   cache_entry - cache entry
+ *
+ * Read data block cache_entry->db_nmbr of file cache_entry->fhandle from
+ * stable storage into 'cache_entry'; cache entry fields are not altered.
+ *
+ * Under the volatile write-back policy, if the data block read is incomplete
+ * then any dirty data blocks beyond it in the same file are flushed and the
+ * data block re-read; see discussion at top.  The file size determined by
+ * an incomplete data block is recorded.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes read (<= dblk_sz)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - invalid/stale file handle
+ *       PIOUS_EACCES - read is invalid access mode for file handle
+ *       PIOUS_EINVAL - file offset is not a proper value
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static pious_ssizet load_dblk(cache_entryt *cache_entry)
+#else
+static pious_ssizet load_dblk(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  pious_ssizet rcode;
+  int fcode;
+
+  rcode = SS_read(cache_entry->fhandle,
+		  (pious_offt)(cache_entry->db_nmbr * dblk_sz),
+		  dblk_sz,
+		  cache_entry->dblk);
+
+  if (cache_writeback && rcode >= 0 && rcode < dblk_sz)
+    { /* incomplete data block; flush dirty blocks beyond and re-read */
+      fcode = flush_file(cache_entry->fhandle, cache_entry->db_nmbr + 1);
+
+      if (fcode > 0)
+	rcode = SS_read(cache_entry->fhandle,
+			(pious_offt)(cache_entry->db_nmbr * dblk_sz),
+			dblk_sz,
+			cache_entry->dblk);
+
+      else if (fcode < 0)
+	rcode = fcode;
+    }
+
+  /* an incomplete data block determines the file size */
+  if (rcode >= 0 && rcode < dblk_sz)
+    {
+      if (rcode > 0 || cache_entry->db_nmbr == 0)
+	eof_lookup(cache_entry->fhandle, TRUE)->fsize =
+	  (cache_entry->db_nmbr * dblk_sz) + rcode;
+      else
+	eof_discard(cache_entry->fhandle);
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * readahead()
+ *
+ * Parameters:
+ *
+ *   fhandle  - file handle
+ *   offset   - starting offset
+ *   nbyte    - byte count (> 0)
+ *   prefetch - prefetch data blocks flag; TRUE/FALSE
+ *
+ * Update the sequential access state of file 'fhandle' to reflect a read
+ * starting at 'offset' and proceeding for 'nbyte' bytes, and if 'prefetch'
+ * is TRUE then prefetch data blocks within the readahead window as required.
+ *
+ * A read that begins where the previous read of 'fhandle' ended, or at
+ * offset zero for a file with no access history, is sequential.  Sequential
+ * access opens a readahead window of RA_WINDOW_INIT data blocks that is
+ * doubled with each subsequent sequential read, up to 'ra_cap' blocks; any
+ * other access closes the window.  Data blocks are prefetched whenever fewer
+ * than half the window's blocks beyond the current read have been fetched.
+ *
+ * If SEQUENTIAL access is advised for 'fhandle' then the window is opened
+ * fully on any read, and if RANDOM access is advised it remains closed.
+ *
+ * Note: readahead is advisory; errors are ignored.  Presumes ra_cap > 0.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void readahead(pds_fhandlet fhandle,
+		      pious_offt offset,
+		      pious_sizet nbyte,
+		      int prefetch)
+#else
+static void readahead(fhandle, offset, nbyte, prefetch)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     int prefetch;
+#endif
+{
+  int advice;
+  file_entryt *ra_entry;
+  pious_offt first_nmbr, last_nmbr, start_nmbr, end_nmbr;
+
+  first_nmbr = offset / dblk_sz;
+  last_nmbr  = (offset + (nbyte - 1)) / dblk_sz;
+
+  ra_entry = file_lookup(fhandle, TRUE);
+
+  /* update readahead window, as advised for the file if applicable */
+
+  advice = ra_entry->advice;
+
+  if (advice == PIOUS_ADV_SEQUENTIAL)
+    { /* sequential access advised; open readahead window fully */
+      ra_entry->window = ra_cap;
+    }
+  else if (advice == PIOUS_ADV_RANDOM)
+    { /* random access advised; keep readahead window closed */
+      ra_entry->window  = 0;
+      ra_entry->ra_nmbr = 0;
+    }
+  else if (offset == ra_entry->next_offset)
+    { /* sequential access; open or grow readahead window */
+      if (ra_entry->window == 0)
+	ra_entry->window = Min(RA_WINDOW_INIT, ra_cap);
+      else
+	ra_entry->window = Min(ra_entry->window * 2, ra_cap);
+    }
+  else
+    { /* non-sequential access; close readahead window */
+      ra_entry->window  = 0;
+      ra_entry->ra_nmbr = 0;
+    }
+
+  ra_entry->next_offset = offset + nbyte;
+
+  /* prefetch data blocks if fewer than half the window is fetched ahead */
+
+  if (prefetch && ra_entry->window > 0 &&
+      ra_entry->ra_nmbr <= last_nmbr + ((ra_entry->window + 1) / 2))
+    {
+      start_nmbr = Max(ra_entry->ra_nmbr, first_nmbr);
+      end_nmbr   = Min(last_nmbr + ra_entry->window,
+		       start_nmbr + (ra_cap - 1));
+
+      prefetch_dblk(fhandle, start_nmbr, (long)(end_nmbr - start_nmbr + 1),
+		    FALSE);
+
+      ra_entry->ra_nmbr = end_nmbr + 1;
+    }
+}
+
+
+
+
+/*
+ * prefetch_dblk()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   db_nmbr - starting data block number
+ *   db_cnt  - data block count (0 < db_cnt <= Max(ra_cap, warm_cap))
+ *   warm    - cache warm-up flag; TRUE/FALSE
+ *
+ * Load into the cache those data blocks of file 'fhandle', starting with
+ * block 'db_nmbr' and proceeding for 'db_cnt' blocks, that are not already
+ * cached.  Each run of consecutive non-cached blocks is read via a single
+ * vectored read directly into the allocated cache entries, which are placed
+ * at the MRU position of the PROBATIONARY segment and marked prefetched.
+ * If 'warm' is TRUE then entries are instead placed at the MRU position of
+ * the PROTECTED segment and are not marked prefetched.
+ *
+ * Cache entries allocated for data blocks beyond end-of-file, or for which
+ * the read fails, are left invalid at the LRU position of the PROBATIONARY
+ * segment.
+ *
+ * Note: prefetching is advisory; errors are ignored, and a failure to
+ *       allocate a cache entry ends prefetching without requiring recovery.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void prefetch_dblk(pds_fhandlet fhandle,
+			  pious_offt db_nmbr,
+			  long db_cnt,
+			  int warm)
+#else
+static void prefetch_dblk(fhandle, db_nmbr, db_cnt, warm)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
+     long db_cnt;
+     int warm;
+#endif
+{
+  int acode, done;
+  long i, runcnt;
+  pious_ssizet rcnt;
+  pious_offt run_nmbr;
+  cache_entryt *cache_entry;
+
+  runcnt   = 0;
+  run_nmbr = db_nmbr;
+  done     = FALSE;
+
+  for (i = 0; i <= db_cnt && !done; i++)
+    {
+      cache_entry = NULL;
+
+      if (i < db_cnt)
+	{ /* allocate cache entry for data block (db_nmbr + i) */
+	  acode = cache_alloc(fhandle, db_nmbr + i, TRUE, &cache_entry);
+
+	  if (acode != PIOUS_OK)
+	    { /* can not allocate; read any pending run and quit */
+	      cache_entry = NULL;
+	      done        = TRUE;
+	    }
+
+	  else if (cache_entry->valid)
+	    /* data block is cached; terminates run */
+	    cache_entry = NULL;
+
+	  else
+	    { /* data block is not cached; add to run.  move to MRU position
+	       * of probationary segment so that entry is not re-allocated.
+	       */
+	      if (runcnt == 0)
+		run_nmbr = db_nmbr + i;
+
+	      make_mru_pb(cache_entry);
+
+	      ra_vec[runcnt]      = cache_entry;
+	      ra_iov[runcnt].base = cache_entry->dblk;
+	      ra_iov[runcnt].len  = dblk_sz;
+	      runcnt++;
+	    }
+	}
+
+      if (cache_entry == NULL && runcnt > 0)
+	{ /* run terminated; read data blocks */
+	  rcnt = SS_readv(fhandle,
+			  (pious_offt)(run_nmbr * dblk_sz),
+			  ra_iov, (int)runcnt);
+
+	  for (runcnt--; runcnt >= 0; runcnt--)
+	    {
+	      cache_entry = ra_vec[runcnt];
+
+	      /* the entry may have been re-allocated within the run if
+	       * dirty blocks could not be flushed; validate only in the
+	       * final run position allocated.
+	       */
+
+	      if (rcnt > (pious_ssizet)(runcnt * dblk_sz) &&
+		  cache_entry->db_nmbr == run_nmbr + runcnt &&
+		  fhandle_eq(cache_entry->fhandle, fhandle) &&
+		  !cache_entry->valid)
+		{ /* data read for block; validate entry */
+		  cache_entry->db_nbyte   =
+		    Min((pious_sizet)rcnt - (runcnt * dblk_sz), dblk_sz);
+		  cache_entry->dirty      = FALSE;
+		  cache_entry->faultmode  = PIOUS_VOLATILE;
+		  cache_entry->prefetched = !warm;
+
+		  entry_validate(cache_entry);
+
+		  if (warm)
+		    { /* block resided in protected segment prior to restart */
+		      make_mru_pt(cache_entry);
+
+		      cm_stat.warm_blks++;
+		    }
+		  else
+		    cm_stat.ra_blks++;
+		}
+
+	      else if (!cache_entry->valid)
+		/* no data for block; make entry first to be re-allocated */
+		make_lru_pb(cache_entry);
+	    }
+
+	  runcnt = 0;
+	}
+    }
+}
+
+
+
+
+/*
+ * small_ref()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   db_nmbr - data block number
+ *
+ * Locate data block 'db_nmbr' of file 'fhandle' in a small data block,
+ * loading the data block into the least recently used small data block that
+ * is not referenced if not located, not otherwise cached, and known from
+ * the recorded file size to hold fewer bytes than a small data block.  A
+ * located small data block is discarded if the recorded file size has
+ * changed, or is no longer recorded.  See discussion at top.
+ *
+ * A small data block located or loaded is made most recently used.
+ *
+ * Returns:
+ *
+ *   cache_entryt * - small data block holding valid data for the data block
+ *   NULL           - data block not held in a small data block
+ */
+
+#ifdef __STDC__
+static cache_entryt *small_ref(pds_fhandlet fhandle,
+			       pious_offt db_nmbr)
+#else
+static cache_entryt *small_ref(fhandle, db_nmbr)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
+#endif
+{
+  pious_ssizet acode;
+  pious_sizet db_nbyte;
+  cache_entryt *cache_entry, *small_entry;
+  file_entryt *eof_entry;
+
+  small_entry = NULL;
+
+  /* determine data block byte count from recorded file size; zero if not
+   * recorded, or if the data block is not a small data block
+   */
+
+  db_nbyte = 0;
+
+  if ((eof_entry = eof_lookup(fhandle, FALSE)) != NULL &&
+      eof_entry->fsize > db_nmbr * dblk_sz &&
+      eof_entry->fsize - (db_nmbr * dblk_sz) < sm_sz)
+    db_nbyte = eof_entry->fsize - (db_nmbr * dblk_sz);
+
+  /* locate data block in cache */
+  cache_entry = cache_lookup(fhandle, db_nmbr);
+
+  if (cache_entry != NULL && cache_entry->segment == SMALL)
+    {
+      if (cache_entry->db_nbyte == db_nbyte)
+	{ /* small data block is current */
+	  cm_stat.hit_sm++;
+
+	  small_place(cache_entry, TRUE);
+
+	  small_entry = cache_entry;
+	}
+
+      else
+	{ /* file size changed or not recorded; discard small data block */
+	  small_discard(cache_entry);
+
+	  cache_entry = NULL;
+	}
+    }
+
+  if (small_entry == NULL && cache_entry == NULL && db_nbyte > 0)
+    { /* data block not cached; load into LRU unreferenced small data block */
+      cache_entry = sm_lru;
+
+      while (cache_entry != NULL && cache_entry->pinned)
+	cache_entry = cache_entry->cprev;
+
+      if (cache_entry != NULL)
+	{ /* small data blocks are never dirty; simply invalidate */
+	  entry_invalidate(cache_entry);
+
+	  cache_entry->fhandle = fhandle;
+	  cache_entry->db_nmbr = db_nmbr;
+
+	  acode = SS_read(fhandle,
+			  (pious_offt)(db_nmbr * dblk_sz),
+			  sm_sz,
+			  cache_entry->dblk);
+
+	  if (acode == db_nbyte)
+	    { /* data block read agrees with recorded file size */
+	      cache_entry->db_nbyte = acode;
+
+	      entry_validate(cache_entry);
+	      small_place(cache_entry, TRUE);
+
+	      cm_stat.miss++;
+	      cm_stat.sm_blks++;
+
+	      small_entry = cache_entry;
+	    }
+
+	  else
+	    { /* file changed or read failed; defer to cache proper */
+	      small_place(cache_entry, FALSE);
+	    }
+	}
+    }
+
+  return small_entry;
+}
+
+
+
+
+/*
+ * small_move()
+ *
+ * Parameters:
+ *
+ *   cache_entry - valid, clean, and unreferenced cache entry
+ *
+ * Move the data block held in 'cache_entry', of fewer bytes than a small
+ * data block, to the least recently used small data block that is not
+ * referenced, if any.  'cache_entry' is invalidated and made the first to be
+ * re-allocated, and the small data block made most recently used.
+ *
+ * Returns:
+ *
+ *   cache_entryt * - small data block now holding the data block
+ *   NULL           - no small data block available; 'cache_entry' unaltered
+ */
+
+#ifdef __STDC__
+static cache_entryt *small_move(cache_entryt *cache_entry)
+#else
+static cache_entryt *small_move(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  cache_entryt *small_entry;
+
+  small_entry = sm_lru;
+
+  while (small_entry != NULL && small_entry->pinned)
+    small_entry = small_entry->cprev;
+
+  if (small_entry != NULL)
+    { /* small data blocks are never dirty; simply invalidate */
+      entry_invalidate(small_entry);
+
+      small_entry->fhandle  = cache_entry->fhandle;
+      small_entry->db_nmbr  = cache_entry->db_nmbr;
+      small_entry->db_nbyte = cache_entry->db_nbyte;
+
+      memcpy(small_entry->dblk, cache_entry->dblk,
+	     (int)cache_entry->db_nbyte);
+
+      /* release cache entry prior to validating small data block */
+      entry_invalidate(cache_entry);
+      make_lru_pb(cache_entry);
+
+      entry_validate(small_entry);
+      small_place(small_entry, TRUE);
+
+      cm_stat.sm_blks++;
+    }
+
+  return small_entry;
+}
+
+
+
+
+/*
+ * small_discard()
+ *
+ * Parameters:
+ *
+ *   cache_entry - small data block cache entry
+ *
+ * Invalidate small data block 'cache_entry' and make it the first to be
+ * re-allocated.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void small_discard(cache_entryt *cache_entry)
+#else
+static void small_discard(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  entry_invalidate(cache_entry);
+  small_place(cache_entry, FALSE);
+}
+
+
+
+
+/*
+ * small_place()
+ *
+ * Parameters:
+ *
+ *   cache_entry - small data block cache entry
+ *   mru         - place at MRU (TRUE) or LRU (FALSE) position
+ *
+ * Move small data block 'cache_entry' to the MRU or LRU position of the
+ * small data block list, as specified by 'mru'.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void small_place(cache_entryt *cache_entry,
+			int mru)
+#else
+static void small_place(cache_entry, mru)
+     cache_entryt *cache_entry;
+     int mru;
+#endif
+{
+  if ((mru && cache_entry != sm_mru) || (!mru && cache_entry != sm_lru))
+    { /* remove 'cache_entry' from small data block list */
+      if (cache_entry->cprev != NULL)
+	cache_entry->cprev->cnext = cache_entry->cnext;
+      else
+	sm_mru = cache_entry->cnext;
+
+      if (cache_entry->cnext != NULL)
+	cache_entry->cnext->cprev = cache_entry->cprev;
+      else
+	sm_lru = cache_entry->cprev;
+
+      /* insert at MRU or LRU position */
+      if (mru)
+	{
+	  cache_entry->cprev = NULL;
+	  cache_entry->cnext = sm_mru;
+	  sm_mru->cprev      = cache_entry;
+	  sm_mru             = cache_entry;
+	}
+      else
+	{
+	  cache_entry->cnext = NULL;
+	  cache_entry->cprev = sm_lru;
+	  sm_lru->cnext      = cache_entry;
+	  sm_lru             = cache_entry;
+	}
+    }
+}
+
+
+
+
+/*
+ * small_reset()
+ *
+ * Parameters:
+ *
+ * Invalidate all small data blocks, without regard to hash chains, and
+ * initialize the small data block list.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void small_reset(void)
+#else
+static void small_reset()
+#endif
+{
+  register long i;
+
+  for (i = 0; i < sm_cnt; i++)
+    {
+      sm_cache[i].valid  = sm_cache[i].pinned = FALSE;
+      sm_cache[i].cprev  = ((i == 0) ? NULL : sm_cache + (i - 1));
+      sm_cache[i].cnext  = ((i == sm_cnt - 1) ? NULL : sm_cache + (i + 1));
+    }
+
+  sm_mru = sm_cache;
+  sm_lru = sm_cache + (sm_cnt - 1);
+}
+
+
+
+
+/*
+ * large_read()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   offset  - starting offset
+ *   nbyte   - byte count
+ *   buf     - buffer
+ *
+ * Read file 'fhandle', of the large data block class, starting at 'offset'
+ * bytes from the beginning and proceeding for 'nbyte' bytes; place results
+ * in buffer 'buf'.
+ *
+ * Data is read via large_ref(), one large data block at a time.  Should no
+ * large data block be available to load, data is instead read from stable
+ * storage directly into 'buf'.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes read and placed in buffer (<= nbyte)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - file offset or nbyte is not a proper value
+ *                      or exceeds SYSTEM constraints
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static pious_ssizet large_read(pds_fhandlet fhandle,
+			       pious_offt offset,
+			       pious_sizet nbyte,
+			       char *buf)
+#else
+static pious_ssizet large_read(fhandle, offset, nbyte, buf)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     char *buf;
+#endif
+{
+  int done;
+  pious_ssizet rcode, acode;
+  pious_sizet readcount, lg_nbyte;
+  pious_offt lg_nmbr, lg_offset;
+  cache_entryt *cache_entry;
+
+  /* calculate first large data block number, offset, and byte count */
+
+  lg_nmbr   = offset / lg_sz;
+  lg_offset = offset % lg_sz;
+  lg_nbyte  = Min(lg_sz - lg_offset, nbyte);
+
+  /* a null read always succeeds without perturbing cache */
+
+  rcode     = 0;
+  readcount = 0;
+  done      = (nbyte == 0);
+
+  /* read large data blocks, one block at a time */
+
+  while (!done)
+    {
+      acode = large_ref(fhandle, lg_nmbr, TRUE, &cache_entry);
+
+      if (acode == PIOUS_EBUSY)
+	{ /* no large data block available; read directly into buffer */
+	  acode = SS_read(fhandle,
+			  (pious_offt)((lg_nmbr * lg_sz) + lg_offset),
+			  lg_nbyte,
+			  buf);
+
+	  if (acode < 0)
+	    switch(acode)
+	      {
+	      case PIOUS_EBADF:
+	      case PIOUS_EACCES:
+	      case PIOUS_EINVAL:
+	      case PIOUS_EINSUF:
+	      case PIOUS_EFATAL:
+		break;
+	      default:
+		acode = PIOUS_EUNXP;
+		break;
+	      }
+	}
+
+      else if (acode > lg_offset)
+	{ /* request starts within valid data; transfer */
+	  acode = Min(lg_nbyte, acode - lg_offset);
+
+	  memcpy(buf, (cache_entry->dblk) + lg_offset, (int)acode);
+	}
+
+      else if (acode >= 0)
+	{ /* request starts at/past EOF; no data transfered */
+	  acode = 0;
+	}
+
+      if (acode < 0)
+	{ /* error, set return code appropriately and exit */
+	  rcode = acode;
+	  done  = TRUE;
+	}
+
+      else
+	{ /* read next large data block, if required */
+	  readcount += acode;
+	  nbyte     -= acode;
+
+	  if (nbyte == 0 || acode < lg_nbyte)
+	    { /* transfer complete or hit EOF */
+	      rcode = readcount;
+	      done  = TRUE;
+	    }
+
+	  else
+	    { /* transfer incomplete; set next block/offset to read */
+	      lg_nmbr++;
+	      lg_offset = 0;
+	      lg_nbyte  = Min(lg_sz, nbyte);
+
+	      /* increment read buffer pointer for next transfer */
+	      buf += acode;
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * large_readv()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   offset  - starting offset
+ *   nbyte   - byte count (> 0)
+ *   iov     - I/O vector
+ *   iovcnt  - I/O vector entry count
+ *
+ * Read file 'fhandle', of the large data block class, as for large_read(),
+ * but place in I/O vector 'iov' references to the data in large data blocks
+ * as for CM_readv().  Referenced large data blocks are pinned until
+ * CM_release().
+ *
+ * References are not available if outstanding, or if the request spans more
+ * large data blocks than 'iovcnt' or than can be referenced; fewer large
+ * data blocks than the slab holds are spanned, such that large_ref() fails
+ * to locate a large data block to load only if those replaceable are held
+ * within partition shares, whereupon references are released.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes read and referenced in 'iov' (<= nbyte)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBUSY  - references not available; read via CM_read()
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - file offset or nbyte is not a proper value
+ *                      or exceeds SYSTEM constraints
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static pious_ssizet large_readv(pds_fhandlet fhandle,
+				pious_offt offset,
+				pious_sizet nbyte,
+				struct FS_iovec *iov,
+				int *iovcnt)
+#else
+static pious_ssizet large_readv(fhandle, offset, nbyte, iov, iovcnt)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     struct FS_iovec *iov;
+     int *iovcnt;
+#endif
+{
+  int done;
+  pious_ssizet rcode, acode;
+  pious_sizet readcount, lg_nbyte;
+  pious_offt lg_nmbr, lg_offset, lg_span;
+  cache_entryt *cache_entry;
+
+  /* references outstanding, or read not suited to reference by block */
+
+  lg_span = (offset + (nbyte - 1)) / lg_sz - offset / lg_sz + 1;
+
+  if (pin_cnt > 0 || lg_span > *iovcnt || lg_span > Min(pin_max, lg_cnt))
+    rcode = PIOUS_EBUSY;
+
+  else
+    { /* calculate first large data block number, offset, and byte count */
+
+      lg_nmbr   = offset / lg_sz;
+      lg_offset = offset % lg_sz;
+      lg_nbyte  = Min(lg_sz - lg_offset, nbyte);
+
+      readcount = 0;
+      done      = FALSE;
+
+      /* reference large data blocks, one block at a time */
+
+      while (!done)
+	{
+	  acode = large_ref(fhandle, lg_nmbr, TRUE, &cache_entry);
+
+	  if (acode < 0)
+	    { /* error, release references, set return code and exit */
+	      CM_release();
+
+	      rcode = acode;
+	      done  = TRUE;
+	    }
+
+	  else
+	    { /* pin referenced data, if any, and read next block */
+	      if (acode > lg_offset)
+		{
+		  acode = Min(lg_nbyte, acode - lg_offset);
+
+		  cache_entry->pinned = TRUE;
+
+		  iov[pin_cnt].base = cache_entry->dblk + lg_offset;
+		  iov[pin_cnt].len  = acode;
+
+		  pin_vec[pin_cnt++] = cache_entry;
+		}
+	      else
+		acode = 0;
+
+	      readcount += acode;
+	      nbyte     -= acode;
+
+	      if (nbyte == 0 || acode < lg_nbyte)
+		{ /* transfer complete or hit EOF */
+		  *iovcnt = pin_cnt;
+		  rcode   = readcount;
+		  done    = TRUE;
+		}
+
+	      else
+		{ /* transfer incomplete; set next block/offset to read */
+		  lg_nmbr++;
+		  lg_offset = 0;
+		  lg_nbyte  = Min(lg_sz, nbyte);
+		}
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * large_write()
+ *
+ * Parameters:
+ *
+ *   fhandle   - file handle
+ *   offset    - starting offset
+ *   nbyte     - byte count
+ *   buf       - buffer
+ *   faultmode - PIOUS_STABLE or PIOUS_VOLATILE
+ *
+ * Write file 'fhandle', of the large data block class, starting at 'offset'
+ * bytes from the beginning and proceeding for 'nbyte' bytes the data in
+ * buffer 'buf'.
+ *
+ * The data is written through to stable storage, and the cached large data
+ * blocks spanned are updated and made most recently used; the recorded
+ * file size, if any, is maintained as for CM_write().
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - write completed successfully
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static int large_write(pds_fhandlet fhandle,
+		       pious_offt offset,
+		       pious_sizet nbyte,
+		       char *buf,
+		       int faultmode)
+#else
+static int large_write(fhandle, offset, nbyte, buf, faultmode)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     char *buf;
+     int faultmode;
+#endif
+{
+  int rcode;
+  pious_ssizet acode;
+  pious_sizet w_start, w_end;
+  pious_offt lg_nmbr, lg_last, lg_start;
+  cache_entryt *cache_entry;
+  file_entryt *eof_entry;
+
+  /* a null write always succeeds without perturbing cache */
+  if (nbyte == 0)
+    rcode = PIOUS_OK;
+
+  /* write through to stable storage */
+  else if ((acode = SS_write(fhandle, offset, nbyte, buf, faultmode)) !=
+	   nbyte)
+    { /* write error, or incomplete transfer of data */
+      if (acode == PIOUS_EFATAL)
+	{ /* fatal error occured */
+	  rcode = PIOUS_EFATAL;
+	}
+      else
+	{ /* non-fatal error; mark for recovery */
+	  SS_recover = TRUE;
+	  rcode      = PIOUS_ERECOV;
+	}
+
+      /* file size no longer known */
+      eof_discard(fhandle);
+    }
+
+  else
+    { /* update cached large data blocks spanned by the write */
+      lg_last = (offset + (nbyte - 1)) / lg_sz;
+
+      for (lg_nmbr = offset / lg_sz; lg_nmbr <= lg_last; lg_nmbr++)
+	if ((cache_entry = large_lookup(fhandle, lg_nmbr)) != NULL)
+	  { /* determine portion of large data block written */
+	    lg_start = lg_nmbr * lg_sz;
+	    w_start  = Max(offset, lg_start) - lg_start;
+	    w_end    = Min(offset + nbyte, lg_start + lg_sz) - lg_start;
+
+	    /* fill void between last valid byte and start of write */
+	    if (w_start > cache_entry->db_nbyte)
+	      memset((cache_entry->dblk) + (cache_entry->db_nbyte), 0,
+		     (int)(w_start - cache_entry->db_nbyte));
+
+	    /* copy updated data into large data block */
+	    memcpy((cache_entry->dblk) + w_start,
+		   buf + ((lg_start + w_start) - offset),
+		   (int)(w_end - w_start));
+
+	    /* reset large data block byte count */
+	    cache_entry->db_nbyte = Max(cache_entry->db_nbyte, w_end);
+
+	    large_place(cache_entry, TRUE);
+	  }
+
+      /* update file size, if recorded */
+      if ((eof_entry = eof_lookup(fhandle, FALSE)) != NULL)
+	eof_entry->fsize = Max(eof_entry->fsize, offset + nbyte);
+
+      rcode = PIOUS_OK;
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * large_ref()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   lg_nmbr - large data block number
+ *   filter  - subject to admission filter flag; TRUE/FALSE
+ *   entry   - large data block cache entry
+ *
+ * Reference large data block 'lg_nmbr' of file 'fhandle', loading it into
+ * the least recently used large data block that is not referenced, and
+ * that may be replaced within the partition shares of the slab (see
+ * part_victim()), if not located.  If data is referenced then a pointer to
+ * the large data block cache entry is placed in 'entry'.
+ *
+ * If 'filter' is TRUE then the reference is recorded with the admission
+ * filter, and a large data block loaded is admitted only if estimated to
+ * be more frequently referenced than the valid large data block replaced,
+ * as for ref_dblk().
+ *
+ * A located large data block that is incomplete is current if the file size
+ * is recorded, and is extended by the zeros implied if it precedes the file
+ * size; otherwise it is re-loaded, as for ref_dblk().  The file size
+ * determined by an incomplete large data block loaded is recorded.  A large
+ * data block located, or loaded and admitted, is made most recently used;
+ * one loaded and not admitted is made least recently used.
+ *
+ * Returns:
+ *
+ *   >  0 - number of valid bytes in large data block (<= lg_sz)
+ *   == 0 - large data block at/past EOF; no data referenced
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBUSY  - no large data block available to load, as all are
+ *                      referenced or held within partition shares
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - file offset is not a proper value
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+static pious_ssizet large_ref(pds_fhandlet fhandle,
+			      pious_offt lg_nmbr,
+			      int filter,
+			      cache_entryt **entry)
+#else
+static pious_ssizet large_ref(fhandle, lg_nmbr, filter, entry)
+     pds_fhandlet fhandle;
+     pious_offt lg_nmbr;
+     int filter;
+     cache_entryt **entry;
+#endif
+{
+  int reload, admit, part, constrain;
+  pious_ssizet rcode, acode;
+  pious_offt lg_end;
+  cache_entryt *cache_entry;
+  file_entryt *eof_entry;
+
+  /* record reference with admission filter */
+  if (filter && adm_sketch != NULL)
+    adm_record(fhandle, lg_nmbr);
+
+  /* locate large data block */
+  cache_entry = large_lookup(fhandle, lg_nmbr);
+  reload      = FALSE;
+
+  if (cache_entry != NULL && cache_entry->db_nbyte < lg_sz)
+    { /* incomplete large data block; validate per recorded file size */
+      eof_entry = eof_lookup(fhandle, FALSE);
+      lg_end    = (lg_nmbr * lg_sz) + cache_entry->db_nbyte;
+
+      if (eof_entry == NULL || eof_entry->fsize < lg_end)
+	{
+	  reload = TRUE;
+	  cm_stat.eof_reload++;
+	}
+
+      else
+	{
+	  if (eof_entry->fsize > lg_end)
+	    {
+	      lg_end = Min(eof_entry->fsize, (lg_nmbr + 1) * lg_sz);
+
+	      memset((cache_entry->dblk) + (cache_entry->db_nbyte), 0,
+		     (int)(lg_end - (lg_nmbr * lg_sz) -
+			   cache_entry->db_nbyte));
+
+	      cache_entry->db_nbyte = lg_end - (lg_nmbr * lg_sz);
+	    }
+
+	  cm_stat.eof_hit++;
+	}
+    }
+
+  if (cache_entry != NULL && !reload)
+    { /* large data block is current */
+      cm_stat.hit_lg++;
+
+      large_place(cache_entry, TRUE);
+
+      *entry = cache_entry;
+      rcode  = cache_entry->db_nbyte;
+    }
+
+  else
+    {
+      admit = TRUE;
+
+      if (cache_entry == NULL)
+	{ /* not located; allocate LRU unreferenced large data block that
+	   * may be replaced within partition shares, as for cache_alloc()
+	   */
+	  part      = ((part_cnt > 0) ? part_lookup(fhandle) : 0);
+	  constrain = FALSE;
+
+	  cache_entry = lg_lru;
+
+	  while (cache_entry != NULL &&
+		 (cache_entry->pinned ||
+		  (part_cnt > 0 && !part_victim(cache_entry, part))))
+	    {
+	      if (!cache_entry->pinned)
+		constrain = TRUE;
+
+	      cache_entry = cache_entry->cprev;
+	    }
+
+	  if (cache_entry == NULL)
+	    { /* no large data block replaceable */
+	      if (constrain)
+		cm_stat.part_bypass++;
+	    }
+
+	  else
+	    { /* admit only if more frequently referenced than the large
+	       * data block replaced; see discussion at top.
+	       */
+	      if (filter && adm_sketch != NULL && cache_entry->valid)
+		admit = (adm_estimate(fhandle, lg_nmbr) >
+			 adm_estimate(cache_entry->fhandle,
+				      cache_entry->db_nmbr));
+
+	      /* large data blocks are never dirty; simply invalidate */
+	      large_invalidate(cache_entry);
+
+	      cache_entry->fhandle = fhandle;
+	      cache_entry->db_nmbr = lg_nmbr;
+	    }
+	}
+
+      if (cache_entry == NULL)
+	{ /* all large data blocks referenced, or held within shares */
+	  rcode = PIOUS_EBUSY;
+	}
+
+      else
+	{ /* load large data block from stable storage */
+	  acode = SS_read(fhandle,
+			  (pious_offt)(lg_nmbr * lg_sz),
+			  lg_sz,
+			  cache_entry->dblk);
+
+	  /* an incomplete large data block determines the file size */
+	  if (acode >= 0 && acode < lg_sz)
+	    {
+	      if (acode > 0 || lg_nmbr == 0)
+		eof_lookup(fhandle, TRUE)->fsize = (lg_nmbr * lg_sz) + acode;
+	      else
+		eof_discard(fhandle);
+	    }
+
+	  if (acode > 0)
+	    { /* large data block read successful; reference data.  a large
+	       * data block not admitted is placed at the LRU position, such
+	       * that it is the first re-allocated.
+	       */
+	      cache_entry->db_nbyte = acode;
+
+	      large_validate(cache_entry);
+	      large_place(cache_entry, admit);
+
+	      cm_stat.lg_blks++;
+
+	      if (!admit)
+		cm_stat.adm_reject++;
+
+	      *entry = cache_entry;
+	      rcode  = acode;
+	    }
+
+	  else
+	    { /* large data block read unsuccessful; set return code */
+	      switch(acode)
+		{
+		case 0: /* large data block read at/past EOF */
+		case PIOUS_EBADF:
+		case PIOUS_EACCES:
+		case PIOUS_EINVAL:
+		case PIOUS_EINSUF:
+		case PIOUS_EFATAL:
+		  rcode = acode;
+		  break;
+		default:
+		  rcode = PIOUS_EUNXP;
+		  break;
+		}
+
+	      large_discard(cache_entry);
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * hash_lg()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   lg_nmbr - large data block number
+ *
+ * Calculates large data block hash value in range 0..(lg_table_sz - 1), as
+ * for hash_dblk().
+ *
+ * Returns:
+ *
+ *   0..(lg_table_sz - 1)
+ */
+
+/*
+static long hash_lg(pds_fhandlet fhandle,
+		    pious_offt lg_nmbr)
+*/
+
+#define hash_lg(fhandle, lg_nmbr) \
+((long)(((unsigned long)(lg_nmbr) + ((fhandle).ino * 257)) % \
+	(unsigned long)lg_table_sz))
+
+
+
+
+/*
+ * large_lookup()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   lg_nmbr - large data block number
+ *
+ * Locate the valid large data block 'lg_nmbr' of file 'fhandle'.  The cache
+ * is not altered.
+ *
+ * Returns:
+ *
+ *   cache_entryt * - large data block, or NULL if not cached
+ */
+
+#ifdef __STDC__
+static cache_entryt *large_lookup(pds_fhandlet fhandle,
+				  pious_offt lg_nmbr)
+#else
+static cache_entryt *large_lookup(fhandle, lg_nmbr)
+     pds_fhandlet fhandle;
+     pious_offt lg_nmbr;
+#endif
+{
+  register cache_entryt *cache_entry;
+
+  /* search large data block hash chain for (fhandle, lg_nmbr) pair */
+
+  cache_entry = lg_table[hash_lg(fhandle, lg_nmbr)];
+
+  while (cache_entry != NULL &&
+	 (cache_entry->db_nmbr != lg_nmbr ||
+	  !fhandle_eq(cache_entry->fhandle, fhandle)))
+    cache_entry = cache_entry->dbnext;
+
+  return cache_entry;
+}
+
+
+
+
+/*
+ * large_validate()
+ *
+ * Parameters:
+ *
+ *   cache_entry - large data block cache entry
+ *
+ * Place large data block 'cache_entry' on the large data block hash chain
+ * determined by its file handle and large data block number, charge it to
+ * the partition of its file, and mark as valid.  Does nothing if
+ * 'cache_entry' is already valid.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void large_validate(cache_entryt *cache_entry)
+#else
+static void large_validate(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  long hindex;
+
+  if (!cache_entry->valid)
+    { /* place 'cache_entry' at head of large data block hash chain */
+      hindex = hash_lg(cache_entry->fhandle, cache_entry->db_nmbr);
+
+      cache_entry->dbprev = NULL;
+      cache_entry->dbnext = lg_table[hindex];
+
+      if (lg_table[hindex] != NULL)
+	lg_table[hindex]->dbprev = cache_entry;
+
+      lg_table[hindex] = cache_entry;
+
+      /* charge large data block to partition of file */
+      cache_entry->part = ((part_cnt > 0) ?
+			   part_lookup(cache_entry->fhandle) : 0);
+
+      part_lgnblk[cache_entry->part]++;
+
+      cache_entry->valid = TRUE;
+    }
+}
+
+
+
+
+/*
+ * large_invalidate()
+ *
+ * Parameters:
+ *
+ *   cache_entry - large data block cache entry
+ *
+ * Remove large data block 'cache_entry' from its hash chain, uncharge it
+ * from its partition, and mark as invalid.  Does not move 'cache_entry' in
+ * the large data block list, and does nothing if 'cache_entry' is already
+ * invalid.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void large_invalidate(cache_entryt *cache_entry)
+#else
+static void large_invalidate(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  if (cache_entry->valid)
+    { /* remove 'cache_entry' from large data block hash chain */
+      if (cache_entry->dbnext != NULL)
+	cache_entry->dbnext->dbprev = cache_entry->dbprev;
+
+      if (cache_entry->dbprev != NULL)
+	cache_entry->dbprev->dbnext = cache_entry->dbnext;
+      else
+	lg_table[hash_lg(cache_entry->fhandle, cache_entry->db_nmbr)] =
+	  cache_entry->dbnext;
+
+      /* uncharge large data block from partition */
+      part_lgnblk[cache_entry->part]--;
+
+      cache_entry->valid = FALSE;
+    }
+}
+
+
+
+
+/*
+ * large_discard()
+ *
+ * Parameters:
+ *
+ *   cache_entry - large data block cache entry
+ *
+ * Invalidate large data block 'cache_entry' and make it the first to be
+ * re-allocated.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void large_discard(cache_entryt *cache_entry)
+#else
+static void large_discard(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  large_invalidate(cache_entry);
+  large_place(cache_entry, FALSE);
+}
+
+
+
+
+/*
+ * large_fdiscard()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *
+ * Discard all large data blocks of file 'fhandle'.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void large_fdiscard(pds_fhandlet fhandle)
+#else
+static void large_fdiscard(fhandle)
+     pds_fhandlet fhandle;
+#endif
+{
+  register long i;
+
+  for (i = 0; i < lg_cnt; i++)
+    if (lg_cache[i].valid && fhandle_eq(lg_cache[i].fhandle, fhandle))
+      large_discard(lg_cache + i);
+}
+
+
+
+
+/*
+ * large_place()
+ *
+ * Parameters:
+ *
+ *   cache_entry - large data block cache entry
+ *   mru         - place at MRU (TRUE) or LRU (FALSE) position
+ *
+ * Move large data block 'cache_entry' to the MRU or LRU position of the
+ * large data block list, as specified by 'mru'.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void large_place(cache_entryt *cache_entry,
+			int mru)
+#else
+static void large_place(cache_entry, mru)
+     cache_entryt *cache_entry;
+     int mru;
+#endif
+{
+  if ((mru && cache_entry != lg_mru) || (!mru && cache_entry != lg_lru))
+    { /* remove 'cache_entry' from large data block list */
+      if (cache_entry->cprev != NULL)
+	cache_entry->cprev->cnext = cache_entry->cnext;
+      else
+	lg_mru = cache_entry->cnext;
+
+      if (cache_entry->cnext != NULL)
+	cache_entry->cnext->cprev = cache_entry->cprev;
+      else
+	lg_lru = cache_entry->cprev;
+
+      /* insert at MRU or LRU position */
+      if (mru)
+	{
+	  cache_entry->cprev = NULL;
+	  cache_entry->cnext = lg_mru;
+	  lg_mru->cprev      = cache_entry;
+	  lg_mru             = cache_entry;
+	}
+      else
+	{
+	  cache_entry->cnext = NULL;
+	  cache_entry->cprev = lg_lru;
+	  lg_lru->cnext      = cache_entry;
+	  lg_lru             = cache_entry;
+	}
+    }
+}
+
+
+
+
+/*
+ * large_reset()
+ *
+ * Parameters:
+ *
+ * Invalidate all large data blocks, initializing the large data block list,
+ * hash table, and partition large data block counts.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void large_reset(void)
+#else
+static void large_reset()
+#endif
+{
+  register long i;
+
+  for (i = 0; i < lg_cnt; i++)
+    {
+      lg_cache[i].valid  = lg_cache[i].pinned = FALSE;
+      lg_cache[i].cprev  = ((i == 0) ? NULL : lg_cache + (i - 1));
+      lg_cache[i].cnext  = ((i == lg_cnt - 1) ? NULL : lg_cache + (i + 1));
+    }
+
+  lg_mru = lg_cache;
+  lg_lru = lg_cache + (lg_cnt - 1);
+
+  for (i = 0; i < lg_table_sz; i++)
+    lg_table[i] = NULL;
+
+  for (i = 0; i <= CM_PART_MAX; i++)
+    part_lgnblk[i] = 0;
+}
+
+
+
+
+/*
+ * file_discard()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *
+ * Invalidate all cache entries, and small data blocks, of file 'fhandle'.
+ * Dirty cache entries are NOT flushed.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void file_discard(pds_fhandlet fhandle)
+#else
+static void file_discard(fhandle)
+     pds_fhandlet fhandle;
+#endif
+{
+  register cache_entryt *cache_entry, *next_entry;
+
+  cache_entry = fh_table[fhandle_hash(fhandle, fh_table_sz)];
+
+  while (cache_entry != NULL)
+    { /* search 'fhandle' hash chain */
+      next_entry = cache_entry->fhnext;
+
+      if (fhandle_eq(cache_entry->fhandle, fhandle))
+	{ /* block belongs to 'fhandle'; invalidate */
+	  if (cache_entry->segment == SMALL)
+	    small_discard(cache_entry);
+	  else
+	    entry_invalidate(cache_entry);
+	}
+
+      cache_entry = next_entry;
+    }
+}
+
+
+
+
+/*
+ * entry_validate()
+ *
+ * Parameters:
+ *
+ *   cache_entry - invalid cache entry
+ *
+ * Place INVALID cache entry 'cache_entry' on appripriate data block and
+ * file handle hash chains and mark as valid.  Does not move 'cache_entry'
+ * in cache list.
+ *
+ * NOTE: Assumes:
+ *         1) cache_entry->db_nmbr and
+ *         2) cache_entry->fhandle
+ *       have been assigned the appropriate (valid) data block number and
+ *       file handle values, respectively.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void entry_validate(cache_entryt *cache_entry)
+#else
+static void entry_validate(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  if (!cache_entry->valid)
+    { /* place 'cache_entry' at head of data block hash chain */
+
+      cache_entry->dbprev = NULL;
+      cache_entry->dbnext = dblk_table[hash_dblk(cache_entry->fhandle,
+						 cache_entry->db_nmbr)];
+      dblk_table[hash_dblk(cache_entry->fhandle,
+			   cache_entry->db_nmbr)] = cache_entry;
+
+      /* set 'prev' pointer of former head of hash chain, if extant */
+      if (cache_entry->dbnext != NULL)
+	cache_entry->dbnext->dbprev = cache_entry;
+
+      /* place 'cache_entry' at head of fhandle hash chain */
+
+      cache_entry->fhprev = NULL;
+      cache_entry->fhnext = fh_table[fhandle_hash(cache_entry->fhandle,
+						  fh_table_sz)];
+      fh_table[fhandle_hash(cache_entry->fhandle, fh_table_sz)] = cache_entry;
+
+      /* set 'prev' pointer of former head of hash chain, if extant */
+      if (cache_entry->fhnext != NULL)
+	cache_entry->fhnext->fhprev = cache_entry;
+
+
+      /* charge entry to partition of file; small data blocks are not
+       * partitioned
+       */
+      if (cache_entry->segment != SMALL)
+	{
+	  cache_entry->part = ((part_cnt > 0) ?
+			       part_lookup(cache_entry->fhandle) : 0);
+
+	  part_nblk[cache_entry->part]++;
+	}
+
+
+      /* mark entry as valid */
+      cache_entry->valid = TRUE;
+    }
+}
+
+
+
+
+/*
+ * entry_invalidate()
+ *
+ * Parameters:
+ *
+ *   cache_entry - valid cache entry
+ *
+ * Remove VALID cache entry 'cache_entry' from associated data block and
+ * file handle hash chains and mark as invalid.  Does not move 'cache_entry'
+ * in cache list.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void entry_invalidate(cache_entryt *cache_entry)
+#else
+static void entry_invalidate(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  if (cache_entry->valid)
+    { /* remove 'cache_entry' from volatile write-back dirty list */
+      wb_remove(cache_entry);
+
+      /* remove 'cache_entry' from data block hash chain */
+
+      /* if not last in chain, reset 'prev' pointer of 'next' entry */
+      if (cache_entry->dbnext != NULL)
+	cache_entry->dbnext->dbprev = cache_entry->dbprev;
+
+      /* if not first in chain, reset 'next' pointer of 'prev' entry */
+      if (cache_entry->dbprev != NULL)
+	cache_entry->dbprev->dbnext = cache_entry->dbnext;
+      else
+	/* first in chain, reset data block hash table entry */
+	dblk_table[hash_dblk(cache_entry->fhandle,
+			     cache_entry->db_nmbr)] = cache_entry->dbnext;
+
+      /* remove 'cache_entry' from fhandle hash chain */
+
+      /* if not last in chain, reset 'prev' pointer of 'next' entry */
+      if (cache_entry->fhnext != NULL)
+	cache_entry->fhnext->fhprev = cache_entry->fhprev;
+
+      /* if not first in chain, reset 'next' pointer of 'prev' entry */
+      if (cache_entry->fhprev != NULL)
+	cache_entry->fhprev->fhnext = cache_entry->fhnext;
+      else
+	/* first in chain, reset fhandle hash table entry */
+	fh_table[fhandle_hash(cache_entry->fhandle, fh_table_sz)] =
+	  cache_entry->fhnext;
+
+
+      /* discharge entry from partition */
+      if (cache_entry->segment != SMALL)
+	part_nblk[cache_entry->part]--;
+
+
+      /* mark 'cache_entry' as invalid */
+      cache_entry->valid = FALSE;
+    }
+}
+
+
+
+
+/*
+ * make_mru_pt()
+ *
+ * Parameters:
+ *
+ *   cache_entry - cache entry
+ *
+ * Insert the data block cache entry 'cache_entry' at the MRU position of
+ * the PROTECTED segment.  Prior to calling make_mru_pt(), 'cache_entry' may
+ * reside in either the protected or the probationary segment of the cache.
+ *
+ * Note: global variables 'cache_mru_pt', 'cache_mru_pb', and 'cache_lru_pb'
+ *       may be altered as a side-effect
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void make_mru_pt(cache_entryt *cache_entry)
+#else
+static void make_mru_pt(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  /* put 'cache_entry' at MRU position of the protected segment */
+  if (cache_entry != cache_mru_pt)
+    {
+      if (cache_entry == cache_lru_pb)
+	{ /* special case; advance MRU and LRU pointers around circular list */
+	  cache_mru_pt = cache_lru_pb;
+	  cache_lru_pb = cache_lru_pb->cprev;
+	  cache_mru_pb = cache_mru_pb->cprev;
+
+	  /* set segment types appropriately */
+	  cache_mru_pt->segment = PROTECTED;
+	  cache_mru_pb->segment = PROBATIONARY;
+	}
+      else
+	{ /* remove from list and place in MRU position of protected segment */
+
+	  /* if removing entry from probationary seg, make LRU entry of
+           * protected seg the new MRU entry of the probationary seg; unless
+	   * protected seg is below target size, in which case it grows.
+	   */
+	  if (cache_entry->segment == PROBATIONARY)
+	    {
+	      if (prot_sz < prot_target)
+		{
+		  if (cache_entry == cache_mru_pb)
+		    cache_mru_pb = cache_entry->cnext;
+
+		  prot_sz++;
+		}
+	      else
+		{
+		  cache_mru_pb          = cache_mru_pb->cprev;
+		  cache_mru_pb->segment = PROBATIONARY;
+		}
+	    }
+
+	  /* remove *cache_entry from cache block list */
+	  cache_entry->cprev->cnext = cache_entry->cnext;
+	  cache_entry->cnext->cprev = cache_entry->cprev;
+
+	  /* set *cache_entry pointers/seg-type appropriately for MRU entry */
+	  cache_entry->cprev   = cache_lru_pb;
+	  cache_entry->cnext   = cache_mru_pt;
+	  cache_entry->segment = PROTECTED;
+
+	  /* set *cache_mru_pt and *cache_lru_pb pointers to new MRU entry */
+	  cache_mru_pt->cprev = cache_entry;
+	  cache_lru_pb->cnext = cache_entry;
+
+	  /* set MRU pointer to cache_entry */
+	  cache_mru_pt = cache_entry;
+	}
+    }
+
+  cache_entry->promoted = TRUE;
+}
+
+
+
+
+/*
+ * make_mru_pb()
+ *
+ * Parameters:
+ *
+ *   cache_entry - cache entry
+ *
+ * Insert the data block cache entry 'cache_entry' at the MRU position of
+ * the PROBATIONARY segment.  Prior to calling make_mru_pb(), 'cache_entry'
+ * MUST reside in the probationary segment of the cache.
+ *
+ * Note: global variables 'cache_mru_pb' and 'cache_lru_pb' may be altered
+ *       as a side-effect
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void make_mru_pb(cache_entryt *cache_entry)
+#else
+static void make_mru_pb(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  /* put 'cache_entry' at MRU position of the probationary segment */
+  if (cache_entry != cache_mru_pb && cache_entry->segment == PROBATIONARY)
+    {
+      /* remove from list and place in MRU position of probationary segment */
+
+      /* remove *cache_entry from cache block list */
+      cache_entry->cprev->cnext = cache_entry->cnext;
+      cache_entry->cnext->cprev = cache_entry->cprev;
+
+      if (cache_entry == cache_lru_pb)
+	cache_lru_pb = cache_entry->cprev;
+
+      /* set *cache_entry pointers appropriately for MRU entry */
+      cache_entry->cprev = cache_mru_pb->cprev;
+      cache_entry->cnext = cache_mru_pb;
+
+      /* set *cache_mru_pb and *(cache_mru_pb->cprev) ptrs to new MRU entry */
+      cache_mru_pb->cprev->cnext = cache_entry;
+      cache_mru_pb->cprev        = cache_entry;
+
+      /* set MRU pointer to cache_entry */
+      cache_mru_pb = cache_entry;
+    }
+}
+
+
+
+/*
+ * make_lru_pb()
+ *
+ * Parameters:
+ *
+ *   cache_entry - cache entry
+ *
+ * Insert the data block cache entry 'cache_entry' at the LRU position of
+ * the PROBATIONARY segment.  Prior to calling make_lru_pb(), 'cache_entry'
+ * MUST reside in the probationary segment of the cache.
+ *
+ * Note: global variables 'cache_mru_pb' and 'cache_lru_pb' may be altered
+ *       as a side-effect
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void make_lru_pb(cache_entryt *cache_entry)
+#else
+static void make_lru_pb(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  /* put 'cache_entry' at LRU position of the probationary segment */
+  if (cache_entry != cache_lru_pb && cache_entry->segment == PROBATIONARY)
+    {
+      /* remove from list and place in LRU position of probationary segment */
+
+      if (cache_entry == cache_mru_pb)
+	cache_mru_pb = cache_entry->cnext;
+
+      /* remove *cache_entry from cache block list */
+      cache_entry->cprev->cnext = cache_entry->cnext;
+      cache_entry->cnext->cprev = cache_entry->cprev;
+
+      /* set *cache_entry pointers appropriately for LRU entry */
+      cache_entry->cprev = cache_lru_pb;
+      cache_entry->cnext = cache_lru_pb->cnext;
+
+      /* set *cache_lru_pb and *(cache_lru_pb->cnext) ptrs to new LRU entry */
+      cache_lru_pb->cnext->cprev = cache_entry;
+      cache_lru_pb->cnext        = cache_entry;
+
+      /* set LRU pointer to cache_entry */
+      cache_lru_pb = cache_entry;
+    }
+}
+
+
+
+/*
+ * ghost_insert()
+ *
+ * Parameters:
+ *
+ *   cache_entry - valid cache entry being discarded
+ *
+ * Retain the identity of the data block in 'cache_entry' at the MRU
+ * position of the appropriate ghost list.  If no ghost entry is free then
+ * the LRU entry of the longer ghost list is re-used.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void ghost_insert(cache_entryt *cache_entry)
+#else
+static void ghost_insert(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  register ghost_entryt *ghost_entry;
+  long hindex;
+  int list;
+
+  /* obtain a ghost entry */
+
+  if (ghost_free != NULL)
+    {
+      ghost_entry = ghost_free;
+      ghost_free  = ghost_free->gnext;
+    }
+  else
+    {
+      if (ghost_len[GHOST_PB] >= ghost_len[GHOST_PT])
+	ghost_entry = ghost_lru[GHOST_PB];
+      else
+	ghost_entry = ghost_lru[GHOST_PT];
+
+      ghost_unlink(ghost_entry);
+    }
+
+  /* set ghost entry fields */
+
+  list = (cache_entry->promoted ? GHOST_PT : GHOST_PB);
+
+  ghost_entry->list    = list;
+  ghost_entry->fhandle = cache_entry->fhandle;
+  ghost_entry->db_nmbr = cache_entry->db_nmbr;
+
+  /* insert at MRU position of ghost list */
+
+  ghost_entry->gprev = NULL;
+  ghost_entry->gnext = ghost_mru[list];
+
+  if (ghost_mru[list] != NULL)
+    ghost_mru[list]->gprev = ghost_entry;
+  else
+    ghost_lru[list] = ghost_entry;
+
+  ghost_mru[list] = ghost_entry;
+  ghost_len[list]++;
+
+  /* insert at head of hash chain */
+
+  hindex = hash_dblk(ghost_entry->fhandle, ghost_entry->db_nmbr);
+
+  ghost_entry->hprev = NULL;
+  ghost_entry->hnext = ghost_table[hindex];
+
+  if (ghost_table[hindex] != NULL)
+    ghost_table[hindex]->hprev = ghost_entry;
+
+  ghost_table[hindex] = ghost_entry;
+}
+
+
+
+
+/*
+ * ghost_hit()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   db_nmbr - data block number
+ *
+ * Determine if data block 'db_nmbr' of file 'fhandle', which is not cached,
+ * resides in a ghost list.  If so, adjust the protected segment target size
+ * and free the ghost entry.
+ *
+ * A hit in the probationary ghost list reduces the target size by the ratio
+ * of the protected to the probationary ghost list lengths, and a hit in the
+ * protected ghost list increases the target size by the inverse ratio; in
+ * either case by at least one.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void ghost_hit(pds_fhandlet fhandle,
+		      pious_offt db_nmbr)
+#else
+static void ghost_hit(fhandle, db_nmbr)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
+#endif
+{
+  register ghost_entryt *ghost_entry;
+
+  /* search ghost hash chain for (fhandle, db_nmbr) pair */
+
+  ghost_entry = ghost_table[hash_dblk(fhandle, db_nmbr)];
+
+  while (ghost_entry != NULL && (ghost_entry->db_nmbr != db_nmbr ||
+				 !fhandle_eq(ghost_entry->fhandle, fhandle)))
+    ghost_entry = ghost_entry->hnext;
+
+  if (ghost_entry != NULL)
+    { /* located in ghost list; adapt protected segment target size */
+
+      if (ghost_entry->list == GHOST_PB)
+	prot_target -= Max(ghost_len[GHOST_PT] / ghost_len[GHOST_PB], 1);
+      else
+	prot_target += Max(ghost_len[GHOST_PB] / ghost_len[GHOST_PT], 1);
+
+      prot_target = Min(Max(prot_target, 1), prot_max);
+
+      /* free ghost entry */
+      ghost_unlink(ghost_entry);
+
+      ghost_entry->list  = GHOST_FREE;
+      ghost_entry->gnext = ghost_free;
+      ghost_free         = ghost_entry;
+    }
+}
+
+
+
+
+/*
+ * ghost_unlink()
+ *
+ * Parameters:
+ *
+ *   ghost_entry - ghost entry in a ghost list
+ *
+ * Remove 'ghost_entry' from its ghost list and hash chain.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void ghost_unlink(ghost_entryt *ghost_entry)
+#else
+static void ghost_unlink(ghost_entry)
+     ghost_entryt *ghost_entry;
+#endif
+{
+  int list;
+
+  list = ghost_entry->list;
+
+  /* remove from ghost list */
+
+  if (ghost_entry->gprev != NULL)
+    ghost_entry->gprev->gnext = ghost_entry->gnext;
+  else
+    ghost_mru[list] = ghost_entry->gnext;
+
+  if (ghost_entry->gnext != NULL)
+    ghost_entry->gnext->gprev = ghost_entry->gprev;
+  else
+    ghost_lru[list] = ghost_entry->gprev;
+
+  ghost_len[list]--;
+
+  /* remove from hash chain */
+
+  if (ghost_entry->hprev != NULL)
+    ghost_entry->hprev->hnext = ghost_entry->hnext;
+  else
+    ghost_table[hash_dblk(ghost_entry->fhandle,
+			  ghost_entry->db_nmbr)] = ghost_entry->hnext;
+
+  if (ghost_entry->hnext != NULL)
+    ghost_entry->hnext->hprev = ghost_entry->hprev;
+}
+
+
+
+
+/*
+ * ghost_reset()
+ *
+ * Parameters:
+ *
+ * Discard the contents of both ghost lists.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void ghost_reset(void)
+#else
+static void ghost_reset()
+#endif
+{
+  long i;
+
+  for (i = 0; i < cache_sz; i++)
+    {
+      ghost[i].list  = GHOST_FREE;
+      ghost[i].gnext = ((i == cache_sz - 1) ? NULL : ghost + (i + 1));
+    }
+
+  ghost_free = ghost;
+
+  for (i = 0; i < dblk_table_sz; i++)
+    ghost_table[i] = NULL;
+
+  ghost_mru[GHOST_PB] = ghost_lru[GHOST_PB] = NULL;
+  ghost_mru[GHOST_PT] = ghost_lru[GHOST_PT] = NULL;
+
+  ghost_len[GHOST_PB] = ghost_len[GHOST_PT] = 0;
+}
+
+
+
+/*
+ * file_lookup()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   alloc   - allocate entry if none exists flag
+ *
+ * Locate the file entry retaining the state of file 'fhandle'.  If none
+ * exists and 'alloc' is TRUE, then an entry is allocated, growing the
+ * entry pool if no entry is free; the least recently used entry is
+ * re-allocated only if the pool is at its size limit.  A newly allocated
+ * entry reflects no access history, no recorded file size or retained
+ * advice, the default partition, and the standard class.  The entry
+ * located, or allocated, is made the most recently used.
+ *
+ * The file of an entry re-allocated loses its state; in particular, a file
+ * of the large class leaves that class, and has its large data blocks and
+ * cache entries discarded.  see discussion at top.
+ *
+ * NOTE: global file_lru and file_mru may be altered by file_grow().
+ *
+ * Returns:
+ *
+ *   file_entryt * - file entry for 'fhandle'
+ *   NULL          - no file entry for 'fhandle' and 'alloc' is FALSE
+ */
+
+#ifdef __STDC__
+static file_entryt *file_lookup(pds_fhandlet fhandle,
+				int alloc)
+#else
+static file_entryt *file_lookup(fhandle, alloc)
+     pds_fhandlet fhandle;
+     int alloc;
+#endif
+{
+  register file_entryt *file_entry;
+  long hindex;
+
+  /* search file hash chain for 'fhandle' */
+
+  file_entry = file_table[fhandle_hash(fhandle, file_table_sz)];
+
+  while (file_entry != NULL && !fhandle_eq(file_entry->fhandle, fhandle))
+    file_entry = file_entry->hnext;
+
+  if (file_entry == NULL && alloc)
+    { /* not located; grow pool if full and not at limit */
+      if (file_lru->valid && file_sz < FILE_POOL_MAX)
+	file_grow();
+
+      /* allocate LRU entry; re-allocated only if pool can not grow */
+      file_entry = file_lru;
+
+      if (file_entry->valid)
+	{ /* remove entry from hash chain */
+	  if (file_entry->hprev == NULL)
+	    file_table[fhandle_hash(file_entry->fhandle, file_table_sz)] =
+	      file_entry->hnext;
+	  else
+	    file_entry->hprev->hnext = file_entry->hnext;
+
+	  if (file_entry->hnext != NULL)
+	    file_entry->hnext->hprev = file_entry->hprev;
+
+	  /* file of entry loses retained advice and leaves large class */
+	  if (file_entry->advice != PIOUS_ADV_NORMAL)
+	    adv_cnt--;
+
+	  if (file_entry->large)
+	    {
+	      large_fdiscard(file_entry->fhandle);
+	      file_discard(file_entry->fhandle);
+	    }
+	}
+
+      file_entry->valid       = TRUE;
+      file_entry->fhandle     = fhandle;
+      file_entry->next_offset = 0;
+      file_entry->ra_nmbr     = 0;
+      file_entry->window      = 0;
+      file_entry->fsize_known = FALSE;
+      file_entry->fsize       = 0;
+      file_entry->advice      = PIOUS_ADV_NORMAL;
+      file_entry->part        = 0;
+      file_entry->large       = FALSE;
+
+      /* insert entry at head of hash chain */
+      hindex = fhandle_hash(fhandle, file_table_sz);
+
+      file_entry->hprev = NULL;
+      file_entry->hnext = file_table[hindex];
+
+      if (file_table[hindex] != NULL)
+	file_table[hindex]->hprev = file_entry;
+
+      file_table[hindex] = file_entry;
+    }
+
+  if (file_entry != NULL && file_entry != file_mru)
+    { /* move entry to MRU position */
+      file_entry->eprev->enext = file_entry->enext;
+
+      if (file_entry == file_lru)
+	file_lru = file_entry->eprev;
+      else
+	file_entry->enext->eprev = file_entry->eprev;
+
+      file_entry->eprev = NULL;
+      file_entry->enext = file_mru;
+      file_mru->eprev   = file_entry;
+      file_mru          = file_entry;
+    }
+
+  return file_entry;
+}
 
-      else
-	{ /* invalidate all 'fhandle' entries */
-	  cache_entry = fh_table[fhandle_hash(fhandle, FH_TABLE_SZ)];
 
-	  while (cache_entry != NULL)
-	    { /* search 'fhandle' hash chain */
-	      next_entry = cache_entry->fhnext;
 
-	      if (fhandle_eq(cache_entry->fhandle, fhandle))
-		/* block belongs to 'fhandle'; invalidate */
-		entry_invalidate(cache_entry);
 
-	      cache_entry = next_entry;
-	    }
-	}
+/*
+ * file_reset()
+ *
+ * Parameters:
+ *
+ * Discard the state of all files, including partition and class
+ * assignments, in the initial file entry pool; presumes file_table is
+ * allocated and that the pool has not grown.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void file_reset(void)
+#else
+static void file_reset()
+#endif
+{
+  long i;
+
+  for (i = 0; i < FILE_POOL_SZ; i++)
+    {
+      file_pool[i].valid = FALSE;
+      file_pool[i].eprev = ((i == 0) ? NULL : file_pool + (i - 1));
+      file_pool[i].enext = ((i == FILE_POOL_SZ - 1) ?
+			    NULL : file_pool + (i + 1));
     }
-}
 
+  file_mru = file_pool;
+  file_lru = file_pool + (FILE_POOL_SZ - 1);
 
+  file_sz = FILE_POOL_SZ;
 
+  for (i = 0; i < file_table_sz; i++)
+    file_table[i] = NULL;
 
-/* Function Defintions - Local Functions */
+  adv_cnt = 0;
+}
 
 
 
 
 /*
- * hash_dblk()
+ * file_grow()
  *
  * Parameters:
  *
- *   db_nmbr - data block number
+ * Grow the file entry pool, doubling its size to at most FILE_POOL_MAX
+ * entries.  New entries are invalid and placed in the LRU positions; the
+ * file entry hash table is resized for the new pool size.  The pool is not
+ * altered if storage can not be allocated for new entries, and the hash
+ * table is retained if storage can not be allocated for a resized table.
  *
- * Calculates data block hash value in range 0..(DBLK_TABLE_SZ - 1).
+ * NOTE: global file_lru and file_mru are altered; these values
+ *       must be treated as volatile by any routine that calls
+ *       file_grow().
  *
  * Returns:
- *
- *   0..(DBLK_TABLE_SZ - 1) - if db_nmbr > 0
- *   0                      - if db_nmbr <= 0
  */
 
+#ifdef __STDC__
+static void file_grow(void)
+#else
+static void file_grow()
+#endif
+{
+  long nentry, tsize, idx, hindex;
+  file_entryt *file_new, *file_entry, **table_new;
+
+  nentry = Min(file_sz, FILE_POOL_MAX - file_sz);
+
+  file_new = (file_entryt *)malloc((unsigned long)nentry *
+				   sizeof(file_entryt));
+
+  if (file_new != NULL)
+    { /* link new entries following LRU entry; last is now LRU */
+      for (idx = 0; idx < nentry; idx++)
+	{
+	  file_new[idx].valid = FALSE;
+	  file_new[idx].eprev = ((idx == 0) ?
+				 file_lru : file_new + (idx - 1));
+	  file_new[idx].enext = ((idx == nentry - 1) ?
+				 NULL : file_new + (idx + 1));
+	}
+
+      file_lru->enext = file_new;
+      file_lru        = file_new + (nentry - 1);
+
+      file_sz += nentry;
+
+      /* resize file entry hash table, rehashing valid entries */
+      tsize = table_size(file_sz);
+
+      if (tsize > file_table_sz &&
+	  (table_new = (file_entryt **)
+	   malloc((unsigned long)tsize * sizeof(file_entryt *))) != NULL)
+	{
+	  for (idx = 0; idx < tsize; idx++)
+	    table_new[idx] = NULL;
+
+	  for (file_entry = file_mru; file_entry != NULL;
+	       file_entry = file_entry->enext)
+	    if (file_entry->valid)
+	      { /* place entry at head of hash chain */
+		hindex = fhandle_hash(file_entry->fhandle, tsize);
+
+		file_entry->hprev = NULL;
+		file_entry->hnext = table_new[hindex];
+
+		if (table_new[hindex] != NULL)
+		  table_new[hindex]->hprev = file_entry;
+
+		table_new[hindex] = file_entry;
+	      }
+
+	  free((char *)file_table);
+
+	  file_table    = table_new;
+	  file_table_sz = tsize;
+	}
+    }
+}
+
+
+
+
 /*
-static int hash_dblk(pious_offt db_nmbr)
-*/
+ * file_clear()
+ *
+ * Parameters:
+ *
+ * Discard the sequential access state, recorded file size, and retained
+ * access advice of all files; partition and class assignments are
+ * retained.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void file_clear(void)
+#else
+static void file_clear()
+#endif
+{
+  register file_entryt *file_entry;
 
-#define hash_dblk(db_nmbr) \
-((int)(((db_nmbr) <= 0) ? 0 : ((db_nmbr) % DBLK_TABLE_SZ)))
+  for (file_entry = file_mru; file_entry != NULL;
+       file_entry = file_entry->enext)
+    {
+      file_entry->next_offset = 0;
+      file_entry->ra_nmbr     = 0;
+      file_entry->window      = 0;
+      file_entry->fsize_known = FALSE;
+      file_entry->advice      = PIOUS_ADV_NORMAL;
+    }
+
+  adv_cnt = 0;
+}
 
 
 
 
 /*
- * read_dblk()
+ * eof_lookup()
  *
  * Parameters:
  *
  *   fhandle - file handle
- *   db_nmbr - data block number
- *   offset  - data block offset (offset from start of data block)
- *   nbyte   - byte count
- *   buf     - buffer
+ *   alloc   - record file size if not recorded flag
  *
- * Read data block 'db_nmbr' of file 'fhandle' starting at 'offset' bytes
- * from the beginning of the block and proceeding for 'nbyte' bytes; place
- * result in buffer 'buf'.
+ * Locate the file entry for file 'fhandle' if it records the size of the
+ * file.  If the file size is not recorded and 'alloc' is TRUE, then the
+ * file entry is located, or allocated, and marked as recording the file
+ * size; the caller must set the file size.  The entry located is made the
+ * most recently used.
  *
  * Returns:
  *
- *   >= 0 - number of bytes read and placed in buffer (<= nbyte)
- *   <  0 - error code defined in pious_errno.h; possible codes are:
- *
- *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
- *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
- *       PIOUS_EINVAL - file offset or nbyte is not a proper value
- *                      or exceeds SYSTEM constraints
- *       PIOUS_EINSUF - insufficient system resources; retry operation
- *       PIOUS_EUNXP  - unexpected error condition encountered
- *       PIOUS_ERECOV - recovery required
- *       PIOUS_EFATAL - fatal error; check PDS error log
+ *   file_entryt * - file entry for 'fhandle' recording its file size
+ *   NULL          - file size not recorded and 'alloc' is FALSE
  */
 
 #ifdef __STDC__
-static pious_ssizet read_dblk(pds_fhandlet fhandle,
-			      pious_offt db_nmbr,
-			      pious_offt offset,
-			      pious_sizet nbyte,
-			      char *buf)
+static file_entryt *eof_lookup(pds_fhandlet fhandle,
+			       int alloc)
 #else
-static pious_ssizet read_dblk(fhandle, db_nmbr, offset, nbyte, buf)
+static file_entryt *eof_lookup(fhandle, alloc)
      pds_fhandlet fhandle;
-     pious_offt db_nmbr;
-     pious_offt offset;
-     pious_sizet nbyte;
-     char *buf;
+     int alloc;
 #endif
 {
-  int copyout, badflush, cachehit;
-  pious_ssizet rcode, acode;
-  cache_entryt *cache_entry;
+  register file_entryt *file_entry;
 
-  /* a null read always succeeds without perturbing cache */
-  if (nbyte == 0)
+  file_entry = file_lookup(fhandle, alloc);
+
+  if (file_entry != NULL && !file_entry->fsize_known)
     {
-      rcode = 0;
+      if (alloc)
+	{
+	  file_entry->fsize_known = TRUE;
+	  file_entry->fsize       = 0;
+	}
+      else
+	file_entry = NULL;
     }
 
-  else
-    { /* allocate a cache entry for (fhandle, db_nmbr) */
+  return file_entry;
+}
 
-      acode = cache_alloc(fhandle, db_nmbr, &cache_entry);
 
-      if (acode != PIOUS_OK)
-	{ /* alloc failed; acode == PIOUS_EFATAL || acode == PIOUS_ERECOV */
-	  rcode = acode;
-	}
 
-      else
-	{ /* cache entry allocated; read data block and/or copy out data */
 
-	  if (cache_entry->valid)
-	    cachehit = TRUE;
-	  else
-	    cachehit = FALSE;
+/*
+ * eof_discard()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *
+ * Discard the recorded size of file 'fhandle', if any.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void eof_discard(pds_fhandlet fhandle)
+#else
+static void eof_discard(fhandle)
+     pds_fhandlet fhandle;
+#endif
+{
+  register file_entryt *file_entry;
 
-	  copyout = TRUE;
+  if ((file_entry = file_lookup(fhandle, FALSE)) != NULL)
+    file_entry->fsize_known = FALSE;
+}
 
-	  if (!cache_entry->valid || cache_entry->db_nbyte < DBLK_SZ)
-	    { /* cache entry invalid or contains a potentially stale EOF
-	       * resulting from an implied write; see discussion at top.
-	       * (re)read data from file in either case; if valid and dirty,
-               * must flush first.
-	       */
 
-	      badflush = FALSE;
 
-	      if (cache_entry->valid && cache_entry->dirty)
-		{ /* cache entry is valid and dirty; attempt to flush */
-		  acode = SS_write(fhandle,
-				   (pious_offt)(db_nmbr * DBLK_SZ),
-				   cache_entry->db_nbyte,
-				   cache_entry->dblk,
-				   cache_entry->faultmode);
 
-		  if (acode != cache_entry->db_nbyte)
-		    { /* block flush unsuccessful */
-		      badflush = TRUE;
-		      copyout  = FALSE;
-		      rcode    = PIOUS_EUNXP;
-		    }
-		}
+/*
+ * adv_lookup()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *
+ * Obtain the access advice retained for file 'fhandle'.
+ *
+ * Returns:
+ *
+ *   PIOUS_ADV_{SEQUENTIAL, RANDOM, NOREUSE} - advice retained for 'fhandle'
+ *   PIOUS_ADV_NORMAL                        - no advice retained
+ */
 
-	      if (!badflush)
-		{ /* read data block from stable storage; at this point the
-                   * alloced cache entry is either invalid, or valid and clean
-                   */
+#ifdef __STDC__
+static int adv_lookup(pds_fhandlet fhandle)
+#else
+static int adv_lookup(fhandle)
+     pds_fhandlet fhandle;
+#endif
+{
+  register file_entryt *file_entry;
 
-		  acode = SS_read(fhandle,
-				  (pious_offt)(db_nmbr * DBLK_SZ),
-				  DBLK_SZ,
-				  cache_entry->dblk);
+  file_entry = file_lookup(fhandle, FALSE);
 
-		  if (acode > 0)
-		    { /* data block read successful; set cache entry fields */
-		      cache_entry->db_nbyte  = acode;
-		      cache_entry->dirty     = FALSE;
-		      cache_entry->faultmode = PIOUS_VOLATILE;
+  return ((file_entry != NULL) ? file_entry->advice : PIOUS_ADV_NORMAL);
+}
 
-		      if (!cache_entry->valid)
-			/* mark valid, put on data block/fhandle hash chains */
-			entry_validate(cache_entry);
-		    }
 
-		  else
-		    { /* data block read unsuccessful; set return code */
-		      copyout = FALSE;
 
-		      switch(acode)
-			{
-			case 0: /* data block read at/past EOF */
-			case PIOUS_EBADF:
-			case PIOUS_EACCES:
-			case PIOUS_EINVAL:
-			case PIOUS_EINSUF:
-			case PIOUS_EFATAL:
-			  rcode = acode;
-			  break;
-			default:
-			  rcode = PIOUS_EUNXP;
-			  break;
-			}
 
-		      if (cache_entry->valid)
-			/* invalidate cache entry, if valid */
-			entry_invalidate(cache_entry);
-		    }
-		}
-	    }
+/*
+ * adv_set()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   advice  - PIOUS_ADV_{NORMAL, SEQUENTIAL, RANDOM, NOREUSE}
+ *
+ * Retain access advice 'advice' for file 'fhandle', allocating a file entry
+ * if 'fhandle' has none.  PIOUS_ADV_NORMAL advice discards the advice
+ * retained for 'fhandle', if any.
+ *
+ * Returns:
+ */
 
-	  if (copyout)
-	    { /* copy requested data to buffer as available */
+#ifdef __STDC__
+static void adv_set(pds_fhandlet fhandle,
+		    int advice)
+#else
+static void adv_set(fhandle, advice)
+     pds_fhandlet fhandle;
+     int advice;
+#endif
+{
+  register file_entryt *file_entry;
 
-	      if (offset >= cache_entry->db_nbyte)
-		{ /* request starts at/past EOF; no data transfered */
-		  rcode = 0;
-		}
+  file_entry = file_lookup(fhandle, (advice != PIOUS_ADV_NORMAL));
 
-	      else
-		{ /* request starts within valid data; transfer */
-		  rcode = Min(nbyte, cache_entry->db_nbyte - offset);
+  if (file_entry != NULL && file_entry->advice != advice)
+    { /* maintain count of files with retained advice */
+      if (file_entry->advice == PIOUS_ADV_NORMAL)
+	adv_cnt++;
+      else if (advice == PIOUS_ADV_NORMAL)
+	adv_cnt--;
 
-		  memcpy(buf, (cache_entry->dblk) + offset, (int)rcode);
-		}
+      file_entry->advice = advice;
+    }
+}
+
+
+
+
+/*
+ * part_lookup()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *
+ * Obtain the cache partition to which file 'fhandle' is assigned.
+ *
+ * Returns:
+ *
+ *   int - cache partition; zero (0) is the default partition
+ */
+
+#ifdef __STDC__
+static int part_lookup(pds_fhandlet fhandle)
+#else
+static int part_lookup(fhandle)
+     pds_fhandlet fhandle;
+#endif
+{
+  register file_entryt *file_entry;
+
+  file_entry = file_lookup(fhandle, FALSE);
+
+  return ((file_entry != NULL) ? file_entry->part : 0);
+}
+
+
+
+
+/*
+ * part_set()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   part    - cache partition; 0 through part_cnt
+ *
+ * Assign file 'fhandle' to cache partition 'part', allocating a file entry
+ * if 'fhandle' has none and 'part' is not the default partition (0).
+ *
+ * Returns:
+ */
 
-	      /* move cache entry to MRU position of appropriate segment */
-	      if (cachehit)
-		make_mru_pt(cache_entry);
-	      else
-		make_mru_pb(cache_entry);
-	    }
-	}
-    }
+#ifdef __STDC__
+static void part_set(pds_fhandlet fhandle,
+		     int part)
+#else
+static void part_set(fhandle, part)
+     pds_fhandlet fhandle;
+     int part;
+#endif
+{
+  register file_entryt *file_entry;
 
-  return rcode;
+  if ((file_entry = file_lookup(fhandle, (part != 0))) != NULL)
+    file_entry->part = part;
 }
 
 
 
 
 /*
- * write_dblk()
+ * part_victim()
  *
  * Parameters:
  *
- *   fhandle   - file handle
- *   db_nmbr   - data block number
- *   offset    - data block offset (offset from start of data block)
- *   nbyte     - byte count
- *   buf       - buffer
- *   faultmode - PIOUS_STABLE or PIOUS_VOLATILE
+ *   cache_entry - cache entry or large data block
+ *   part        - cache partition
  *
- * Write to data block 'db_nmbr' of file 'fhandle' starting at 'offset' bytes
- * from the beginning of the block and proceeding for 'nbyte' bytes the data
- * in buffer 'buf'.
+ * Determine if 'cache_entry' may be replaced by an entry allocated for
+ * cache partition 'part'.  An invalid entry may always be replaced.  If
+ * 'part' is at its maximum share then only an entry of 'part' may be
+ * replaced; otherwise an entry of 'part', or of a partition above its
+ * reserved share, may be replaced.  Shares are of the cache proper for a
+ * cache entry, and of the large data block slab for a large data block.
  *
  * Returns:
  *
- *   PIOUS_OK (0) - file data block successfully written
- *   <  0         - error code defined in pious_errno.h; possible codes are:
- *
- *       PIOUS_ERECOV - recovery required
- *       PIOUS_EFATAL - fatal error; check PDS error log
+ *   TRUE  - 'cache_entry' may be replaced
+ *   FALSE - 'cache_entry' may not be replaced
  */
 
 #ifdef __STDC__
-static int write_dblk(pds_fhandlet fhandle,
-		      pious_offt db_nmbr,
-		      pious_offt offset,
-		      pious_sizet nbyte,
-		      char *buf,
-		      int faultmode)
+static int part_victim(cache_entryt *cache_entry,
+		       int part)
 #else
-static int write_dblk(fhandle, db_nmbr, offset, nbyte, buf, faultmode)
-     pds_fhandlet fhandle;
-     pious_offt db_nmbr;
-     pious_offt offset;
-     pious_sizet nbyte;
-     char *buf;
-     int faultmode;
+static int part_victim(cache_entry, part)
+     cache_entryt *cache_entry;
+     int part;
 #endif
 {
   int rcode;
-  pious_ssizet acode;
-  register cache_entryt *cache_entry;
+  long *nblk, *pmin, *pmax;
 
-  /* a null write always succeeds without perturbing cache */
-  if (nbyte == 0)
+  if (cache_entry->segment == LARGE)
     {
-      rcode = PIOUS_OK;
+      nblk = part_lgnblk;
+      pmin = part_lgmin;
+      pmax = part_lgmax;
     }
-
   else
-    { /* search cache via data block hash chain for (fhandle, db_nmbr) pair */
-
-      cache_entry = dblk_table[hash_dblk(db_nmbr)];
-
-      while (cache_entry != NULL &&
-	     (cache_entry->db_nmbr != db_nmbr ||
-	      !fhandle_eq(cache_entry->fhandle, fhandle)))
-	cache_entry = cache_entry->dbnext;
-
-      /* if cache-miss or volatile write then write-through w/o allocation */
-
-      rcode = PIOUS_OK;
-
-      if (cache_entry == NULL || faultmode == PIOUS_VOLATILE)
-	{
-	  if ((acode = SS_write(fhandle,
-				(pious_offt)((db_nmbr * DBLK_SZ) + offset),
-				nbyte,
-				buf,
-				faultmode)) != nbyte)
-	    { /* write error, or incomplete transfer of data */
-	      if (acode == PIOUS_EFATAL)
-		{ /* fatal error occured */
-		  rcode = PIOUS_EFATAL;
-		}
-	      else
-		{ /* non-fatal error; mark for recovery */
-		  SS_recover = TRUE;
-		  rcode      = PIOUS_ERECOV;
-		}
-	    }
-	}
+    {
+      nblk = part_nblk;
+      pmin = part_min;
+      pmax = part_max;
+    }
 
-      /* if cache-hit then update cached block */
+  if (!cache_entry->valid)
+    rcode = TRUE;
+  else if (nblk[part] >= pmax[part])
+    rcode = (cache_entry->part == part);
+  else
+    rcode = (cache_entry->part == part ||
+	     nblk[cache_entry->part] > pmin[cache_entry->part]);
 
-      if (cache_entry != NULL && rcode == PIOUS_OK)
-	{ /* fill void between last valid byte and start of write */
-	  if (offset > cache_entry->db_nbyte)
-	    memset((cache_entry->dblk) + (cache_entry->db_nbyte), 0,
-		   (int)(offset - cache_entry->db_nbyte));
+  return rcode;
+}
 
-	  /* copy updated data into cached block */
-	  memcpy((cache_entry->dblk) + offset, buf, (int)nbyte);
 
-	  /* reset data block byte count */
-	  cache_entry->db_nbyte = Max(cache_entry->db_nbyte,
-				      offset + nbyte);
 
-	  /* if write faultmode is stable, mark block as dirty and stable */
-	  if (faultmode == PIOUS_STABLE)
-	    {
-	      cache_entry->dirty     = TRUE;
-	      cache_entry->faultmode = PIOUS_STABLE;
-	    }
 
-	  /* move cache entry to MRU position of protected segment */
-	  make_mru_pt(cache_entry);
-	}
-    }
+/*
+ * part_promote()
+ *
+ * Parameters:
+ *
+ *   cache_entry - valid cache entry
+ *
+ * Determine if 'cache_entry' may be promoted to the PROTECTED segment on a
+ * cache-hit; an entry of a partition at its maximum share is not promoted.
+ *
+ * Returns:
+ *
+ *   TRUE  - 'cache_entry' may be promoted
+ *   FALSE - 'cache_entry' may not be promoted
+ */
 
-  return rcode;
+#ifdef __STDC__
+static int part_promote(cache_entryt *cache_entry)
+#else
+static int part_promote(cache_entry)
+     cache_entryt *cache_entry;
+#endif
+{
+  return (part_cnt == 0 ||
+	  part_nblk[cache_entry->part] < part_max[cache_entry->part]);
 }
 
 
 
 
 /*
- * cache_alloc()
+ * class_lookup()
  *
  * Parameters:
  *
- *   fhandle     - file handle
- *   db_nmbr     - data block number
- *   cache_entry - allocated cache entry
- *
- * Allocate a cache entry for data block 'db_nmbr' of file 'fhandle', placing
- * a pointer to the cache entry in 'cache_entry'.
- *
- * If the requested data block resided in the cache prior to calling
- * cache_alloc(), then 'cache_entry' contains valid data.  Otherwise,
- * a cache entry is allocated from the PROBATIONARY segment of the
- * cache (cache_lru_pb in all but exceptional circumstances) and
- * 'cache_entry' is marked invalid.
+ *   fhandle - file handle
  *
- * NOTE: if successful then upon return:
- *         1) cache_entry->fhandle == fhandle and
- *         2) cache_entry->db_nmbr == db_nmbr
- *       even if cache_entry->valid == FALSE
+ * Determine if file 'fhandle' is assigned the large data block class.
  *
  * Returns:
  *
- *   PIOUS_OK (0) - data block successfully allocated
- *   <  0         - error code defined in pious_errno.h; possible codes are:
- *
- *       PIOUS_ERECOV - recovery required
- *       PIOUS_EFATAL - fatal error; check PDS error log
+ *   TRUE  - 'fhandle' is of the large data block class
+ *   FALSE - 'fhandle' is of the standard class
  */
 
 #ifdef __STDC__
-static int cache_alloc(pds_fhandlet fhandle,
-		       pious_offt db_nmbr,
-		       cache_entryt **cache_entry)
+static int class_lookup(pds_fhandlet fhandle)
 #else
-static int cache_alloc(fhandle, db_nmbr, cache_entry)
+static int class_lookup(fhandle)
      pds_fhandlet fhandle;
-     pious_offt db_nmbr;
-     cache_entryt **cache_entry;
 #endif
 {
-  int rcode, done, found;
-  pious_ssizet fcode;
-  register cache_entryt* cache_pos;
-
-  /* search cache via data block hash chain for (fhandle, db_nmbr) pair */
+  register file_entryt *file_entry;
 
-  cache_pos = dblk_table[hash_dblk(db_nmbr)];
+  file_entry = file_lookup(fhandle, FALSE);
 
-  while (cache_pos != NULL && (cache_pos->db_nmbr != db_nmbr ||
-			       !fhandle_eq(cache_pos->fhandle, fhandle)))
-    cache_pos = cache_pos->dbnext;
+  return (file_entry != NULL && file_entry->large);
+}
 
-  if (cache_pos != NULL)
-    { /* located (fhandle, db_nmbr) pair in cache */
-      *cache_entry = cache_pos;
-      rcode        = PIOUS_OK;
-    }
-  else
-    { /* did NOT locate (fhandle, db_nmbr) pair in cache; allocate entry */
 
-      done  = FALSE;
-      found = FALSE;
 
-      cache_pos = cache_lru_pb;
 
-      do
-	{ /* working from LRU to MRU entry of probationary segment, find the
-           * first cache entry such that:
-           *   1) entry is not valid, or
-           *   2) entry is valid but not dirty, or
-           *   3) entry is valid and dirty but can be successfully flushed
-           *      to stable storage.
-           * if no such entry can be found then PDS can not continue and
-           * recovery will be required.
-           *
-	   */
+/*
+ * class_set()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   large   - large data block class flag; TRUE/FALSE
+ *
+ * Assign file 'fhandle' the large data block class if 'large' is TRUE,
+ * allocating a file entry if 'fhandle' has none, and otherwise the standard
+ * class.
+ *
+ * A file leaving the large class has its large data blocks and cache
+ * entries discarded; see discussion at top.
+ *
+ * Returns:
+ */
 
-	  if (cache_pos->valid == FALSE || cache_pos->dirty == FALSE)
-	    { /* cache entry is not valid, or is valid but not dirty */
-	      found = done = TRUE;
-	    }
+#ifdef __STDC__
+static void class_set(pds_fhandlet fhandle,
+		      int large)
+#else
+static void class_set(fhandle, large)
+     pds_fhandlet fhandle;
+     int large;
+#endif
+{
+  register file_entryt *file_entry;
 
-	  else
-	    { /* cache entry is valid and dirty; attempt to flush */
-	      fcode = SS_write(cache_pos->fhandle,
-			       (pious_offt)(cache_pos->db_nmbr * DBLK_SZ),
-			       cache_pos->db_nbyte,
-			       cache_pos->dblk,
-			       cache_pos->faultmode);
+  if ((file_entry = file_lookup(fhandle, large)) != NULL)
+    {
+      if (large)
+	file_entry->large = TRUE;
 
-	      if (fcode == cache_pos->db_nbyte)
-		/* block flush successful */
-		found = done = TRUE;
+      else if (file_entry->large)
+	{ /* file leaves large class */
+	  file_entry->large = FALSE;
 
-	      else if (fcode == PIOUS_EFATAL)
-		/* PDS can not continue; SS_fatalerror set by Stable Storage
-                 * Manager.
-		 */
-		done = TRUE;
-	      else
-		/* block flush unsuccessful but not fatal, go to next block */
-		cache_pos = cache_pos->cprev;
-	    }
+	  large_fdiscard(fhandle);
+	  file_discard(fhandle);
 	}
-      while (!done && cache_pos->segment == PROBATIONARY);
+    }
+}
 
-      if (SS_fatalerror)
-	{ /* indicate that a fatal error occured */
-	  rcode = PIOUS_EFATAL;
-	}
 
-      else if (!found)
-	{ /* indicate that a cache entry can not be successfully allocated */
-	  SS_recover = TRUE;
-	  rcode      = PIOUS_ERECOV;
-	}
 
-      else
-	{ /* successfully located/flushed a cache entry to allocate */
 
-	  /* if cache entry to replace is valid, invalidate it */
-	  if (cache_pos->valid)
-	    entry_invalidate(cache_pos);
+/*
+ * adm_index()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   db_nmbr - data block number
+ *   idx     - frequency sketch counter indices
+ *
+ * Compute the index into 'adm_sketch' of the frequency counter in each row
+ * of the sketch for data block 'db_nmbr' of file 'fhandle', placing the
+ * indices in idx[0] through idx[ADM_DEPTH - 1].  Row indices are derived
+ * from two hash values by double hashing; the second is odd, so that rows
+ * index distinct counters.
+ *
+ * Returns:
+ */
 
-	  /* update relevant cache entry fields */
-	  cache_pos->fhandle  = fhandle;
-	  cache_pos->db_nmbr  = db_nmbr;
+#ifdef __STDC__
+static void adm_index(pds_fhandlet fhandle,
+		      pious_offt db_nmbr,
+		      unsigned long *idx)
+#else
+static void adm_index(fhandle, db_nmbr, idx)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
+     unsigned long *idx;
+#endif
+{
+  register unsigned long h1, h2;
+  int i;
 
-	  /* set return values */
-	  *cache_entry = cache_pos;
-	  rcode        = PIOUS_OK;
-	}
-    }
+  /* mix file handle and data block number; multiplicative constants are
+   * odd and retain their low-order bits in 32-bit arithmetic
+   */
+  h1  = ((unsigned long)db_nmbr * 0x9e3779b1UL) ^
+        (fhandle.ino * 0x85ebca6bUL) ^ fhandle.dev;
+  h1 &= 0xffffffffUL;
+  h1 ^= h1 >> 15;
+  h1  = (h1 * 0x2c1b3c6dUL) & 0xffffffffUL;
+  h1 ^= h1 >> 13;
 
-  return rcode;
+  h2 = (h1 >> 16) | 1;
+
+  for (i = 0; i < ADM_DEPTH; i++)
+    idx[i] = (i * adm_width) + ((h1 + (i * h2)) & (adm_width - 1));
 }
 
 
 
 
 /*
- * entry_validate()
+ * adm_record()
  *
  * Parameters:
  *
- *   cache_entry - invalid cache entry
- *
- * Place INVALID cache entry 'cache_entry' on appripriate data block and
- * file handle hash chains and mark as valid.  Does not move 'cache_entry'
- * in cache list.
+ *   fhandle - file handle
+ *   db_nmbr - data block number
  *
- * NOTE: Assumes:
- *         1) cache_entry->db_nmbr and
- *         2) cache_entry->fhandle
- *       have been assigned the appropriate (valid) data block number and
- *       file handle values, respectively.
+ * Record a reference to data block 'db_nmbr' of file 'fhandle' in the
+ * admission filter frequency sketch.  Only the counters equal to the
+ * estimated frequency are incremented (conservative update), reducing the
+ * overestimate due to hash collisions.  Every 'adm_sample' references all
+ * counters are halved, aging reference history.
  *
  * Returns:
  */
 
 #ifdef __STDC__
-static void entry_validate(cache_entryt *cache_entry)
+static void adm_record(pds_fhandlet fhandle,
+		       pious_offt db_nmbr)
 #else
-static void entry_validate(cache_entry)
-     cache_entryt *cache_entry;
+static void adm_record(fhandle, db_nmbr)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
 #endif
 {
-  if (!cache_entry->valid)
-    { /* place 'cache_entry' at head of data block hash chain */
+  unsigned long idx[ADM_DEPTH], i;
+  int count;
 
-      cache_entry->dbprev = NULL;
-      cache_entry->dbnext = dblk_table[hash_dblk(cache_entry->db_nmbr)];
-      dblk_table[hash_dblk(cache_entry->db_nmbr)] = cache_entry;
-
-      /* set 'prev' pointer of former head of hash chain, if extant */
-      if (cache_entry->dbnext != NULL)
-	cache_entry->dbnext->dbprev = cache_entry;
+  /* determine estimated frequency; minimum of row counters */
+  adm_index(fhandle, db_nmbr, idx);
 
-      /* place 'cache_entry' at head of fhandle hash chain */
+  count = ADM_COUNT_MAX;
 
-      cache_entry->fhprev = NULL;
-      cache_entry->fhnext = fh_table[fhandle_hash(cache_entry->fhandle,
-						  FH_TABLE_SZ)];
-      fh_table[fhandle_hash(cache_entry->fhandle, FH_TABLE_SZ)] = cache_entry;
+  for (i = 0; i < ADM_DEPTH; i++)
+    count = Min(count, adm_sketch[idx[i]]);
 
-      /* set 'prev' pointer of former head of hash chain, if extant */
-      if (cache_entry->fhnext != NULL)
-	cache_entry->fhnext->fhprev = cache_entry;
+  /* increment minimum counters, unless saturated */
+  if (count < ADM_COUNT_MAX)
+    for (i = 0; i < ADM_DEPTH; i++)
+      if (adm_sketch[idx[i]] == count)
+	adm_sketch[idx[i]]++;
 
+  /* age reference history at end of sample */
+  if (++adm_nref >= adm_sample)
+    {
+      for (i = 0; i < ADM_DEPTH * adm_width; i++)
+	adm_sketch[i] >>= 1;
 
-      /* mark entry as valid */
-      cache_entry->valid = TRUE;
+      adm_nref = 0;
     }
 }
 
@@ -1267,181 +6507,155 @@ static void entry_validate(cache_entry)
 
 
 /*
- * entry_invalidate()
+ * adm_estimate()
  *
  * Parameters:
  *
- *   cache_entry - valid cache entry
+ *   fhandle - file handle
+ *   db_nmbr - data block number
  *
- * Remove VALID cache entry 'cache_entry' from associated data block and
- * file handle hash chains and mark as invalid.  Does not move 'cache_entry'
- * in cache list.
+ * Estimate the recent frequency of reference to data block 'db_nmbr' of
+ * file 'fhandle' from the admission filter frequency sketch.
  *
  * Returns:
+ *
+ *   int - estimated reference count, 0 through ADM_COUNT_MAX
  */
 
 #ifdef __STDC__
-static void entry_invalidate(cache_entryt *cache_entry)
+static int adm_estimate(pds_fhandlet fhandle,
+			pious_offt db_nmbr)
 #else
-static void entry_invalidate(cache_entry)
-     cache_entryt *cache_entry;
+static int adm_estimate(fhandle, db_nmbr)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
 #endif
 {
-  if (cache_entry->valid)
-    { /* remove 'cache_entry' from data block hash chain */
+  unsigned long idx[ADM_DEPTH];
+  int count, i;
 
-      /* if not last in chain, reset 'prev' pointer of 'next' entry */
-      if (cache_entry->dbnext != NULL)
-	cache_entry->dbnext->dbprev = cache_entry->dbprev;
-
-      /* if not first in chain, reset 'next' pointer of 'prev' entry */
-      if (cache_entry->dbprev != NULL)
-	cache_entry->dbprev->dbnext = cache_entry->dbnext;
-      else
-	/* first in chain, reset data block hash table entry */
-	dblk_table[hash_dblk(cache_entry->db_nmbr)] = cache_entry->dbnext;
-
-      /* remove 'cache_entry' from fhandle hash chain */
-
-      /* if not last in chain, reset 'prev' pointer of 'next' entry */
-      if (cache_entry->fhnext != NULL)
-	cache_entry->fhnext->fhprev = cache_entry->fhprev;
+  adm_index(fhandle, db_nmbr, idx);
 
-      /* if not first in chain, reset 'next' pointer of 'prev' entry */
-      if (cache_entry->fhprev != NULL)
-	cache_entry->fhprev->fhnext = cache_entry->fhnext;
-      else
-	/* first in chain, reset fhandle hash table entry */
-	fh_table[fhandle_hash(cache_entry->fhandle, FH_TABLE_SZ)] =
-	  cache_entry->fhnext;
+  count = ADM_COUNT_MAX;
 
+  for (i = 0; i < ADM_DEPTH; i++)
+    count = Min(count, adm_sketch[idx[i]]);
 
-      /* mark 'cache_entry' as invalid */
-      cache_entry->valid = FALSE;
-    }
+  return count;
 }
 
 
 
 
 /*
- * make_mru_pt()
+ * adm_admit()
  *
  * Parameters:
  *
- *   cache_entry - cache entry
- *
- * Insert the data block cache entry 'cache_entry' at the MRU position of
- * the PROTECTED segment.  Prior to calling make_mru_pt(), 'cache_entry' may
- * reside in either the protected or the probationary segment of the cache.
+ *   fhandle - file handle
+ *   db_nmbr - data block number
  *
- * Note: global variables 'cache_mru_pt', 'cache_mru_pb', and 'cache_lru_pb'
- *       may be altered as a side-effect
+ * Determine if data block 'db_nmbr' of file 'fhandle' is to be admitted to
+ * the cache, i.e. placed in the PROBATIONARY segment as usual.  The data
+ * block is admitted if the entry next to be replaced, the first entry from
+ * the LRU position of the PROBATIONARY segment that is neither pinned nor
+ * the data block itself, is invalid or is estimated to be less frequently
+ * referenced.
  *
  * Returns:
+ *
+ *   TRUE  - admit data block
+ *   FALSE - do not admit data block
  */
 
 #ifdef __STDC__
-static void make_mru_pt(cache_entryt *cache_entry)
+static int adm_admit(pds_fhandlet fhandle,
+		     pious_offt db_nmbr)
 #else
-static void make_mru_pt(cache_entry)
-     cache_entryt *cache_entry;
+static int adm_admit(fhandle, db_nmbr)
+     pds_fhandlet fhandle;
+     pious_offt db_nmbr;
 #endif
 {
-  /* put 'cache_entry' at MRU position of the protected segment */
-  if (cache_entry != cache_mru_pt)
-    {
-      if (cache_entry == cache_lru_pb)
-	{ /* special case; advance MRU and LRU pointers around circular list */
-	  cache_mru_pt = cache_lru_pb;
-	  cache_lru_pb = cache_lru_pb->cprev;
-	  cache_mru_pb = cache_mru_pb->cprev;
-
-	  /* set segment types appropriately */
-	  cache_mru_pt->segment = PROTECTED;
-	  cache_mru_pb->segment = PROBATIONARY;
-	}
-      else
-	{ /* remove from list and place in MRU position of protected segment */
+  int rcode;
+  register cache_entryt *victim;
 
-	  /* if removing entry from probationary seg, make LRU entry of
-           * protected seg the new MRU entry of the probationary seg
-	   */
-	  if (cache_entry->segment == PROBATIONARY)
-	    {
-	      cache_mru_pb          = cache_mru_pb->cprev;
-	      cache_mru_pb->segment = PROBATIONARY;
-	    }
-	    
-	  /* remove *cache_entry from cache block list */
-	  cache_entry->cprev->cnext = cache_entry->cnext;
-	  cache_entry->cnext->cprev = cache_entry->cprev;
+  /* locate entry next to be replaced; see cache_alloc() */
+  victim = cache_lru_pb;
 
-	  /* set *cache_entry pointers/seg-type appropriately for MRU entry */
-	  cache_entry->cprev   = cache_lru_pb;
-	  cache_entry->cnext   = cache_mru_pt;
-	  cache_entry->segment = PROTECTED;
+  while (victim != NULL && victim->segment == PROBATIONARY &&
+	 (victim->pinned ||
+	  (victim->valid && victim->db_nmbr == db_nmbr &&
+	   fhandle_eq(victim->fhandle, fhandle))))
+    victim = victim->cprev;
 
-	  /* set *cache_mru_pt and *cache_lru_pb pointers to new MRU entry */
-	  cache_mru_pt->cprev = cache_entry;
-	  cache_lru_pb->cnext = cache_entry;
+  if (victim == NULL || victim->segment != PROBATIONARY || !victim->valid)
+    rcode = TRUE;
+  else
+    rcode = (adm_estimate(fhandle, db_nmbr) >
+	     adm_estimate(victim->fhandle, victim->db_nmbr));
 
-	  /* set MRU pointer to cache_entry */
-	  cache_mru_pt = cache_entry;
-	}
-    }
+  return rcode;
 }
 
 
 
 
+
 /*
- * make_mru_pb()
+ * table_size()
  *
  * Parameters:
  *
- *   cache_entry - cache entry
- *
- * Insert the data block cache entry 'cache_entry' at the MRU position of
- * the PROBATIONARY segment.  Prior to calling make_mru_pb(), 'cache_entry'
- * MUST reside in the probationary segment of the cache.
+ *   nentry - expected number of hash table entries
  *
- * Note: global variables 'cache_mru_pb' and 'cache_lru_pb' may be altered
- *       as a side-effect
+ * Determine a hash table size for 'nentry' entries; the size is the
+ * smallest prime, not near a power of 2, that is greater than or equal to
+ * Max(nentry, TABLE_SZ_MIN).
  *
  * Returns:
+ *
+ *   long - hash table size
  */
 
 #ifdef __STDC__
-static void make_mru_pb(cache_entryt *cache_entry)
+static long table_size(long nentry)
 #else
-static void make_mru_pb(cache_entry)
-     cache_entryt *cache_entry;
+static long table_size(nentry)
+     long nentry;
 #endif
 {
-  /* put 'cache_entry' at MRU position of the probationary segment */
-  if (cache_entry != cache_mru_pb && cache_entry->segment == PROBATIONARY)
-    {
-      /* remove from list and place in MRU position of probationary segment */
+  long tsize, pow2, div;
+  int prime;
 
-      /* remove *cache_entry from cache block list */
-      cache_entry->cprev->cnext = cache_entry->cnext;
-      cache_entry->cnext->cprev = cache_entry->cprev;
+  tsize = Max(nentry, TABLE_SZ_MIN);
 
-      if (cache_entry == cache_lru_pb)
-	cache_lru_pb = cache_entry->cprev;
+  /* avoid sizes within 1/8 of a power of 2 */
+  for (pow2 = 1; pow2 < tsize; pow2 *= 2);
 
-      /* set *cache_entry pointers appropriately for MRU entry */
-      cache_entry->cprev = cache_mru_pb->cprev;
-      cache_entry->cnext = cache_mru_pb;
+  if (tsize > pow2 - (pow2 / 8))
+    tsize = pow2 + (pow2 / 8);
+  else if (tsize < (pow2 / 2) + (pow2 / 16))
+    tsize = (pow2 / 2) + (pow2 / 16);
 
-      /* set *cache_mru_pb and *(cache_mru_pb->cprev) ptrs to new MRU entry */
-      cache_mru_pb->cprev->cnext = cache_entry;
-      cache_mru_pb->cprev        = cache_entry;
+  /* locate next prime; trial division is adequate for a one-time cost */
+  if (tsize % 2 == 0)
+    tsize++;
 
-      /* set MRU pointer to cache_entry */
-      cache_mru_pb = cache_entry;
+  do
+    {
+      prime = TRUE;
+
+      for (div = 3; div * div <= tsize && prime; div += 2)
+	if (tsize % div == 0)
+	  prime = FALSE;
+
+      if (!prime)
+	tsize += 2;
     }
+  while (!prime);
+
+  return tsize;
 }
 
 
@@ -1452,65 +6666,455 @@ static void make_mru_pb(cache_entry)
  *
  * Parameters:
  *
- * Initializes the data block cache in preparation for access.
+ *   param - cache configuration parameters
+ *
+ * Initializes the data block cache in preparation for access, as specified
+ * by configuration parameters 'param'; 'param' is presumed valid.
+ *
+ * If 'param' is NULL then the default configuration is used, and if the
+ * cache can not be allocated then the cache manager operates without a
+ * cache (cache_sz == 0) rather than failing.
  *
  * Returns:
+ *
+ *   PIOUS_OK (0) - cache initialized without error
+ *   PIOUS_EINSUF - insufficient system resources to allocate cache
  */
 
 #ifdef __STDC__
-static void cachemanager_init(void)
+static int cachemanager_init(struct CM_param *param)
 #else
-static void cachemanager_init()
+static int cachemanager_init(param)
+     struct CM_param *param;
 #endif
 {
-#if CACHE_SZ > 0 /* no initialization if no cache */
+  int rcode;
+  long i;
+  struct CM_param defparam;
   register cache_entryt *cache_pos;
-  int prot_seg_sz;
 
-  /* initialize data block cache as a doubly linked circular list.
-   * presumes CACHE_SZ >= 2, as set when CACHE_SZ is defined above.
-   */
+  /* use default configuration if none specified */
+  if (param == NULL)
+    {
+      CM_defparam(&defparam);
+      param = &defparam;
+    }
 
-  /* determine number of protected segment cache entries:
-   *   1 <= prot_seg_sz <= (CACHE_SZ - 1)
+  /* set cache configuration; a cache size of 1 is taken as 2 since the
+   * cache is comprised of a protected and a probationary segment.
    */
 
-  prot_seg_sz = Min(Max((int)(CACHE_SZ * PROT_SEG_RATIO), 1), CACHE_SZ - 1);
+  cache_sz       = ((param->cache_sz == 1) ? 2 : param->cache_sz);
+  dblk_sz        = param->dblk_sz;
+  cache_hugepage = param->hugepage;
+
+  cache       = NULL;
+  cache_arena = NULL;
+  dblk_table  = fh_table = NULL;
+  fl_vec      = NULL;
+  fl_iov      = NULL;
+  file_table  = NULL;
+
+  sm_cnt   = 0;
+  sm_sz    = param->sm_sz;
+  sm_cache = NULL;
+  sm_arena = NULL;
+
+  lg_cnt   = 0;
+  lg_sz    = param->lg_sz;
+  lg_min   = param->lg_min;
+  lg_cache = NULL;
+  lg_arena = NULL;
+  lg_table = NULL;
+
+  ra_cap = 0;
+  ra_iov = NULL;
+  ra_vec = NULL;
+
+  warm_cap = 0;
+  warm_vec = NULL;
+  warm_cnt = warm_pos = 0;
+
+  lr_min = param->lr_min;
+
+  pin_max = pin_cnt = 0;
+  pin_vec = NULL;
+
+  cache_policy = CM_POLICY_SLRU;
+  ghost        = NULL;
+  ghost_table  = NULL;
+
+  adm_sketch = NULL;
+  adm_width  = 0;
+  adm_sample = adm_nref = 0;
+
+  /* set cache partition shares in data blocks, and of the large data
+   * block slab in large data blocks; the default partition has no reserved
+   * share and may occupy the cache.
+   */
 
-  /* initialize all but first and last */
+  part_cnt = param->part_cnt;
 
-  for (cache_pos = cache + 1; cache_pos < cache + (CACHE_SZ - 1); cache_pos++)
+  for (i = 0; i <= CM_PART_MAX; i++)
     {
-      cache_pos->cnext = cache_pos + 1;
-      cache_pos->cprev = cache_pos - 1;
-      cache_pos->valid = FALSE;
-
-      if (cache_pos < cache + prot_seg_sz)
-	cache_pos->segment = PROTECTED;
+      if (i == 0 || i > part_cnt)
+	{
+	  part_min[i]   = 0;
+	  part_max[i]   = cache_sz;
+	  part_lgmin[i] = 0;
+	  part_lgmax[i] = param->lg_cnt;
+	}
       else
-	cache_pos->segment = PROBATIONARY;
+	{
+	  part_min[i]   = (cache_sz * param->part_min[i - 1]) / 100;
+	  part_max[i]   = (cache_sz * param->part_max[i - 1]) / 100;
+	  part_lgmin[i] = (param->lg_cnt * param->part_min[i - 1]) / 100;
+	  part_lgmax[i] = (param->lg_cnt * param->part_max[i - 1]) / 100;
+	}
+
+      part_nblk[i] = part_lgnblk[i] = 0;
     }
 
-  /* initialize first */
-  cache[0].cnext   = cache + 1;
-  cache[0].cprev   = cache + (CACHE_SZ - 1);
-  cache[0].valid   = FALSE;
-  cache[0].segment = PROTECTED;
+  cache_writeback = FALSE;
+  wb_ndirty       = 0;
+  wb_head         = wb_tail = NULL;
 
-  /* initialize last */
-  cache[CACHE_SZ - 1].cnext   = cache;
-  cache[CACHE_SZ - 1].cprev   = cache + (CACHE_SZ - 2);
-  cache[CACHE_SZ - 1].valid   = FALSE;
-  cache[CACHE_SZ - 1].segment = PROBATIONARY;
+  rcode = PIOUS_OK;
 
-  /* set MRU protected/probationary and LRU probationary seg pointers */
+  if (cache_sz > 0)
+    { /* allocate cache entries, data block arena, and hash tables */
 
-  cache_mru_pt = cache;
-  cache_mru_pb = cache + prot_seg_sz;
-  cache_lru_pb = cache + (CACHE_SZ - 1);
-#endif
+      dblk_table_sz = table_size(cache_sz + param->sm_cnt);
+      fh_table_sz   = table_size(cache_sz / FH_TABLE_LOAD);
+      file_table_sz = table_size(FILE_POOL_SZ);
+
+      if ((cache = (cache_entryt *)
+	   malloc((unsigned long)cache_sz * sizeof(cache_entryt))) == NULL ||
+
+	  (cache_arena =
+	   SYS_arena_alloc((unsigned long)cache_sz * dblk_sz,
+			   cache_hugepage)) == NULL ||
+
+	  (dblk_table = (cache_entryt **)
+	   malloc((unsigned long)dblk_table_sz *
+		  sizeof(cache_entryt *))) == NULL ||
+
+	  (fh_table = (cache_entryt **)
+	   malloc((unsigned long)fh_table_sz *
+		  sizeof(cache_entryt *))) == NULL ||
+
+	  (fl_vec = (cache_entryt **)
+	   malloc((unsigned long)cache_sz *
+		  sizeof(cache_entryt *))) == NULL ||
+
+	  (fl_iov = (struct FS_iovec *)
+	   malloc((unsigned long)FLUSH_RUN_MAX *
+		  sizeof(struct FS_iovec))) == NULL ||
+
+	  (file_table = (file_entryt **)
+	   malloc((unsigned long)file_table_sz *
+		  sizeof(file_entryt *))) == NULL)
+	{ /* unable to allocate cache; deallocate any partial allocation */
+	  if (cache != NULL)
+	    free((char *)cache);
+
+	  if (cache_arena != NULL)
+	    SYS_arena_free(cache_arena,
+			   (unsigned long)cache_sz * dblk_sz, cache_hugepage);
+
+	  if (dblk_table != NULL)
+	    free((char *)dblk_table);
+
+	  if (fh_table != NULL)
+	    free((char *)fh_table);
+
+	  if (fl_vec != NULL)
+	    free((char *)fl_vec);
+
+	  if (fl_iov != NULL)
+	    free((char *)fl_iov);
+
+	  cache       = NULL;
+	  cache_arena = NULL;
+	  dblk_table  = fh_table = NULL;
+	  fl_vec      = NULL;
+	  fl_iov      = NULL;
+
+	  cache_sz = 0;
+	  rcode    = PIOUS_EINSUF;
+	}
+    }
+
+  if (cache_sz > 0)
+    { /* initialize data block cache as a doubly linked circular list.
+       * presumes cache_sz >= 2, as set above.
+       */
+
+      /* determine number of protected segment cache entries:
+       *   1 <= prot_sz <= (cache_sz - 1)
+       */
+
+      prot_sz = Min(Max((cache_sz * param->prot_pct) / 100, 1),
+		    cache_sz - 1);
+
+      /* initialize all but first and last */
+
+      for (cache_pos = cache + 1;
+	   cache_pos < cache + (cache_sz - 1);
+	   cache_pos++)
+	{
+	  cache_pos->cnext = cache_pos + 1;
+	  cache_pos->cprev = cache_pos - 1;
+	  cache_pos->valid = FALSE;
+
+	  if (cache_pos < cache + prot_sz)
+	    cache_pos->segment = PROTECTED;
+	  else
+	    cache_pos->segment = PROBATIONARY;
+	}
+
+      /* initialize first */
+      cache[0].cnext   = cache + 1;
+      cache[0].cprev   = cache + (cache_sz - 1);
+      cache[0].valid   = FALSE;
+      cache[0].segment = PROTECTED;
+
+      /* initialize last */
+      cache[cache_sz - 1].cnext   = cache;
+      cache[cache_sz - 1].cprev   = cache + (cache_sz - 2);
+      cache[cache_sz - 1].valid   = FALSE;
+      cache[cache_sz - 1].segment = PROBATIONARY;
+
+      /* assign each cache entry a data block from the arena */
+      for (i = 0; i < cache_sz; i++)
+	{
+	  cache[i].dblk       = cache_arena + (i * dblk_sz);
+	  cache[i].prefetched = FALSE;
+	  cache[i].promoted   = FALSE;
+	  cache[i].wbdirty    = FALSE;
+	  cache[i].pinned     = FALSE;
+	}
+
+      /* initialize data block and file handle hash tables */
+      for (i = 0; i < dblk_table_sz; i++)
+	dblk_table[i] = NULL;
+
+      for (i = 0; i < fh_table_sz; i++)
+	fh_table[i] = NULL;
 
-  /* indicate that initilization has taken place */
+      /* set MRU protected/probationary and LRU probationary seg pointers */
 
-  cache_initialized = TRUE;
+      cache_mru_pt = cache;
+      cache_mru_pb = cache + prot_sz;
+      cache_lru_pb = cache + (cache_sz - 1);
+
+      /* initialize sequential readahead and cache warm-up; the readahead
+       * window is limited to half the probationary segment so that
+       * prefetched data blocks are not replaced by subsequent prefetching
+       * prior to being read.  warm-up runs are likewise limited, and share
+       * the readahead I/O vector.
+       */
+
+      ra_cap   = Min(param->ra_max, (cache_sz - prot_sz) / 2);
+      warm_cap = Min(WARM_RUN_MAX, (cache_sz - prot_sz) / 2);
+
+      if (ra_cap > 0 || warm_cap > 0)
+	{
+	  if ((ra_iov = (struct FS_iovec *)
+	       malloc((unsigned long)Max(ra_cap, warm_cap) *
+		      sizeof(struct FS_iovec))) == NULL ||
+
+	      (ra_vec = (cache_entryt **)
+	       malloc((unsigned long)Max(ra_cap, warm_cap) *
+		      sizeof(cache_entryt *))) == NULL)
+	    { /* unable to allocate I/O vector; operate without readahead */
+	      if (ra_iov != NULL)
+		free((char *)ra_iov);
+
+	      ra_iov = NULL;
+	      ra_cap = warm_cap = 0;
+	    }
+	}
+
+      /* initialize file state; sequential access state, file size (EOF)
+       * tracking, retained access advice, and partition and class
+       * assignment
+       */
+      file_reset();
+
+      /* initialize small data block slab */
+      if (param->sm_cnt > 0)
+	{
+	  sm_cnt = param->sm_cnt;
+
+	  if ((sm_cache = (cache_entryt *)
+	       malloc((unsigned long)sm_cnt * sizeof(cache_entryt))) == NULL ||
+
+	      (sm_arena =
+	       SYS_arena_alloc((unsigned long)sm_cnt * sm_sz,
+			       cache_hugepage)) == NULL)
+	    { /* unable to allocate slab; operate without small data blocks */
+	      if (sm_cache != NULL)
+		free((char *)sm_cache);
+
+	      sm_cache = NULL;
+	      sm_cnt   = 0;
+	    }
+	  else
+	    {
+	      for (i = 0; i < sm_cnt; i++)
+		{
+		  sm_cache[i].dblk       = sm_arena + (i * sm_sz);
+		  sm_cache[i].segment    = SMALL;
+		  sm_cache[i].dirty      = FALSE;
+		  sm_cache[i].faultmode  = PIOUS_VOLATILE;
+		  sm_cache[i].prefetched = FALSE;
+		  sm_cache[i].promoted   = FALSE;
+		  sm_cache[i].wbdirty    = FALSE;
+		  sm_cache[i].pinned     = FALSE;
+		}
+
+	      small_reset();
+	    }
+	}
+
+      /* initialize large data block slab */
+      if (param->lg_cnt > 0)
+	{
+	  lg_cnt      = param->lg_cnt;
+	  lg_table_sz = table_size(lg_cnt);
+
+	  if ((lg_cache = (cache_entryt *)
+	       malloc((unsigned long)lg_cnt * sizeof(cache_entryt))) == NULL ||
+
+	      (lg_table = (cache_entryt **)
+	       malloc((unsigned long)lg_table_sz *
+		      sizeof(cache_entryt *))) == NULL ||
+
+	      (lg_arena =
+	       SYS_arena_alloc((unsigned long)lg_cnt * lg_sz,
+			       cache_hugepage)) == NULL)
+	    { /* unable to allocate slab; operate without large data blocks */
+	      if (lg_cache != NULL)
+		free((char *)lg_cache);
+
+	      if (lg_table != NULL)
+		free((char *)lg_table);
+
+	      lg_cache = NULL;
+	      lg_table = NULL;
+	      lg_cnt   = 0;
+	    }
+	  else
+	    {
+	      for (i = 0; i < lg_cnt; i++)
+		{
+		  lg_cache[i].dblk       = lg_arena + (i * lg_sz);
+		  lg_cache[i].segment    = LARGE;
+		  lg_cache[i].dirty      = FALSE;
+		  lg_cache[i].faultmode  = PIOUS_VOLATILE;
+		  lg_cache[i].prefetched = FALSE;
+		  lg_cache[i].promoted   = FALSE;
+		  lg_cache[i].wbdirty    = FALSE;
+		  lg_cache[i].pinned     = FALSE;
+		  lg_cache[i].part       = 0;
+		}
+
+	      large_reset();
+	    }
+	}
+
+      /* initialize data block reference limit; fewer entries are pinned
+       * than the configured size of the probationary segment.
+       */
+
+      pin_max = Max(Min(PIN_MAX, (cache_sz - prot_sz) - 1), 0);
+
+      /* initialize replacement policy; under the adaptive policy the
+       * protected segment target size is initially the configured size,
+       * and the probationary segment is never reduced to less than twice
+       * the readahead window limit, nor to the data block reference limit.
+       */
+
+      cache_policy = param->policy;
+      prot_target  = prot_sz;
+      prot_max     = cache_sz - Max(2 * ra_cap, pin_max + 1);
+
+      if (cache_policy == CM_POLICY_ARC)
+	{
+	  if ((ghost = (ghost_entryt *)
+	       malloc((unsigned long)cache_sz *
+		      sizeof(ghost_entryt))) == NULL ||
+
+	      (ghost_table = (ghost_entryt **)
+	       malloc((unsigned long)dblk_table_sz *
+		      sizeof(ghost_entryt *))) == NULL)
+	    { /* unable to allocate ghost lists; operate under SLRU policy */
+	      if (ghost != NULL)
+		free((char *)ghost);
+
+	      ghost        = NULL;
+	      cache_policy = CM_POLICY_SLRU;
+	    }
+	  else
+	    ghost_reset();
+	}
+
+      /* initialize admission filter; the frequency sketch is retained
+       * across cache invalidation, as reference history remains valid.
+       */
+
+      if (param->admit)
+	{
+	  for (adm_width = 1;
+	       adm_width < (unsigned long)cache_sz * ADM_WIDTH_FACTOR;
+	       adm_width *= 2);
+
+	  if ((adm_sketch = (unsigned char *)
+	       malloc((unsigned long)ADM_DEPTH * adm_width)) == NULL)
+	    { /* unable to allocate frequency sketch; operate without filter */
+	      adm_width = 0;
+	    }
+	  else
+	    {
+	      memset((char *)adm_sketch, 0, (int)(ADM_DEPTH * adm_width));
+
+	      adm_sample = cache_sz * ADM_SAMPLE_FACTOR;
+	    }
+	}
+
+      /* initialize data block references; fewer entries are pinned than
+       * the minimum size of the probationary segment, such that an entry
+       * to replace can always be located.
+       */
+
+      if (pin_max > 0 &&
+	  (pin_vec = (cache_entryt **)
+	   malloc((unsigned long)pin_max * sizeof(cache_entryt *))) == NULL)
+	{ /* unable to allocate pinned entry vector; operate without refs */
+	  pin_max = 0;
+	}
+
+      /* initialize volatile write-back policy */
+
+      cache_writeback = param->writeback;
+      wb_dirty_max    = Max((cache_sz * param->wb_dirty_pct) / 100, 1);
+      wb_age          = param->wb_age;
+
+      /* initialize direct I/O; data blocks are aligned in the arena, so
+       * whole data block transfers bypass the host file system cache.
+       */
+
+      SS_direct(param->direct);
+    }
+
+  /* indicate that initilization has taken place; on failure an explicit
+   * configuration may be retried, but a default configuration operates
+   * without a cache.
+   */
+
+  if (rcode == PIOUS_OK || param == &defparam)
+    cache_initialized = TRUE;
+
+  return rcode;
 }
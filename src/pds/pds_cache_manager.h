@@ -35,15 +35,166 @@
  *
  * Function Summary:
  *
+ * CM_defparam();
+ * CM_init();
  * CM_read();
+ * CM_readv();
+ * CM_release();
  * CM_write();
  * CM_flush();
  * CM_fflush();
+ * CM_bgflush();
  * CM_invalidate();
  * CM_finvalidate();
+ * CM_advise();
+ * CM_fpartition();
+ * CM_fclass();
+ * CM_warmsave();
+ * CM_warmload();
+ * CM_warmup();
+ * CM_stats();
  */
 
 
+/*
+ * CM_defparam()
+ *
+ * Parameters:
+ *
+ *   param - cache configuration parameters
+ *
+ * Set the cache configuration parameters 'param' to the system defaults
+ * defined in config/pious_sysconfig.h.
+ *
+ * The cache configuration parameters are:
+ *
+ *   cache_sz     - cache size in number of data blocks (>= 0); a value of
+ *                  zero specifies no caching, and a value of one is taken
+ *                  as two.
+ *   dblk_sz      - data block size in bytes (> 0)
+ *   sm_cnt       - number of small data blocks (>= 0), in a slab apart from
+ *                  the cache proper, holding incomplete data blocks of at
+ *                  most sm_sz bytes when read; zero disables the slab
+ *   sm_sz        - small data block size in bytes (0 < sm_sz < dblk_sz).
+ *                  sm_sz must be a multiple of FS_DIRECT_ALIGN if direct.
+ *   lg_cnt       - number of large data blocks (>= 0), in a slab apart from
+ *                  the cache proper, holding the data of files assigned the
+ *                  large data block class via CM_fclass(); zero disables
+ *                  the slab, and all files are of the standard class
+ *   lg_sz        - large data block size in bytes
+ *                  (dblk_sz < lg_sz <= PIOUS_INT_MAX).  lg_sz must be a
+ *                  multiple of FS_DIRECT_ALIGN if direct.
+ *   lg_min       - minimum size in bytes of a file assigned the large data
+ *                  block class by size (>= 0); zero assigns by hint only
+ *   prot_pct     - protected segment size as a percentage of the cache size
+ *                  (0 < prot_pct < 100)
+ *   hugepage     - back the cache with huge pages, if available; TRUE/FALSE
+ *   direct       - transfer data blocks via direct I/O, if available, such
+ *                  that data is not also cached by the host file system;
+ *                  TRUE/FALSE.  dblk_sz must be a multiple of
+ *                  FS_DIRECT_ALIGN (see pfs/pfs.h) when TRUE.
+ *   ra_max       - maximum sequential readahead window in number of data
+ *                  blocks (>= 0); a value of zero disables readahead
+ *   lr_min       - minimum data block span of a read performed by extent,
+ *                  reading non-cached data blocks directly into the caller's
+ *                  buffer without caching (>= 0); a value of zero disables
+ *   policy       - cache replacement policy; CM_POLICY_SLRU (segmented LRU
+ *                  with fixed segment sizes) or CM_POLICY_ARC (segmented
+ *                  LRU with segment sizes adapted online via ghost lists,
+ *                  where prot_pct sets the initial protected segment size)
+ *   admit        - filter admission of missed data blocks by estimated
+ *                  reference frequency; TRUE/FALSE
+ *   writeback    - cache volatile writes under a write-back, rather than
+ *                  write-through, policy; TRUE/FALSE
+ *   wb_dirty_pct - write-back dirty data threshold as a percentage of the
+ *                  cache size (0 < wb_dirty_pct <= 100)
+ *   wb_age       - write-back dirty data age threshold in milliseconds (>= 0)
+ *   part_cnt     - number of cache partitions to which files may be assigned
+ *                  via CM_fpartition() (0 <= part_cnt <= CM_PART_MAX); files
+ *                  not assigned share the default partition
+ *   part_min     - part_min[i] is the share of the cache reserved for
+ *                  partition i + 1, as a percentage of the cache size; the
+ *                  same share of the large data block slab is reserved
+ *   part_max     - part_max[i] is the maximum share of the cache occupied by
+ *                  partition i + 1, as a percentage of the cache size; the
+ *                  same share of the large data block slab may be occupied
+ *                  (0 <= part_min[i] <= part_max[i] <= 100, and the sum of
+ *                  part_min[] over all partitions is at most 100)
+ *
+ * Returns:
+ */
+
+#define CM_POLICY_SLRU  0
+#define CM_POLICY_ARC   1
+
+#define CM_PART_MAX     8
+
+struct CM_param{
+  long cache_sz;          /* cache size in number of data blocks */
+  pious_sizet dblk_sz;    /* data block size in bytes */
+  long sm_cnt;            /* small data block count */
+  pious_sizet sm_sz;      /* small data block size in bytes */
+  long lg_cnt;            /* large data block count */
+  pious_sizet lg_sz;      /* large data block size in bytes */
+  pious_offt lg_min;      /* large class minimum file size in bytes */
+  int prot_pct;           /* protected segment percentage of cache size */
+  int hugepage;           /* back cache with huge pages flag */
+  int direct;             /* bypass host file system cache flag */
+  long ra_max;            /* maximum readahead window in data blocks */
+  long lr_min;            /* minimum data block span of extent read */
+  int policy;             /* cache replacement policy */
+  int admit;              /* admission filter flag */
+  int writeback;          /* volatile write-back policy flag */
+  int wb_dirty_pct;       /* write-back dirty percentage of cache size */
+  long wb_age;            /* write-back dirty age in milliseconds */
+  int part_cnt;           /* cache partition count */
+  int part_min[CM_PART_MAX];  /* partition reserved percentage of cache */
+  int part_max[CM_PART_MAX];  /* partition maximum percentage of cache */
+};
+
+#ifdef __STDC__
+void CM_defparam(struct CM_param *param);
+#else
+void CM_defparam();
+#endif
+
+
+
+
+/*
+ * CM_init()
+ *
+ * Parameters:
+ *
+ *   param - cache configuration parameters
+ *
+ * Initialize the data block cache as specified by the configuration
+ * parameters 'param'; see CM_defparam() for a description of parameters.
+ * The data blocks are allocated as a single page-aligned arena.
+ *
+ * CM_init() is called at most once, prior to any other cache manager
+ * operation.  If CM_init() is not called, or fails, then the cache is
+ * initialized upon first access with the default configuration.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - cache initialized without error
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINVAL - invalid configuration parameter
+ *       PIOUS_EINSUF - insufficient system resources to allocate cache
+ *       PIOUS_EPERM  - cache previously initialized
+ */
+
+#ifdef __STDC__
+int CM_init(struct CM_param *param);
+#else
+int CM_init();
+#endif
+
+
+
+
 /*
  * CM_read()
  *
@@ -84,6 +235,82 @@ pious_ssizet CM_read();
 
 
 
+/*
+ * CM_readv()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   offset  - starting offset
+ *   nbyte   - byte count
+ *   iov     - I/O vector
+ *   iovcnt  - I/O vector entry count
+ *
+ * Read file 'fhandle' starting at 'offset' bytes from the beginning
+ * and proceeding for 'nbyte' bytes, as for CM_read().  Rather than copying
+ * data, place in I/O vector 'iov' references to the data in the cache;
+ * on entry 'iovcnt' is the number of entries in 'iov', and on successful
+ * return is the number of entries used.
+ *
+ * Cache entries referenced are pinned, and hence remain valid and unaltered,
+ * until CM_release() is called.  References from at most one CM_readv() may
+ * be outstanding, and MUST be released prior to calling CM_invalidate() or
+ * CM_finvalidate().
+ *
+ * Note: References are not available if the request spans more data blocks
+ *       than can be referenced, or is of sufficient size to be read by
+ *       extent (see CM_defparam()); the caller then reads via CM_read().
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes read and referenced in 'iov' (<= nbyte)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBUSY  - references not available; read via CM_read()
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - file offset or nbyte is not a proper value
+ *                      or exceeds SYSTEM constraints
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+struct FS_iovec;           /* see pfs/pfs.h */
+
+#ifdef __STDC__
+pious_ssizet CM_readv(pds_fhandlet fhandle,
+		      pious_offt offset,
+		      pious_sizet nbyte,
+		      struct FS_iovec *iov,
+		      int *iovcnt);
+#else
+pious_ssizet CM_readv();
+#endif
+
+
+
+
+/*
+ * CM_release()
+ *
+ * Parameters:
+ *
+ * Release all data block references returned by CM_readv().
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+void CM_release(void);
+#else
+void CM_release();
+#endif
+
+
+
+
 /*
  * CM_write()
  *
@@ -140,7 +367,9 @@ int CM_write();
  * Flush contents of entire cache to stable storage.
  *
  * Note: Only data written with a faultmode of PIOUS_STABLE is flushed
- *       to disk via synchronous writes.
+ *       to disk via synchronous writes.  Data written with a faultmode of
+ *       PIOUS_VOLATILE and cached under the write-back policy is written
+ *       to stable storage as for a volatile write-through.
  *
  * Returns:
  *
@@ -172,7 +401,9 @@ int CM_flush();
  * Flush all cache entries associated with file 'fhandle'.
  *
  * Note: Only data written with a faultmode of PIOUS_STABLE is flushed
- *       to disk via synchronous writes.
+ *       to disk via synchronous writes.  Data written with a faultmode of
+ *       PIOUS_VOLATILE and cached under the write-back policy is written
+ *       to stable storage as for a volatile write-through.
  *
  * Returns:
  *
@@ -194,6 +425,40 @@ int CM_fflush();
 
 
 
+/*
+ * CM_bgflush()
+ *
+ * Parameters:
+ *
+ * Perform background flushing of volatile data cached under the write-back
+ * policy.  Dirty volatile data blocks are written to stable storage, oldest
+ * first, while the amount of dirty volatile data exceeds the configured
+ * percentage of the cache or the oldest dirty volatile data block exceeds
+ * the configured age; at most a bounded number of blocks are written per
+ * call so that request service is not unduly delayed.
+ *
+ * CM_bgflush() is intended to be called periodically by the PDS daemon;
+ * if the write-back policy is not in effect then CM_bgflush() does nothing.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - background flush completed without error
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+int CM_bgflush(void);
+#else
+int CM_bgflush();
+#endif
+
+
+
+
 /*
  * CM_invalidate()
  *
@@ -242,3 +507,354 @@ void CM_finvalidate(pds_fhandlet fhandle);
 #else
 void CM_finvalidate();
 #endif
+
+
+
+
+/*
+ * CM_advise()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   offset  - starting offset
+ *   nbyte   - byte count; zero (0) specifies through end of file
+ *   advice  - expected access pattern
+ *
+ * Advise the cache manager of the expected pattern of access to file
+ * 'fhandle', starting at 'offset' bytes from the beginning and proceeding
+ * for 'nbyte' bytes.  Valid values of 'advice', defined in pious_std.h, are:
+ *
+ *   PIOUS_ADV_NORMAL     - no particular pattern; discard prior SEQUENTIAL,
+ *                          RANDOM, or NOREUSE advice for the file
+ *   PIOUS_ADV_SEQUENTIAL - file is read sequentially; open the readahead
+ *                          window fully on sequential access
+ *   PIOUS_ADV_RANDOM     - file is read randomly; do not read ahead
+ *   PIOUS_ADV_WILLNEED   - data will be accessed soon; load into cache,
+ *                          to at most half the probationary segment
+ *   PIOUS_ADV_DONTNEED   - data will not be accessed soon; flush dirty
+ *                          data blocks and discard from cache
+ *   PIOUS_ADV_NOREUSE    - file data is accessed once; data blocks are not
+ *                          promoted to the protected segment and are the
+ *                          first replaced
+ *
+ * SEQUENTIAL, RANDOM, and NOREUSE advice applies to the file as a whole and
+ * is retained, for as many files as the stable storage manager retains file
+ * information, until superseded or the file is invalidated.  WILLNEED and
+ * DONTNEED advice applies to the data blocks spanned by the range at the
+ * time of the call.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - advice successfully applied
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINVAL - 'offset', 'nbyte', or 'advice' is not a proper value
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+int CM_advise(pds_fhandlet fhandle,
+	      pious_offt offset,
+	      pious_sizet nbyte,
+	      int advice);
+#else
+int CM_advise();
+#endif
+
+
+
+
+/*
+ * CM_fpartition()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   part    - cache partition
+ *
+ * Assign file 'fhandle' to cache partition 'part', where
+ * 1 <= part <= part_cnt (see CM_defparam()), or to the default partition
+ * if 'part' is zero (0).
+ *
+ * Each cached data block is charged to the partition to which its file is
+ * assigned when the block is cached.  A data block allocated for a
+ * partition at its maximum share replaces a data block of the same
+ * partition, and data blocks of a partition at or below its reserved share
+ * are not replaced on behalf of other partitions.  A data block that can not
+ * be cached within these constraints is read or written without caching.
+ * Data blocks of a partition at its maximum share are not promoted to the
+ * protected segment.  Large data blocks are charged and constrained likewise,
+ * by shares of the large data block slab.
+ *
+ * Assignments are retained for as many files as the stable storage manager
+ * retains file information, beyond which the least recently accessed revert
+ * to the default partition; assignments are thus best renewed whenever a
+ * file is opened.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - file successfully assigned
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINVAL - 'part' is not a proper value
+ */
+
+#ifdef __STDC__
+int CM_fpartition(pds_fhandlet fhandle,
+		  int part);
+#else
+int CM_fpartition();
+#endif
+
+
+
+
+/*
+ * CM_fclass()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   large   - large data block class hint; TRUE/FALSE
+ *
+ * Assign file 'fhandle' a data block class: the large data block class if
+ * 'large' is TRUE, or if the file is at least lg_min bytes (see
+ * CM_defparam()), and the standard class otherwise.
+ *
+ * The data of a large class file is cached only in large data blocks, each
+ * loaded with a single stable storage read, and writes are written through
+ * to stable storage.  Large data blocks are subject to the admission filter
+ * and to cache partitions as are data blocks, but not to readahead or reads
+ * by extent.  A file entering the large class is flushed and its
+ * cached data blocks invalidated; a file leaving it has its large data
+ * blocks discarded.  If the large data block slab is off then all files are
+ * of the standard class.
+ *
+ * Assignments are retained for as many files as the stable storage manager
+ * retains file information, beyond which the least recently accessed revert
+ * to the standard class; as the file size is that at the time of the call,
+ * assignments are best renewed whenever a file is opened.
+ *
+ * NOTE: references returned by CM_readv() MUST be released prior to calling
+ *       CM_fclass().
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - file successfully assigned
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EINSUF - insufficient system resources to complete
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_ERECOV - recovery required
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+int CM_fclass(pds_fhandlet fhandle,
+	      int large);
+#else
+int CM_fclass();
+#endif
+
+
+
+
+/*
+ * CM_warmsave()
+ *
+ * Parameters:
+ *
+ * Record the data blocks cached in the protected segment in the cache
+ * warm-up manifest (see SS_warmsave()), such that the cache may be warmed
+ * via CM_warmload() and CM_warmup() when the PDS is next started.
+ *
+ * CM_warmsave() is intended to be called by the PDS daemon at shutdown or
+ * reset, after the cache is flushed.  The cache is not altered.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - manifest written
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINSUF - insufficient system resources to complete
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+int CM_warmsave(void);
+#else
+int CM_warmsave();
+#endif
+
+
+
+
+/*
+ * CM_warmload()
+ *
+ * Parameters:
+ *
+ * Read the cache warm-up manifest (see SS_warmload()) recorded by
+ * CM_warmsave(), retaining at most as many data blocks as the protected
+ * segment holds.  The data blocks are loaded into the cache by subsequent
+ * calls to CM_warmup().
+ *
+ * Note: the manifest is ignored if it was recorded for a different data
+ *       block size; warm-up is advisory and errors are not reported.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of data blocks pending warm-up
+ */
+
+#ifdef __STDC__
+long CM_warmload(void);
+#else
+long CM_warmload();
+#endif
+
+
+
+
+/*
+ * CM_warmup()
+ *
+ * Parameters:
+ *
+ * Load into the cache the next run of data blocks pending warm-up, reading
+ * at most a bounded number of contiguous data blocks of a single file such
+ * that request service is not unduly delayed.  Data blocks are loaded in
+ * file order and placed in the protected segment; data blocks already
+ * cached are not altered.
+ *
+ * CM_warmup() is intended to be called by the PDS daemon when idle, until
+ * no data blocks remain pending.  Any pending warm-up is discarded by
+ * CM_invalidate().
+ *
+ * Note: warm-up is advisory; errors are ignored.
+ *
+ * Returns:
+ *
+ *   TRUE  - data blocks remain pending warm-up
+ *   FALSE - warm-up complete
+ */
+
+#ifdef __STDC__
+int CM_warmup(void);
+#else
+int CM_warmup();
+#endif
+
+
+
+
+/*
+ * CM_stats()
+ *
+ * Parameters:
+ *
+ *   stats - cache statistics
+ *
+ * Obtain statistics describing cache configuration, state, and activity
+ * since initialization; results are placed in 'stats'.  The cache is not
+ * altered.
+ *
+ * Read references are counted as: hits in the protected or probationary
+ * segment; hits on data blocks loaded by readahead and not previously
+ * referenced; hits on small data blocks; and misses.  Data blocks placed
+ * in small data blocks, and data blocks read by extent without caching, are
+ * counted separately (see CM_defparam()).  Data blocks read but not
+ * admitted by the admission filter are counted as misses, or readahead
+ * hits, and as not admitted.  Reads of large data block class files are
+ * counted apart, as large data block hits and large data blocks loaded;
+ * large data blocks loaded but not admitted are also counted as not
+ * admitted.
+ *
+ * The cached data block count and the reserved and maximum data block
+ * counts of each cache partition are reported, along with the cached large
+ * data block count, where element zero (0) is the default partition.  Data
+ * blocks, and large data blocks, accessed without caching, as no entry
+ * could be replaced within partition shares, are counted as partition
+ * bypasses.
+ *
+ * The files with the most cached data blocks, up to CM_STAT_TOPN, are listed
+ * in order of decreasing cached data block count.
+ *
+ * Returns:
+ */
+
+#define CM_STAT_TOPN  8
+
+struct CM_fstats{
+  pds_fhandlet fhandle;       /* file handle */
+  long nblk;                  /* cached data blocks */
+  long ndirty;                /* dirty cached data blocks */
+};
+
+struct CM_stats{
+  /* configuration and state */
+  long cache_sz;              /* cache size in data blocks */
+  long dblk_sz;               /* data block size in bytes */
+  long sm_cnt;                /* small data block count */
+  long sm_sz;                 /* small data block size in bytes */
+  long lg_cnt;                /* large data block count */
+  long lg_sz;                 /* large data block size in bytes */
+  int policy;                 /* cache replacement policy */
+  int admit;                  /* admission filter flag */
+  int writeback;              /* volatile write-back policy flag */
+  long prot_sz;               /* protected segment size */
+  long prot_target;           /* protected segment target size */
+  long nvalid;                /* valid cached data blocks */
+  long ndirty;                /* dirty cached data blocks */
+  long wb_ndirty;             /* dirty volatile write-back data blocks */
+  long sm_nvalid;             /* valid small data blocks */
+  long lg_nvalid;             /* valid large data blocks */
+
+  /* read references */
+  unsigned long hit_pt;       /* protected segment hits */
+  unsigned long hit_pb;       /* probationary segment hits */
+  unsigned long hit_ra;       /* readahead data block hits */
+  unsigned long hit_sm;       /* small data block hits */
+  unsigned long hit_lg;       /* large data block hits */
+  unsigned long miss;         /* misses */
+  unsigned long ra_blks;      /* data blocks loaded by readahead */
+  unsigned long sm_blks;      /* data blocks placed in small data blocks */
+  unsigned long lg_blks;      /* large data blocks loaded */
+  unsigned long lr_blks;      /* data blocks read by extent without caching */
+  unsigned long eof_hit;      /* incomplete data block hits served, EOF known */
+  unsigned long eof_reload;   /* incomplete data block hits re-read */
+  unsigned long warm_blks;    /* data blocks loaded by warm-up */
+  unsigned long adm_reject;   /* missed data blocks not admitted */
+
+  /* replacement */
+  unsigned long evict;        /* valid data blocks replaced */
+  unsigned long evict_dirty;  /* dirty data blocks flushed to be replaced */
+  unsigned long part_bypass;  /* data blocks not cached; partition shares */
+
+  /* flush */
+  unsigned long flush_ops;    /* stable storage writes to flush */
+  unsigned long flush_blks;   /* data blocks flushed */
+  unsigned long flush_bytes;  /* bytes flushed */
+
+  /* partitions; element 0 is the default partition */
+  int part_cnt;                       /* cache partition count */
+  long part_nblk[CM_PART_MAX + 1];    /* cached data blocks */
+  long part_min[CM_PART_MAX + 1];     /* reserved data blocks */
+  long part_max[CM_PART_MAX + 1];     /* maximum data blocks */
+  long part_lgnblk[CM_PART_MAX + 1];  /* cached large data blocks */
+
+  /* per-file */
+  int nfile;                  /* files listed */
+  struct CM_fstats file[CM_STAT_TOPN];
+};
+
+#ifdef __STDC__
+void CM_stats(struct CM_stats *stats);
+#else
+void CM_stats();
+#endif
@@ -44,10 +44,15 @@
  *   2PL scheduling constraint: Conflicting lock requests for overlapping
  *     data regions are satisfied in the order received.
  *
+ *   Deadlock detection constraint: When a blocked lock request completes a
+ *     cycle in the local wait-for graph, the transaction Ti in the cycle
+ *     with the greatest transaction id i is aborted.
+ *
  *   Deadlock avoidance/recovery constraint: A transaction Ti is aborted when
  *     an associated lock request has been delayed for longer than the timeout
  *     period if and only if there exists an active transaction Tj (known
- *     to this PDS) such that i > j.
+ *     to this PDS) such that i > j.  This time-out recovers from deadlocks
+ *     that span data servers, which are not locally detectable.
  *
  *
  * NOTE:
@@ -77,6 +82,8 @@
  * PDS_chmod();
  * PDS_stat();
  * PDS_ping();
+ * PDS_cachestat();
+ * PDS_advise();
  * PDS_reset();
  * PDS_shutdown();
  *
@@ -84,16 +91,22 @@
  * ----------------------------------------------------------------------------
  * Implementation Notes:
  *
- *   1) The method of scanning/re-trying blocked operations after freeing
- *      locks, as performed in the main server loop, is inherently inefficient.
- *      A really efficient implementation will share state between the
- *      pds_lock_manager and the pds_daemon, allowing the lock manager to
- *      unblock operations as locks are released.
+ *   1) Blocked transaction operations queue their lock request with the
+ *      pds_lock_manager, which wakes requests as locks are released in the
+ *      order received; only woken operations are re-tried after freeing
+ *      locks.  Should the lock manager be unable to queue a request, all
+ *      blocked transaction operations are scanned/re-tried until no such
+ *      operation remains.  Blocked control operations, which are rare, are
+ *      always scanned/re-tried after freeing locks.
+ *
+ *      A queued lock request is checked for deadlock, via the lock manager's
+ *      wait-for graph, when queued; victims are aborted immediately, rather
+ *      than upon time-out, by abort_victims().
  *
- *   2) Neither recovery nor checkpointing is implemented, allowing only
- *      volatile transactions to be properly executed.  Stable transactions
- *      can be executed for benchmarking purposes, as logging does take
- *      place, but are not recoverable in the event of a system failure.
+ *   2) Recovery is performed when the PDS starts, and the transaction log
+ *      is checkpointed by log_checkpoint() once it reaches a size limit and
+ *      no transaction is prepared.  Dynamic recovery, i.e. without
+ *      restarting the PDS, is not implemented.
  *
  *   3) The function PDS_fa_sint() avoids the heterogeneity problem by
  *      operating on files that are treated as arrays of integers, with
@@ -191,6 +204,7 @@
 #include "pious_sysconfig.h"
 
 #include "psys.h"
+#include "pfs.h"
 
 #include "pds_transidt.h"
 #include "pds_fhandlet.h"
@@ -201,6 +215,7 @@
 
 #include "pds_sstorage_manager.h"
 #include "pds_data_manager.h"
+#include "pds_recovery_manager.h"
 #include "pds_cache_manager.h"
 #include "pds_lock_manager.h"
 #include "pds.h"
@@ -220,6 +235,12 @@
 /* Transaction Id hash table size; choose prime not near a power of 2 */
 #define TI_TABLE_SZ 103
 
+/* Maximum number of data block references in a read reply */
+#define READ_IOV_MAX 64
+
+/* Maximum number of path prefixes hinting the large data block class */
+#define LARGE_PREFIX_MAX 8
+
 
 #ifdef PDSPROFILE
 /* Transaction profile file name */
@@ -280,12 +301,15 @@ typedef struct trans_entry{
   int writelk;                         /* transaction write lock flag */
   int readonly;                        /* transaction read-only flag */
   int prepared;                        /* transaction prepared flag */
+  int lkqueued;                        /* blocked op. lock request queued */
+  int dlcheck;                         /* blocked op. completed a deadlock */
   req_infot transop_req;               /* transaction op. request - current */
   reply_infot transop_reply;           /* transaction op. reply   - last */
   struct trans_entry *tblnext;         /* next entry in transaction table */
   struct trans_entry *tblprev;         /* prev entry in transaction table */
   struct trans_entry *tinext;          /* next entry in transid hash chain */
   struct trans_entry *tiprev;          /* prev entry in transid hash chain */
+  struct trans_entry *gcnext;          /* next entry awaiting log sync */
 
 #ifdef PDSPROFILE
   unsigned long prof_opcum;            /* transaction op. cumulative time */
@@ -334,6 +358,11 @@ static struct {
 static trans_entryt *ti_table[TI_TABLE_SZ];
 
 
+/* Read Reply I/O Vectors - for replying with data referenced in cache */
+static struct FS_iovec read_iov[READ_IOV_MAX];
+static struct DCE_iovec read_dceiov[READ_IOV_MAX];
+
+
 /* Blocked Control Operation Table */
 static struct {
   cntrl_entryt *block_head;
@@ -341,6 +370,54 @@ static struct {
 } cntrltable;
 
 
+/* Cache Partition Table - file path prefix selecting each cache partition;
+ *                         part_prefix[i] selects partition i + 1.
+ */
+static char *part_prefix[CM_PART_MAX];
+static int part_cnt;
+
+
+/* Large Class Table - file path prefixes hinting the large data block class */
+static char *large_prefix[LARGE_PREFIX_MAX];
+static int large_cnt;
+
+
+/* Group Commit - transactions that have prepared, in order, with prepare
+ *                reply deferred until their log records are forced; see
+ *                gc_defer() and gc_flush().
+ */
+static trans_entryt *gc_head, *gc_tail;
+static int gc_cnt;
+static util_clockt gc_timer;           /* time first transaction deferred */
+static long gc_wait = PDS_GC_WAIT;     /* group commit window (msec) */
+static int gc_max   = PDS_GC_MAX;      /* group size limit */
+
+
+/* Log Checkpoint - count of prepared transactions, and transaction log size
+ *                  at which the log is checkpointed; see log_checkpoint().
+ */
+static int prep_cnt;
+static pious_offt ckpt_sz = PDS_CKPT_SZ;
+
+
+/* Blocked Transaction Operations - count of those whose lock request could
+ *                                  not be queued with the lock manager;
+ *                                  see block_transop().
+ */
+static int blk_unqueued;
+
+
+/* Deadlock Detection - flag that some blocked transaction operation has
+ *                      completed a cycle in the wait-for graph; see
+ *                      block_transop() and abort_victims().
+ */
+static int dl_pending;
+
+
+/* Transaction Abort Counts - by cause; reported via PDS_cachestat() */
+static struct PDS_abortstats abortcnt;
+
+
 #ifdef PDSPROFILE
 /* Transaction profile file stream pointer and timer clock */
 static FILE *prof_stream;
@@ -380,6 +457,10 @@ static int PDS_stat_(req_infot *request);
 
 static int PDS_ping_(req_infot *request);
 
+static int PDS_cachestat_(req_infot *request);
+
+static int PDS_advise_(req_infot *request);
+
 static int PDS_reset_(req_infot *request);
 
 static void PDS_shutdown_(req_infot *request);
@@ -401,6 +482,10 @@ static void do_transop(trans_entryt *transrec);
 
 static void retry_blk_transop(void);
 
+static void abort_victims(void);
+
+static int abort_blk_transop(trans_entryt *transrec);
+
 static void PDS_read_(trans_entryt *transrec);
 
 static void PDS_write_(trans_entryt *transrec);
@@ -417,6 +502,16 @@ static void PDS_commit_(trans_entryt *transrec);
 
 static void PDS_abort_(trans_entryt *transrec);
 
+static void prepare_reply(trans_entryt *transrec);
+
+static void gc_defer(trans_entryt *transrec);
+
+static int gc_flush(void);
+
+static void gc_remove(trans_entryt *transrec);
+
+static void log_checkpoint(void);
+
 static int init_transreq(req_infot *request,
 			 trans_entryt **transrec);
 
@@ -438,6 +533,18 @@ static void transreq_dealloc(req_infot *request);
 
 static void transreply_dealloc(reply_infot *reply);
 
+static int transreply_restore(trans_entryt *transrec);
+
+static int parse_options(char *optstr,
+			 struct CM_param *cmparam);
+
+static int parse_partition(char *value,
+			   struct CM_param *cmparam);
+
+static int part_match(char *path);
+
+static int large_match(char *path);
+
 #ifdef PDSPROFILE
 static void prof_init(char *logpath);
 static void prof_print(trans_entryt *transrec);
@@ -470,6 +577,10 @@ static int PDS_stat_();
 
 static int PDS_ping_();
 
+static int PDS_cachestat_();
+
+static int PDS_advise_();
+
 static int PDS_reset_();
 
 static void PDS_shutdown_();
@@ -489,6 +600,8 @@ static void cntrlreq_dealloc();
 static void do_transop();
 
 static void retry_blk_transop();
+static void abort_victims();
+static int abort_blk_transop();
 
 static void PDS_read_();
 
@@ -506,6 +619,16 @@ static void PDS_commit_();
 
 static void PDS_abort_();
 
+static void prepare_reply();
+
+static void gc_defer();
+
+static int gc_flush();
+
+static void gc_remove();
+
+static void log_checkpoint();
+
 static int init_transreq();
 
 static void complete_transop();
@@ -524,6 +647,16 @@ static void transreq_dealloc();
 
 static void transreply_dealloc();
 
+static int transreply_restore();
+
+static int parse_options();
+
+static int parse_partition();
+
+static int part_match();
+
+static int large_match();
+
 #ifdef PDSPROFILE
 static void prof_init();
 static void prof_print();
@@ -542,6 +675,15 @@ static void prof_print();
  * Parameters:
  *
  *   logpath - PDS host log directory path
+ *   options - PDS start-up option list (optional)
+ *
+ * The start-up option list is a comma separated list of 'name=value'
+ * settings, as passed through from the PSC configuration file; e.g.
+ *
+ *   cachesz=262144,blksz=64k,protpct=80,ramax=64,hugepage,direct,writeback
+ *
+ * See parse_options() for recognized options.  Options that are not
+ * specified take the default values defined in config/pious_sysconfig.h.
  *
  * Returns:
  */
@@ -562,6 +704,9 @@ int main(argc, argv)
   util_clockt deadlock_timer;
   pds_transidt min_transid;
   int transtimedout;
+  int warming, idle, timeout;
+  long elapsed;
+  struct CM_param cmparam;
 
 
   /* The following global stable storage flags are exported by the stable
@@ -594,15 +739,45 @@ int main(argc, argv)
 
   /* Initialize Stable Storage Manager */
 
-  if (SS_init(logpath) == PIOUS_ERECOV)
-    { /* stable storage recovery required; not currently implemented */
-      SS_errlog("pds_daemon", "main()", PIOUS_EFATAL,
-		"stable storage recovery required; not implemented");
+  if (SS_init(logpath) == PIOUS_ERECOV &&
+      (rcode = RM_recover()) != PIOUS_OK)
+    { /* stable storage recovery required; unable to recover */
+      SS_errlog("pds_daemon", "main()", rcode,
+		"stable storage recovery failed");
 
       SS_fatalerror = TRUE;
     }
 
 
+  /* Initialize Cache Manager as specified by start-up options */
+
+  CM_defparam(&cmparam);
+
+  if (argc > 2 && parse_options(argv[2], &cmparam) != PIOUS_OK)
+    { /* invalid option list; cache initialized with defaults on first use */
+      SS_errlog("pds_daemon", "main()", PIOUS_EINVAL,
+		"invalid start-up option list; using defaults");
+    }
+
+  else if ((rcode = CM_init(&cmparam)) != PIOUS_OK)
+    { /* unable to configure cache; cache initialized with defaults */
+      SS_errlog("pds_daemon", "main()", rcode,
+		"unable to allocate cache as specified; using defaults");
+    }
+
+
+  /* Read cache warm-up manifest recorded at last shutdown or reset; data
+   * blocks are loaded when the PDS is otherwise idle.
+   */
+
+  warming = (CM_warmload() > 0);
+
+
+  /* Defer log synchronization at prepare if group commit is enabled */
+
+  RM_logdefer(gc_wait > 0);
+
+
   /* Start deadlock avoidance interval timer */
 
   UTIL_clock_mark(&deadlock_timer);
@@ -611,14 +786,26 @@ int main(argc, argv)
   /* Service Client Requests */
 
   while (!SS_fatalerror)
-    { /* receive client request */
+    { /* receive client request; while transactions await a log sync, wait
+       * no longer than the remainder of the group commit window.
+       */
+      timeout = (warming ? 0 : (PDS_TDEADLOCK / 2));
+
+      if (gc_cnt > 0)
+	{
+	  elapsed = (long)UTIL_clock_delta(&gc_timer, UTIL_MSEC);
+	  timeout = (int)Max(0, Min((long)timeout, gc_wait - elapsed));
+	}
+
       do
 	rcode = PDSMSG_req_recv(&request.clientid,
 				&request.reqop,
 				&request.reqmsg,
-				(PDS_TDEADLOCK / 2));
+				timeout);
       while (rcode != PIOUS_OK && rcode != PIOUS_ETIMEOUT);
 
+      idle = (rcode == PIOUS_ETIMEOUT);
+
       /* perform requested transaction or control operation */
 
       if (rcode == PIOUS_OK)
@@ -669,15 +856,16 @@ int main(argc, argv)
 		  do_transop(transrec);
 
 		  /* if requested operation released locks, then scan the
-		   * control and transaction operation tables for blocked
-		   * operations that can now be performed and do them.
+		   * control operation table for blocked operations that can
+		   * now be performed, and re-try transaction operations woken
+		   * by the lock manager, and do them.
 		   *
 		   * blocked control operations are scanned first since
 		   * control ops do not hold locks over multiple requests.
 		   *
 		   * only PDS_prepare(), PDS_commit(), and PDS_abort() release
 		   * locks; since these operations are NEVER blocked, a single
-		   * scan of the control and transaction tables is sufficient.
+		   * scan/re-try of blocked operations is sufficient.
 		   */
 
 		  if (request.reqop == PDS_PREPARE_OP ||
@@ -687,7 +875,7 @@ int main(argc, argv)
 		      /* scan blocked control operations */
 		      retry_blk_cntrlop();
 
-		      /* scan blocked transaction operations */
+		      /* re-try woken blocked transaction operations */
 		      retry_blk_transop();
 		    }
 		}
@@ -695,6 +883,49 @@ int main(argc, argv)
 	}
 
 
+      /* force log records of transactions awaiting a log sync, replying to
+       * prepare requests, once the group commit window has expired or the
+       * group is full.  if log records could not be forced then locks were
+       * released; re-try blocked operations as for PDS_prepare().
+       */
+
+      if (gc_cnt > 0 &&
+	  (gc_cnt >= gc_max ||
+	   UTIL_clock_delta(&gc_timer, UTIL_MSEC) >= gc_wait) &&
+	  gc_flush())
+	{
+	  /* scan blocked control operations */
+	  retry_blk_cntrlop();
+
+	  /* re-try woken blocked transaction operations */
+	  retry_blk_transop();
+	}
+
+
+      /* abort victims of deadlocks detected on blocking an operation */
+
+      if (dl_pending)
+	abort_victims();
+
+
+      /* checkpoint the transaction log once it reaches ckpt_sz bytes and no
+       * transaction is prepared or awaiting a log sync.  should the log
+       * reach four times ckpt_sz first, or be unable to grow, then prepare
+       * requests vote to abort (SS_checkpoint) until the checkpoint is taken.
+       * the log can not be checkpointed while transactions left in doubt by
+       * recovery are retained in it.
+       */
+
+      if (!SS_fatalerror && !SS_recover && RM_indoubt() == 0 &&
+	  (SS_checkpoint || RM_logsize() >= ckpt_sz))
+	{
+	  if (prep_cnt == 0 && gc_cnt == 0)
+	    log_checkpoint();
+	  else if (RM_logsize() >= 4 * ckpt_sz)
+	    SS_checkpoint = TRUE;
+	}
+
+
       /* all transaction/control ops that can be performed are now complete */
 
 
@@ -724,19 +955,18 @@ int main(argc, argv)
 
 	  /* case: SS_checkpoint - dynamic checkpoint required
 	   *
-	   *   1) continue operation under following rules:
-	   *        a) respond to all prepare requests with PIOUS_EABORT.
-	   *        b) continue in this mode until no transactions are
-	   *           prepared, then proceed to step 2).
-	   *   2) flush and invalidate cache.
-	   *   3) truncate transaction log.
-	   *   4) continue operation.
+	   *   operation continues, with prepare requests voting to abort,
+	   *   until no transactions are prepared; the checkpoint is then
+	   *   taken as above.  however, transactions left in doubt by
+	   *   recovery must be retained in the log, which can not then be
+	   *   truncated; checkpointing such a log is not implemented.
 	   */
 
-	  else if (SS_checkpoint)
+	  else if (SS_checkpoint && RM_indoubt() > 0)
 	    {
 	      SS_errlog("pds_daemon", "main()", PIOUS_EFATAL,
-			"stable storage checkpoint required; not implemented");
+			"stable storage checkpoint required with in-doubt "
+			"transactions; not implemented");
 
 	      SS_fatalerror = TRUE;
 	    }
@@ -744,7 +974,9 @@ int main(argc, argv)
 	  /* case: !SS_recover && !SS_checkpoint - deadlock/postponement check
 	   *
 	   *   Perform transaction operation deadlock avoidance/recovery and
-           *   control operation indefinite-postponement recovery.
+           *   control operation indefinite-postponement recovery.  Local
+	   *   deadlocks are detected on blocking; this time-out recovers
+	   *   from deadlocks spanning data servers.
 	   *
 	   *   1) complete "old" blocked transaction operations, responding
 	   *      with PIOUS_EABORT; abort same transactions, which are
@@ -802,23 +1034,10 @@ int main(argc, argv)
 		  if (UTIL_clock_delta(&(transrec->transop_req.tstamp),
 				       UTIL_MSEC) >= PDS_TDEADLOCK &&
 		      transid_gt(transrec->transid, min_transid))
-		    { /* issue abort to data manager */
-		      if (DM_abort(transrec->transid) != PIOUS_EFATAL)
+		    { /* abort; flag that transaction was timed-out */
+		      if (abort_blk_transop(transrec))
 			{
-			  /* free ALL locks held by the transaction */
-			  if (transrec->readlk)
-			    LM_rfree(transrec->transid);
-
-			  if (transrec->writelk)
-			    LM_wfree(transrec->transid);
-
-			  /* reply to client */
-			  transreq_ack(&(transrec->transop_req), PIOUS_EABORT);
-
-			  /* remove transaction from transaction table */
-			  rm_transrec(transrec);
-
-			  /* flag that transaction was timed-out */
+			  abortcnt.timeout++;
 			  transtimedout = TRUE;
 			}
 		    }
@@ -848,23 +1067,28 @@ int main(argc, argv)
 		}
 
 	      /* if any transaction timed-out and was aborted, then scan the
-	       * control and transaction operation tables for blocked
-	       * operations that can now be performed and do them.
+	       * control operation table for blocked operations that can now
+	       * be performed, and re-try transaction operations woken by the
+	       * lock manager, and do them.
 	       *
 	       * blocked control operations are scanned first since
 	       * control ops do not hold locks over multiple requests.
 	       *
 	       * only PDS_prepare(), PDS_commit(), and PDS_abort() release
 	       * locks; since these operations are NEVER blocked, a single
-	       * scan of the control and transaction tables is sufficient.
+	       * scan/re-try of blocked operations is sufficient.
 	       */
 
 	      if (transtimedout)
 		{ /* scan blocked control operations */
 		  retry_blk_cntrlop();
 
-		  /* scan blocked transaction operations */
+		  /* re-try woken blocked transaction operations */
 		  retry_blk_transop();
+
+		  /* abort victims of deadlocks detected in re-try */
+		  if (dl_pending)
+		    abort_victims();
 		}
 
 
@@ -872,6 +1096,27 @@ int main(argc, argv)
 
 	      UTIL_clock_mark(&deadlock_timer);
 	    }
+
+
+	  /* background flush of volatile data cached under a write-back
+	   * policy; performed at least every (PDS_TDEADLOCK / 2) msec, as
+	   * bounded by the request receive time-out.  blocks that can not be
+	   * flushed remain dirty and are retried on a subsequent iteration;
+	   * fatal errors are reflected in SS_fatalerror.
+	   */
+
+	  if (!SS_recover && !SS_checkpoint)
+	    CM_bgflush();
+
+
+	  /* cache warm-up; while data blocks are pending, requests are
+	   * polled for rather than awaited and a bounded run of data blocks
+	   * is loaded whenever no request is received, such that warm-up
+	   * does not delay request service.
+	   */
+
+	  if (warming && idle && !SS_recover && !SS_checkpoint)
+	    warming = CM_warmup();
 	}
     }
 
@@ -880,11 +1125,16 @@ int main(argc, argv)
 
   /* fatal error detected
    *
-   *   1) complete ALL blocked operations, responding with PIOUS_EFATAL.
+   *   1) complete ALL blocked operations, and prepare operations awaiting
+   *      a log sync, responding with PIOUS_EFATAL.
    *   2) do not initiate any new requests; respond to all new requests
    *      with PIOUS_EFATAL.
    */
 
+  /* complete prepare operations awaiting a log sync */
+  if (gc_cnt > 0)
+    gc_flush();
+
   /* complete blocked control operations */
   cntrlrec = cntrltable.block_head;
 
@@ -1013,6 +1263,12 @@ static int do_cntrlop(request)
     case PDS_PING_OP:
       rcode = PDS_ping_(request);
       break;
+    case PDS_CACHESTAT_OP:
+      rcode = PDS_cachestat_(request);
+      break;
+    case PDS_ADVISE_OP:
+      rcode = PDS_advise_(request);
+      break;
     case PDS_RESET_OP:
       rcode = PDS_reset_(request);
       break;
@@ -1146,6 +1402,17 @@ static int PDS_lookup_(request)
 	    /* truncated file; invalidate cache */
 	    CM_finvalidate(reply.LookupBody.fhandle);
 
+	  if (part_cnt > 0)
+	    /* assign file to cache partition selected by path prefix */
+	    CM_fpartition(reply.LookupBody.fhandle,
+			  part_match(request->reqmsg.LookupBody.path));
+
+	  /* assign file data block class, as hinted by path prefix or by
+	   * file size; class assignment is advisory
+	   */
+	  CM_fclass(reply.LookupBody.fhandle,
+		    large_match(request->reqmsg.LookupBody.path));
+
 	  /* determine file accessability */
 
 	  lcode = SS_faccess(reply.LookupBody.fhandle,
@@ -1726,6 +1993,90 @@ static int PDS_ping_(request)
 
 
 
+/*
+ * PDS_cachestat() - See pds.h for description.
+ */
+
+#ifdef __STDC__
+static int PDS_cachestat_(req_infot *request)
+#else
+static int PDS_cachestat_(request)
+     req_infot *request;
+#endif
+{
+  pdsmsg_replyt reply;
+
+  /* obtain cache and stable storage statistics; the cache is not altered */
+  CM_stats(&reply.CachestatBody.stats);
+
+  SS_stats(&reply.CachestatBody.ss_stats);
+
+  /* transaction abort counts */
+  reply.CachestatBody.abort_stats = abortcnt;
+
+  reply.CachestatHead.rcode  = PIOUS_OK;
+  reply.CachestatHead.cmsgid = request->reqmsg.CachestatHead.cmsgid;
+
+  /* reply to client; inability to send is equivalent to a lost message */
+  PDSMSG_reply_send(request->clientid, PDS_CACHESTAT_OP, &reply);
+
+  /* indicate completion of control operation */
+  return COMPLETED;
+}
+
+
+
+
+/*
+ * PDS_advise() - See pds.h for description.
+ */
+
+#ifdef __STDC__
+static int PDS_advise_(req_infot *request)
+#else
+static int PDS_advise_(request)
+     req_infot *request;
+#endif
+{
+  int acode;
+  pdsmsg_replyt reply;
+
+  /* apply advice to cache */
+  acode = CM_advise(request->reqmsg.AdviseBody.fhandle,
+		    request->reqmsg.AdviseBody.offset,
+		    request->reqmsg.AdviseBody.nbyte,
+		    request->reqmsg.AdviseBody.advice);
+
+  /* set result code. if the cache manager indicates that recovery
+   * is required, the main daemon loop will detect this via the global
+   * stable storage flag SS_recover and take action.
+   */
+
+  switch(acode)
+    {
+    case PIOUS_OK:
+    case PIOUS_EINVAL:
+    case PIOUS_EFATAL:
+      reply.AdviseHead.rcode = acode;
+      break;
+    default:
+      reply.AdviseHead.rcode = PIOUS_EUNXP;
+      break;
+    }
+
+  /* set control message id */
+  reply.AdviseHead.cmsgid = request->reqmsg.AdviseHead.cmsgid;
+
+  /* reply to client; inability to send is equivalent to a lost message */
+  PDSMSG_reply_send(request->clientid, PDS_ADVISE_OP, &reply);
+
+  /* indicate completion of control operation */
+  return COMPLETED;
+}
+
+
+
+
 /*
  * PDS_reset() - see pds.h for description
  */
@@ -1743,7 +2094,8 @@ static int PDS_reset_(request)
   /* determine if there are active transactions or blocked control ops */
 
   if (cntrltable.block_head != NULL ||
-      transtable.block_head != NULL || transtable.ready != NULL)
+      transtable.block_head != NULL || transtable.ready != NULL ||
+      RM_indoubt() > 0)
     reply.ResetHead.rcode = PIOUS_EBUSY;
 
   /* flush cache */
@@ -1763,13 +2115,18 @@ static int PDS_reset_(request)
 	reply.ResetHead.rcode = PIOUS_EUNXP;
     }
 
-  /* invalidate cache and truncate transaction log file */
+  /* record cache contents for warm-up, invalidate cache, and truncate
+   * transaction log file.  warm-up is advisory; a manifest that can not be
+   * recorded is not an error.
+   */
 
   else
     {
+      CM_warmsave();
+
       CM_invalidate();
 
-      fcode = SS_logtrunc();
+      fcode = RM_logtrunc();
 
       switch(fcode)
 	{
@@ -1814,6 +2171,10 @@ static void PDS_shutdown_(request)
   cntrl_entryt *cntrlrec;
 
 
+  /* complete prepare operations awaiting a log sync */
+  if (gc_cnt > 0)
+    gc_flush();
+
   /* complete blocked control operations */
   cntrlrec = cntrltable.block_head;
 
@@ -1853,7 +2214,8 @@ static void PDS_shutdown_(request)
    * performing a shutdown while a transaction is in the uncertainty
    * period (i.e. is prepared) is equivalent to a crash and thus the log
    * file must be retained to uphold the guarantee of fault-tolerance, since
-   * a prepared transaction is a "stable" transaction (see pds.h).
+   * a prepared transaction is a "stable" transaction (see pds.h).  the
+   * same holds for transactions left in doubt by recovery (RM_indoubt()).
    *
    * however, shutting down with active but un-prepared transactions allows
    * the log file to be truncated without violating semantics since no
@@ -1863,18 +2225,21 @@ static void PDS_shutdown_(request)
 
   else
     {
+      /* record cache contents for warm-up on restart; advisory */
+      CM_warmsave();
+
       transrec = transtable.ready;
 
       while (transrec != NULL && transrec->prepared == FALSE)
 	transrec = transrec->tblnext;
 
-      if (transrec != NULL)
-	/* found a prepared transaction */
+      if (transrec != NULL || RM_indoubt() > 0)
+	/* found a prepared or in-doubt transaction */
 	reply.ShutdownHead.rcode = PIOUS_EUNXP;
 
       else
 	{ /* NO prepared transactions; truncate transaction log */
-	  fcode = SS_logtrunc();
+	  fcode = RM_logtrunc();
 
 	  switch(fcode)
 	    {
@@ -2195,8 +2560,10 @@ static void do_transop(transrec)
  *
  * Parameters:
  *
- * Scan the transaction table for blocked operations that can now be
- * performed and do them.
+ * Re-try blocked transaction operations woken by the lock manager, in the
+ * order woken, and do them.  If any blocked operation could not queue its
+ * lock request with the lock manager, first scan the transaction table for
+ * blocked operations that can now be performed and do them.
  *
  * NOTE: Will not attempt further operations if any operation generates a
  *       SS_fatalerror, SS_recover, or SS_checkpoint flag.
@@ -2211,9 +2578,13 @@ static void retry_blk_transop()
 #endif
 {
   trans_entryt *transrec, *transrec_next;
+  pds_transidt transid;
 
-  /* scan blocked transaction operations */
-  transrec = transtable.block_head;
+  /* scan blocked transaction operations if not all are queued */
+  if (blk_unqueued > 0)
+    transrec = transtable.block_head;
+  else
+    transrec = NULL;
 
   while (transrec != NULL &&
 	 !SS_fatalerror && !SS_recover && !SS_checkpoint)
@@ -2227,6 +2598,155 @@ static void retry_blk_transop()
 
       transrec = transrec_next;
     }
+
+  /* re-try woken transaction operations; an operation re-tried above has
+   * either completed, dequeuing its lock request, or blocked again,
+   * re-queueing its lock request as not woken.
+   */
+  while (!SS_fatalerror && !SS_recover && !SS_checkpoint &&
+	 LM_woken(&transid))
+    {
+      transrec = ti_lookup(transid, NOINSERT);
+
+      if (transrec != NULL && transrec->transop_state == BLOCKED)
+	do_transop(transrec);
+    }
+}
+
+
+
+
+/*
+ * abort_victims()
+ *
+ * Parameters:
+ *
+ * For each blocked transaction operation whose lock request completed a
+ * cycle in the wait-for graph, abort the victim selected by the lock manager
+ * until the operation is no longer deadlocked; then re-try woken blocked
+ * operations, and repeat for any deadlocks detected in re-trying them.
+ *
+ * Victims are necessarily blocked, and hence not prepared, as a transaction
+ * in a cycle has a lock request queued.
+ *
+ * NOTE: Will not attempt further operations if any operation generates a
+ *       SS_fatalerror, SS_recover, or SS_checkpoint flag.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void abort_victims(void)
+#else
+static void abort_victims()
+#endif
+{
+  int aborted, deadlocked;
+  trans_entryt *transrec, *victrec;
+  pds_transidt victim;
+
+  while (dl_pending && !SS_fatalerror && !SS_recover && !SS_checkpoint)
+    {
+      dl_pending = FALSE;
+      aborted    = FALSE;
+
+      transrec = transtable.block_head;
+
+      while (transrec != NULL && !SS_fatalerror)
+	if (!transrec->dlcheck)
+	  transrec = transrec->tblnext;
+
+	else
+	  { /* abort victims until operation is not deadlocked */
+	    transrec->dlcheck = FALSE;
+
+	    do
+	      {
+		deadlocked = FALSE;
+
+		if (LM_deadlock(transrec->transid, &victim))
+		  {
+		    victrec = ti_lookup(victim, NOINSERT);
+
+		    if (victrec != NULL && victrec->transop_state == BLOCKED &&
+			abort_blk_transop(victrec))
+		      {
+			abortcnt.deadlock++;
+			aborted = TRUE;
+
+			deadlocked = (victrec != transrec);
+		      }
+		  }
+	      }
+	    while (deadlocked);
+
+	    /* re-start scan, as aborting removes from the blocked list */
+	    transrec = transtable.block_head;
+	  }
+
+      /* if any transaction aborted, re-try blocked operations */
+      if (aborted)
+	{ /* scan blocked control operations */
+	  retry_blk_cntrlop();
+
+	  /* re-try woken blocked transaction operations */
+	  retry_blk_transop();
+	}
+    }
+}
+
+
+
+
+/*
+ * abort_blk_transop()
+ *
+ * Parameters:
+ *
+ *   transrec - transaction table record
+ *
+ * Abort blocked transaction operation 'transrec', and hence the transaction;
+ * free all locks held, reply to client with PIOUS_EABORT, and remove the
+ * transaction from the transaction table.  The transaction is not removed
+ * if the data manager abort results in a fatal error.
+ *
+ * Returns:
+ *
+ *   TRUE  (1) - transaction aborted
+ *   FALSE (0) - transaction not aborted; SS_fatalerror is set
+ */
+
+#ifdef __STDC__
+static int abort_blk_transop(trans_entryt *transrec)
+#else
+static int abort_blk_transop(transrec)
+     trans_entryt *transrec;
+#endif
+{
+  int aborted;
+
+  aborted = FALSE;
+
+  /* issue abort to data manager */
+  if (DM_abort(transrec->transid) != PIOUS_EFATAL)
+    {
+      /* free ALL locks held by the transaction */
+      if (transrec->readlk)
+	LM_rfree(transrec->transid);
+
+      if (transrec->writelk)
+	LM_wfree(transrec->transid);
+
+      /* reply to client */
+      transreq_ack(&(transrec->transop_req), PIOUS_EABORT);
+
+      /* remove transaction from transaction table */
+      rm_transrec(transrec);
+
+      aborted = TRUE;
+    }
+
+  return aborted;
 }
 
 
@@ -2243,7 +2763,7 @@ static void PDS_read_(transrec)
      trans_entryt *transrec;
 #endif
 {
-  int completed, lcode;
+  int completed, lcode, iovcnt, i;
   pious_ssizet dmcode, rcode;
   pious_sizet nbyte_prime;
   char *rbuf;
@@ -2254,6 +2774,7 @@ static void PDS_read_(transrec)
 
   completed = FALSE;
   rbuf      = NULL;
+  iovcnt    = 0;
   request   = &(transrec->transop_req.reqmsg);
   reqaux    = &(transrec->transop_req.aux);
 
@@ -2316,56 +2837,72 @@ static void PDS_read_(transrec)
 			 request->ReadBody.offset,
 			 nbyte_prime);
 
-      /* allocate a read buffer and perform read operation if lock obtained */
+      /* perform read operation if lock obtained; data is referenced in
+       * cache, such that the reply is sent without first copying data into
+       * a read buffer, or if references are not available is read into an
+       * allocated read buffer.
+       */
 
       if (lcode == LM_GRANT)
-	{ /* allocate a read buffer */
-	  if ((rbuf = (char *)malloc((unsigned)nbyte_prime)) == NULL)
-	    { /* insufficient buffer space for operation */
-	      rcode = PIOUS_EINSUF;
-	    }
+	{ /* reference data in cache */
+	  iovcnt = READ_IOV_MAX;
 
-	  /* read data into buffer */
-	  else
-	    { 
-	      dmcode = DM_read(request->ReadHead.transid,
-			       request->ReadBody.fhandle,
-			       request->ReadBody.offset,
-			       nbyte_prime,
-			       rbuf);
+	  dmcode = DM_readv(request->ReadHead.transid,
+			    request->ReadBody.fhandle,
+			    request->ReadBody.offset,
+			    nbyte_prime,
+			    read_iov,
+			    &iovcnt);
 
-	      if (dmcode >= 0)
-		/* read successful, return number of bytes read */
-		rcode = dmcode;
-	      else
-		/* read failed, set error code appropriately.  if the data
-		 * manager indicates that recovery is required, inform client
-		 * that this transaction is aborted.
-		 *
-		 * the main daemon loop will detect that recovery is required
-		 * via the global stable storage flag SS_recover and take
-		 * action.
-		 */
+	  if (dmcode == PIOUS_EBUSY)
+	    { /* references not available; allocate a read buffer */
+	      iovcnt = 0;
 
-		switch(dmcode)
-		  {
-		  case PIOUS_EBADF:
-		  case PIOUS_EACCES:
-		  case PIOUS_EINVAL:
-		  case PIOUS_EINSUF:
-		  case PIOUS_EPROTO:
-		  case PIOUS_EFATAL:
-		    rcode = dmcode;
-		    break;
-		  case PIOUS_ERECOV:
-		    rcode = PIOUS_EABORT;
-		    break;
-		  default:
-		    rcode = PIOUS_EUNXP;
-		    break;
-		  }
+	      if ((rbuf = (char *)malloc((unsigned)nbyte_prime)) == NULL)
+		/* insufficient buffer space for operation */
+		dmcode = PIOUS_EINSUF;
+
+	      /* read data into buffer */
+	      else
+		dmcode = DM_read(request->ReadHead.transid,
+				 request->ReadBody.fhandle,
+				 request->ReadBody.offset,
+				 nbyte_prime,
+				 rbuf);
 	    }
 
+	  /* set return code */
+	  if (dmcode >= 0)
+	    /* read successful, return number of bytes read */
+	    rcode = dmcode;
+	  else
+	    /* read failed, set error code appropriately.  if the data
+	     * manager indicates that recovery is required, inform client
+	     * that this transaction is aborted.
+	     *
+	     * the main daemon loop will detect that recovery is required
+	     * via the global stable storage flag SS_recover and take
+	     * action.
+	     */
+
+	    switch(dmcode)
+	      {
+	      case PIOUS_EBADF:
+	      case PIOUS_EACCES:
+	      case PIOUS_EINVAL:
+	      case PIOUS_EINSUF:
+	      case PIOUS_EPROTO:
+	      case PIOUS_EFATAL:
+		rcode = dmcode;
+		break;
+	      case PIOUS_ERECOV:
+		rcode = PIOUS_EABORT;
+		break;
+	      default:
+		rcode = PIOUS_EUNXP;
+		break;
+	      }
+
 	  /* flag completion of operation; mark transaction as holding a
 	   * read or write lock, as appropriate.
 	   */
@@ -2390,6 +2927,17 @@ static void PDS_read_(transrec)
 	  rbuf = NULL;
 	}
 
+      /* set data I/O vector if data is referenced in cache */
+
+      if (rcode <= 0)
+	iovcnt = 0;
+
+      for (i = 0; i < iovcnt; i++)
+	{
+	  read_dceiov[i].base = read_iov[i].base;
+	  read_dceiov[i].len  = (int)read_iov[i].len;
+	}
+
       /* set reply message */
       transrec->transop_reply.replyop                   = PDS_READ_OP;
 
@@ -2400,6 +2948,8 @@ static void PDS_read_(transrec)
       transrec->transop_reply.replymsg.ReadHead.rcode   = rcode;
 
       transrec->transop_reply.replymsg.ReadBody.buf     = rbuf;
+      transrec->transop_reply.replymsg.ReadBody.iov     = read_dceiov;
+      transrec->transop_reply.replymsg.ReadBody.iovcnt  = iovcnt;
 
       /* mark operation as completed */
       complete_transop(transrec);
@@ -2408,6 +2958,16 @@ static void PDS_read_(transrec)
       PDSMSG_reply_send(transrec->transop_req.clientid,
 			PDS_READ_OP,
 			&transrec->transop_reply.replymsg);
+
+      /* release data referenced in cache; reply retains no data, which is
+       * restored by transreply_restore() should the reply be re-sent.
+       */
+
+      if (iovcnt > 0)
+	CM_release();
+
+      transrec->transop_reply.replymsg.ReadBody.iov     = NULL;
+      transrec->transop_reply.replymsg.ReadBody.iovcnt  = 0;
     }
 
   else
@@ -3167,6 +3727,41 @@ static void PDS_prepare_(transrec)
     transrec->transop_req.reqmsg.PrepareHead.transsn;
   transrec->transop_reply.replymsg.PrepareHead.rcode   = rcode;
 
+  /* if vote to commit and log synchronization is deferred, then reply when
+   * log records are forced (group commit); otherwise reply now.
+   */
+
+  if (rcode == PIOUS_OK && gc_wait > 0)
+    gc_defer(transrec);
+  else
+    prepare_reply(transrec);
+}
+
+
+
+
+/*
+ * prepare_reply()
+ *
+ * Parameters:
+ *
+ *   transrec - transaction table record
+ *
+ * Complete prepare operation for transaction 'transrec', replying to the
+ * client with the result set in the transop_reply field.  If the vote is
+ * to abort, or the transaction is read-only, then the transaction is
+ * removed from the transaction table; otherwise it is marked as prepared.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void prepare_reply(trans_entryt *transrec)
+#else
+static void prepare_reply(transrec)
+     trans_entryt *transrec;
+#endif
+{
   /* mark operation as complete */
   complete_transop(transrec);
 
@@ -3177,10 +3772,217 @@ static void PDS_prepare_(transrec)
 
 
   /* if vote to abort or read-only transaction, remove from table */
-  if (rcode != PIOUS_OK)
+  if (transrec->transop_reply.replymsg.PrepareHead.rcode == PIOUS_EABORT)
+    abortcnt.prepare++;
+
+  if (transrec->transop_reply.replymsg.PrepareHead.rcode != PIOUS_OK)
     rm_transrec(transrec);
   else
-    transrec->prepared = TRUE;
+    {
+      transrec->prepared = TRUE;
+      prep_cnt++;
+    }
+}
+
+
+
+
+/*
+ * gc_defer()
+ *
+ * Parameters:
+ *
+ *   transrec - transaction table record
+ *
+ * Defer the prepare reply for transaction 'transrec', which has voted to
+ * commit, until its log records are forced to stable storage together with
+ * those of other transactions that prepare within the group commit window
+ * (group commit).  The operation remains active until then, so that a
+ * re-sent prepare request is treated as delayed.
+ *
+ * Log records are forced immediately if no other transaction is active
+ * that might prepare within the window, so as not to delay a lone client.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void gc_defer(trans_entryt *transrec)
+#else
+static void gc_defer(transrec)
+     trans_entryt *transrec;
+#endif
+{
+  register trans_entryt *sibling;
+
+  /* append to group, marking start of the group commit window */
+  transrec->gcnext = NULL;
+
+  if (gc_cnt++ == 0)
+    {
+      gc_head = transrec;
+      UTIL_clock_mark(&gc_timer);
+    }
+  else
+    gc_tail->gcnext = transrec;
+
+  gc_tail = transrec;
+
+  /* locate an active transaction, not prepared or awaiting a log sync */
+
+  for (sibling =  transtable.ready;
+       sibling != NULL && (sibling->prepared ||
+			   sibling->transop_req.reqop == PDS_PREPARE_OP);
+       sibling =  sibling->tblnext);
+
+  if (sibling == NULL)
+    sibling = transtable.block_head;
+
+  /* force log records if no transaction might join the group */
+  if (sibling == NULL)
+    gc_flush();
+}
+
+
+
+
+/*
+ * gc_flush()
+ *
+ * Parameters:
+ *
+ * Force log records of transactions whose prepare reply is deferred by
+ * gc_defer(), replying to each in the order prepared.  If log records
+ * can not be forced, each transaction is aborted and votes to abort,
+ * releasing its locks; the caller must then re-try blocked operations.
+ *
+ * Returns:
+ *
+ *   TRUE  (1) - locks released; transactions aborted
+ *   FALSE (0) - no locks released
+ */
+
+#ifdef __STDC__
+static int gc_flush(void)
+#else
+static int gc_flush()
+#endif
+{
+  int lcode, rcode, released;
+  trans_entryt *transrec;
+
+  lcode    = RM_logsync();
+  released = (lcode != PIOUS_OK && gc_head != NULL);
+
+  while (gc_head != NULL)
+    { /* dequeue, as replying may remove from table */
+      transrec = gc_head;
+      gc_head  = transrec->gcnext;
+      gc_cnt--;
+
+      if (lcode != PIOUS_OK)
+	{ /* vote to abort; free ALL locks, as for prepare */
+	  if (transrec->readlk)
+	    LM_rfree(transrec->transid);
+
+	  if (transrec->writelk)
+	    LM_wfree(transrec->transid);
+
+	  /* transaction NOT prepared; data manager must discard it */
+	  if (lcode == PIOUS_EFATAL)
+	    rcode = PIOUS_EFATAL;
+	  else
+	    {
+	      DM_abort(transrec->transid);
+	      rcode = PIOUS_EABORT;
+	    }
+
+	  transrec->transop_reply.replymsg.PrepareHead.rcode = rcode;
+	}
+
+      prepare_reply(transrec);
+    }
+
+  gc_tail = NULL;
+
+  return released;
+}
+
+
+
+
+/*
+ * gc_remove()
+ *
+ * Parameters:
+ *
+ *   transrec - transaction table record
+ *
+ * Remove transaction 'transrec' from those whose prepare reply is deferred
+ * by gc_defer(), if present, so that the prepare reply is never sent; e.g.
+ * when the transaction is aborted before its log records are forced.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void gc_remove(trans_entryt *transrec)
+#else
+static void gc_remove(transrec)
+     trans_entryt *transrec;
+#endif
+{
+  register trans_entryt *prev, *cur;
+
+  /* locate transrec in group; group is bounded by gc_max */
+  prev = NULL;
+
+  for (cur = gc_head; cur != NULL && cur != transrec; cur = cur->gcnext)
+    prev = cur;
+
+  if (cur != NULL)
+    { /* unlink from group */
+      if (prev == NULL)
+	gc_head = cur->gcnext;
+      else
+	prev->gcnext = cur->gcnext;
+
+      if (gc_tail == cur)
+	gc_tail = prev;
+
+      gc_cnt--;
+    }
+}
+
+
+
+
+/*
+ * log_checkpoint()
+ *
+ * Parameters:
+ *
+ * Checkpoint the transaction log: flush the cache, so that the writes of
+ * committed transactions are on disk, then truncate the log and reset the
+ * stable storage flag SS_checkpoint.  If the cache can not be flushed then
+ * the checkpoint is re-tried later; errors requiring recovery, or fatal
+ * errors, are reflected in the global stable storage flags.
+ *
+ * Note: The caller must insure that no transaction is prepared, awaiting a
+ *       log sync, or in doubt.  The cache is not invalidated, as required by
+ *       SS_logtrunc(), as file handles are retained when not recovering.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void log_checkpoint(void)
+#else
+static void log_checkpoint()
+#endif
+{
+  if (CM_flush() == PIOUS_OK && RM_logtrunc() == PIOUS_OK)
+    SS_checkpoint = FALSE;
 }
 
 
@@ -3286,6 +4088,8 @@ static void PDS_abort_(transrec)
   /* issue abort to data manager and set result code */
   dmcode = DM_abort(transrec->transid);
 
+  abortcnt.client++;
+
   switch(dmcode)
     {
     case PIOUS_OK:
@@ -3432,6 +4236,10 @@ static int init_transreq(request, transrec)
 	      ti_entry->transop_reply.replymsg.TransopHead.rcode   =
 		PIOUS_EABORT;
 
+	      /* drop prepare reply if deferred awaiting a log sync */
+	      if (gc_cnt > 0)
+		gc_remove(ti_entry);
+
 	      /* mark operation as completed */
 	      complete_transop(ti_entry);
 
@@ -3578,7 +4386,8 @@ static int init_transreq(request, transrec)
 
       if (req_transsn == prev_req_transsn)
 	{
-	  if (ti_entry->transop_state == COMPLETED)
+	  if (ti_entry->transop_state == COMPLETED &&
+	      transreply_restore(ti_entry) == PIOUS_OK)
 	    /* reply; inability to send is equivalent to a lost message */
 	    PDSMSG_reply_send(request->clientid, request->reqop,
 			      &(ti_entry->transop_reply.replymsg));
@@ -3674,7 +4483,8 @@ static int init_transreq(request, transrec)
  *   transrec - transaction table record
  *
  * Mark transaction operation as completed. If transaction is on the blocked
- * list, move to the ready list in the transaction table.
+ * list, move to the ready list in the transaction table and dequeue the
+ * lock request.
  *
  * NOTE: For profiling purposes, complete_transop() MUST be called after
  *       the transop_reply field is set in transrec.  To avoid counting
@@ -3694,7 +4504,13 @@ static void complete_transop(transrec)
 {
   /* if transaction blocked, move to ready list */
   if (transrec->transop_state == BLOCKED)
-    { /* remove from blocked list */
+    { /* dequeue lock request, if not already dequeued by lock grant */
+      if (transrec->lkqueued)
+	LM_cancel(transrec->transid);
+      else
+	blk_unqueued--;
+
+      /* remove from blocked list */
       if (transrec->tblnext != NULL)
 	transrec->tblnext->tblprev = transrec->tblprev;
       else
@@ -3738,6 +4554,13 @@ static void complete_transop(transrec)
  * Mark transaction operation as blocked.  If operation was not previously
  * blocked then move to the tail of the blocked list in the transaction table.
  *
+ * The operation's lock request is queued with the lock manager, to be woken
+ * when it can be granted; if the request can not be queued, the count of
+ * such operations is incremented and all blocked operations are scanned by
+ * retry_blk_transop() until the request can be queued.  A queued request
+ * that completes a cycle in the wait-for graph is flagged for deadlock
+ * recovery by abort_victims().
+ *
  * NOTE: For profiling purposes, block_transop() MUST be called to
  *       re-block an already blocked operation so that processing time
  *       can be charged; the operation's position in the blocked list
@@ -3753,6 +4576,10 @@ static void block_transop(transrec)
      trans_entryt *transrec;
 #endif
 {
+  int lcode;
+  pds_transidt victim;
+  req_auxstoret *reqaux;
+
   /* if transaction not blocked, move to blocked list */
   if (transrec->transop_state != BLOCKED)
     { /* remove from ready list */
@@ -3775,8 +4602,40 @@ static void block_transop(transrec)
 
       transtable.block_tail = transrec;
 
-      /* mark transaction state as blocked */
+      /* mark transaction state as blocked; lock request not yet queued */
       transrec->transop_state = BLOCKED;
+
+      transrec->lkqueued = FALSE;
+      transrec->dlcheck  = FALSE;
+      blk_unqueued++;
+    }
+
+  /* queue lock request with lock manager; re-queue if already queued */
+
+  reqaux = &(transrec->transop_req.aux);
+
+  if (reqaux->lk_type == PDS_READLK)
+    lcode = LM_rwait(transrec->transid, reqaux->lk_fhandle,
+		     reqaux->lk_start,
+		     (pious_sizet)(reqaux->lk_stop - reqaux->lk_start) + 1);
+  else
+    lcode = LM_wwait(transrec->transid, reqaux->lk_fhandle,
+		     reqaux->lk_start,
+		     (pious_sizet)(reqaux->lk_stop - reqaux->lk_start) + 1);
+
+  if (lcode == PIOUS_OK && !transrec->lkqueued)
+    {
+      transrec->lkqueued = TRUE;
+      blk_unqueued--;
+    }
+
+  /* flag if queued lock request completes a cycle in the wait-for graph;
+   * victims are aborted by abort_victims(), which determines the victim.
+   */
+  if (lcode == PIOUS_OK && LM_deadlock(transrec->transid, &victim))
+    {
+      transrec->dlcheck = TRUE;
+      dl_pending        = TRUE;
     }
 
 #ifdef PDSPROFILE
@@ -3801,6 +4660,13 @@ static void block_transop(transrec)
  * Fair scheduling and freedom from live-lock requires that conflicting lock
  * requests for overlapping data regions be satisfied in the order received.
  *
+ * Blocked operations queue their lock request with the lock manager, which
+ * indexes queued requests by file handle and byte range and wakes them in
+ * the order received.  Thus a new operation is checked against queued
+ * requests via the lock manager, and a blocked operation is not checked.
+ * Only if some blocked operation could not queue its lock request is the
+ * blocked list searched.
+ *
  * Returns:
  *
  *   FALSE (0) - there is NO scheduling conflict
@@ -3816,14 +4682,30 @@ static int fcfs_conflict(transrec)
 {
   int conflict;
   register trans_entryt *priorrec;
+  register req_auxstoret *reqaux;
 
   conflict = FALSE;
+  priorrec = NULL;
 
   /* check ops on blocked list ahead of this op to determine if conflict */
 
-  if (transrec->transop_state != COMPLETED)
+  if (transrec->transop_state == ACTIVE && blk_unqueued == 0)
+    { /* all blocked ops queued; check queued lock requests */
+      reqaux = &(transrec->transop_req.aux);
+
+      if (reqaux->lk_type == PDS_READLK)
+	conflict = LM_rconflict(reqaux->lk_fhandle, reqaux->lk_start,
+				(pious_sizet)(reqaux->lk_stop -
+					      reqaux->lk_start) + 1);
+      else
+	conflict = LM_wconflict(reqaux->lk_fhandle, reqaux->lk_start,
+				(pious_sizet)(reqaux->lk_stop -
+					      reqaux->lk_start) + 1);
+    }
+
+  else if (transrec->transop_state != COMPLETED && blk_unqueued > 0)
     { /* determine portion of blocked list to search */
-      
+
       if (transrec->transop_state == ACTIVE)
 	priorrec = transtable.block_tail;
       else
@@ -3907,6 +4789,8 @@ static trans_entryt *ti_lookup(transid, action)
 	  ti_entry->writelk                  = FALSE;
 	  ti_entry->readonly                 = TRUE;
 	  ti_entry->prepared                 = FALSE;
+	  ti_entry->lkqueued                 = FALSE;
+	  ti_entry->dlcheck                  = FALSE;
 
 	  ti_entry->tblnext                  = transtable.ready;
 	  ti_entry->tblprev                  = NULL;
@@ -3970,10 +4854,26 @@ static void rm_transrec(transrec)
 	ti_table[transid_hash(transrec->transid, TI_TABLE_SZ)] =
 	  transrec->tinext;
 
+      /* remove transrec from group awaiting a log sync, if deferred */
+
+      if (gc_cnt > 0)
+	gc_remove(transrec);
+
+      /* update count of prepared transactions */
+
+      if (transrec->prepared)
+	prep_cnt--;
+
       /* remove transrec from transaction table */
 
       if (transrec->transop_state == BLOCKED)
-	{ /* remove from blocked list */
+	{ /* cancel queued lock request */
+	  if (transrec->lkqueued)
+	    LM_cancel(transrec->transid);
+	  else
+	    blk_unqueued--;
+
+	  /* remove from blocked list */
 
 	  if (transrec->tblnext != NULL)
 	    transrec->tblnext->tblprev = transrec->tblprev;
@@ -4145,6 +5045,440 @@ static void transreply_dealloc(reply)
 
 
 
+/*
+ * transreply_restore()
+ *
+ * Parameters:
+ *
+ *   transrec - transaction table entry
+ *
+ * Restore any data not retained in the transaction operation reply of
+ * 'transrec', such that the reply can be re-sent.
+ *
+ * A read reply sent with data referenced in cache does not retain the
+ * data; the data is re-read into an allocated read buffer.  The data read
+ * is unchanged since the transaction continues to hold the lock obtained
+ * by the read, and has not since written data.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - reply restored
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ */
+
+#ifdef __STDC__
+static int transreply_restore(trans_entryt *transrec)
+#else
+static int transreply_restore(transrec)
+     trans_entryt *transrec;
+#endif
+{
+  int rcode;
+  char *rbuf;
+  pdsmsg_reqt *request;
+  pdsmsg_replyt *reply;
+
+  rcode   = PIOUS_OK;
+  request = &(transrec->transop_req.reqmsg);
+  reply   = &(transrec->transop_reply.replymsg);
+
+  if (transrec->transop_reply.replyop == PDS_READ_OP &&
+      reply->ReadHead.rcode > 0 && reply->ReadBody.buf == NULL)
+    { /* read reply data not retained; allocate a read buffer */
+      if ((rbuf = (char *)malloc((unsigned)reply->ReadHead.rcode)) == NULL)
+	rcode = PIOUS_EINSUF;
+
+      /* re-read data into buffer */
+      else if (DM_read(request->ReadHead.transid,
+		       request->ReadBody.fhandle,
+		       request->ReadBody.offset,
+		       (pious_sizet)reply->ReadHead.rcode,
+		       rbuf) != reply->ReadHead.rcode)
+	{
+	  free(rbuf);
+	  rcode = PIOUS_EUNXP;
+	}
+
+      else
+	reply->ReadBody.buf = rbuf;
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * Private Function Definitions - Start-up Option Parsing
+ */
+
+
+/*
+ * parse_options()
+ *
+ * Parameters:
+ *
+ *   optstr  - start-up option list
+ *   cmparam - cache configuration parameters
+ *
+ * Parse the comma separated start-up option list 'optstr', setting the
+ * cache configuration parameters 'cmparam', and the daemon group commit
+ * parameters, accordingly.  Parameters not specified in 'optstr' are not
+ * altered.
+ *
+ * Recognized options are:
+ *
+ *   cachesz=N  - cache size in number of data blocks
+ *   blksz=N    - data block size in bytes
+ *   smcnt=N    - small data block count
+ *   smsz=N     - small data block size in bytes
+ *   lgcnt=N    - large data block count
+ *   lgsz=N     - large data block size in bytes
+ *   lgmin=N    - minimum size in bytes of a file cached in large data blocks
+ *   large=P    - cache files whose path begins with prefix P in large data
+ *                blocks regardless of size; may be repeated for up to
+ *                LARGE_PREFIX_MAX prefixes
+ *   protpct=N  - protected segment size as a percentage of cache size
+ *   ramax=N    - maximum sequential readahead window in data blocks
+ *   lrmin=N    - minimum data block span of a read performed by extent
+ *   hugepage   - back cache with huge pages, if available
+ *   direct     - bypass the host file system cache via direct I/O, if
+ *                available; block size must be a multiple of 4k
+ *   policy=P   - cache replacement policy; 'slru' or 'arc' (adaptive)
+ *   admit      - filter cache admission by estimated reference frequency
+ *   writeback  - cache volatile writes under a write-back policy
+ *   dirtypct=N - write-back dirty data threshold as a percentage of cache size
+ *   dirtyage=N - write-back dirty data age threshold in milliseconds
+ *   part=P:N:M - cache partition for files whose path begins with prefix P,
+ *                reserving N and at most M percent of the cache; may be
+ *                repeated for up to CM_PART_MAX partitions
+ *   gcwait=N   - group commit window in milliseconds; 0 (zero) disables
+ *   gcmax=N    - maximum transactions whose log records are forced together
+ *   ckptsz=N   - transaction log size at which the log is checkpointed
+ *
+ * Numeric values may be suffixed with 'k', 'm', or 'g' to denote
+ * units of 2^10, 2^20, or 2^30, respectively.  Cache parameter values are
+ * validated by CM_init(); group commit and checkpoint parameter values are
+ * validated here.
+ *
+ * Files are assigned to the cache partition of the longest path prefix that
+ * matches, when looked up; other files share the default partition.
+ * Likewise, files are assigned the large data block class when looked up if
+ * a large class prefix matches, or if at least lgmin bytes in size.
+ *
+ * Note: 'optstr' is modified by parse_options().
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - option list parsed without error
+ *   PIOUS_EINVAL - option list contains an unrecognized option or value
+ */
+
+#ifdef __STDC__
+static int parse_options(char *optstr,
+			 struct CM_param *cmparam)
+#else
+static int parse_options(optstr, cmparam)
+     char *optstr;
+     struct CM_param *cmparam;
+#endif
+{
+  int rcode;
+  char *name, *value, *next, *vend;
+  long lvalue;
+
+  rcode = PIOUS_OK;
+
+  for (name = optstr; name != NULL && rcode == PIOUS_OK; name = next)
+    { /* delimit option name and value */
+
+      if ((next = strchr(name, ',')) != NULL)
+	*next++ = '\0';
+
+      if ((value = strchr(name, '=')) != NULL)
+	*value++ = '\0';
+
+      /* convert numeric value, if any, applying unit suffix; the policy,
+       * partition, and large class options take a symbolic value.
+       */
+
+      lvalue = 0;
+
+      if (value != NULL && strcmp(name, "policy") && strcmp(name, "part") &&
+	  strcmp(name, "large"))
+	{
+	  lvalue = strtol(value, &vend, 10);
+
+	  switch(*vend)
+	    {
+	    case 'k':
+	    case 'K':
+	      lvalue *= 1024L;
+	      vend++;
+	      break;
+	    case 'm':
+	    case 'M':
+	      lvalue *= 1024L * 1024L;
+	      vend++;
+	      break;
+	    case 'g':
+	    case 'G':
+	      lvalue *= 1024L * 1024L * 1024L;
+	      vend++;
+	      break;
+	    }
+
+	  if (vend == value || *vend != '\0' || lvalue < 0)
+	    rcode = PIOUS_EINVAL;
+	}
+
+      /* set configuration parameter */
+
+      if (rcode == PIOUS_OK)
+	{
+	  if (!strcmp(name, "cachesz") && value != NULL)
+	    cmparam->cache_sz = lvalue;
+
+	  else if (!strcmp(name, "blksz") && value != NULL)
+	    cmparam->dblk_sz = (pious_sizet)lvalue;
+
+	  else if (!strcmp(name, "smcnt") && value != NULL)
+	    cmparam->sm_cnt = lvalue;
+
+	  else if (!strcmp(name, "smsz") && value != NULL)
+	    cmparam->sm_sz = (pious_sizet)lvalue;
+
+	  else if (!strcmp(name, "lgcnt") && value != NULL)
+	    cmparam->lg_cnt = lvalue;
+
+	  else if (!strcmp(name, "lgsz") && value != NULL)
+	    cmparam->lg_sz = (pious_sizet)lvalue;
+
+	  else if (!strcmp(name, "lgmin") && value != NULL)
+	    cmparam->lg_min = lvalue;
+
+	  else if (!strcmp(name, "large") && value != NULL &&
+		   *value != '\0' && large_cnt < LARGE_PREFIX_MAX)
+	    large_prefix[large_cnt++] = value;
+
+	  else if (!strcmp(name, "protpct") && value != NULL)
+	    cmparam->prot_pct = (int)Min(lvalue, 100);
+
+	  else if (!strcmp(name, "ramax") && value != NULL)
+	    cmparam->ra_max = lvalue;
+
+	  else if (!strcmp(name, "lrmin") && value != NULL)
+	    cmparam->lr_min = lvalue;
+
+	  else if (!strcmp(name, "hugepage") && value == NULL)
+	    cmparam->hugepage = TRUE;
+
+	  else if (!strcmp(name, "direct") && value == NULL)
+	    cmparam->direct = TRUE;
+
+	  else if (!strcmp(name, "policy") && value != NULL)
+	    {
+	      if (!strcmp(value, "slru"))
+		cmparam->policy = CM_POLICY_SLRU;
+	      else if (!strcmp(value, "arc"))
+		cmparam->policy = CM_POLICY_ARC;
+	      else
+		rcode = PIOUS_EINVAL;
+	    }
+
+	  else if (!strcmp(name, "admit") && value == NULL)
+	    cmparam->admit = TRUE;
+
+	  else if (!strcmp(name, "writeback") && value == NULL)
+	    cmparam->writeback = TRUE;
+
+	  else if (!strcmp(name, "dirtypct") && value != NULL)
+	    cmparam->wb_dirty_pct = (int)Min(lvalue, 100);
+
+	  else if (!strcmp(name, "dirtyage") && value != NULL)
+	    cmparam->wb_age = lvalue;
+
+	  else if (!strcmp(name, "part") && value != NULL)
+	    rcode = parse_partition(value, cmparam);
+
+	  else if (!strcmp(name, "gcwait") && value != NULL)
+	    gc_wait = lvalue;
+
+	  else if (!strcmp(name, "gcmax") && value != NULL && lvalue > 0)
+	    gc_max = (int)Min(lvalue, PIOUS_INT_MAX);
+
+	  else if (!strcmp(name, "ckptsz") && value != NULL && lvalue > 0)
+	    ckpt_sz = lvalue;
+
+	  else
+	    /* unrecognized option, or option value missing/extraneous */
+	    rcode = PIOUS_EINVAL;
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * parse_partition()
+ *
+ * Parameters:
+ *
+ *   value   - partition option value
+ *   cmparam - cache configuration parameters
+ *
+ * Parse the partition option value 'value', of the form 'prefix:min:max',
+ * adding a cache partition to the cache configuration parameters 'cmparam'
+ * and recording the path prefix that selects it.
+ *
+ * Note: 'value' is modified by parse_partition() and referenced thereafter.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - partition option parsed without error
+ *   PIOUS_EINVAL - partition option value is invalid, or too many partitions
+ */
+
+#ifdef __STDC__
+static int parse_partition(char *value,
+			   struct CM_param *cmparam)
+#else
+static int parse_partition(value, cmparam)
+     char *value;
+     struct CM_param *cmparam;
+#endif
+{
+  int rcode;
+  char *minstr, *maxstr, *vend;
+  long minpct, maxpct;
+
+  rcode = PIOUS_EINVAL;
+
+  /* delimit prefix, reserved percentage, and maximum percentage */
+
+  if (cmparam->part_cnt < CM_PART_MAX &&
+      (maxstr = strrchr(value, ':')) != NULL)
+    {
+      *maxstr++ = '\0';
+
+      if ((minstr = strrchr(value, ':')) != NULL && minstr != value)
+	{
+	  *minstr++ = '\0';
+
+	  minpct = strtol(minstr, &vend, 10);
+
+	  if (vend != minstr && *vend == '\0' && minpct >= 0)
+	    {
+	      maxpct = strtol(maxstr, &vend, 10);
+
+	      if (vend != maxstr && *vend == '\0' && maxpct >= 0)
+		{ /* add partition */
+		  part_prefix[cmparam->part_cnt] = value;
+
+		  cmparam->part_min[cmparam->part_cnt] = (int)Min(minpct, 100);
+		  cmparam->part_max[cmparam->part_cnt] = (int)Min(maxpct, 100);
+
+		  part_cnt = ++cmparam->part_cnt;
+
+		  rcode = PIOUS_OK;
+		}
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * part_match()
+ *
+ * Parameters:
+ *
+ *   path - file path name
+ *
+ * Determine the cache partition for file 'path', as selected by the longest
+ * partition path prefix that 'path' begins with.
+ *
+ * Returns:
+ *
+ *   int - cache partition; zero (0) is the default partition
+ */
+
+#ifdef __STDC__
+static int part_match(char *path)
+#else
+static int part_match(path)
+     char *path;
+#endif
+{
+  int part, i, len, matchlen;
+
+  part     = 0;
+  matchlen = 0;
+
+  for (i = 0; i < part_cnt; i++)
+    {
+      len = (int)strlen(part_prefix[i]);
+
+      if (len > matchlen && !strncmp(path, part_prefix[i], len))
+	{
+	  part     = i + 1;
+	  matchlen = len;
+	}
+    }
+
+  return part;
+}
+
+
+
+
+/*
+ * large_match()
+ *
+ * Parameters:
+ *
+ *   path - file path name
+ *
+ * Determine if file 'path' begins with a path prefix hinting the large data
+ * block class.
+ *
+ * Returns:
+ *
+ *   TRUE  - 'path' hints the large data block class
+ *   FALSE - otherwise
+ */
+
+#ifdef __STDC__
+static int large_match(char *path)
+#else
+static int large_match(path)
+     char *path;
+#endif
+{
+  int large, i;
+
+  large = FALSE;
+
+  for (i = 0; i < large_cnt && !large; i++)
+    if (!strncmp(path, large_prefix[i], strlen(large_prefix[i])))
+      large = TRUE;
+
+  return large;
+}
+
+
+
 
 #ifdef PDSPROFILE
 /*
@@ -70,6 +70,7 @@
  * Function Summary:
  *
  * DM_read();
+ * DM_readv();
  * DM_write();
  * DM_prepare();
  * DM_commit();
@@ -305,6 +306,95 @@ pious_ssizet DM_read(transid, fhandle, offset, nbyte, buf)
 
 
 
+/*
+ * DM_readv() - See pds_data_manager.h for description
+ */
+
+#ifdef __STDC__
+pious_ssizet DM_readv(pds_transidt transid,
+		      pds_fhandlet fhandle,
+		      pious_offt offset,
+		      pious_sizet nbyte,
+		      struct FS_iovec *iov,
+		      int *iovcnt)
+#else
+pious_ssizet DM_readv(transid, fhandle, offset, nbyte, iov, iovcnt)
+     pds_transidt transid;
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+     struct FS_iovec *iov;
+     int *iovcnt;
+#endif
+{
+  int famode;
+  pious_ssizet acode, rcode;
+  ti_entryt *ti_entry;
+
+
+  /* determine if is a non-read-only transaction */
+  if ((ti_entry = ti_lookup(transid, NOINSERT)) != NULL)
+    { /* data read must be augmented with updates, or is a protocol error */
+      if (ti_entry->prepared)
+	rcode = PIOUS_EPROTO;
+      else
+	rcode = PIOUS_EBUSY;
+    }
+
+  /* validate 'offset' and 'nbyte' arguments */
+  else if (offset < 0 || nbyte < 0)
+    rcode = PIOUS_EINVAL;
+
+  /* determine if file has read accessability */
+  else if ((acode = SS_faccess(fhandle, &famode)) != PIOUS_OK)
+    /* error in determining accessability */
+    switch (acode)
+      {
+      case PIOUS_EBADF:
+      case PIOUS_EINSUF:
+      case PIOUS_EFATAL:
+	rcode = acode;
+	break;
+      default:
+	rcode = PIOUS_EUNXP;
+	break;
+      }
+
+  else if (!(famode & PIOUS_R_OK))
+    /* file not read accessable */
+    rcode = PIOUS_EACCES;
+
+  else
+    { /* reference requested data in cache */
+      acode = CM_readv(fhandle, offset, nbyte, iov, iovcnt);
+
+      if (acode >= 0)
+	rcode = acode;
+
+      else
+	/* error occured during read, set return code appropriately */
+	switch (acode)
+	  {
+	  case PIOUS_EBUSY:
+	  case PIOUS_EBADF:
+	  case PIOUS_EACCES:
+	  case PIOUS_EINVAL:
+	  case PIOUS_EINSUF:
+	  case PIOUS_ERECOV:
+	  case PIOUS_EFATAL:
+	    rcode = acode;
+	    break;
+	  default:
+	    rcode = PIOUS_EUNXP;
+	    break;
+	  }
+    }
+
+  return rcode;
+}
+
+
+
 
 /*
  * DM_write() - See pds_data_manager.h for description
@@ -61,6 +61,7 @@
  * Function Summary:
  *
  * DM_read();
+ * DM_readv();
  * DM_write();
  * DM_prepare();
  * DM_commit();
@@ -116,6 +117,68 @@ pious_ssizet DM_read();
 
 
 
+/*
+ * DM_readv()
+ *
+ * Parameters:
+ *
+ *   transid - transaction id
+ *   fhandle - file handle
+ *   offset  - starting offset
+ *   nbyte   - byte count
+ *   iov     - I/O vector
+ *   iovcnt  - I/O vector entry count
+ *
+ * Read file 'fhandle' starting at 'offset' bytes from the beginning
+ * and proceeding for 'nbyte' bytes, as for DM_read(); place references to
+ * cached data in I/O vector 'iov' as for CM_readv().  On entry 'iovcnt' is
+ * the number of entries in 'iov', and on successful return is the number
+ * of entries used.
+ *
+ * References are released via CM_release().
+ *
+ * Note: References are not available if transaction 'transid' has written
+ *       data, as data read must then be augmented with the data written,
+ *       or if the cache manager can not reference the data in place; the
+ *       caller then reads via DM_read().
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes read and referenced in 'iov' (<= nbyte)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBUSY  - references not available; read via DM_read()
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - 'offset' or 'nbyte' argument not a proper value
+ *                      or exceeds SYSTEM constraints
+ *       PIOUS_EINSUF - insufficient system resources; retry operation
+ *       PIOUS_EPROTO - attempted read after prepare; 2PC protocol error
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_ERECOV - recovery required for PDS to continue
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ *
+ * Note: Assumes offset, nbyte, and (offset + (nbyte - 1)) have been checked
+ *       and are confirmed to be valid and within limits defined in
+ *       include/pious_types.h.
+ */
+
+struct FS_iovec;           /* see pfs/pfs.h */
+
+#ifdef __STDC__
+pious_ssizet DM_readv(pds_transidt transid,
+		      pds_fhandlet fhandle,
+		      pious_offt offset,
+		      pious_sizet nbyte,
+		      struct FS_iovec *iov,
+		      int *iovcnt);
+#else
+pious_ssizet DM_readv();
+#endif
+
+
+
+
 /*
  * DM_write()
  *
@@ -37,6 +37,13 @@
  *   LM_wlock();
  *   LM_rfree();
  *   LM_wfree();
+ *   LM_rwait();
+ *   LM_wwait();
+ *   LM_cancel();
+ *   LM_woken();
+ *   LM_rconflict();
+ *   LM_wconflict();
+ *   LM_deadlock();
  *
  */
 
@@ -52,6 +59,8 @@
 #include "gpmacro.h"
 
 #include "pious_types.h"
+#include "pious_errno.h"
+#include "pious_sysconfig.h"
 
 #include "pds_transidt.h"
 #include "pds_fhandlet.h"
@@ -70,8 +79,27 @@
 #define INSERT   0 /* Perform insert during lookup operations */
 #define NOINSERT 1 /* Do NOT perform insert during lookup operations */
 
+#define QUEUED    0 /* Queued request waiting on conflicting lock/request */
+#define WOKEN     1 /* Queued request woken; awaiting retrieval */
+#define RETRIEVED 2 /* Queued request woken and retrieved */
 
-/* File Handle and Transaction Id hash table sizes */
+#define EDGE_INIT  0 /* Wait-for edge search: not started */
+#define EDGE_LOCKS 1 /* Wait-for edge search: conflicting locks */
+#define EDGE_WAITS 2 /* Wait-for edge search: conflicting requests ahead */
+#define EDGE_DONE  3 /* Wait-for edge search: complete */
+
+/* Maximum stop position in lock tree subtree of locks conflicting with a
+ * 'lock' lock; i.e. of all locks for WRITE, and of write locks for READ.
+ */
+
+#define Lmaxstop(lock_entry, lock) \
+((lock) == WRITE ? (lock_entry)->maxstop : (lock_entry)->wmaxstop)
+
+
+/* File Handle and Transaction Id hash table initial sizes; each table is
+ * allocated when first required, and grown as entries are inserted such
+ * that entries never outnumber hash chains.
+ */
 
 #define FH_TABLE_SZ 103 /* Choose prime not near a power of 2 */
 #define TI_TABLE_SZ 103 /* Choose prime not near a power of 2 */
@@ -82,21 +110,50 @@ struct fh_entry; /* defined below */
 struct ti_entry; /* defined below */
 
 typedef struct lock_entry{
-  pds_transidt transid;      /* transaction id of lock owner */
-  pious_offt start;          /* lock start position */
-  pious_offt stop;           /* lock stop position */
-  int lock;                  /* lock type */
-  struct lock_entry *lnext;  /* next lock associated with file */
-  struct lock_entry *lprev;  /* previous lock associated with file */
-  struct lock_entry *onext;  /* next lock owned by transaction, any file */
-  struct fh_entry *fhchain;  /* reference back to file handle hash chain */
+  pds_transidt transid;       /* transaction id of lock owner */
+  pious_offt start;           /* lock start position */
+  pious_offt stop;            /* lock stop position */
+  int lock;                   /* lock type */
+  pious_offt maxstop;         /* maximum stop position of locks in subtree */
+  pious_offt wmaxstop;        /* maximum stop position of write locks, or -1 */
+  unsigned long prio;         /* lock tree heap priority */
+  struct lock_entry *lleft;   /* lock tree left child; lesser start */
+  struct lock_entry *lright;  /* lock tree right child; greater/equal start */
+  struct lock_entry *lparent; /* lock tree parent */
+  struct lock_entry *onext;   /* next lock owned by transaction, any file */
+  struct lock_entry *oprev;   /* prev lock owned by transaction, any file */
+  struct fh_entry *fhchain;   /* reference back to file handle hash chain */
 } lock_entryt;
 
+/* Wait Queue Entry: Lock request queued by a transaction on a file handle;
+ *                   requested lock is a node in the file's 'waits' tree.
+ */
+
+typedef struct wait_entry{
+  lock_entryt req;            /* requested lock; MUST be first member */
+  unsigned long seq;          /* request sequence number in wait queue */
+  int state;                  /* request state */
+  struct wait_entry *wnext;   /* next request in file handle wait queue */
+  struct wait_entry *wprev;   /* previous request in file handle wait queue */
+  struct wait_entry *rnext;   /* next request in woken queue */
+  struct wait_entry *rprev;   /* previous request in woken queue */
+  struct wait_entry *snext;   /* next request in wait scan list */
+  struct ti_entry *tichain;   /* reference back to transid hash chain */
+} wait_entryt;
+
 /* File Handle Hash Table: File handle hash chain entry */
 
 typedef struct fh_entry{
   pds_fhandlet fhandle;     /* file handle */
-  lock_entryt *locks;       /* locks associated with fhandle */
+  lock_entryt *locks;       /* lock tree of locks associated with fhandle */
+  lock_entryt *waits;       /* lock tree of requests queued on fhandle */
+  unsigned long wseq;       /* next wait queue sequence number */
+  wait_entryt *whead;       /* head of request wait queue; earliest */
+  wait_entryt *wtail;       /* tail of request wait queue; latest */
+  int wscan;                /* flag wait queue to be scanned */
+  pious_offt sstart;        /* start of range released, to be scanned */
+  pious_offt sstop;         /* stop of range released, to be scanned */
+  struct fh_entry *snext;   /* next entry in list to be scanned */
   struct fh_entry *fhnext;  /* next entry in fhandle hash chain */
   struct fh_entry *fhprev;  /* previous entry in fhandle hash chain */
 } fh_entryt;
@@ -107,6 +164,13 @@ typedef struct ti_entry{
   pds_transidt transid;    /* transaction id */
   lock_entryt *rlocks;     /* Read lock list */
   lock_entryt *wlocks;     /* Write lock list */
+  long rcnt;               /* Read lock list length */
+  long wcnt;               /* Write lock list length */
+  wait_entryt *wait;       /* Queued lock request */
+  unsigned long dmark;     /* deadlock search visit mark */
+  int dphase;              /* deadlock search wait-for edge phase */
+  lock_entryt *dnext;      /* deadlock search next wait-for edge */
+  struct ti_entry *dparent; /* deadlock search parent */
   struct ti_entry *tinext; /* next entry in transid hash chain */
   struct ti_entry *tiprev; /* previous entry in transid hash chain */
 } ti_entryt;
@@ -128,11 +192,17 @@ static fh_entryt *fh_lookup(pds_fhandlet fhandle,
 
 static void fh_rm(fh_entryt *fh_entry);
 
+static int fh_grow(void);
+
 static ti_entryt *ti_lookup(pds_transidt transid,
 			    int action);
 
 static void ti_rm(ti_entryt *ti_entry);
 
+static int ti_grow(void);
+
+static long table_size(long nentry);
+
 static lock_entryt *lock_insert(fh_entryt *fh_entry,
 				ti_entryt *ti_entry,
 				pds_transidt transid,
@@ -141,18 +211,87 @@ static lock_entryt *lock_insert(fh_entryt *fh_entry,
 				int lock);
 
 static void lock_rm(lock_entryt *lock_entry);
+
+static int lock_escalate(fh_entryt *fh_entry,
+			 ti_entryt *ti_entry,
+			 int lock);
+
+static void lock_tinsert(lock_entryt **root,
+			 lock_entryt *lock_entry);
+
+static void lock_tremove(lock_entryt **root,
+			 lock_entryt *lock_entry);
+
+static lock_entryt *lock_first(lock_entryt *lock_entry,
+			       pious_offt start,
+			       pious_offt stop,
+			       int lock);
+
+static lock_entryt *lock_next(lock_entryt *lock_entry,
+			      pious_offt start,
+			      pious_offt stop,
+			      int lock);
+
+static void lock_rotate(lock_entryt **root,
+			lock_entryt *lock_entry);
+
+static void lock_maxstop(lock_entryt *lock_entry);
+
+static int putwait(pds_transidt transid,
+		   pds_fhandlet fhandle,
+		   pious_offt start,
+		   pious_offt stop,
+		   int lock);
+
+static int waitconflict(pds_fhandlet fhandle,
+			pious_offt start,
+			pious_offt stop,
+			int lock);
+
+static void wait_rm(wait_entryt *wait_entry);
+
+static void wait_scan(fh_entryt *fh_entry,
+		      pious_offt start,
+		      pious_offt stop);
+
+static wait_entryt *wait_sort(wait_entryt *wait_list);
+
+static int wait_grant(wait_entryt *wait_entry);
+
+static ti_entryt *wait_edge(ti_entryt *ti_entry);
 #else
 static int getlock();
 static void ti_freelocks();
 
 static fh_entryt *fh_lookup();
 static void fh_rm();
+static int fh_grow();
 
 static ti_entryt *ti_lookup();
 static void ti_rm();
+static int ti_grow();
+
+static long table_size();
 
 static lock_entryt *lock_insert();
 static void lock_rm();
+static int lock_escalate();
+
+static void lock_tinsert();
+static void lock_tremove();
+
+static lock_entryt *lock_first();
+static lock_entryt *lock_next();
+static void lock_rotate();
+static void lock_maxstop();
+
+static int putwait();
+static int waitconflict();
+static void wait_rm();
+static void wait_scan();
+static wait_entryt *wait_sort();
+static int wait_grant();
+static ti_entryt *wait_edge();
 #endif
 
 
@@ -161,8 +300,20 @@ static void lock_rm();
  *
  */
 
-static fh_entryt *fh_table[FH_TABLE_SZ]; /* File handle hash table */
-static ti_entryt *ti_table[TI_TABLE_SZ]; /* Transaction Id hash table */
+static fh_entryt **fh_table;             /* File handle hash table */
+static long fh_table_sz;                 /* File handle hash table size */
+static long fh_cnt;                      /* File handle hash table entries */
+
+static ti_entryt **ti_table;             /* Transaction Id hash table */
+static long ti_table_sz;                 /* Transaction Id hash table size */
+static long ti_cnt;                      /* Transaction Id hash entries */
+
+static unsigned long lock_seed = 1;      /* Lock tree priority generator */
+
+static wait_entryt *wake_head;           /* Woken queue; earliest woken */
+static wait_entryt *wake_tail;           /* Woken queue; latest woken */
+
+static unsigned long dl_mark;            /* Deadlock search visit mark */
 
 
 
@@ -256,6 +407,245 @@ void LM_wfree(transid)
 
 
 
+/*
+ * LM_rwait() - See pds_lock_manager.h for description.
+ */
+
+#ifdef __STDC__
+int LM_rwait(pds_transidt transid,
+	     pds_fhandlet fhandle,
+	     pious_offt offset,
+	     pious_sizet nbyte)
+#else
+int LM_rwait(transid, fhandle, offset, nbyte)
+     pds_transidt transid;
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+#endif
+{
+  return putwait(transid, fhandle, offset,
+		 offset + (pious_offt)(nbyte - 1), READ);
+}
+
+
+
+
+/*
+ * LM_wwait() - See pds_lock_manager.h for description.
+ */
+
+#ifdef __STDC__
+int LM_wwait(pds_transidt transid,
+	     pds_fhandlet fhandle,
+	     pious_offt offset,
+	     pious_sizet nbyte)
+#else
+int LM_wwait(transid, fhandle, offset, nbyte)
+     pds_transidt transid;
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+#endif
+{
+  return putwait(transid, fhandle, offset,
+		 offset + (pious_offt)(nbyte - 1), WRITE);
+}
+
+
+
+
+/*
+ * LM_cancel() - See pds_lock_manager.h for description.
+ */
+
+#ifdef __STDC__
+void LM_cancel(pds_transidt transid)
+#else
+void LM_cancel(transid)
+     pds_transidt transid;
+#endif
+{
+  ti_entryt *ti_entry;
+  fh_entryt *fh_entry;
+  pious_offt start, stop;
+
+  /* locate transid in transaction id table */
+  ti_entry = ti_lookup(transid, NOINSERT);
+
+  if (ti_entry != NULL && ti_entry->wait != NULL)
+    { /* dequeue request and wake requests that were queued behind it */
+      fh_entry = ti_entry->wait->req.fhchain;
+      start    = ti_entry->wait->req.start;
+      stop     = ti_entry->wait->req.stop;
+
+      wait_rm(ti_entry->wait);
+
+      wait_scan(fh_entry, start, stop);
+
+      /* deallocate entries no longer referenced */
+      if (fh_entry->locks == NULL && fh_entry->whead == NULL)
+	fh_rm(fh_entry);
+
+      if (ti_entry->rlocks == NULL && ti_entry->wlocks == NULL)
+	ti_rm(ti_entry);
+    }
+}
+
+
+
+
+/*
+ * LM_woken() - See pds_lock_manager.h for description.
+ */
+
+#ifdef __STDC__
+int LM_woken(pds_transidt *transid)
+#else
+int LM_woken(transid)
+     pds_transidt *transid;
+#endif
+{
+  wait_entryt *wait_entry;
+
+  if ((wait_entry = wake_head) == NULL)
+    return FALSE;
+  else
+    { /* remove from head of woken queue; request remains queued on file */
+      wake_head = wait_entry->rnext;
+
+      if (wake_head != NULL)
+	wake_head->rprev = NULL;
+      else
+	wake_tail = NULL;
+
+      wait_entry->state = RETRIEVED;
+
+      *transid = wait_entry->req.transid;
+      return TRUE;
+    }
+}
+
+
+
+
+/*
+ * LM_rconflict() - See pds_lock_manager.h for description.
+ */
+
+#ifdef __STDC__
+int LM_rconflict(pds_fhandlet fhandle,
+		 pious_offt offset,
+		 pious_sizet nbyte)
+#else
+int LM_rconflict(fhandle, offset, nbyte)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+#endif
+{
+  return waitconflict(fhandle, offset,
+		      offset + (pious_offt)(nbyte - 1), READ);
+}
+
+
+
+
+/*
+ * LM_wconflict() - See pds_lock_manager.h for description.
+ */
+
+#ifdef __STDC__
+int LM_wconflict(pds_fhandlet fhandle,
+		 pious_offt offset,
+		 pious_sizet nbyte)
+#else
+int LM_wconflict(fhandle, offset, nbyte)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     pious_sizet nbyte;
+#endif
+{
+  return waitconflict(fhandle, offset,
+		      offset + (pious_offt)(nbyte - 1), WRITE);
+}
+
+
+
+
+/*
+ * LM_deadlock() - See pds_lock_manager.h for description.
+ */
+
+#ifdef __STDC__
+int LM_deadlock(pds_transidt transid,
+		pds_transidt *victim)
+#else
+int LM_deadlock(transid, victim)
+     pds_transidt transid;
+     pds_transidt *victim;
+#endif
+{
+  int cycle;
+  ti_entryt *ti_root, *ti_cur, *ti_succ;
+
+  cycle = FALSE;
+
+  /* locate transid in transaction id table */
+  ti_root = ti_lookup(transid, NOINSERT);
+
+  if (ti_root != NULL && ti_root->wait != NULL)
+    { /* depth-first search of wait-for graph for a path back to ti_root;
+       * transactions on the current path are linked via dparent.
+       */
+      dl_mark++;
+
+      ti_root->dmark   = dl_mark;
+      ti_root->dphase  = EDGE_INIT;
+      ti_root->dparent = NULL;
+
+      ti_cur = ti_root;
+
+      while (ti_cur != NULL && !cycle)
+	{
+	  ti_succ = wait_edge(ti_cur);
+
+	  if (ti_succ == NULL)
+	    /* all edges searched; backtrack */
+	    ti_cur = ti_cur->dparent;
+
+	  else if (ti_succ == ti_root)
+	    /* path from ti_cur back to ti_root; cycle found */
+	    cycle = TRUE;
+
+	  else if (ti_succ->dmark != dl_mark)
+	    { /* transaction not yet visited; extend path */
+	      ti_succ->dmark   = dl_mark;
+	      ti_succ->dphase  = EDGE_INIT;
+	      ti_succ->dparent = ti_cur;
+
+	      ti_cur = ti_succ;
+	    }
+	}
+
+      /* select the transaction in the cycle with the greatest transid */
+
+      if (cycle)
+	{
+	  *victim = ti_root->transid;
+
+	  for (; ti_cur != ti_root; ti_cur = ti_cur->dparent)
+	    if (transid_gt(ti_cur->transid, *victim))
+	      *victim = ti_cur->transid;
+	}
+    }
+
+  return cycle;
+}
+
+
+
+
 /*
  * getlock()
  *
@@ -289,9 +679,10 @@ static int getlock(transid, fhandle, start, stop, lock)
      int lock;
 #endif
 {
-  int owned, conflict, result;
-  fh_entryt *fh_entry;
+  int owned, conflict, result, subsumed;
+  fh_entryt *fh_entry, *wfh_entry;
   ti_entryt *ti_entry;
+  wait_entryt *wait_entry;
   register lock_entryt *lock_entry;
 
   /* Validate 'start', 'stop', and 'lock' arguments */
@@ -307,45 +698,35 @@ static int getlock(transid, fhandle, start, stop, lock)
 
   else /* check for conflicting locks */
     {
-      /* locks maintained in ascending order based on start position.
-       * can stop looking at locks when stop < lock_entry->start
+      /* locks maintained in an interval tree; only granted locks that
+       * overlap the requested lock are examined, of any type so that
+       * lock ownership is determined.
        *
-       * NOTE: Currently locks maintained in a simple linked list.
-       *       This provides sufficient performance for PIOUS calls,
-       *       but may prove inadequate if the number of locks for
-       *       a file becomes large, such as in using the PDS as a
-       *       "standard" transaction-oriented database system.
-       *
-       *       The semantics of lock ownership will no doubt require update
+       * NOTE: The semantics of lock ownership will no doubt require update
        *       when inter-group concurrency control mechanisms, beyond
        *       sequential consistency, are implemented.
        */
 
-      lock_entry  = fh_entry->locks; /* first file lock entry */
       owned       = FALSE; /* flag if equivalent lock already held */
       conflict    = FALSE; /* flag if there exists a conflicting lock */
 
-      while (!conflict && !owned &&
-	     lock_entry != NULL && stop >= lock_entry->start)
-	{ /* check if requested lock overlaps granted lock */
-
-	  if (start <= lock_entry->stop) /* && stop >= lock_entry->start */
-	    /* overlap; check for lock ownership or conflict */
+      for (lock_entry = lock_first(fh_entry->locks, start, stop, WRITE);
+	   !conflict && !owned && lock_entry != NULL;
+	   lock_entry = lock_next(lock_entry, start, stop, WRITE))
+	{ /* overlap; check for lock ownership or conflict */
 
-	    if (transid_eq(transid, lock_entry->transid))
-	      { /* owned; determine if granted lock subsumes requested lock */
+	  if (transid_eq(transid, lock_entry->transid))
+	    { /* owned; determine if granted lock subsumes requested lock */
 
-		if (start >= lock_entry->start && stop <= lock_entry->stop &&
-		    (lock == READ || lock_entry->lock == WRITE))
-		  owned = TRUE;
-	      }
+	      if (start >= lock_entry->start && stop <= lock_entry->stop &&
+		  (lock == READ || lock_entry->lock == WRITE))
+		owned = TRUE;
+	    }
 
-	    else /* overlapping lock does not belong to transid; confict? */
+	  else /* overlapping lock does not belong to transid; confict? */
 
-	      if (lock == WRITE || lock_entry->lock == WRITE)
-		conflict = TRUE;
-	  
-	  lock_entry = lock_entry->lnext; /* advance to next granted lock */
+	    if (lock == WRITE || lock_entry->lock == WRITE)
+	      conflict = TRUE;
 	}
 
       if (owned)
@@ -363,7 +744,14 @@ static int getlock(transid, fhandle, start, stop, lock)
 	    result = LM_DENY;
 	  else
 	    {
-	      /* Allocate and insert lock into lock table */
+	      /* escalate to a whole-file lock if transid holds too many */
+	      if (lock_escalate(fh_entry, ti_entry, lock))
+		{
+		  start = 0;
+		  stop  = PIOUS_OFFT_MAX;
+		}
+
+	      /* Insert lock into lock table, merging owned locks */
 	      lock_entry = lock_insert(fh_entry, ti_entry,
 				       transid, start, stop, lock);
 
@@ -376,14 +764,42 @@ static int getlock(transid, fhandle, start, stop, lock)
 	  if (result == LM_DENY)
 	    {
 	      /* deallocate created entries */
-	      if (fh_entry->locks == NULL)
+	      if (fh_entry->locks == NULL && fh_entry->whead == NULL)
 		fh_rm(fh_entry);
 
 	      if (ti_entry != NULL && ti_entry->rlocks == NULL &&
-		  ti_entry->wlocks == NULL)
+		  ti_entry->wlocks == NULL && ti_entry->wait == NULL)
 		ti_rm(ti_entry);
 	    }
 	}
+
+      /* lock granted; dequeue request queued by transid, if any. if the
+       * granted lock does not subsume the queued request then requests
+       * queued behind it may now be woken.
+       */
+
+      if (result == LM_GRANT &&
+	  (ti_entry = ti_lookup(transid, NOINSERT)) != NULL &&
+	  (wait_entry = ti_entry->wait) != NULL)
+	{
+	  wfh_entry = wait_entry->req.fhchain;
+
+	  subsumed = (wfh_entry == fh_entry &&
+		      start <= wait_entry->req.start &&
+		      stop >= wait_entry->req.stop &&
+		      (lock == WRITE || wait_entry->req.lock == READ));
+
+	  start = wait_entry->req.start;
+	  stop  = wait_entry->req.stop;
+
+	  wait_rm(wait_entry);
+
+	  if (!subsumed)
+	    wait_scan(wfh_entry, start, stop);
+
+	  if (wfh_entry->locks == NULL && wfh_entry->whead == NULL)
+	    fh_rm(wfh_entry);
+	}
     }
 
   return (result);
@@ -416,6 +832,7 @@ static void ti_freelocks(transid, lock)
 #endif
 {
   ti_entryt *ti_entry;
+  fh_entryt *fh_entry, *scan_list;
   register lock_entryt *lock_entry, *next_lock;
 
   /* Validate arguments */
@@ -433,18 +850,43 @@ static void ti_freelocks(transid, lock)
 	{
 	  lock_entry = ti_entry->rlocks;
 	  ti_entry->rlocks = NULL; /* entire chain to be deallocated */
+	  ti_entry->rcnt   = 0;
 	}
       else /* lock == WRITE */
 	{
 	  lock_entry = ti_entry->wlocks;
 	  ti_entry->wlocks = NULL; /* entire chain to be deallocated */
+	  ti_entry->wcnt   = 0;
 	}
       
       /* remove all 'lock' locks owned by transid */
+      scan_list = NULL;
+
       while (lock_entry != NULL)
 	{
 	  next_lock = lock_entry->onext;
 
+	  /* note file, and range released, to be scanned for queued
+	   * requests that can be woken once all locks are removed; file
+	   * handle entry is retained while requests are queued.
+	   */
+	  fh_entry = lock_entry->fhchain;
+
+	  if (fh_entry->whead != NULL && !fh_entry->wscan)
+	    {
+	      fh_entry->wscan  = TRUE;
+	      fh_entry->sstart = lock_entry->start;
+	      fh_entry->sstop  = lock_entry->stop;
+	      fh_entry->snext  = scan_list;
+	      scan_list        = fh_entry;
+	    }
+
+	  else if (fh_entry->wscan)
+	    {
+	      fh_entry->sstart = Min(fh_entry->sstart, lock_entry->start);
+	      fh_entry->sstop  = Max(fh_entry->sstop, lock_entry->stop);
+	    }
+
 	  /* NOTE: file handle hash chains updated by lock_rm(); see
            * description of lock_rm() for details.
 	   */
@@ -453,8 +895,19 @@ static void ti_freelocks(transid, lock)
 	  lock_entry = next_lock;
 	}
 
-      /* deallocate *ti_entry if no more associated locks */
-      if (ti_entry->rlocks == NULL && ti_entry->wlocks == NULL)
+      /* wake queued requests that can now be granted */
+      while (scan_list != NULL)
+	{
+	  fh_entry        = scan_list;
+	  scan_list       = fh_entry->snext;
+	  fh_entry->wscan = FALSE;
+
+	  wait_scan(fh_entry, fh_entry->sstart, fh_entry->sstop);
+	}
+
+      /* deallocate *ti_entry if no more associated locks or requests */
+      if (ti_entry->rlocks == NULL && ti_entry->wlocks == NULL &&
+	  ti_entry->wait == NULL)
 	ti_rm(ti_entry);
     }
 }
@@ -491,28 +944,41 @@ static fh_entryt *fh_lookup(fhandle, action)
   int index;
   register fh_entryt *fh_entry;
 
-  /* perform hash function on fhandle */
-  index = fhandle_hash(fhandle, FH_TABLE_SZ);
+  fh_entry = NULL;
+
+  if (fh_table != NULL)
+    { /* perform hash function on fhandle */
+      index = fhandle_hash(fhandle, fh_table_sz);
 
-  fh_entry = fh_table[index];
+      fh_entry = fh_table[index];
 
-  /* search appropriate file handle hash chain for fhandle */
-  while (fh_entry != NULL && !fhandle_eq(fhandle, fh_entry->fhandle))
-    fh_entry = fh_entry->fhnext;
+      /* search appropriate file handle hash chain for fhandle */
+      while (fh_entry != NULL && !fhandle_eq(fhandle, fh_entry->fhandle))
+	fh_entry = fh_entry->fhnext;
+    }
 
-  if (fh_entry == NULL && action == INSERT)
-    { /* fhandle not located; insert into appropriate file handle hash chain */
+  if (fh_entry == NULL && action == INSERT &&
+      (fh_cnt < fh_table_sz || fh_grow() == PIOUS_OK || fh_table != NULL))
+    { /* fhandle not located; insert into appropriate file handle hash chain.
+       * if the table could not be grown, then it is used at its current size.
+       */
 
+      index    = fhandle_hash(fhandle, fh_table_sz);
       fh_entry = (fh_entryt *)malloc((unsigned)sizeof(fh_entryt));
 
       if (fh_entry != NULL)
 	{ /* initialize and place at head of hash chain */
 	  fh_entry->fhandle = fhandle;
 	  fh_entry->locks   = NULL;
+	  fh_entry->waits   = NULL;
+	  fh_entry->whead   = NULL;
+	  fh_entry->wtail   = NULL;
+	  fh_entry->wscan   = FALSE;
 	  fh_entry->fhnext  = fh_table[index];
 	  fh_entry->fhprev  = NULL;
 
 	  fh_table[index] = fh_entry;
+	  fh_cnt++;
 
 	  /* reset 'previous' pointer of former head, if extant */
 	  if (fh_entry->fhnext != NULL)
@@ -556,9 +1022,11 @@ static void fh_rm(fh_entry)
 	fh_entry->fhprev->fhnext = fh_entry->fhnext;
       else
 	/* first in chain, reset file handle hash table entry */
-	fh_table[fhandle_hash(fh_entry->fhandle, FH_TABLE_SZ)] =
+	fh_table[fhandle_hash(fh_entry->fhandle, fh_table_sz)] =
 	  fh_entry->fhnext;
 
+      fh_cnt--;
+
       free((char *)fh_entry); /* deallocate storage for fh_entry */
     }
 }
@@ -566,6 +1034,74 @@ static void fh_rm(fh_entry)
 
 
 
+/*
+ * fh_grow()
+ *
+ * Parameters:
+ *
+ * Allocate the file handle hash table at its initial size, or grow it to
+ * twice the number of entries, re-hashing all entries.  On failure the
+ * table is unaltered.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - table successfully allocated/grown
+ *   PIOUS_EINSUF - insufficient system resources
+ */
+
+#ifdef __STDC__
+static int fh_grow(void)
+#else
+static int fh_grow()
+#endif
+{
+  int rcode, index;
+  long tsize, i;
+  fh_entryt **table, *fh_entry, *fh_next;
+
+  /* allocate table */
+  tsize = ((fh_table == NULL) ? FH_TABLE_SZ : table_size(2 * fh_cnt));
+
+  table = (fh_entryt **)malloc((unsigned)(tsize * sizeof(fh_entryt *)));
+
+  if (table == NULL)
+    rcode = PIOUS_EINSUF;
+
+  else
+    { /* move entries to chains of new table */
+      for (i = 0; i < tsize; i++)
+	table[i] = NULL;
+
+      for (i = 0; i < fh_table_sz; i++)
+	for (fh_entry = fh_table[i]; fh_entry != NULL; fh_entry = fh_next)
+	  {
+	    fh_next = fh_entry->fhnext;
+	    index   = fhandle_hash(fh_entry->fhandle, tsize);
+
+	    fh_entry->fhprev = NULL;
+	    fh_entry->fhnext = table[index];
+
+	    if (table[index] != NULL)
+	      table[index]->fhprev = fh_entry;
+
+	    table[index] = fh_entry;
+	  }
+
+      if (fh_table != NULL)
+	free((char *)fh_table);
+
+      fh_table    = table;
+      fh_table_sz = tsize;
+
+      rcode = PIOUS_OK;
+    }
+
+  return rcode;
+}
+
+
+
+
 /*
  * ti_lookup()
  *
@@ -595,18 +1131,26 @@ static ti_entryt *ti_lookup(transid, action)
   int index;
   register ti_entryt *ti_entry;
 
-  /* perform hash function on transid */
-  index = transid_hash(transid, TI_TABLE_SZ);
+  ti_entry = NULL;
 
-  ti_entry = ti_table[index];
+  if (ti_table != NULL)
+    { /* perform hash function on transid */
+      index = transid_hash(transid, ti_table_sz);
 
-  /* search appropriate transaction id hash chain for transid */
-  while (ti_entry != NULL && !transid_eq(transid, ti_entry->transid))
-    ti_entry = ti_entry->tinext;
+      ti_entry = ti_table[index];
 
-  if (ti_entry == NULL && action == INSERT)
-    { /* transid not located; insert into transaction id hash chain */
+      /* search appropriate transaction id hash chain for transid */
+      while (ti_entry != NULL && !transid_eq(transid, ti_entry->transid))
+	ti_entry = ti_entry->tinext;
+    }
+
+  if (ti_entry == NULL && action == INSERT &&
+      (ti_cnt < ti_table_sz || ti_grow() == PIOUS_OK || ti_table != NULL))
+    { /* transid not located; insert into transaction id hash chain.
+       * if the table could not be grown, then it is used at its current size.
+       */
 
+      index    = transid_hash(transid, ti_table_sz);
       ti_entry = (ti_entryt *)malloc((unsigned)sizeof(ti_entryt));
 
       if (ti_entry != NULL)
@@ -614,10 +1158,15 @@ static ti_entryt *ti_lookup(transid, action)
 	  ti_entry->transid = transid;
 	  ti_entry->rlocks   = NULL;
 	  ti_entry->wlocks   = NULL;
+	  ti_entry->rcnt     = 0;
+	  ti_entry->wcnt     = 0;
+	  ti_entry->wait     = NULL;
+	  ti_entry->dmark    = 0;
 	  ti_entry->tinext   = ti_table[index];
 	  ti_entry->tiprev   = NULL;
 
 	  ti_table[index] = ti_entry;
+	  ti_cnt++;
 
 	  /* reset 'previous' pointer of former head, if extant */
 	  if (ti_entry->tinext != NULL)
@@ -661,29 +1210,163 @@ static void ti_rm(ti_entry)
 	ti_entry->tiprev->tinext = ti_entry->tinext;
       else
 	/* first in chain, reset transaction id hash table entry */
-	ti_table[transid_hash(ti_entry->transid, TI_TABLE_SZ)] =
+	ti_table[transid_hash(ti_entry->transid, ti_table_sz)] =
 	  ti_entry->tinext;
 
+      ti_cnt--;
+
       free((char *)ti_entry); /* deallocate storage for ti_entry */
     }
 }
 
 
 
+
 /*
- * lock_insert()
+ * ti_grow()
  *
  * Parameters:
  *
- *   fh_entry - file handle hash chain entry associated with lock
- *   ti_entry - transaction id hash chain entry associated with lock
+ * Allocate the transaction id hash table at its initial size, or grow it
+ * to twice the number of entries, re-hashing all entries.  On failure the
+ * table is unaltered.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - table successfully allocated/grown
+ *   PIOUS_EINSUF - insufficient system resources
+ */
+
+#ifdef __STDC__
+static int ti_grow(void)
+#else
+static int ti_grow()
+#endif
+{
+  int rcode, index;
+  long tsize, i;
+  ti_entryt **table, *ti_entry, *ti_next;
+
+  /* allocate table */
+  tsize = ((ti_table == NULL) ? TI_TABLE_SZ : table_size(2 * ti_cnt));
+
+  table = (ti_entryt **)malloc((unsigned)(tsize * sizeof(ti_entryt *)));
+
+  if (table == NULL)
+    rcode = PIOUS_EINSUF;
+
+  else
+    { /* move entries to chains of new table */
+      for (i = 0; i < tsize; i++)
+	table[i] = NULL;
+
+      for (i = 0; i < ti_table_sz; i++)
+	for (ti_entry = ti_table[i]; ti_entry != NULL; ti_entry = ti_next)
+	  {
+	    ti_next = ti_entry->tinext;
+	    index   = transid_hash(ti_entry->transid, tsize);
+
+	    ti_entry->tiprev = NULL;
+	    ti_entry->tinext = table[index];
+
+	    if (table[index] != NULL)
+	      table[index]->tiprev = ti_entry;
+
+	    table[index] = ti_entry;
+	  }
+
+      if (ti_table != NULL)
+	free((char *)ti_table);
+
+      ti_table    = table;
+      ti_table_sz = tsize;
+
+      rcode = PIOUS_OK;
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * table_size()
+ *
+ * Parameters:
+ *
+ *   nentry - expected number of hash table entries
+ *
+ * Determine a hash table size for 'nentry' entries; the size is the
+ * smallest prime, not near a power of 2, that is greater than or equal to
+ * 'nentry'.
+ *
+ * Returns:
+ *
+ *   long - hash table size
+ */
+
+#ifdef __STDC__
+static long table_size(long nentry)
+#else
+static long table_size(nentry)
+     long nentry;
+#endif
+{
+  long tsize, pow2, div;
+  int prime;
+
+  tsize = Max(nentry, 2);
+
+  /* avoid sizes within 1/8 of a power of 2 */
+  for (pow2 = 1; pow2 < tsize; pow2 *= 2);
+
+  if (tsize > pow2 - (pow2 / 8))
+    tsize = pow2 + (pow2 / 8);
+  else if (tsize < (pow2 / 2) + (pow2 / 16))
+    tsize = (pow2 / 2) + (pow2 / 16);
+
+  /* locate next prime; trial division is adequate as tables double */
+  if (tsize % 2 == 0)
+    tsize++;
+
+  do
+    {
+      prime = TRUE;
+
+      for (div = 3; div * div <= tsize && prime; div += 2)
+	if (tsize % div == 0)
+	  prime = FALSE;
+
+      if (!prime)
+	tsize += 2;
+    }
+  while (!prime);
+
+  return tsize;
+}
+
+
+
+/*
+ * lock_insert()
+ *
+ * Parameters:
+ *
+ *   fh_entry - file handle hash chain entry associated with lock
+ *   ti_entry - transaction id hash chain entry associated with lock
  *   transid  - transaction id
  *   start    - start byte
  *   stop     - stop byte
  *   lock     - lock type
  *
- * Allocate and insert a lock into the lock table.  The lock is to
- * be associate with the file 'fh_entry' and the transaction 'ti_entry'.
+ * Insert a lock into the lock table.  The lock is to be associate with
+ * the file 'fh_entry' and the transaction 'ti_entry'.
+ *
+ * Locks of type 'lock' held by the transaction on the file that overlap or
+ * adjoin the lock are merged with it, such that a transaction's locks of a
+ * given type on a file are disjoint and non-adjacent; a lock is allocated
+ * only if there are none.
  *
  * Returns:
  *   lock_entryt * - pointer to lock_entry
@@ -709,7 +1392,8 @@ static lock_entryt *lock_insert(fh_entry, ti_entry, transid, start, stop, lock)
      int lock;
 #endif
 {
-  register lock_entryt *lock_entry, *cur_lpos, *last_lpos;
+  pious_offt adj_start, adj_stop;
+  register lock_entryt *lock_entry, *next_lock, *cur_lpos;
 
   /* Check that arguments are valid */
 
@@ -719,62 +1403,168 @@ static lock_entryt *lock_insert(fh_entry, ti_entry, transid, start, stop, lock)
 
   /* Valid arguments; begin function */
 
-  lock_entry = (lock_entryt *)malloc((unsigned)sizeof(lock_entryt));
+  /* Step 1: merge owned 'lock' locks that overlap or adjoin the lock;
+   *         the first such lock is retained, others are deallocated.
+   */
+
+  adj_start  = (start > 0 ? start - 1 : start);
+  adj_stop   = (stop < PIOUS_OFFT_MAX ? stop + 1 : stop);
 
-  if (lock_entry != NULL) /* lock space allocated */
+  lock_entry = NULL;
+
+  for (cur_lpos = lock_first(fh_entry->locks, adj_start, adj_stop, WRITE);
+       cur_lpos != NULL;
+       cur_lpos = next_lock)
     {
-      /* Step 1: initialize constant lock information */
+      next_lock = lock_next(cur_lpos, adj_start, adj_stop, WRITE);
+
+      if (cur_lpos->lock == lock && transid_eq(transid, cur_lpos->transid))
+	{ /* owned; extend lock to include */
+	  start = Min(start, cur_lpos->start);
+	  stop  = Max(stop, cur_lpos->stop);
+
+	  if (lock_entry == NULL)
+	    lock_entry = cur_lpos;
+	  else
+	    { /* remove from *fh_entry 'locks' tree and *ti_entry chain */
+	      lock_tremove(&(fh_entry->locks), cur_lpos);
+
+	      if (cur_lpos->onext != NULL)
+		cur_lpos->onext->oprev = cur_lpos->oprev;
+
+	      if (cur_lpos->oprev != NULL)
+		cur_lpos->oprev->onext = cur_lpos->onext;
+	      else if (lock == READ)
+		ti_entry->rlocks = cur_lpos->onext;
+	      else
+		ti_entry->wlocks = cur_lpos->onext;
+
+	      if (lock == READ)
+		ti_entry->rcnt--;
+	      else
+		ti_entry->wcnt--;
+
+	      free((char *)cur_lpos);
+	    }
+	}
+    }
+
+  if (lock_entry != NULL)
+    { /* Step 2: re-position retained lock in *fh_entry 'locks' tree */
+      lock_tremove(&(fh_entry->locks), lock_entry);
+
+      lock_entry->start = start;
+      lock_entry->stop  = stop;
+
+      lock_tinsert(&(fh_entry->locks), lock_entry);
+    }
+
+  else if ((lock_entry =
+	    (lock_entryt *)malloc((unsigned)sizeof(lock_entryt))) != NULL)
+    { /* Step 2: initialize constant lock information */
       lock_entry->transid  = transid;
       lock_entry->start    = start;
       lock_entry->stop     = stop;
       lock_entry->lock     = lock;
       lock_entry->fhchain  = fh_entry;
+      lock_entry->oprev    = NULL;
 
-      /* Step 2: place lock at head of *ti_entry 'rlocks' or 'wlocks' chain */
+      /* Step 3: place lock at head of *ti_entry 'rlocks' or 'wlocks' chain */
 
       if (lock == READ) /* place at head of rlocks chain */
 	{
 	  lock_entry->onext = ti_entry->rlocks;
 	  ti_entry->rlocks  = lock_entry;
+	  ti_entry->rcnt++;
 	}
       else /* lock == WRITE so place at head of wlocks chain */
 	{
 	  lock_entry->onext = ti_entry->wlocks;
 	  ti_entry->wlocks  = lock_entry;
+	  ti_entry->wcnt++;
 	}
 
-      /* Step 3: place lock at appropriate position in *fh_entry 'locks'
-       * chain.  locks maintained in ascending order based on start position.
-       */
+      if (lock_entry->onext != NULL)
+	lock_entry->onext->oprev = lock_entry;
 
-      last_lpos = NULL;
-      cur_lpos  = fh_entry->locks;
+      /* Step 4: place lock in *fh_entry 'locks' tree */
+      lock_tinsert(&(fh_entry->locks), lock_entry);
+    }
 
-      /* search lock chain for insert position */
+  return (lock_entry);
+}
 
-      while (cur_lpos != NULL && start > cur_lpos->start)
-	{
-	  last_lpos = cur_lpos;
-	  cur_lpos  = cur_lpos->lnext;
-	}
 
-      /* insert lock between last_lpos and cur_lpos */
 
-      lock_entry->lprev = last_lpos;
-      lock_entry->lnext = cur_lpos;
 
-      /* reset 'prev' pointer of 'next' entry relative to lock_entry */
-      if (lock_entry->lnext != NULL)
-	lock_entry->lnext->lprev = lock_entry;
+/*
+ * lock_escalate()
+ *
+ * Parameters:
+ *
+ *   fh_entry - file handle hash chain entry
+ *   ti_entry - transaction id hash chain entry
+ *   lock     - lock type
+ *
+ * Determine if a further 'lock' lock for transaction 'ti_entry' on file
+ * 'fh_entry' should be escalated to a whole-file lock; i.e. if at least
+ * PDS_LM_ESCALATE 'lock' locks are already held on the file, and no other
+ * transaction holds, or has queued a request for, a lock on the file that
+ * conflicts with a whole-file 'lock' lock.  A value of zero (0) for
+ * PDS_LM_ESCALATE disables escalation.
+ *
+ * Returns:
+ *
+ *   TRUE  (1) - escalate to whole-file lock
+ *   FALSE (0) - do not escalate
+ */
+
+#ifdef __STDC__
+static int lock_escalate(fh_entryt *fh_entry,
+			 ti_entryt *ti_entry,
+			 int lock)
+#else
+static int lock_escalate(fh_entry, ti_entry, lock)
+     fh_entryt *fh_entry;
+     ti_entryt *ti_entry;
+     int lock;
+#endif
+{
+  int escalate;
+  long cnt;
+  register lock_entryt *lock_entry;
+
+  escalate = FALSE;
+
+  if (PDS_LM_ESCALATE > 0 &&
+      (lock == READ ? ti_entry->rcnt : ti_entry->wcnt) >= PDS_LM_ESCALATE)
+    { /* count 'lock' locks held on file */
+      cnt = 0;
+
+      for (lock_entry = (lock == READ ? ti_entry->rlocks : ti_entry->wlocks);
+	   lock_entry != NULL && cnt < PDS_LM_ESCALATE;
+	   lock_entry = lock_entry->onext)
+	if (lock_entry->fhchain == fh_entry)
+	  cnt++;
 
-      /* reset 'next' pointer of 'prev' entry relative to lock_entry */
-      if (lock_entry->lprev != NULL)
-	lock_entry->lprev->lnext = lock_entry;
-      else
-	fh_entry->locks = lock_entry;
+      escalate = (cnt >= PDS_LM_ESCALATE);
+
+      /* check for conflicting locks or requests of other transactions */
+
+      for (lock_entry = lock_first(fh_entry->locks, 0, PIOUS_OFFT_MAX, lock);
+	   escalate && lock_entry != NULL;
+	   lock_entry = lock_next(lock_entry, 0, PIOUS_OFFT_MAX, lock))
+	if (!transid_eq(ti_entry->transid, lock_entry->transid))
+	  escalate = FALSE;
+
+      for (lock_entry = lock_first(fh_entry->waits, 0, PIOUS_OFFT_MAX, lock);
+	   escalate && lock_entry != NULL;
+	   lock_entry = lock_next(lock_entry, 0, PIOUS_OFFT_MAX, lock))
+	if (!transid_eq(ti_entry->transid, lock_entry->transid))
+	  escalate = FALSE;
     }
 
-  return (lock_entry);
+  return escalate;
 }
 
 
@@ -787,7 +1577,7 @@ static lock_entryt *lock_insert(fh_entry, ti_entry, transid, start, stop, lock)
  *
  *   lock_entry - lock table entry
  *
- * Remove lock_entry from chain of locks associated with a given file handle
+ * Remove lock_entry from tree of locks associated with a given file handle
  * and deallocate space.
  *
  * Returns:
@@ -795,8 +1585,9 @@ static lock_entryt *lock_insert(fh_entry, ti_entry, transid, start, stop, lock)
  * Note:
  *
  *   If lock_entry is the last lock associated with a given file handle,
- *   then that file handle entry is removed. Thus lock_rm() can have the
- *   side effect of altering a file handle hash chain via a call to fh_rm().
+ *   and no requests are queued on the file, then that file handle entry
+ *   is removed. Thus lock_rm() can have the side effect of altering a file
+ *   handle hash chain via a call to fh_rm().
  *
  *   Lock_entry is also an entry in a chain of locks associated with a given
  *   transaction id. This chain of locks is NOT updated when lock_entry
@@ -816,24 +1607,949 @@ static void lock_rm(lock_entry)
 {
   if (lock_entry != NULL)
     {
-      /* remove lock_entry from file handle locks chain */
-
-      /* if not last in chain, reset 'previous' pointer of 'next' entry */
-      if (lock_entry->lnext != NULL)
-	lock_entry->lnext->lprev = lock_entry->lprev;
-
-      /* if not first in chain, reset 'next' pointer of 'previous' entry */
-      if (lock_entry->lprev != NULL)
-	lock_entry->lprev->lnext = lock_entry->lnext;
-      else
-	/* first; reset associated fhchain->locks entry; noted side effect  */
-	lock_entry->fhchain->locks = lock_entry->lnext;
+      /* remove lock_entry from file handle locks tree */
+      lock_tremove(&(lock_entry->fhchain->locks), lock_entry);
 
-      /* Deallocate file handle entry if no more locks on file */
-      if  (lock_entry->fhchain->locks == NULL)
+      /* Deallocate file handle entry if no more locks or requests on file */
+      if  (lock_entry->fhchain->locks == NULL &&
+	   lock_entry->fhchain->whead == NULL)
 	fh_rm(lock_entry->fhchain);
 
       /* Deallocate lock space */
       free((char *)lock_entry);
     }
 }
+
+
+
+
+/*
+ * lock_tinsert()
+ *
+ * Parameters:
+ *
+ *   root       - lock tree root
+ *   lock_entry - lock table entry
+ *
+ * Insert 'lock_entry' into the lock tree 'root'.  A lock tree is a treap,
+ * ordered by start position and heap ordered by a random priority, with
+ * each lock recording the maximum stop position of all locks, and of write
+ * locks, in its subtree (an interval tree).  Both the locks and the queued
+ * requests of a file are maintained in a lock tree.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void lock_tinsert(lock_entryt **root,
+			 lock_entryt *lock_entry)
+#else
+static void lock_tinsert(root, lock_entry)
+     lock_entryt **root;
+     lock_entryt *lock_entry;
+#endif
+{
+  register lock_entryt *cur_lpos, *last_lpos;
+
+  lock_seed = lock_seed * 1103515245 + 12345;
+
+  lock_entry->prio    = (lock_seed >> 16) & 0x7fff;
+  lock_entry->lleft   = lock_entry->lright = NULL;
+
+  lock_maxstop(lock_entry);
+
+  /* search lock tree for leaf insert position, extending maxstop */
+
+  last_lpos = NULL;
+  cur_lpos  = *root;
+
+  while (cur_lpos != NULL)
+    {
+      if (lock_entry->stop > cur_lpos->maxstop)
+	cur_lpos->maxstop = lock_entry->stop;
+
+      if (lock_entry->lock == WRITE && lock_entry->stop > cur_lpos->wmaxstop)
+	cur_lpos->wmaxstop = lock_entry->stop;
+
+      last_lpos = cur_lpos;
+
+      if (lock_entry->start < cur_lpos->start)
+	cur_lpos = cur_lpos->lleft;
+      else
+	cur_lpos = cur_lpos->lright;
+    }
+
+  /* insert lock as child of last_lpos */
+
+  lock_entry->lparent = last_lpos;
+
+  if (last_lpos == NULL)
+    *root = lock_entry;
+  else if (lock_entry->start < last_lpos->start)
+    last_lpos->lleft = lock_entry;
+  else
+    last_lpos->lright = lock_entry;
+
+  /* restore heap order */
+
+  while (lock_entry->lparent != NULL &&
+	 lock_entry->prio > lock_entry->lparent->prio)
+    lock_rotate(root, lock_entry);
+}
+
+
+
+
+/*
+ * lock_tremove()
+ *
+ * Parameters:
+ *
+ *   root       - lock tree root
+ *   lock_entry - lock table entry
+ *
+ * Remove 'lock_entry' from the lock tree 'root'; space is NOT deallocated.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void lock_tremove(lock_entryt **root,
+			 lock_entryt *lock_entry)
+#else
+static void lock_tremove(root, lock_entry)
+     lock_entryt **root;
+     lock_entryt *lock_entry;
+#endif
+{
+  register lock_entryt *child, *parent;
+
+  /* rotate lock_entry down, preserving heap order, until it has at
+   * most one child
+   */
+  while (lock_entry->lleft != NULL && lock_entry->lright != NULL)
+    if (lock_entry->lleft->prio > lock_entry->lright->prio)
+      lock_rotate(root, lock_entry->lleft);
+    else
+      lock_rotate(root, lock_entry->lright);
+
+  /* replace lock_entry with its child, if any */
+
+  if (lock_entry->lleft != NULL)
+    child = lock_entry->lleft;
+  else
+    child = lock_entry->lright;
+
+  parent = lock_entry->lparent;
+
+  if (child != NULL)
+    child->lparent = parent;
+
+  if (parent == NULL)
+    *root = child;
+  else if (parent->lleft == lock_entry)
+    parent->lleft = child;
+  else
+    parent->lright = child;
+
+  /* update maxstop of ancestors */
+  for (; parent != NULL; parent = parent->lparent)
+    lock_maxstop(parent);
+}
+
+
+
+
+/*
+ * lock_first()
+ *
+ * Parameters:
+ *
+ *   lock_entry - lock tree root
+ *   start      - start byte
+ *   stop       - stop byte
+ *   lock       - lock type
+ *
+ * Locate the lock, in the lock tree rooted at 'lock_entry', with the least
+ * start position of those locks overlapping bytes 'start' through 'stop'
+ * that conflict with a 'lock' lock; i.e. of all overlapping locks if 'lock'
+ * is WRITE, and of overlapping write locks if 'lock' is READ.  Subtrees with
+ * no such lock extending to 'start' are not examined.
+ *
+ * Returns:
+ *
+ *   lock_entryt * - pointer to overlapping lock
+ *   NULL          - no overlapping lock
+ */
+
+#ifdef __STDC__
+static lock_entryt *lock_first(lock_entryt *lock_entry,
+			       pious_offt start,
+			       pious_offt stop,
+			       int lock)
+#else
+static lock_entryt *lock_first(lock_entry, start, stop, lock)
+     lock_entryt *lock_entry;
+     pious_offt start;
+     pious_offt stop;
+     int lock;
+#endif
+{
+  register lock_entryt *cur_lpos;
+
+  cur_lpos = lock_entry;
+
+  if (cur_lpos != NULL && Lmaxstop(cur_lpos, lock) < start)
+    cur_lpos = NULL;
+
+  /* invariant: some conflicting lock in subtree cur_lpos extends to 'start' */
+
+  while (cur_lpos != NULL)
+    {
+      if (cur_lpos->lleft != NULL && Lmaxstop(cur_lpos->lleft, lock) >= start)
+	/* an overlapping lock, if any, with least start is in left subtree */
+	cur_lpos = cur_lpos->lleft;
+
+      else if (cur_lpos->start > stop)
+	/* no lock with greater or equal start overlaps */
+	cur_lpos = NULL;
+
+      else if (cur_lpos->stop >= start &&
+	       (lock == WRITE || cur_lpos->lock == WRITE))
+	/* overlap */
+	break;
+
+      else if (cur_lpos->lright != NULL &&
+	       Lmaxstop(cur_lpos->lright, lock) >= start)
+	cur_lpos = cur_lpos->lright;
+
+      else
+	cur_lpos = NULL;
+    }
+
+  return (cur_lpos);
+}
+
+
+
+
+/*
+ * lock_next()
+ *
+ * Parameters:
+ *
+ *   lock_entry - lock table entry
+ *   start      - start byte
+ *   stop       - stop byte
+ *   lock       - lock type
+ *
+ * Locate the lock following 'lock_entry', in order of start position, that
+ * overlaps bytes 'start' through 'stop' and conflicts with a 'lock' lock;
+ * 'lock_entry' is as located by lock_first() or lock_next() for the same
+ * byte range and lock type.
+ *
+ * Returns:
+ *
+ *   lock_entryt * - pointer to overlapping lock
+ *   NULL          - no further overlapping lock
+ */
+
+#ifdef __STDC__
+static lock_entryt *lock_next(lock_entryt *lock_entry,
+			      pious_offt start,
+			      pious_offt stop,
+			      int lock)
+#else
+static lock_entryt *lock_next(lock_entry, start, stop, lock)
+     lock_entryt *lock_entry;
+     pious_offt start;
+     pious_offt stop;
+     int lock;
+#endif
+{
+  register lock_entryt *cur_lpos;
+
+  cur_lpos = lock_entry;
+
+  while (TRUE)
+    {
+      /* search right subtree, which follows cur_lpos in order */
+      if (cur_lpos->lright != NULL &&
+	  Lmaxstop(cur_lpos->lright, lock) >= start)
+	return (lock_first(cur_lpos->lright, start, stop, lock));
+
+      /* ascend to the ancestor that next follows cur_lpos in order */
+      while (cur_lpos->lparent != NULL &&
+	     cur_lpos->lparent->lright == cur_lpos)
+	cur_lpos = cur_lpos->lparent;
+
+      cur_lpos = cur_lpos->lparent;
+
+      if (cur_lpos == NULL || cur_lpos->start > stop)
+	return (NULL);
+
+      if (cur_lpos->stop >= start &&
+	  (lock == WRITE || cur_lpos->lock == WRITE))
+	return (cur_lpos);
+    }
+}
+
+
+
+
+/*
+ * lock_rotate()
+ *
+ * Parameters:
+ *
+ *   root       - lock tree root
+ *   lock_entry - lock table entry
+ *
+ * Rotate 'lock_entry' above its parent in the lock tree 'root', preserving
+ * start position order and updating maxstop of both.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void lock_rotate(lock_entryt **root,
+			lock_entryt *lock_entry)
+#else
+static void lock_rotate(root, lock_entry)
+     lock_entryt **root;
+     lock_entryt *lock_entry;
+#endif
+{
+  register lock_entryt *parent, *grandparent;
+
+  parent      = lock_entry->lparent;
+  grandparent = parent->lparent;
+
+  /* parent adopts lock_entry's inner subtree */
+
+  if (parent->lleft == lock_entry)
+    {
+      parent->lleft = lock_entry->lright;
+
+      if (lock_entry->lright != NULL)
+	lock_entry->lright->lparent = parent;
+
+      lock_entry->lright = parent;
+    }
+  else
+    {
+      parent->lright = lock_entry->lleft;
+
+      if (lock_entry->lleft != NULL)
+	lock_entry->lleft->lparent = parent;
+
+      lock_entry->lleft = parent;
+    }
+
+  parent->lparent     = lock_entry;
+  lock_entry->lparent = grandparent;
+
+  /* lock_entry replaces parent as child of grandparent */
+
+  if (grandparent == NULL)
+    *root = lock_entry;
+  else if (grandparent->lleft == parent)
+    grandparent->lleft = lock_entry;
+  else
+    grandparent->lright = lock_entry;
+
+  lock_maxstop(parent);
+  lock_maxstop(lock_entry);
+}
+
+
+
+
+/*
+ * lock_maxstop()
+ *
+ * Parameters:
+ *
+ *   lock_entry - lock table entry
+ *
+ * Set maxstop and wmaxstop of 'lock_entry' from its stop position and the
+ * maxstop and wmaxstop of its children.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void lock_maxstop(lock_entryt *lock_entry)
+#else
+static void lock_maxstop(lock_entry)
+     lock_entryt *lock_entry;
+#endif
+{
+  lock_entry->maxstop = lock_entry->stop;
+
+  if (lock_entry->lock == WRITE)
+    lock_entry->wmaxstop = lock_entry->stop;
+  else
+    lock_entry->wmaxstop = -1;
+
+  if (lock_entry->lleft != NULL)
+    {
+      lock_entry->maxstop  = Max(lock_entry->maxstop,
+				 lock_entry->lleft->maxstop);
+      lock_entry->wmaxstop = Max(lock_entry->wmaxstop,
+				 lock_entry->lleft->wmaxstop);
+    }
+
+  if (lock_entry->lright != NULL)
+    {
+      lock_entry->maxstop  = Max(lock_entry->maxstop,
+				 lock_entry->lright->maxstop);
+      lock_entry->wmaxstop = Max(lock_entry->wmaxstop,
+				 lock_entry->lright->wmaxstop);
+    }
+}
+
+
+
+
+/*
+ * putwait()
+ *
+ * Parameters:
+ *
+ *   transid  - transaction id
+ *   fhandle  - file handle
+ *   start    - start byte
+ *   stop     - stop byte
+ *   lock     - lock type
+ *
+ * Queue request for lock, at the tail of the wait queue for 'fhandle'.  If
+ * a request is already queued for 'transid' then it retains its position
+ * and is re-queued as waiting.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK     - request queued
+ *   PIOUS_EINVAL - invalid byte range or lock type
+ *   PIOUS_EINSUF - insufficient system resources to queue request
+ */
+
+#ifdef __STDC__
+static int putwait(pds_transidt transid,
+		   pds_fhandlet fhandle,
+		   pious_offt start,
+		   pious_offt stop,
+		   int lock)
+#else
+static int putwait(transid, fhandle, start, stop, lock)
+     pds_transidt transid;
+     pds_fhandlet fhandle;
+     pious_offt start;
+     pious_offt stop;
+     int lock;
+#endif
+{
+  int rcode;
+  fh_entryt *fh_entry;
+  ti_entryt *ti_entry;
+  wait_entryt *wait_entry;
+
+  /* Validate 'start', 'stop', and 'lock' arguments */
+
+  if ((lock != READ && lock != WRITE) || stop < start)
+    return(PIOUS_EINVAL);
+
+  /* Locate/insert transid in transaction id table */
+  ti_entry = ti_lookup(transid, INSERT);
+
+  if (ti_entry == NULL) /* ti_lookup() couldn't allocate space */
+    rcode = PIOUS_EINSUF;
+
+  else if ((wait_entry = ti_entry->wait) != NULL)
+    { /* request already queued; retains position; remove from woken queue */
+      if (wait_entry->state == WOKEN)
+	{
+	  if (wait_entry->rnext != NULL)
+	    wait_entry->rnext->rprev = wait_entry->rprev;
+	  else
+	    wake_tail = wait_entry->rprev;
+
+	  if (wait_entry->rprev != NULL)
+	    wait_entry->rprev->rnext = wait_entry->rnext;
+	  else
+	    wake_head = wait_entry->rnext;
+	}
+
+      wait_entry->state = QUEUED;
+
+      rcode = PIOUS_OK;
+    }
+
+  else
+    { /* Locate/insert fhandle in lock table (fhandle hash chain) */
+      fh_entry = fh_lookup(fhandle, INSERT);
+
+      if (fh_entry == NULL) /* fh_lookup() couldn't allocate space */
+	rcode = PIOUS_EINSUF;
+
+      else if ((wait_entry =
+		(wait_entryt *)malloc((unsigned)sizeof(wait_entryt))) == NULL)
+	{ /* can not allocate space; deallocate created entry */
+	  rcode = PIOUS_EINSUF;
+
+	  if (fh_entry->locks == NULL && fh_entry->whead == NULL)
+	    fh_rm(fh_entry);
+	}
+
+      else
+	{ /* initialize request; sequence restarts when wait queue empty */
+	  if (fh_entry->whead == NULL)
+	    fh_entry->wseq = 0;
+
+	  wait_entry->req.transid = transid;
+	  wait_entry->req.start   = start;
+	  wait_entry->req.stop    = stop;
+	  wait_entry->req.lock    = lock;
+	  wait_entry->req.onext   = NULL;
+	  wait_entry->req.oprev   = NULL;
+	  wait_entry->req.fhchain = fh_entry;
+
+	  wait_entry->seq     = fh_entry->wseq++;
+	  wait_entry->state   = QUEUED;
+	  wait_entry->tichain = ti_entry;
+
+	  /* place request in *fh_entry 'waits' tree */
+	  lock_tinsert(&(fh_entry->waits), &(wait_entry->req));
+
+	  /* place request at tail of file wait queue */
+	  wait_entry->wnext = NULL;
+	  wait_entry->wprev = fh_entry->wtail;
+
+	  if (wait_entry->wprev != NULL)
+	    wait_entry->wprev->wnext = wait_entry;
+	  else
+	    fh_entry->whead = wait_entry;
+
+	  fh_entry->wtail = wait_entry;
+
+	  ti_entry->wait = wait_entry;
+
+	  rcode = PIOUS_OK;
+	}
+
+      /* deallocate *ti_entry if created for request not queued */
+      if (rcode != PIOUS_OK &&
+	  ti_entry->rlocks == NULL && ti_entry->wlocks == NULL)
+	ti_rm(ti_entry);
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * waitconflict()
+ *
+ * Parameters:
+ *
+ *   fhandle  - file handle
+ *   start    - start byte
+ *   stop     - stop byte
+ *   lock     - lock type
+ *
+ * Determine if a request for a 'lock' lock on file 'fhandle' from 'start'
+ * to 'stop' conflicts with any queued request; the file's 'waits' tree is
+ * searched for a single conflicting request.
+ *
+ * Returns:
+ *
+ *   TRUE  (1) - conflicting request queued
+ *   FALSE (0) - no conflicting request queued
+ */
+
+#ifdef __STDC__
+static int waitconflict(pds_fhandlet fhandle,
+			pious_offt start,
+			pious_offt stop,
+			int lock)
+#else
+static int waitconflict(fhandle, start, stop, lock)
+     pds_fhandlet fhandle;
+     pious_offt start;
+     pious_offt stop;
+     int lock;
+#endif
+{
+  fh_entryt *fh_entry;
+
+  fh_entry = fh_lookup(fhandle, NOINSERT);
+
+  return (fh_entry != NULL &&
+	  lock_first(fh_entry->waits, start, stop, lock) != NULL);
+}
+
+
+
+
+/*
+ * wait_rm()
+ *
+ * Parameters:
+ *
+ *   wait_entry - wait queue entry
+ *
+ * Remove 'wait_entry' from the wait queue and 'waits' tree of the associated
+ * file handle, and the woken queue if woken and not retrieved, and
+ * deallocate space.
+ *
+ * Returns:
+ *
+ * Note: The associated file handle and transaction id entries are NOT
+ *       deallocated, even if no longer referenced; this is the
+ *       responsibility of the caller.
+ */
+
+#ifdef __STDC__
+static void wait_rm(wait_entryt *wait_entry)
+#else
+static void wait_rm(wait_entry)
+     wait_entryt *wait_entry;
+#endif
+{
+  fh_entryt *fh_entry;
+
+  fh_entry = wait_entry->req.fhchain;
+
+  /* remove from woken queue */
+  if (wait_entry->state == WOKEN)
+    {
+      if (wait_entry->rnext != NULL)
+	wait_entry->rnext->rprev = wait_entry->rprev;
+      else
+	wake_tail = wait_entry->rprev;
+
+      if (wait_entry->rprev != NULL)
+	wait_entry->rprev->rnext = wait_entry->rnext;
+      else
+	wake_head = wait_entry->rnext;
+    }
+
+  /* remove from file handle wait queue and 'waits' tree */
+  if (wait_entry->wnext != NULL)
+    wait_entry->wnext->wprev = wait_entry->wprev;
+  else
+    fh_entry->wtail = wait_entry->wprev;
+
+  if (wait_entry->wprev != NULL)
+    wait_entry->wprev->wnext = wait_entry->wnext;
+  else
+    fh_entry->whead = wait_entry->wnext;
+
+  lock_tremove(&(fh_entry->waits), &(wait_entry->req));
+
+  /* transaction no longer has a queued request */
+  wait_entry->tichain->wait = NULL;
+
+  free((char *)wait_entry);
+}
+
+
+
+
+/*
+ * wait_scan()
+ *
+ * Parameters:
+ *
+ *   fh_entry - file handle hash chain entry
+ *   start    - start byte of range released
+ *   stop     - stop byte of range released
+ *
+ * Scan the wait queue of 'fh_entry', in order, waking each waiting request
+ * that can be granted; woken requests are placed at the tail of the woken
+ * queue.
+ *
+ * Only a request overlapping bytes 'start' through 'stop', where locks
+ * have been freed or a request dequeued, can have become grantable; such
+ * requests are located via the file's 'waits' tree and examined in the
+ * order received.  The scan stops at a write request that still can not be
+ * granted and that spans the range released, as all requests queued behind
+ * it in the range conflict with it.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void wait_scan(fh_entryt *fh_entry,
+		      pious_offt start,
+		      pious_offt stop)
+#else
+static void wait_scan(fh_entry, start, stop)
+     fh_entryt *fh_entry;
+     pious_offt start;
+     pious_offt stop;
+#endif
+{
+  int done;
+  register wait_entryt *wait_entry;
+  wait_entryt *scan_list;
+  lock_entryt *lock_entry;
+
+  /* list queued requests overlapping range released, in order received */
+  scan_list = NULL;
+
+  for (lock_entry = lock_first(fh_entry->waits, start, stop, WRITE);
+       lock_entry != NULL;
+       lock_entry = lock_next(lock_entry, start, stop, WRITE))
+    {
+      wait_entry = (wait_entryt *)lock_entry;
+
+      if (wait_entry->state == QUEUED)
+	{
+	  wait_entry->snext = scan_list;
+	  scan_list         = wait_entry;
+	}
+    }
+
+  scan_list = wait_sort(scan_list);
+
+  /* wake requests that can be granted */
+  done = FALSE;
+
+  while (scan_list != NULL && !done)
+    {
+      wait_entry = scan_list;
+      scan_list  = wait_entry->snext;
+
+      if (wait_grant(wait_entry))
+	{ /* wake request; place at tail of woken queue */
+	  wait_entry->state = WOKEN;
+
+	  wait_entry->rnext = NULL;
+	  wait_entry->rprev = wake_tail;
+
+	  if (wake_tail != NULL)
+	    wake_tail->rnext = wait_entry;
+	  else
+	    wake_head = wait_entry;
+
+	  wake_tail = wait_entry;
+	}
+
+      else if (wait_entry->req.lock == WRITE &&
+	       wait_entry->req.start <= start && wait_entry->req.stop >= stop)
+	/* all requests remaining conflict with this request */
+	done = TRUE;
+    }
+}
+
+
+
+
+/*
+ * wait_sort()
+ *
+ * Parameters:
+ *
+ *   wait_list - list of wait queue entries, linked via 'snext'
+ *
+ * Sort the list of wait queue entries 'wait_list' into the order received,
+ * i.e. by increasing sequence number, via merge sort.
+ *
+ * Returns:
+ *
+ *   wait_entryt * - head of sorted list
+ */
+
+#ifdef __STDC__
+static wait_entryt *wait_sort(wait_entryt *wait_list)
+#else
+static wait_entryt *wait_sort(wait_list)
+     wait_entryt *wait_list;
+#endif
+{
+  wait_entryt *half, *tail, **link;
+  register wait_entryt *wait_entry;
+
+  if (wait_list != NULL && wait_list->snext != NULL)
+    { /* split list in two; 'wait_entry' advances twice per 'tail' */
+      tail = wait_list;
+
+      for (wait_entry = wait_list->snext;
+	   wait_entry != NULL && wait_entry->snext != NULL;
+	   wait_entry = wait_entry->snext->snext)
+	tail = tail->snext;
+
+      half        = tail->snext;
+      tail->snext = NULL;
+
+      /* sort each half and merge */
+      wait_list = wait_sort(wait_list);
+      half      = wait_sort(half);
+
+      link = &wait_list;
+
+      while (*link != NULL && half != NULL)
+	{
+	  if (half->seq < (*link)->seq)
+	    { /* insert head of 'half' ahead of *link */
+	      wait_entry        = half;
+	      half              = half->snext;
+	      wait_entry->snext = *link;
+	      *link             = wait_entry;
+	    }
+
+	  link = &((*link)->snext);
+	}
+
+      if (half != NULL)
+	*link = half;
+    }
+
+  return wait_list;
+}
+
+
+
+
+/*
+ * wait_grant()
+ *
+ * Parameters:
+ *
+ *   wait_entry - wait queue entry
+ *
+ * Determine if the request 'wait_entry' can be granted; i.e. that it
+ * conflicts neither with a lock held by another transaction nor with a
+ * request queued ahead of it.  Requests queued ahead, woken or not, are
+ * considered so that conflicting requests are granted in the order received.
+ *
+ * Only conflicting locks and requests are examined, via the file's 'locks'
+ * and 'waits' trees.
+ *
+ * Returns:
+ *
+ *   TRUE  (1) - request can be granted
+ *   FALSE (0) - request can NOT be granted
+ */
+
+#ifdef __STDC__
+static int wait_grant(wait_entryt *wait_entry)
+#else
+static int wait_grant(wait_entry)
+     wait_entryt *wait_entry;
+#endif
+{
+  int grant;
+  register lock_entryt *req, *lock_entry;
+
+  grant = TRUE;
+  req   = &(wait_entry->req);
+
+  /* check for conflicting locks held by other transactions */
+
+  for (lock_entry = lock_first(req->fhchain->locks,
+			       req->start, req->stop, req->lock);
+       grant && lock_entry != NULL;
+       lock_entry = lock_next(lock_entry, req->start, req->stop, req->lock))
+    if (!transid_eq(req->transid, lock_entry->transid))
+      grant = FALSE;
+
+  /* check for conflicting requests queued ahead; one request per trans. */
+
+  for (lock_entry = lock_first(req->fhchain->waits,
+			       req->start, req->stop, req->lock);
+       grant && lock_entry != NULL;
+       lock_entry = lock_next(lock_entry, req->start, req->stop, req->lock))
+    if (((wait_entryt *)lock_entry)->seq < wait_entry->seq)
+      grant = FALSE;
+
+  return grant;
+}
+
+
+
+
+/*
+ * wait_edge()
+ *
+ * Parameters:
+ *
+ *   ti_entry - transaction id hash chain entry
+ *
+ * Locate the next transaction that 'ti_entry' waits for in the wait-for
+ * graph, continuing the search state of 'ti_entry' (dphase/dnext), which
+ * is initialized by setting dphase to EDGE_INIT.
+ *
+ * A transaction with a queued request, that is not woken, waits for each
+ * other transaction holding a conflicting lock and for each transaction
+ * with a conflicting request queued ahead of it.  A transaction may be
+ * located more than once.
+ *
+ * Returns:
+ *
+ *   ti_entryt * - pointer to transaction waited for
+ *   NULL        - no further transactions waited for
+ */
+
+#ifdef __STDC__
+static ti_entryt *wait_edge(ti_entryt *ti_entry)
+#else
+static ti_entryt *wait_edge(ti_entry)
+     ti_entryt *ti_entry;
+#endif
+{
+  ti_entryt *ti_succ;
+  wait_entryt *wait_entry;
+  register lock_entryt *req;
+
+  ti_succ    = NULL;
+  wait_entry = ti_entry->wait;
+  req        = NULL;
+
+  if (wait_entry == NULL || wait_entry->state != QUEUED)
+    /* not waiting */
+    ti_entry->dphase = EDGE_DONE;
+  else
+    req = &(wait_entry->req);
+
+  while (ti_succ == NULL && ti_entry->dphase != EDGE_DONE)
+    if (ti_entry->dphase == EDGE_INIT)
+      { /* begin search of conflicting locks */
+	ti_entry->dnext  = lock_first(req->fhchain->locks,
+				      req->start, req->stop, req->lock);
+	ti_entry->dphase = EDGE_LOCKS;
+      }
+
+    else if (ti_entry->dnext == NULL && ti_entry->dphase == EDGE_LOCKS)
+      { /* begin search of conflicting requests */
+	ti_entry->dnext  = lock_first(req->fhchain->waits,
+				      req->start, req->stop, req->lock);
+	ti_entry->dphase = EDGE_WAITS;
+      }
+
+    else if (ti_entry->dnext == NULL)
+      /* search complete */
+      ti_entry->dphase = EDGE_DONE;
+
+    else
+      { /* conflicting lock held by other transaction, or request ahead */
+	if (ti_entry->dphase == EDGE_LOCKS)
+	  {
+	    if (!transid_eq(ti_entry->dnext->transid, req->transid))
+	      ti_succ = ti_lookup(ti_entry->dnext->transid, NOINSERT);
+	  }
+	else
+	  {
+	    if (((wait_entryt *)ti_entry->dnext)->seq < wait_entry->seq)
+	      ti_succ = ((wait_entryt *)ti_entry->dnext)->tichain;
+	  }
+
+	ti_entry->dnext = lock_next(ti_entry->dnext,
+				    req->start, req->stop, req->lock);
+      }
+
+  return ti_succ;
+}
@@ -37,6 +37,33 @@
  *   LM_wlock();
  *   LM_rfree();
  *   LM_wfree();
+ *   LM_rwait();
+ *   LM_wwait();
+ *   LM_cancel();
+ *   LM_woken();
+ *   LM_rconflict();
+ *   LM_wconflict();
+ *   LM_deadlock();
+ *
+ * A transaction whose lock request is denied may queue the request to wait
+ * on the file via LM_rwait()/LM_wwait().  Requests for a file are queued in
+ * the order received.  As locks are released, or queued requests cancelled,
+ * the lock manager wakes each queued request that neither conflicts with
+ * a granted lock nor with a request queued ahead of it; woken requests are
+ * retrieved in the order woken via LM_woken() and are then re-tried by the
+ * caller.  Thus only those requests that can proceed need be re-tried, and
+ * conflicting requests for overlapping data regions are satisfied in the
+ * order received.  A new request can be checked against queued requests,
+ * so as not to overtake them, via LM_rconflict()/LM_wconflict().
+ *
+ * A transaction with a queued request waits for each transaction holding a
+ * conflicting lock, and for each transaction with a conflicting request
+ * queued ahead of it; LM_deadlock() searches this wait-for graph for cycles.
+ *
+ * Granted locks of a given type held by a transaction on a file are merged
+ * where they overlap or adjoin.  Once a transaction holds PDS_LM_ESCALATE
+ * such locks on a file, a further lock is escalated to cover the whole file
+ * if no other transaction holds or awaits a conflicting lock on the file.
  */
 
 #define LM_GRANT 0
@@ -119,7 +146,8 @@ int LM_wlock();
  *
  *   transid - transaction id
  *
- * Free all read locks held by transaction 'transid'.
+ * Free all read locks held by transaction 'transid', waking queued requests
+ * that can now be granted.
  *
  * Returns:
  *
@@ -141,7 +169,8 @@ void LM_rfree();
  *
  *   transid - transaction id
  *
- * Free all write locks held by transaction 'transid'.
+ * Free all write locks held by transaction 'transid', waking queued requests
+ * that can now be granted.
  *
  * Returns:
  *
@@ -152,3 +181,246 @@ void LM_wfree(pds_transidt transid);
 #else
 void LM_wfree();
 #endif
+
+
+
+
+/*
+ * LM_rwait()
+ *
+ * Parameters:
+ *
+ *   transid  - transaction id
+ *   fhandle  - file handle
+ *   offset   - starting offset
+ *   nbyte    - byte count
+ *
+ * Queue a request by transaction 'transid' for a read lock on file 'fhandle'
+ * starting at 'offset' and extending for 'nbyte', to be woken when the lock
+ * can be granted; see LM_woken().
+ *
+ * A transaction has at most one queued request.  If a request is already
+ * queued for 'transid' it is assumed to be this request, which retains its
+ * position in the queue and is no longer considered woken; i.e. a woken
+ * request that is re-tried and again denied is re-queued without loss of
+ * position.
+ *
+ * A queued request is removed from the queue when a lock is granted to
+ * 'transid', or when cancelled via LM_cancel().
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - request queued
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINVAL - byte range is not a proper value
+ *       PIOUS_EINSUF - insufficient system resources to queue request
+ *
+ * Note: Assumes offset, nbyte, and (offset + (nbyte - 1)) have been checked
+ *       and are confirmed to be valid and within limits defined in
+ *       include/pious_types.h.
+ */
+
+#ifdef __STDC__
+int LM_rwait(pds_transidt transid,
+	     pds_fhandlet fhandle,
+	     pious_offt offset,
+	     pious_sizet nbyte);
+#else
+int LM_rwait();
+#endif
+
+
+
+
+/*
+ * LM_wwait()
+ *
+ * Parameters:
+ *
+ *   transid  - transaction id
+ *   fhandle  - file handle
+ *   offset   - starting offset
+ *   nbyte    - byte count
+ *
+ * Queue a request by transaction 'transid' for a write lock on file
+ * 'fhandle' starting at 'offset' and extending for 'nbyte', to be woken
+ * when the lock can be granted; see LM_rwait() for a full discussion.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - request queued
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINVAL - byte range is not a proper value
+ *       PIOUS_EINSUF - insufficient system resources to queue request
+ *
+ * Note: Assumes offset, nbyte, and (offset + (nbyte - 1)) have been checked
+ *       and are confirmed to be valid and within limits defined in
+ *       include/pious_types.h.
+ */
+
+#ifdef __STDC__
+int LM_wwait(pds_transidt transid,
+	     pds_fhandlet fhandle,
+	     pious_offt offset,
+	     pious_sizet nbyte);
+#else
+int LM_wwait();
+#endif
+
+
+
+
+/*
+ * LM_cancel()
+ *
+ * Parameters:
+ *
+ *   transid - transaction id
+ *
+ * Cancel the queued request, if any, of transaction 'transid', waking
+ * requests queued behind it that can now be granted.
+ *
+ * Returns:
+ *
+ */
+
+#ifdef __STDC__
+void LM_cancel(pds_transidt transid);
+#else
+void LM_cancel();
+#endif
+
+
+
+
+/*
+ * LM_woken()
+ *
+ * Parameters:
+ *
+ *   transid - transaction id
+ *
+ * Retrieve the transaction id of the next woken request, in the order woken.
+ * A retrieved request remains queued until a lock is granted to the
+ * transaction or the request is cancelled.
+ *
+ * Returns:
+ *
+ *   TRUE  (1) - woken request retrieved; transaction id set in 'transid'
+ *   FALSE (0) - no woken requests
+ */
+
+#ifdef __STDC__
+int LM_woken(pds_transidt *transid);
+#else
+int LM_woken();
+#endif
+
+
+
+
+/*
+ * LM_rconflict()
+ *
+ * Parameters:
+ *
+ *   fhandle  - file handle
+ *   offset   - starting offset
+ *   nbyte    - byte count
+ *
+ * Determine if a read lock request for file 'fhandle' starting at 'offset'
+ * and extending for 'nbyte' conflicts with any queued request; i.e. with
+ * a queued write lock request for an overlapping region.
+ *
+ * Queued requests are indexed by file handle and byte range, such that the
+ * cost of the check is logarithmic in the number of requests queued on the
+ * file.
+ *
+ * Returns:
+ *
+ *   TRUE  (1) - conflicting request queued
+ *   FALSE (0) - no conflicting request queued
+ *
+ * Note: Assumes offset, nbyte, and (offset + (nbyte - 1)) have been checked
+ *       and are confirmed to be valid and within limits defined in
+ *       include/pious_types.h.
+ */
+
+#ifdef __STDC__
+int LM_rconflict(pds_fhandlet fhandle,
+		 pious_offt offset,
+		 pious_sizet nbyte);
+#else
+int LM_rconflict();
+#endif
+
+
+
+
+/*
+ * LM_wconflict()
+ *
+ * Parameters:
+ *
+ *   fhandle  - file handle
+ *   offset   - starting offset
+ *   nbyte    - byte count
+ *
+ * Determine if a write lock request for file 'fhandle' starting at 'offset'
+ * and extending for 'nbyte' conflicts with any queued request; i.e. with
+ * a queued request for an overlapping region.  See LM_rconflict().
+ *
+ * Returns:
+ *
+ *   TRUE  (1) - conflicting request queued
+ *   FALSE (0) - no conflicting request queued
+ *
+ * Note: Assumes offset, nbyte, and (offset + (nbyte - 1)) have been checked
+ *       and are confirmed to be valid and within limits defined in
+ *       include/pious_types.h.
+ */
+
+#ifdef __STDC__
+int LM_wconflict(pds_fhandlet fhandle,
+		 pious_offt offset,
+		 pious_sizet nbyte);
+#else
+int LM_wconflict();
+#endif
+
+
+
+
+/*
+ * LM_deadlock()
+ *
+ * Parameters:
+ *
+ *   transid - transaction id
+ *   victim  - transaction id of deadlock victim
+ *
+ * Determine if the queued request of transaction 'transid' completes a
+ * cycle in the wait-for graph; i.e. if the transactions that 'transid'
+ * waits for, directly or indirectly, include 'transid'.  If so, the
+ * transaction in the cycle with the greatest transaction id, as ordered
+ * by transid_gt(), is selected as the victim and placed in 'victim'.
+ * Aborting the victim breaks the cycle.
+ *
+ * Only cycles through 'transid' are located, so LM_deadlock() should be
+ * called each time a request is queued, or re-queued, such that a cycle
+ * is detected when formed.  A woken request does not wait.
+ *
+ * Returns:
+ *
+ *   TRUE  (1) - deadlock; victim transaction id set in 'victim'
+ *   FALSE (0) - no deadlock involving 'transid'
+ */
+
+#ifdef __STDC__
+int LM_deadlock(pds_transidt transid,
+		pds_transidt *victim);
+#else
+int LM_deadlock();
+#endif
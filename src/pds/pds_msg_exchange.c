@@ -74,6 +74,8 @@
 #include "pdce_msgtagt.h"
 #include "pdce.h"
 
+#include "pds_sstorage_manager.h"
+#include "pds_cache_manager.h"
 #include "pds.h"
 #include "pds_msg_exchange.h"
 
@@ -345,6 +347,19 @@ int PDSMSG_req_send(pdsid, reqop, reqmsg, vbuf)
 
 		    (tcode = DCE_pkchar(reqmsg->StatBody.path, pathlen)));
 		break;
+
+	      case PDS_ADVISE_OP:
+		if ((tcode = DCE_pkfhandlet(&reqmsg->AdviseBody.fhandle,
+					    1)) == PIOUS_OK &&
+
+		    (tcode = DCE_pkofft(&reqmsg->AdviseBody.offset,
+					1)) == PIOUS_OK &&
+
+		    (tcode = DCE_pksizet(&reqmsg->AdviseBody.nbyte,
+					 1)) == PIOUS_OK &&
+
+		    (tcode = DCE_pkint(&reqmsg->AdviseBody.advice, 1)));
+		break;
 	      }
 	}
 
@@ -654,6 +669,19 @@ int PDSMSG_req_recv(clientid, reqop, reqmsg, timeout)
 		      free(reqmsg->StatBody.path);
 		  }
 		break;
+
+	      case PDS_ADVISE_OP:
+		if ((tcode = DCE_upkfhandlet(&reqmsg->AdviseBody.fhandle,
+					     1)) == PIOUS_OK &&
+
+		    (tcode = DCE_upkofft(&reqmsg->AdviseBody.offset,
+					 1)) == PIOUS_OK &&
+
+		    (tcode = DCE_upksizet(&reqmsg->AdviseBody.nbyte,
+					  1)) == PIOUS_OK &&
+
+		    (tcode = DCE_upkint(&reqmsg->AdviseBody.advice, 1)));
+		break;
 	      }
 	}
     }
@@ -699,7 +727,10 @@ int PDSMSG_reply_send(clientid, replyop, replymsg)
      pdsmsg_replyt *replymsg;
 #endif
 {
-  int rcode, tcode;
+  int rcode, tcode, i;
+  struct CM_stats *stats;
+  struct SS_stats *ss_stats;
+  struct PDS_abortstats *abort_stats;
 
   /* validate 'replyop' argument */
 
@@ -729,10 +760,18 @@ int PDSMSG_reply_send(clientid, replyop, replymsg)
 	      { /* pack message body */
 
 	      case PDS_READ_OP:
-		/* determine if data is returned */
+		/* determine if data is returned; pack from read buffer or
+		 * directly from memory referenced by data I/O vector
+		 */
 		if (replymsg->TransopHead.rcode > 0)
-		  tcode = DCE_pkbyte(replymsg->ReadBody.buf,
-				     (int)replymsg->TransopHead.rcode);
+		  {
+		    if (replymsg->ReadBody.buf != NULL)
+		      tcode = DCE_pkbyte(replymsg->ReadBody.buf,
+					 (int)replymsg->TransopHead.rcode);
+		    else
+		      tcode = DCE_pkbytev(replymsg->ReadBody.iov,
+					  replymsg->ReadBody.iovcnt);
+		  }
 		break;
 
 	      case PDS_READ_SINT_OP:
@@ -787,6 +826,115 @@ int PDSMSG_reply_send(clientid, replyop, replymsg)
 		/* determine if data is returned */
 		if (replymsg->CntrlopHead.rcode == PIOUS_OK)
 		  tcode = DCE_pkmodet(&replymsg->StatBody.mode, 1);
+		break;
+
+	      case PDS_CACHESTAT_OP:
+		/* determine if data is returned */
+		if (replymsg->CntrlopHead.rcode == PIOUS_OK)
+		  {
+		    stats    = &replymsg->CachestatBody.stats;
+		    ss_stats = &replymsg->CachestatBody.ss_stats;
+
+		    abort_stats = &replymsg->CachestatBody.abort_stats;
+
+		    if ((tcode = DCE_pklong(&stats->cache_sz, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->dblk_sz, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->sm_cnt, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->sm_sz, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->lg_cnt, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->lg_sz, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkint(&stats->policy, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkint(&stats->admit, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkint(&stats->writeback, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->prot_sz, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->prot_target,
+					    1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->nvalid, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->ndirty, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->wb_ndirty, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->sm_nvalid, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&stats->lg_nvalid,
+					    1)) == PIOUS_OK &&
+
+			(tcode = DCE_pkulong(&stats->hit_pt, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->hit_pb, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->hit_ra, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->hit_sm, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->hit_lg, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->miss, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->ra_blks, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->sm_blks, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->lg_blks, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->lr_blks, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->eof_hit, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->eof_reload,
+					     1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->warm_blks,
+					     1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->adm_reject,
+					     1)) == PIOUS_OK &&
+
+			(tcode = DCE_pkulong(&stats->evict, 1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->evict_dirty,
+					     1)) == PIOUS_OK &&
+
+			(tcode = DCE_pkulong(&stats->flush_ops,
+					     1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->flush_blks,
+					     1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&stats->flush_bytes,
+					     1)) == PIOUS_OK &&
+
+			(tcode = DCE_pklong(&ss_stats->fic_sz,
+					    1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&ss_stats->fic_max,
+					    1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&ss_stats->fic_nvalid,
+					    1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&ss_stats->fildes_max,
+					    1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(&ss_stats->fildes_nopen,
+					    1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&ss_stats->fic_replace,
+					     1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&ss_stats->fildes_open,
+					     1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&ss_stats->fildes_close,
+					     1)) == PIOUS_OK &&
+
+			(tcode = DCE_pkulong(&abort_stats->deadlock,
+					     1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&abort_stats->timeout,
+					     1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&abort_stats->prepare,
+					     1)) == PIOUS_OK &&
+			(tcode = DCE_pkulong(&abort_stats->client,
+					     1)) == PIOUS_OK &&
+
+			(tcode = DCE_pkint(&stats->part_cnt, 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(stats->part_nblk,
+					    CM_PART_MAX + 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(stats->part_min,
+					    CM_PART_MAX + 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(stats->part_max,
+					    CM_PART_MAX + 1)) == PIOUS_OK &&
+			(tcode = DCE_pklong(stats->part_lgnblk,
+					    CM_PART_MAX + 1)) == PIOUS_OK &&
+
+			(tcode = DCE_pkint(&stats->nfile, 1)) == PIOUS_OK)
+
+		      for (i = 0; i < stats->nfile && tcode == PIOUS_OK; i++)
+			{
+			  if ((tcode = DCE_pkfhandlet(&stats->file[i].fhandle,
+						      1)) == PIOUS_OK &&
+
+			      (tcode = DCE_pklong(&stats->file[i].nblk,
+						  1)) == PIOUS_OK &&
+
+			      (tcode = DCE_pklong(&stats->file[i].ndirty, 1)));
+			}
+		  }
+		break;
 	      }
 	}
 
@@ -841,9 +989,12 @@ int PDSMSG_reply_recv(pdsid, replyop, replymsg, vbuf)
      struct PDS_vbuf_dscrp *vbuf;
 #endif
 {
-  int rcode, tcode;
+  int rcode, tcode, i;
   dce_srcdestt msgsrc;
   dce_msgtagt msgtag;
+  struct CM_stats *stats;
+  struct SS_stats *ss_stats;
+  struct PDS_abortstats *abort_stats;
 
   int firstblk_sz, lastblk_sz, middleblk_cnt;
   char *bufptr;
@@ -882,7 +1033,9 @@ int PDSMSG_reply_recv(pdsid, replyop, replymsg, vbuf)
 		     * data returned into specified buffer
 		     */
 
-		    replymsg->ReadBody.buf = NULL;
+		    replymsg->ReadBody.buf    = NULL;
+		    replymsg->ReadBody.iov    = NULL;
+		    replymsg->ReadBody.iovcnt = 0;
 
 		    if (!transid_eq(vbuf->transid,
 				    replymsg->TransopHead.transid) ||
@@ -1024,6 +1177,167 @@ int PDSMSG_reply_recv(pdsid, replyop, replymsg, vbuf)
 		    if (replymsg->CntrlopHead.rcode == PIOUS_OK)
 		      tcode = DCE_upkmodet(&replymsg->StatBody.mode, 1);
 		    break;
+
+		  case PDS_CACHESTAT_OP:
+		    /* determine if data is returned */
+		    if (replymsg->CntrlopHead.rcode == PIOUS_OK)
+		      {
+			stats    = &replymsg->CachestatBody.stats;
+			ss_stats = &replymsg->CachestatBody.ss_stats;
+
+			abort_stats = &replymsg->CachestatBody.abort_stats;
+
+			if ((tcode =
+			     DCE_upklong(&stats->cache_sz, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->dblk_sz, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->sm_cnt, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->sm_sz, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->lg_cnt, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->lg_sz, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkint(&stats->policy, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkint(&stats->admit, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkint(&stats->writeback, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->prot_sz, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->prot_target, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->nvalid, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->ndirty, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->wb_ndirty, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->sm_nvalid, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&stats->lg_nvalid, 1)) == PIOUS_OK &&
+
+			    (tcode =
+			     DCE_upkulong(&stats->hit_pt, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->hit_pb, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->hit_ra, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->hit_sm, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->hit_lg, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->miss, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->ra_blks, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->sm_blks, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->lg_blks, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->lr_blks, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->eof_hit, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->eof_reload, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->warm_blks, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->adm_reject, 1)) == PIOUS_OK &&
+
+			    (tcode =
+			     DCE_upkulong(&stats->evict, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->evict_dirty, 1)) == PIOUS_OK &&
+
+			    (tcode =
+			     DCE_upkulong(&stats->flush_ops, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->flush_blks, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&stats->flush_bytes, 1)) == PIOUS_OK &&
+
+			    (tcode =
+			     DCE_upklong(&ss_stats->fic_sz, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&ss_stats->fic_max, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&ss_stats->fic_nvalid,
+					 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&ss_stats->fildes_max,
+					 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(&ss_stats->fildes_nopen,
+					 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&ss_stats->fic_replace,
+					  1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&ss_stats->fildes_open,
+					  1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&ss_stats->fildes_close,
+					  1)) == PIOUS_OK &&
+
+			    (tcode =
+			     DCE_upkulong(&abort_stats->deadlock,
+					  1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&abort_stats->timeout,
+					  1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&abort_stats->prepare,
+					  1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upkulong(&abort_stats->client,
+					  1)) == PIOUS_OK &&
+
+			    (tcode =
+			     DCE_upkint(&stats->part_cnt, 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(stats->part_nblk,
+					 CM_PART_MAX + 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(stats->part_min,
+					 CM_PART_MAX + 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(stats->part_max,
+					 CM_PART_MAX + 1)) == PIOUS_OK &&
+			    (tcode =
+			     DCE_upklong(stats->part_lgnblk,
+					 CM_PART_MAX + 1)) == PIOUS_OK &&
+
+			    (tcode =
+			     DCE_upkint(&stats->nfile, 1)) == PIOUS_OK)
+			  {
+			    if (stats->nfile < 0 || stats->nfile > CM_STAT_TOPN ||
+				stats->part_cnt < 0 ||
+				stats->part_cnt > CM_PART_MAX)
+			      tcode = PIOUS_EUNXP;
+
+			    for (i = 0;
+				 i < stats->nfile && tcode == PIOUS_OK;
+				 i++)
+			      {
+				if ((tcode =
+				     DCE_upkfhandlet(&stats->file[i].fhandle,
+						     1)) == PIOUS_OK &&
+
+				    (tcode =
+				     DCE_upklong(&stats->file[i].nblk,
+						 1)) == PIOUS_OK &&
+
+				    (tcode =
+				     DCE_upklong(&stats->file[i].ndirty, 1)));
+			      }
+			  }
+		      }
+		    break;
 		  }
 	    }
 	}
@@ -75,8 +75,10 @@
 #define PDS_PING_OP        15
 #define PDS_RESET_OP       16
 #define PDS_SHUTDOWN_OP    17
+#define PDS_CACHESTAT_OP   18
+#define PDS_ADVISE_OP      19
 
-#define PDS_OPCODE_MAX     17    /* maximum operation code */
+#define PDS_OPCODE_MAX     19    /* maximum operation code */
 
 /* valid PDS operation test macro */
 #define PdsOp(OPcode) ((OPcode) >= 0 && (OPcode) <= PDS_OPCODE_MAX)
@@ -154,9 +156,11 @@ struct PDSMSG_transop_reply{
   /* reply dependent body information */
   union{
 
-    /* read reply */
+    /* read reply; data is in 'buf', or if NULL is referenced by 'iov' */
     struct{
       char *buf;              /* data buffer */
+      struct DCE_iovec *iov;  /* data I/O vector; see pdce/pdce.h */
+      int iovcnt;             /* data I/O vector entry count */
     } read;
 
     /* read signed int reply */
@@ -220,6 +224,14 @@ struct PDSMSG_cntrlop_req{
       char *path;             /* path name */
     } stat;
 
+    /* advise request */
+    struct{
+      pds_fhandlet fhandle;   /* file handle */
+      pious_offt offset;      /* starting offset */
+      pious_sizet nbyte;      /* byte count; 0 is to end of file */
+      int advice;             /* expected access pattern */
+    } advise;
+
   } body;
 };
 
@@ -249,6 +261,13 @@ struct PDSMSG_cntrlop_reply{
       pious_modet mode;       /* returned file mode */
     } stat;
 
+    /* cachestat reply */
+    struct{
+      struct CM_stats stats;              /* returned cache statistics */
+      struct SS_stats ss_stats;           /* returned stable storage stats */
+      struct PDS_abortstats abort_stats;  /* returned trans abort counts */
+    } cachestat;
+
   } body;
 };
 
@@ -328,6 +347,12 @@ typedef union{
 
 #define ShutdownHead   cntrlop
 
+#define CachestatHead  cntrlop
+#define CachestatBody  cntrlop.body.cachestat
+
+#define AdviseHead     cntrlop
+#define AdviseBody     cntrlop.body.advise
+
 
 
 
@@ -435,6 +460,10 @@ int PDSMSG_req_recv();
  *
  * Note: 'replymsg' parameters are presumed to be correct.
  *
+ *       Data for a PDS_READ_OP reply is packed from the read buffer or, if
+ *       the read buffer is NULL, directly from the memory referenced by the
+ *       data I/O vector.
+ *
  * Returns:
  *
  *   PIOUS_OK - PDSMSG_reply_send() completed without error
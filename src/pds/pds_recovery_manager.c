@@ -41,21 +41,38 @@
  *
  *   RM_trans_log();
  *   RM_trans_state();
+ *   RM_logdefer();
+ *   RM_logsync();
+ *   RM_logtrunc();
+ *   RM_indoubt();
  *   RM_checkpt();      [not yet implemented]
- *   RM_recover();      [not yet implemented]
+ *   RM_recover();
  *
  *
  *
  * ----------------------------------------------------------------------------
  * Implementation Notes:
  *
- *   1) RM_trans_log() and RM_trans_state() are currently "dummy" routines
- *      implemented solely for the purposes of benchmarking performance.
+ *   1) RM_trans_log() and RM_trans_state() append checksummed records to
+ *      a write-ahead log; records are accumulated in an append buffer and
+ *      written with large sequential writes to a log file that is
+ *      preallocated in segments.  Log synchronization can be deferred so
+ *      that the PDS daemon can force the records of several prepared
+ *      transactions at once.
  *
- *   2) When implementing recovery, it is necessary to undo a number of
- *      performance/convenience hacks in pds_sstorage_manager routines.
- *      These hacks are well documented in the pds_sstorage_manager
- *      implementation notes and only require un-commenting to undo.
+ *   2) RM_recover() replays the writes of committed transactions a file
+ *      at a time, with large sorted writes; the PDS is single-threaded, so
+ *      files are not replayed concurrently.  Each file is forced to disk
+ *      only with its last write.
+ *
+ *   3) Transactions logged but without a final state in the log were in
+ *      their uncertainty period at failure.  Their outcome is known only
+ *      to the transaction coordinator, and resolution with the coordinator
+ *      is not implemented; thus RM_recover() reports each such in-doubt
+ *      transaction in the PDS error log and retains the log, rather than
+ *      truncating it, so that the intentions list is not lost.  A recovery
+ *      record marks those committed transactions already redone, so that
+ *      subsequent recovery does not redo them again.
  */
 
 
@@ -66,8 +83,15 @@
 #include <stdlib.h>
 #else
 #include "nonansi.h"
+#include <memory.h>
 #endif
 
+#include <stdio.h>
+#include <string.h>
+
+#include "gpmacro.h"
+#include "gputil.h"
+
 #include "pious_types.h"
 #include "pious_errno.h"
 #include "pious_std.h"
@@ -79,6 +103,178 @@
 #include "pds_recovery_manager.h"
 
 
+/*
+ * Private Declarations - Types and Constants
+ */
+
+
+/* Log record format
+ *
+ *   Log records are appended to the transaction log (TLOG) file in native
+ *   format.  Each record consists of a header, a body of R_LEN bytes, and
+ *   a trailer; the trailer is a CRC32C checksum computed over the header
+ *   and body, so that a torn or partially written record is detected.
+ *
+ *   Log sequence numbers (LSN) are strictly increasing, starting from 1;
+ *   a scan of the log terminates at the first record whose LSN does not
+ *   exceed that of its predecessor, or whose checksum is invalid.
+ *
+ *   Record bodies are as follows:
+ *
+ *     RM_REC_INTENT - transid, write count, and for each write:
+ *                     fhandle, offset, nbyte, and nbyte bytes of data
+ *
+ *     RM_REC_STATE  - intent record LSN (lhandle) and final state
+ *
+ *     RM_REC_RECOV  - LSN of the last record scanned by a recovery that
+ *                     retained the log; final states logged at or before
+ *                     this LSN have been applied
+ */
+
+#define R_LSN  0    /* record header: log sequence number */
+#define R_TYPE 1    /* record header: record type */
+#define R_LEN  2    /* record header: record body length */
+
+#define RM_REC_HDR_SZ (3 * sizeof(unsigned long))
+#define RM_REC_TLR_SZ (sizeof(unsigned long))
+
+#define RM_REC_INTENT 1   /* intentions list record */
+#define RM_REC_STATE  2   /* transaction final state record */
+#define RM_REC_RECOV  3   /* recovery completed record */
+
+
+/* Log append buffer size, and log preallocation segment size, in bytes */
+
+#define RM_BUF_SZ 65536
+#define RM_SEG_SZ 4194304
+
+
+/* Log scan buffer size, redo write coalescing limit, and initial redo and
+ * intentions list vector sizes, for recovery
+ */
+
+#define RM_SCAN_SZ 1048576
+#define RM_REDO_SZ 1048576
+#define RM_VEC_SZ  1024
+
+
+/* Redo list entry; a write of a committed transaction to be replayed */
+
+typedef struct {
+  pds_fhandlet fhandle;   /* file handle */
+  pious_offt offset;      /* starting offset */
+  pious_sizet nbyte;      /* byte count */
+  pious_offt loff;        /* log file offset of data */
+  long seq;               /* sequence of write in log */
+  long intent;            /* intentions list record index */
+} rm_redot;
+
+
+/* Intentions list entry; the final state of an intentions list record */
+
+typedef struct {
+  unsigned long lsn;      /* log sequence number of record */
+  unsigned long slsn;     /* LSN of final state record; 0 if none */
+  int commit;             /* transaction committed flag */
+  pds_transidt transid;   /* transaction id */
+} rm_intentt;
+
+
+
+
+/*
+ * Private Variable Definitions
+ */
+
+
+/* log synchronization deferred flag; see RM_logdefer() */
+static int rm_defer = FALSE;
+
+/* log records written but not forced to stable storage flag */
+static int rm_unsync = FALSE;
+
+/* log append buffer and byte count */
+static char rm_buf[RM_BUF_SZ];
+static pious_sizet rm_nbuf;
+
+/* log file offset of append buffer, and of end of records forced */
+static pious_offt rm_boff;
+static pious_offt rm_soff;
+
+/* log file size preallocated */
+static pious_offt rm_alloc;
+
+/* next log sequence number to assign */
+static unsigned long rm_lsn = 1;
+
+/* checksum of record being appended, or scanned in recovery */
+static unsigned long rm_crc;
+
+/* deferred records lost; result for RM_logsync() */
+static int rm_lerror = PIOUS_OK;
+
+/* in-doubt transactions retained in log by RM_recover() */
+static long rm_indoubt = 0;
+
+/* log scan buffer, log file offset and byte count of data buffered, and
+ * scan error code; see rm_scan()
+ */
+static char *rm_sbuf;
+static pious_offt rm_sstart;
+static pious_sizet rm_scnt;
+static int rm_serror;
+
+
+
+
+/*
+ * Local Function Declarations
+ */
+
+#ifdef __STDC__
+static int rm_append(char *buf,
+		     pious_sizet nbyte);
+
+static int rm_flush(void);
+
+static int rm_force(void);
+
+static void rm_rollback(int ecode);
+
+static int rm_scan(pious_offt offset,
+		   pious_sizet nbyte,
+		   char *buf);
+
+static int rm_grow(char **vec,
+		   long *cap,
+		   size_t elsize);
+
+static int redo_cmp(const void *redo_1,
+		    const void *redo_2);
+
+static int redo_seqcmp(const void *redo_1,
+		       const void *redo_2);
+#else
+static int rm_append();
+
+static int rm_flush();
+
+static int rm_force();
+
+static void rm_rollback();
+
+static int rm_scan();
+
+static int rm_grow();
+
+static int redo_cmp();
+
+static int redo_seqcmp();
+#endif
+
+
+
+
 /*
  * Function Definitions - Recovery Manager Operations
  */
@@ -98,7 +294,9 @@ pious_offt RM_trans_log(transid, wbuf)
 #endif
 {
   pious_offt rcode;
-  int tempstate;
+  int acode;
+  unsigned long hdr[3], nwrite, lsn, crc;
+  struct RM_wbuf *wnext;
 
   /* check for previous stable storage fatal error or log check-point flags */
 
@@ -108,41 +306,82 @@ pious_offt RM_trans_log(transid, wbuf)
   else if (SS_checkpoint)
     rcode = PIOUS_ECHCKPT;
 
-  /* write log record */
+  /* append intentions list record */
 
   else
-    {
-      tempstate = RM_TRANS_UNKNOWN;
+    { /* determine record body length */
+      hdr[R_LEN] = sizeof(pds_transidt) + sizeof(unsigned long);
+      nwrite     = 0;
+
+      for (wnext = wbuf; wnext != NULL; wnext = wnext->next)
+	{
+	  hdr[R_LEN] += (sizeof(pds_fhandlet) +
+			 sizeof(pious_offt) + sizeof(pious_sizet) +
+			 wnext->nbyte);
+	  nwrite++;
+	}
 
-      /* dummy log record header */
-      SS_logwrite((pious_offt)0, PIOUS_SEEK_SET,
-		  (pious_sizet)sizeof(pds_transidt), (char *)&transid);
+      lsn          = rm_lsn++;
+      hdr[R_LSN]   = lsn;
+      hdr[R_TYPE]  = RM_REC_INTENT;
 
-      SS_logwrite((pious_offt)0, PIOUS_SEEK_SET, (pious_sizet)sizeof(int),
-		  (char *)&tempstate);
+      /* append record header and body */
+      rm_crc = 0;
 
+      acode = rm_append((char *)hdr, (pious_sizet)RM_REC_HDR_SZ);
 
-      /* dummy record body */
-      while (!SS_fatalerror && wbuf != NULL)
+      if (acode == PIOUS_OK)
+	acode = rm_append((char *)&transid, (pious_sizet)sizeof(pds_transidt));
+
+      if (acode == PIOUS_OK)
+	acode = rm_append((char *)&nwrite, (pious_sizet)sizeof(unsigned long));
+
+      for (wnext = wbuf; acode == PIOUS_OK && wnext != NULL;
+	   wnext = wnext->next)
 	{
-	  SS_logwrite((pious_offt)0, PIOUS_SEEK_SET,
-		      (pious_sizet)(sizeof(pds_fhandlet) +
-				    sizeof(pious_offt) +
-				    sizeof(pious_sizet)),
-		      (char *)&(wbuf->fhandle));
+	  acode = rm_append((char *)&wnext->fhandle,
+			    (pious_sizet)sizeof(pds_fhandlet));
 
-	  SS_logwrite((pious_offt)0, PIOUS_SEEK_SET,
-		      (pious_sizet)(wbuf->nbyte), wbuf->buf);
+	  if (acode == PIOUS_OK)
+	    acode = rm_append((char *)&wnext->offset,
+			      (pious_sizet)sizeof(pious_offt));
 
-	  wbuf = wbuf->next;
+	  if (acode == PIOUS_OK)
+	    acode = rm_append((char *)&wnext->nbyte,
+			      (pious_sizet)sizeof(pious_sizet));
+
+	  if (acode == PIOUS_OK)
+	    acode = rm_append(wnext->buf, wnext->nbyte);
 	}
 
-      SS_logsync();
+      /* append record trailer */
+      if (acode == PIOUS_OK)
+	{
+	  crc   = rm_crc;
+	  acode = rm_append((char *)&crc, (pious_sizet)RM_REC_TLR_SZ);
+	}
 
-      if (SS_fatalerror)
-	rcode = PIOUS_EFATAL;
+      /* force log records, unless synchronization deferred */
+      if (acode == PIOUS_OK)
+	{
+	  if (rm_defer)
+	    rm_unsync = TRUE;
+	  else
+	    acode = rm_force();
+	}
+
+      /* set result code; records not forced are discarded on error */
+      if (acode == PIOUS_OK)
+	rcode = lsn;
       else
-	rcode = 0;
+	{
+	  rm_rollback(acode);
+
+	  if (SS_fatalerror)
+	    rcode = PIOUS_EFATAL;
+	  else
+	    rcode = PIOUS_ECHCKPT;
+	}
     }
 
   return rcode;
@@ -164,31 +403,1042 @@ int RM_trans_state(lhandle, state)
      int state;
 #endif
 {
-  int rcode, tempstate;
-
-  /* dummy transaction log routine; write data to disk for accurate timing */
+  int rcode, acode;
+  unsigned long hdr[3], body[2], crc;
 
   /* check for previous fatal error */
 
   if (SS_fatalerror)
     rcode = PIOUS_EFATAL;
 
-  /* write log record */
+  /* validate arguments; lhandle must be the LSN of an intentions list */
+
+  else if ((state != RM_TRANS_COMMIT && state != RM_TRANS_ABORT) ||
+	   lhandle <= 0 || (unsigned long)lhandle >= rm_lsn)
+    rcode = PIOUS_EINVAL;
+
+  /* append final state record */
 
   else
     {
-      tempstate = RM_TRANS_COMMIT;
+      hdr[R_LSN]  = rm_lsn++;
+      hdr[R_TYPE] = RM_REC_STATE;
+      hdr[R_LEN]  = sizeof(body);
+
+      body[0] = lhandle;
+      body[1] = state;
+
+      rm_crc = 0;
+
+      if ((acode = rm_append((char *)hdr,
+			     (pious_sizet)RM_REC_HDR_SZ)) == PIOUS_OK &&
+	  (acode = rm_append((char *)body,
+			     (pious_sizet)sizeof(body))) == PIOUS_OK)
+	{
+	  crc   = rm_crc;
+	  acode = rm_append((char *)&crc, (pious_sizet)RM_REC_TLR_SZ);
+	}
+
+      /* forces any log records with synchronization deferred as well */
+      if (acode == PIOUS_OK)
+	acode = rm_force();
+
+      if (acode == PIOUS_OK)
+	rcode = PIOUS_OK;
+      else
+	{
+	  rm_rollback(acode);
+
+	  if (SS_fatalerror)
+	    rcode = PIOUS_EFATAL;
+	  else
+	    rcode = PIOUS_EUNXP;
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * RM_logdefer() - See pds_recovery_manager.h for description
+ */
+
+#ifdef __STDC__
+void RM_logdefer(int on)
+#else
+void RM_logdefer(on)
+     int on;
+#endif
+{
+  rm_defer = on;
+}
+
+
+
+
+/*
+ * RM_logsync() - See pds_recovery_manager.h for description
+ */
+
+#ifdef __STDC__
+int RM_logsync(void)
+#else
+int RM_logsync()
+#endif
+{
+  int rcode;
+
+  /* force log records, if any are written but not forced */
 
-      SS_logwrite((pious_offt)0, PIOUS_SEEK_SET, (pious_sizet)sizeof(int),
-		  (char *)&tempstate);
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
 
-      SS_logsync();
+  else if (rm_unsync && (rcode = rm_force()) != PIOUS_OK)
+    {
+      rm_rollback(rcode);
 
       if (SS_fatalerror)
 	rcode = PIOUS_EFATAL;
       else
-	rcode = PIOUS_OK;
+	rcode = PIOUS_ECHCKPT;
     }
 
+  else
+    rcode = PIOUS_OK;
+
+  /* report deferred records discarded by a previous logging error */
+
+  if (rcode == PIOUS_OK && rm_lerror != PIOUS_OK)
+    rcode = rm_lerror;
+
+  rm_lerror = PIOUS_OK;
+
+  return rcode;
+}
+
+
+
+
+/*
+ * RM_logtrunc() - See pds_recovery_manager.h for description
+ */
+
+#ifdef __STDC__
+int RM_logtrunc(void)
+#else
+int RM_logtrunc()
+#endif
+{
+  int rcode;
+
+  /* truncate log file; log sequence numbers continue to increase */
+
+  rcode = SS_logtrunc();
+
+  rm_boff = rm_soff = rm_alloc = 0;
+  rm_nbuf = 0;
+
+  rm_unsync  = FALSE;
+  rm_lerror  = PIOUS_OK;
+  rm_indoubt = 0;
+
+  return rcode;
+}
+
+
+
+
+/*
+ * RM_logsize() - See pds_recovery_manager.h for description
+ */
+
+#ifdef __STDC__
+pious_offt RM_logsize(void)
+#else
+pious_offt RM_logsize()
+#endif
+{
+  return (rm_boff + rm_nbuf);
+}
+
+
+
+
+/*
+ * RM_indoubt() - See pds_recovery_manager.h for description
+ */
+
+#ifdef __STDC__
+long RM_indoubt(void)
+#else
+long RM_indoubt()
+#endif
+{
+  return rm_indoubt;
+}
+
+
+
+
+/*
+ * RM_recover() - See pds_recovery_manager.h for description
+ *
+ * Recovery proceeds in three phases:
+ *
+ *   1) the log is scanned once, from the beginning to the last valid
+ *      record, collecting the writes of each intentions list record and
+ *      noting which transactions committed;
+ *
+ *   2) writes of committed transactions are sorted by file and offset,
+ *      forming a redo list per file;
+ *
+ *   3) each file's redo list is replayed, with overlapping and adjacent
+ *      writes coalesced into a single write, and forced to disk.
+ *
+ * The log is then truncated, unless in-doubt transactions were found; in
+ * that case the log is retained and a recovery record is appended.
+ */
+
+#ifdef __STDC__
+int RM_recover(void)
+#else
+int RM_recover()
+#endif
+{
+  int rcode, valid, done;
+  unsigned long hdr[3], body[2], lastlsn, applied, nwrite, k, used, need;
+  unsigned long crc, tlr;
+  pious_offt off, pos, cstart, cend;
+  pious_sizet span;
+  pious_ssizet acode;
+  long nredo, nintent, redo_cap, intent_cap, lo, hi, mid;
+  long i, j, w, f, fend, seq, rec_nredo, nindoubt;
+  pious_sizet rbuf_sz;
+  pds_transidt transid;
+  rm_redot *redo, *rp;
+  rm_intentt *intent;
+  char *rbuf, msg[128];
+
+  /* check for previous fatal error and that recovery is required */
+
+  if (SS_fatalerror)
+    return PIOUS_EFATAL;
+
+  if (!SS_recover)
+    return PIOUS_OK;
+
+  rcode  = PIOUS_OK;
+  redo   = NULL;
+  intent = NULL;
+  rbuf   = NULL;
+
+  redo_cap = intent_cap = rbuf_sz = 0;
+  nredo    = nintent    = nindoubt = 0;
+
+  if ((rm_sbuf = malloc((unsigned)RM_SCAN_SZ)) == NULL ||
+      rm_grow((char **)&redo, &redo_cap, sizeof(rm_redot)) != PIOUS_OK ||
+      rm_grow((char **)&intent, &intent_cap, sizeof(rm_intentt)) != PIOUS_OK)
+    rcode = PIOUS_EINSUF;
+
+
+  /* Phase 1: scan log, collecting writes and final transaction states */
+
+  rm_sstart = 0;
+  rm_scnt   = 0;
+  rm_serror = PIOUS_OK;
+
+  off     = 0;
+  lastlsn = 0;
+  applied = 0;
+  seq     = 0;
+  done    = FALSE;
+
+  while (rcode == PIOUS_OK && !done)
+    { /* scan record header; LSN of valid records are increasing */
+      rm_crc    = 0;
+      pos       = off;
+      rec_nredo = nredo;
+
+      valid = (rm_scan(pos, (pious_sizet)RM_REC_HDR_SZ, (char *)hdr) &&
+	       hdr[R_LSN] > lastlsn);
+
+      pos += RM_REC_HDR_SZ;
+
+      /* scan record body, validating field lengths against record length */
+
+      if (valid && hdr[R_TYPE] == RM_REC_INTENT)
+	{
+	  used  = sizeof(pds_transidt) + sizeof(unsigned long);
+
+	  valid = (hdr[R_LEN] >= used &&
+		   rm_scan(pos, (pious_sizet)sizeof(pds_transidt),
+			   (char *)&transid) &&
+		   rm_scan(pos + sizeof(pds_transidt),
+			   (pious_sizet)sizeof(unsigned long),
+			   (char *)&nwrite));
+
+	  pos += used;
+
+	  for (k = 0; valid && k < nwrite; k++)
+	    {
+	      if (nredo == redo_cap &&
+		  rm_grow((char **)&redo, &redo_cap,
+			  sizeof(rm_redot)) != PIOUS_OK)
+		{ /* can not extend redo list */
+		  rcode = PIOUS_EINSUF;
+		  break;
+		}
+
+	      rp   = redo + nredo;
+	      need = (sizeof(pds_fhandlet) +
+		      sizeof(pious_offt) + sizeof(pious_sizet));
+
+	      valid = (hdr[R_LEN] - used >= need &&
+		       rm_scan(pos, (pious_sizet)sizeof(pds_fhandlet),
+			       (char *)&rp->fhandle) &&
+		       rm_scan(pos + sizeof(pds_fhandlet),
+			       (pious_sizet)sizeof(pious_offt),
+			       (char *)&rp->offset) &&
+		       rm_scan(pos + sizeof(pds_fhandlet) + sizeof(pious_offt),
+			       (pious_sizet)sizeof(pious_sizet),
+			       (char *)&rp->nbyte));
+
+	      used += need;
+	      pos  += need;
+
+	      /* scan write data; only its location is recorded */
+	      valid = (valid &&
+		       rp->offset >= 0 && rp->nbyte <= hdr[R_LEN] - used &&
+		       rm_scan(pos, rp->nbyte, (char *)NULL));
+
+	      if (valid && rp->nbyte > 0)
+		{
+		  rp->loff   = pos;
+		  rp->seq    = seq++;
+		  rp->intent = nintent;
+		  nredo++;
+		}
+
+	      used += rp->nbyte;
+	      pos  += rp->nbyte;
+	    }
+
+	  valid = (valid && used == hdr[R_LEN]);
+	}
+
+      else if (valid && hdr[R_TYPE] == RM_REC_STATE)
+	{
+	  valid = (hdr[R_LEN] == sizeof(body) &&
+		   rm_scan(pos, (pious_sizet)sizeof(body), (char *)body));
+
+	  pos += sizeof(body);
+	}
+
+      else if (valid && hdr[R_TYPE] == RM_REC_RECOV)
+	{
+	  valid = (hdr[R_LEN] == sizeof(unsigned long) &&
+		   rm_scan(pos, (pious_sizet)sizeof(unsigned long),
+			   (char *)body));
+
+	  pos += sizeof(unsigned long);
+	}
+
+      else
+	valid = FALSE;
+
+      /* scan record trailer and validate checksum */
+
+      crc   = rm_crc;
+      valid = (valid &&
+	       rm_scan(pos, (pious_sizet)RM_REC_TLR_SZ, (char *)&tlr) &&
+	       tlr == crc);
+
+      pos += RM_REC_TLR_SZ;
+
+      /* record the intentions list, or the final state of the intentions
+       * list (located by LSN), if the record is valid; otherwise the last
+       * valid record has been scanned.
+       */
+
+      if (rcode != PIOUS_OK)
+	break;
+
+      else if (!valid)
+	{
+	  nredo = rec_nredo;
+	  done  = TRUE;
+	}
+
+      else
+	{
+	  if (hdr[R_TYPE] == RM_REC_INTENT)
+	    {
+	      if (nintent == intent_cap &&
+		  rm_grow((char **)&intent, &intent_cap,
+			  sizeof(rm_intentt)) != PIOUS_OK)
+		rcode = PIOUS_EINSUF;
+	      else
+		{
+		  intent[nintent].lsn     = hdr[R_LSN];
+		  intent[nintent].slsn    = 0;
+		  intent[nintent].commit  = FALSE;
+		  intent[nintent].transid = transid;
+		  nintent++;
+		}
+	    }
+
+	  else if (hdr[R_TYPE] == RM_REC_RECOV)
+	    applied = body[0];
+
+	  else
+	    {
+	      lo = 0;
+	      hi = nintent - 1;
+
+	      while (lo <= hi)
+		{
+		  mid = (lo + hi) / 2;
+
+		  if (intent[mid].lsn == body[0])
+		    {
+		      intent[mid].slsn   = hdr[R_LSN];
+		      intent[mid].commit = (body[1] == RM_TRANS_COMMIT);
+		      break;
+		    }
+		  else if (intent[mid].lsn < body[0])
+		    lo = mid + 1;
+		  else
+		    hi = mid - 1;
+		}
+	    }
+
+	  lastlsn = hdr[R_LSN];
+	  off     = pos;
+	}
+    }
+
+  /* an error in reading the log prevents recovery */
+  if (rcode == PIOUS_OK && rm_serror != PIOUS_OK)
+    rcode = rm_serror;
+
+
+  /* Phase 2: sort writes of committed transactions by file and offset,
+   *          excluding those applied by a previous recovery; transactions
+   *          without a final state are in doubt and are NOT redone.
+   */
+
+  if (rcode == PIOUS_OK)
+    {
+      for (i = 0; i < nintent; i++)
+	if (intent[i].slsn == 0)
+	  { /* in-doubt transaction; intentions list retained in log */
+	    sprintf(msg, "in-doubt trans %lx.%lx.%lx.%lx retained",
+		    intent[i].transid.hostid,
+		    (unsigned long)intent[i].transid.procid,
+		    (unsigned long)intent[i].transid.sec,
+		    (unsigned long)intent[i].transid.usec);
+
+	    SS_errlog("pds_recovery_manager", "RM_recover()", PIOUS_OK, msg);
+
+	    nindoubt++;
+	  }
+
+      for (i = j = 0; i < nredo; i++)
+	if (intent[redo[i].intent].commit &&
+	    intent[redo[i].intent].slsn > applied)
+	  redo[j++] = redo[i];
+
+      nredo = j;
+
+      qsort((char *)redo, (size_t)nredo, sizeof(rm_redot), redo_cmp);
+    }
+
+
+  /* Phase 3: replay each file's redo list, coalescing writes that overlap
+   *          or are adjacent, and force the file to disk with its last write
+   */
+
+  for (f = 0; rcode == PIOUS_OK && f < nredo; f = fend)
+    { /* locate end of file's redo list */
+      for (fend = f + 1;
+	   fend < nredo && fhandle_eq(redo[fend].fhandle, redo[f].fhandle);
+	   fend++);
+
+      for (i = f; rcode == PIOUS_OK && i < fend; i = j)
+	{ /* extend coalesced write; overlapping writes are always included */
+	  cstart = redo[i].offset;
+	  cend   = cstart + redo[i].nbyte;
+
+	  for (j = i + 1;
+	       j < fend &&
+	       (redo[j].offset < cend ||
+		(redo[j].offset == cend &&
+		 redo[j].offset + redo[j].nbyte - cstart <= RM_REDO_SZ));
+	       j++)
+	    cend = Max(cend, (pious_offt)(redo[j].offset + redo[j].nbyte));
+
+	  span = cend - cstart;
+
+	  /* extend redo buffer, if necessary */
+	  if (span > rbuf_sz)
+	    {
+	      if (rbuf != NULL)
+		free(rbuf);
+
+	      rbuf_sz = Max(span, (pious_sizet)RM_REDO_SZ);
+
+	      if ((rbuf = malloc((unsigned)rbuf_sz)) == NULL)
+		{
+		  rbuf_sz = 0;
+		  rcode   = PIOUS_EINSUF;
+		  break;
+		}
+	    }
+
+	  /* read write data from log in the order logged; later writes
+	   * overwrite any earlier writes that they overlap
+	   */
+	  if (j - i > 1)
+	    qsort((char *)(redo + i), (size_t)(j - i), sizeof(rm_redot),
+		  redo_seqcmp);
+
+	  for (w = i; rcode == PIOUS_OK && w < j; w++)
+	    {
+	      rp    = redo + w;
+	      acode = SS_logread(rp->loff, PIOUS_SEEK_SET, rp->nbyte,
+				 rbuf + (rp->offset - cstart));
+
+	      if (acode != (pious_ssizet)rp->nbyte)
+		rcode = ((acode < 0) ? acode : PIOUS_EUNXP);
+	    }
+
+	  /* write data to file */
+	  if (rcode == PIOUS_OK)
+	    {
+	      acode = SS_write(redo[i].fhandle, cstart, span, rbuf,
+			       ((j == fend) ? PIOUS_STABLE : PIOUS_VOLATILE));
+
+	      if (acode == PIOUS_EBADF || acode == PIOUS_EUNXP)
+		{ /* file no longer extant; redo is not required */
+		  SS_errlog("pds_recovery_manager", "RM_recover()",
+			    (int)acode,
+			    "file not accessible; redo records discarded");
+		  j = fend;
+		}
+
+	      else if (acode != (pious_ssizet)span)
+		rcode = ((acode < 0) ? acode : PIOUS_EUNXP);
+	    }
+	}
+    }
+
+
+  /* deallocate storage */
+
+  if (rm_sbuf != NULL)
+    {
+      free(rm_sbuf);
+      rm_sbuf = NULL;
+    }
+
+  if (redo != NULL)
+    free((char *)redo);
+
+  if (intent != NULL)
+    free((char *)intent);
+
+  if (rbuf != NULL)
+    free(rbuf);
+
+
+  /* truncate log, completing recovery, if no transactions are in doubt.
+   *
+   * otherwise retain the log, appending records following the last valid
+   * record scanned; the stale log file beyond is overwritten by segment
+   * preallocation.  a recovery record marks the final states applied.
+   */
+
+  if (rcode == PIOUS_OK && nindoubt == 0)
+    {
+      if ((rcode = RM_logtrunc()) == PIOUS_OK)
+	SS_recover = FALSE;
+    }
+
+  else if (rcode == PIOUS_OK)
+    {
+      rm_boff = rm_soff = rm_alloc = off;
+      rm_nbuf = 0;
+      rm_lsn  = lastlsn + 1;
+
+      hdr[R_LSN]  = rm_lsn++;
+      hdr[R_TYPE] = RM_REC_RECOV;
+      hdr[R_LEN]  = sizeof(unsigned long);
+
+      rm_crc = 0;
+
+      if ((rcode = rm_append((char *)hdr,
+			     (pious_sizet)RM_REC_HDR_SZ)) == PIOUS_OK &&
+	  (rcode = rm_append((char *)&lastlsn,
+			     (pious_sizet)sizeof(unsigned long))) == PIOUS_OK)
+	{
+	  crc   = rm_crc;
+	  rcode = rm_append((char *)&crc, (pious_sizet)RM_REC_TLR_SZ);
+	}
+
+      if (rcode == PIOUS_OK)
+	rcode = rm_force();
+
+      if (rcode == PIOUS_OK)
+	{
+	  rm_indoubt = nindoubt;
+	  SS_recover = FALSE;
+	}
+      else
+	rm_rollback(rcode);
+    }
+
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+  else if (rcode != PIOUS_OK && rcode != PIOUS_EINSUF)
+    rcode = PIOUS_EUNXP;
+
+  return rcode;
+}
+
+
+
+
+/*
+ * Function Definitions - Local Functions
+ */
+
+
+/*
+ * rm_append()
+ *
+ * Parameters:
+ *
+ *   buf   - buffer
+ *   nbyte - byte count
+ *
+ * Append 'nbyte' bytes from buffer 'buf' to the log record being formed,
+ * updating the record checksum; the append buffer is written to the log
+ * file via rm_flush() as it fills.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - data appended
+ *   <  0         - error code returned by rm_flush()
+ */
+
+#ifdef __STDC__
+static int rm_append(char *buf,
+		     pious_sizet nbyte)
+#else
+static int rm_append(buf, nbyte)
+     char *buf;
+     pious_sizet nbyte;
+#endif
+{
+  int rcode;
+  pious_sizet cnt;
+
+  rm_crc = UTIL_crc32c(rm_crc, buf, (unsigned long)nbyte);
+  rcode  = PIOUS_OK;
+
+  while (rcode == PIOUS_OK && nbyte > 0)
+    {
+      cnt = Min(nbyte, RM_BUF_SZ - rm_nbuf);
+
+      memcpy(rm_buf + rm_nbuf, buf, (size_t)cnt);
+
+      rm_nbuf += cnt;
+      buf     += cnt;
+      nbyte   -= cnt;
+
+      if (rm_nbuf == RM_BUF_SZ)
+	rcode = rm_flush();
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * rm_flush()
+ *
+ * Parameters:
+ *
+ * Write the append buffer to the log file.  The log file is extended in
+ * segments of RM_SEG_SZ zero bytes ahead of the records written, so that
+ * appends do not grow the file and forcing the log is not burdened with
+ * file size updates.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - append buffer written
+ *   <  0         - error code defined in pious_errno.h; as for SS_logwrite()
+ */
+
+#ifdef __STDC__
+static int rm_flush(void)
+#else
+static int rm_flush()
+#endif
+{
+  int rcode;
+  pious_ssizet acode;
+  pious_sizet cnt;
+  pious_offt segend;
+  static char zero[RM_BUF_SZ];
+
+  rcode = PIOUS_OK;
+
+  /* preallocate log file segment(s), if required */
+
+  while (rcode == PIOUS_OK && rm_boff + rm_nbuf > rm_alloc)
+    {
+      segend = rm_alloc + RM_SEG_SZ;
+
+      while (rcode == PIOUS_OK && rm_alloc < segend)
+	{
+	  cnt = Min(RM_BUF_SZ, segend - rm_alloc);
+
+	  acode = SS_logwrite(rm_alloc, PIOUS_SEEK_SET, cnt, zero);
+
+	  if (acode == (pious_ssizet)cnt)
+	    rm_alloc += cnt;
+	  else if (acode < 0)
+	    rcode = acode;
+	  else
+	    rcode = PIOUS_EUNXP;
+	}
+    }
+
+  /* write append buffer */
+
+  if (rcode == PIOUS_OK && rm_nbuf > 0)
+    {
+      acode = SS_logwrite(rm_boff, PIOUS_SEEK_SET, rm_nbuf, rm_buf);
+
+      if (acode == (pious_ssizet)rm_nbuf)
+	{
+	  rm_boff += rm_nbuf;
+	  rm_nbuf  = 0;
+	}
+      else if (acode < 0)
+	rcode = acode;
+      else
+	rcode = PIOUS_EUNXP;
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * rm_force()
+ *
+ * Parameters:
+ *
+ * Write the append buffer to the log file and force all log records to
+ * stable storage.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - log records forced
+ *   <  0         - error code defined in pious_errno.h
+ */
+
+#ifdef __STDC__
+static int rm_force(void)
+#else
+static int rm_force()
+#endif
+{
+  int rcode;
+
+  if ((rcode = rm_flush()) == PIOUS_OK &&
+      (rcode = SS_logsync()) == PIOUS_OK)
+    {
+      rm_soff   = rm_boff;
+      rm_unsync = FALSE;
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * rm_rollback()
+ *
+ * Parameters:
+ *
+ *   ecode - error code returned by rm_append(), rm_flush(), or rm_force()
+ *
+ * Discard log records not forced to stable storage, such that subsequent
+ * records are appended following the last record forced.  Log sequence
+ * numbers are not reused, so a record discarded but partially written
+ * can not be mistaken for its successor.
+ *
+ * If records written with synchronization deferred are discarded then
+ * RM_logsync() reports the loss.  If 'ecode' indicates that the log file
+ * can not grow then a check-point is required for the PDS to continue.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void rm_rollback(int ecode)
+#else
+static void rm_rollback(ecode)
+     int ecode;
+#endif
+{
+  if (rm_unsync)
+    rm_lerror = PIOUS_ECHCKPT;
+
+  rm_boff   = rm_soff;
+  rm_nbuf   = 0;
+  rm_unsync = FALSE;
+
+  if (ecode == PIOUS_EFBIG || ecode == PIOUS_ENOSPC || ecode == PIOUS_EINVAL)
+    SS_checkpoint = TRUE;
+}
+
+
+
+
+/*
+ * rm_scan()
+ *
+ * Parameters:
+ *
+ *   offset - log file offset
+ *   nbyte  - byte count
+ *   buf    - buffer
+ *
+ * Scan 'nbyte' bytes of the log file starting at 'offset', updating the
+ * record checksum and placing the data in buffer 'buf' if not NULL.  The
+ * log file is read via the log scan buffer with large sequential reads.
+ *
+ * If the log file can not be read, the error code is retained in the scan
+ * error code (rm_serror) and the end of the log is assumed.
+ *
+ * Returns:
+ *
+ *   TRUE  - 'nbyte' bytes scanned
+ *   FALSE - end of log file reached
+ */
+
+#ifdef __STDC__
+static int rm_scan(pious_offt offset,
+		   pious_sizet nbyte,
+		   char *buf)
+#else
+static int rm_scan(offset, nbyte, buf)
+     pious_offt offset;
+     pious_sizet nbyte;
+     char *buf;
+#endif
+{
+  pious_ssizet acode;
+  pious_sizet cnt;
+  char *data;
+
+  while (nbyte > 0)
+    { /* refill scan buffer if 'offset' not buffered */
+      if (offset < rm_sstart || offset >= rm_sstart + rm_scnt)
+	{
+	  acode = SS_logread(offset, PIOUS_SEEK_SET,
+			     (pious_sizet)RM_SCAN_SZ, rm_sbuf);
+
+	  if (acode <= 0)
+	    { /* end of log file, or error reading log file */
+	      if (acode < 0)
+		rm_serror = acode;
+
+	      return FALSE;
+	    }
+
+	  rm_sstart = offset;
+	  rm_scnt   = acode;
+	}
+
+      /* scan buffered data */
+      data = rm_sbuf + (offset - rm_sstart);
+      cnt  = Min(nbyte, rm_scnt - (offset - rm_sstart));
+
+      rm_crc = UTIL_crc32c(rm_crc, data, (unsigned long)cnt);
+
+      if (buf != NULL)
+	{
+	  memcpy(buf, data, (size_t)cnt);
+	  buf += cnt;
+	}
+
+      offset += cnt;
+      nbyte  -= cnt;
+    }
+
+  return TRUE;
+}
+
+
+
+
+/*
+ * rm_grow()
+ *
+ * Parameters:
+ *
+ *   vec    - vector
+ *   cap    - vector capacity in elements
+ *   elsize - element size in bytes
+ *
+ * Double the capacity of vector '*vec', of '*cap' elements of 'elsize'
+ * bytes each, retaining its contents; if '*cap' is zero then a vector of
+ * RM_VEC_SZ elements is allocated.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - vector extended
+ *   PIOUS_EINSUF - insufficient memory; vector unchanged
+ */
+
+#ifdef __STDC__
+static int rm_grow(char **vec,
+		   long *cap,
+		   size_t elsize)
+#else
+static int rm_grow(vec, cap, elsize)
+     char **vec;
+     long *cap;
+     size_t elsize;
+#endif
+{
+  long ncap;
+  char *nvec;
+
+  ncap = ((*cap == 0) ? RM_VEC_SZ : 2 * *cap);
+
+  if ((nvec = malloc((unsigned)(ncap * elsize))) == NULL)
+    return PIOUS_EINSUF;
+
+  if (*vec != NULL)
+    {
+      memcpy(nvec, *vec, (size_t)(*cap * elsize));
+      free(*vec);
+    }
+
+  *vec = nvec;
+  *cap = ncap;
+
+  return PIOUS_OK;
+}
+
+
+
+
+/*
+ * redo_cmp()
+ *
+ * Parameters:
+ *
+ *   redo_1 - pointer to redo list entry
+ *   redo_2 - pointer to redo list entry
+ *
+ * Compare redo list entries by file handle, offset, and log sequence, for
+ * qsort().
+ *
+ * Note: redo_cmp() violates the pds_fhandlet type abstraction, as for
+ *       pds_cache_manager, to order file handles.
+ *
+ * Returns:
+ *
+ *   < 0 - redo_1 precedes redo_2
+ *   = 0 - redo_1 and redo_2 are the same write
+ *   > 0 - redo_1 follows redo_2
+ */
+
+#ifdef __STDC__
+static int redo_cmp(const void *redo_1,
+		    const void *redo_2)
+#else
+static int redo_cmp(redo_1, redo_2)
+     char *redo_1;
+     char *redo_2;
+#endif
+{
+  register rm_redot *r1, *r2;
+  int rcode;
+
+  r1 = (rm_redot *)redo_1;
+  r2 = (rm_redot *)redo_2;
+
+  if (r1->fhandle.dev != r2->fhandle.dev)
+    rcode = ((r1->fhandle.dev < r2->fhandle.dev) ? -1 : 1);
+
+  else if (r1->fhandle.ino != r2->fhandle.ino)
+    rcode = ((r1->fhandle.ino < r2->fhandle.ino) ? -1 : 1);
+
+  else if (r1->offset != r2->offset)
+    rcode = ((r1->offset < r2->offset) ? -1 : 1);
+
+  else
+    rcode = redo_seqcmp(redo_1, redo_2);
+
+  return rcode;
+}
+
+
+
+
+/*
+ * redo_seqcmp()
+ *
+ * Parameters:
+ *
+ *   redo_1 - pointer to redo list entry
+ *   redo_2 - pointer to redo list entry
+ *
+ * Compare redo list entries by log sequence, for qsort().
+ *
+ * Returns:
+ *
+ *   < 0 - redo_1 precedes redo_2
+ *   = 0 - redo_1 and redo_2 are the same write
+ *   > 0 - redo_1 follows redo_2
+ */
+
+#ifdef __STDC__
+static int redo_seqcmp(const void *redo_1,
+		       const void *redo_2)
+#else
+static int redo_seqcmp(redo_1, redo_2)
+     char *redo_1;
+     char *redo_2;
+#endif
+{
+  register rm_redot *r1, *r2;
+  int rcode;
+
+  r1 = (rm_redot *)redo_1;
+  r2 = (rm_redot *)redo_2;
+
+  if (r1->seq != r2->seq)
+    rcode = ((r1->seq < r2->seq) ? -1 : 1);
+  else
+    rcode = 0;
+
   return rcode;
 }
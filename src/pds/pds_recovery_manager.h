@@ -36,8 +36,12 @@
  *
  *   RM_trans_log();
  *   RM_trans_state();
+ *   RM_logdefer();
+ *   RM_logsync();
+ *   RM_logtrunc();
+ *   RM_logsize();
  *   RM_checkpt();      [not implemented]
- *   RM_recover();      [not implemented]
+ *   RM_recover();
  */
 
 
@@ -111,16 +115,15 @@ pious_offt RM_trans_log();
  *   state   - RM_TRANS_COMMIT or RM_TRANS_ABORT
  *
  * For log record 'lhandle', set final committement state to 'state'.
- *
- * WARNING: RM_trans_state() can not validate 'lhandle'; bad values will
- *          result in corruption of the transaction log file.
+ * The state record is forced to stable storage prior to returning, along
+ * with any log records written with synchronization deferred.
  *
  * Returns:
  *
  *   PIOUS_OK (0) - transaction final committement state logged
  *   <  0         - error code defined in pious_errno.h; possible codes are:
  *
- *       PIOUS_EINVAL - 'state' argument is invalid
+ *       PIOUS_EINVAL - 'lhandle' or 'state' argument is invalid
  *       PIOUS_EUNXP  - state NOT logged; unexpected error
  *       PIOUS_EFATAL - fatal error; check PDS error log
  */
@@ -131,3 +134,173 @@ int RM_trans_state(pious_offt lhandle,
 #else
 int RM_trans_state();
 #endif
+
+
+
+
+/*
+ * RM_logdefer()
+ *
+ * Parameters:
+ *
+ *   on - defer log synchronization flag
+ *
+ * If 'on' is TRUE, RM_trans_log() writes log records without forcing them
+ * to stable storage, deferring synchronization to RM_logsync(); records
+ * logged for a group of transactions can then be forced with a single
+ * synchronization (group commit).  If 'on' is FALSE, the default,
+ * RM_trans_log() forces log records to stable storage prior to returning.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+void RM_logdefer(int on);
+#else
+void RM_logdefer();
+#endif
+
+
+
+
+/*
+ * RM_logsync()
+ *
+ * Parameters:
+ *
+ * Force log records written by RM_trans_log() with synchronization
+ * deferred to stable storage, if not already forced.
+ *
+ * If log records written with synchronization deferred can not be forced,
+ * or were discarded due to an error in logging a subsequent record, then
+ * the transactions so logged are NOT prepared and must be aborted.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - log records forced to stable storage
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_ECHCKPT - log records NOT forced; check-point required
+ *                       for PDS to continue
+ *       PIOUS_EFATAL  - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+int RM_logsync(void);
+#else
+int RM_logsync();
+#endif
+
+
+
+
+/*
+ * RM_logtrunc()
+ *
+ * Parameters:
+ *
+ * Truncate the transaction log via SS_logtrunc(), discarding all log
+ * records; subsequent records are appended from the beginning of the log.
+ *
+ * NOTE: Prior to calling RM_logtrunc(), must insure that no transaction
+ *       is prepared, that no transaction is in doubt (see RM_indoubt()),
+ *       and that the requirements of SS_logtrunc() are met.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - transaction log truncated without error
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+int RM_logtrunc(void);
+#else
+int RM_logtrunc();
+#endif
+
+
+
+
+/*
+ * RM_logsize()
+ *
+ * Parameters:
+ *
+ * Determine the size of the transaction log, i.e. the number of bytes of
+ * log records appended since the log was last truncated; the log file is
+ * larger, as it is preallocated in segments.  The PDS daemon checkpoints
+ * the log, via RM_logtrunc(), based on its size.
+ *
+ * Returns:
+ *
+ *   pious_offt - transaction log size in bytes
+ */
+
+#ifdef __STDC__
+pious_offt RM_logsize(void);
+#else
+pious_offt RM_logsize();
+#endif
+
+
+
+
+/*
+ * RM_indoubt()
+ *
+ * Parameters:
+ *
+ * Determine the number of in-doubt transactions, i.e. transactions logged
+ * without a final state, retained in the transaction log by RM_recover().
+ *
+ * Returns:
+ *
+ *   >= 0 - in-doubt transaction count; zero if the log may be truncated
+ */
+
+#ifdef __STDC__
+long RM_indoubt(void);
+#else
+long RM_indoubt();
+#endif
+
+
+
+
+/*
+ * RM_recover()
+ *
+ * Parameters:
+ *
+ * Recover stable storage after a system failure, as indicated by the stable
+ * storage flag SS_recover, by redoing the write operations of transactions
+ * logged as committed; file data is forced to disk and the log truncated,
+ * and SS_recover is reset.
+ *
+ * Transactions logged without a final state were in their uncertainty
+ * period at failure; these are in doubt and are NOT redone.  Each is
+ * reported in the PDS error log and the log is retained, rather than
+ * truncated, so that the transaction can be resolved; resolution with the
+ * transaction coordinator is not implemented.  See RM_indoubt().
+ *
+ * NOTE: RM_recover() must be called following SS_init() and prior to
+ *       any other stable storage operations.  Writes to files that are
+ *       no longer accessible are discarded; see PDS error log.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - recovery completed, or not required
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINSUF - recovery NOT completed; insufficient memory
+ *       PIOUS_EUNXP  - recovery NOT completed; unexpected error
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+int RM_recover(void);
+#else
+int RM_recover();
+#endif
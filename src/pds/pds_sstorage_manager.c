@@ -34,11 +34,15 @@
  * Function Summary:
  *
  *   SS_init();
+ *   SS_direct();
  *
  *   SS_lookup();
  *   SS_read();
+ *   SS_readv();
  *   SS_write();
+ *   SS_writev();
  *   SS_faccess();
+ *   SS_fsize();
  *   SS_stat();
  *   SS_rename();    [not implemented]
  *   SS_chmod();
@@ -52,6 +56,11 @@
  *   SS_logsync();
  *   SS_logtrunc();
  *
+ *   SS_warmsave();
+ *   SS_warmload();
+ *
+ *   SS_stats();
+ *
  *   SS_errlog();
  *
  *
@@ -80,26 +89,21 @@
  *      call to indicate this situation to the recovery manager.
  *
  *   4) WARNING: SS_logtrunc() has been hacked to prevent truncation of the
- *               FHDB.  Thus file handles that have been looked up will not
- *               go stale until the PDS is shutdown and later restarted;
- *               this behavior has been documented in pds/pds.h.  The result
- *               is that the PIOUS service coordinator and library routines
- *               are easier to implement; both may require update if this
- *               behavior is changed.  Note that truncation of the FHDB is
- *               only required for long-term continuous operation.
+ *               FHDB, except when recovery is completed.  Thus file handles
+ *               that have been looked up will not go stale until the PDS is
+ *               shutdown and later restarted; this behavior has been
+ *               documented in pds/pds.h.  The result is that the PIOUS
+ *               service coordinator and library routines are easier to
+ *               implement; both may require update if this behavior is
+ *               changed.  Note that truncation of the FHDB is only required
+ *               for long-term continuous operation.
  *
  *               fhandle_db_write() has been hacked to avoid forced writes
  *               to the FHDB.  Thus initial file handle lookup (SS_lookup())
  *               and file unlinking (SS_unlink()) will have much improved
- *               performance.  Synchronous writes to the FHDB are only
- *               required for recoverability, which is not an issue since
- *               recovery has not yet been implemented in the PDS.
- *
- *               SS_init() has been hacked to truncate the log file at open.
- *               Thus it is possible to benchmark stable mode access without
- *               the system detecting a recovery condition the next time it
- *               is started.  Maintaining the log file is not necessary since
- *               recovery has not yet been implemented in the PDS.
+ *               performance.  Instead, SS_logsync() forces FHDB writes
+ *               prior to forcing the log, so that any file handle recorded
+ *               in the log is mapped in the FHDB for recovery.
  */
 
 
@@ -145,7 +149,9 @@
  *
  *   Cached information associated with a given file handle. Cache is
  *   implemented as a doubly linked circular list, with first and last
- *   entries being MRU and LRU respectively.
+ *   entries being MRU and LRU respectively.  Entries with an associated
+ *   file descriptor are also kept on a doubly linked list, from MRU to LRU,
+ *   so that the descriptor to reclaim is located without search.
  */
 
 typedef struct fic_entry{
@@ -154,25 +160,49 @@ typedef struct fic_entry{
   char *path;                /* file path name */
   int amode;                 /* file accessibility by PDS */
   int fildes;                /* associated file descriptor */
+  int direct;                /* fildes has direct I/O enabled */
   struct fic_entry *cnext;   /* next cache entry in LRU chain (towards LRU) */
   struct fic_entry *cprev;   /* prev cache entry in LRU chain (towards MRU) */
   struct fic_entry *fhnext;  /* next entry in file handle hash chain */
   struct fic_entry *fhprev;  /* prev entry in file handle hash chain */
+  struct fic_entry *fdnext;  /* next entry in descriptor list (towards LRU) */
+  struct fic_entry *fdprev;  /* prev entry in descriptor list (towards MRU) */
 } fic_entryt;
 
-/* FIC cache size in number of entries (must be > 0) */
-#define SS_FIC_SZ 512
+/* FIC initial cache size, and size limit to which the cache grows rather
+ * than replace entries, in number of entries (0 < SS_FIC_SZ <= SS_FIC_MAX)
+ */
+#define SS_FIC_SZ  512
+#define SS_FIC_MAX 65536
 
 /* FIC invalid file descriptor flag */
 #define FILDES_INVALID -1
 
-/* file handle hash table size; choose prime not near a power of 2 */
+/* file handle hash table minimum size; the table is resized as the FIC
+ * grows, to a prime not near a power of 2.  see table_size().
+ */
 #define FH_TABLE_SZ 103
 
+/* file descriptor pool size limit; the pool is sized from the host limit on
+ * open files at initialization, less descriptors reserved for the log files
+ * and message passing.
+ */
+#define SS_FILDES_MAX     65536
+#define SS_FILDES_RESERVE 32
+
 /* file handle database (FHDB) name and permission mask */
 #define FHDB_NAME "PIOUS.DS.FHDB"
 #define FHDB_PERM (PIOUS_IRUSR | PIOUS_IWUSR)
 
+/* FHDB index entry allocation block size, in number of entries */
+#define FHDB_IX_BLK 1024
+
+/* FHDB buffer size for index construction and compaction, in bytes */
+#define FHDB_BUF_SZ 65536
+
+/* FHDB size below which the FHDB is not compacted, in bytes */
+#define FHDB_COMPACT_MIN 1048576
+
 /* transaction log (TLOG) file name and permission mask */
 #define TLOG_NAME "PIOUS.DS.TLOG"
 #define TLOG_PERM (PIOUS_IRUSR | PIOUS_IWUSR)
@@ -181,6 +211,13 @@ typedef struct fic_entry{
 #define ERRLOG_NAME "PIOUS.DS.ERRLOG"
 #define ERRLOG_PERM (PIOUS_IRUSR | PIOUS_IWUSR | PIOUS_IRGRP | PIOUS_IROTH)
 
+/* cache warm-up manifest (WARM) file name and permission mask */
+#define WARM_NAME "PIOUS.DS.WARM"
+#define WARM_PERM (PIOUS_IRUSR | PIOUS_IWUSR)
+
+/* WARM record field width bound; a decimal long and separator */
+#define WARM_FIELD_MAX 24
+
 
 
 
@@ -189,13 +226,18 @@ typedef struct fic_entry{
  */
 
 
-/* file information cache (FIC) */
+/* file information cache (FIC); initial entries, with further entries
+ * allocated as the cache grows.  see fic_grow().
+ */
 static fic_entryt fic_cache[SS_FIC_SZ];
+static long fic_sz;                          /* cache size in entries */
+static long fic_nvalid;                      /* valid cache entries */
 static fic_entryt *fic_lru;                  /* LRU cache entry */
 static fic_entryt *fic_mru;                  /* MRU cache entry */
 
 /* file handle hash table (for locating FIC entries) */
-static fic_entryt *fh_table[FH_TABLE_SZ];
+static fic_entryt **fh_table;
+static long fh_table_sz;
 
 /* file handle database (FHDB) - file information entry */
 static fic_entryt FHDBinfo;
@@ -206,6 +248,44 @@ static fic_entryt TLOGinfo;
 /* error log (ERRLOG) - file information entry */
 static fic_entryt ERRLOGinfo;
 
+/* cache warm-up manifest (WARM) - file information entry */
+static fic_entryt WARMinfo;
+
+
+/* file handle database (FHDB) index:
+ *
+ *   Maps a file handle to the location of the most recent FHDB record for
+ *   that file handle, so that fhandle_db_read() need not scan the FHDB.
+ *   The index is constructed by SS_init() and maintained by
+ *   fhandle_db_write(); if storage for the index can not be allocated then
+ *   the index is discarded and fhandle_db_read() reverts to scanning.
+ *
+ *   Index entries are allocated in blocks and are only deallocated with
+ *   the index; the hash table is resized as entries are added.
+ */
+
+typedef struct fhdb_ixentry{
+  pds_fhandlet fhandle;         /* file handle */
+  pious_offt offset;            /* FHDB offset of record path name */
+  unsigned long pathlen;        /* path name length; 0 (zero) if "unmapping" */
+  struct fhdb_ixentry *hnext;   /* next entry in hash chain */
+} fhdb_ixentryt;
+
+typedef struct fhdb_ixblk{
+  struct fhdb_ixblk *next;            /* next (previously allocated) block */
+  fhdb_ixentryt entry[FHDB_IX_BLK];   /* index entries */
+} fhdb_ixblkt;
+
+static fhdb_ixentryt **fhdb_table;   /* index hash table; NULL if no index */
+static long fhdb_table_sz;           /* index hash table size */
+static long fhdb_nentry;             /* index entries */
+static fhdb_ixblkt *fhdb_blk;        /* index entry blocks; first is current */
+static long fhdb_blk_nused;          /* entries used in current block */
+
+static pious_offt fhdb_size;         /* FHDB size in bytes */
+static pious_offt fhdb_live;         /* FHDB bytes in most recent mappings */
+static pious_offt fhdb_compact_sz;   /* FHDB size to reconsider compaction */
+
 
 /* file descriptor (fildes) table:
  *
@@ -217,6 +297,16 @@ static fic_entryt ERRLOGinfo;
 
 static int fildes_total;              /* file descriptors available total */
 static fic_entryt **fildes_table;     /* file descriptor table */
+static long fildes_max;               /* file descriptor pool size */
+static long fildes_nopen;             /* file descriptors open in pool */
+static fic_entryt *fd_mru, *fd_lru;   /* MRU/LRU entries with descriptor */
+
+
+/* Stable storage statistics; activity counters only, state determined by
+ * SS_stats()
+ */
+
+static struct SS_stats ss_stat;
 
 
 /* file handle database record template:
@@ -230,6 +320,10 @@ static fic_entryt **fildes_table;     /* file descriptor table */
  *   only ever appended, so that the FHDB is read backwards to obtain
  *   the most recent mapping.  When a file is deleted, a tuple containing
  *   a null path name is appended to the FHDB to indicate this "unmapping".
+ *   The FHDB index locates the most recent record for a file handle without
+ *   reading the FHDB backwards; when superseded records come to dominate,
+ *   the FHDB is compacted to the most recent mappings in the same format.
+ *   see fhdb_compact().
  *
  *   Maintaing file handle to pathname mappings is necessary for two reasons:
  *
@@ -308,6 +402,7 @@ int SS_fatalerror = TRUE;
  *   indicates that stable storage requires recovery before PDS can continue
  *
  *   set by: pds_cache_manager routines, pds_sstorage_manager in SS_init()
+ *   reset by: pds_recovery_manager in RM_recover()
  */
 
 int SS_recover = FALSE;
@@ -343,6 +438,20 @@ int SS_checkpoint = FALSE;
 static int FHDBfull = FALSE;
 
 
+/* local FHDB unsynchronized flag
+ *
+ *   indicates FHDB records have been written but not forced to disk; see
+ *   SS_logsync().
+ */
+
+static int FHDBunsync = FALSE;
+
+
+/* data file direct I/O flag; see SS_direct() */
+
+static int ss_direct = FALSE;
+
+
 
 
 /* Local Function Declarations */
@@ -366,17 +475,48 @@ static void fic_make_mru(fic_entryt *fic_entry);
 
 static void fic_make_lru(fic_entryt *fic_entry);
 
+static void fic_grow(void);
+
+static long table_size(long nentry);
+
 static int fhandle_db_write(pds_fhandlet fhandle,
 			    char *path);
 
 static int fhandle_db_read(pds_fhandlet fhandle,
 			   char **path);
 
+static void fhdb_index_build(pious_offt size);
+
+static fhdb_ixentryt *fhdb_index_locate(pds_fhandlet fhandle);
+
+static int fhdb_index_update(pds_fhandlet fhandle,
+			     pious_offt offset,
+			     unsigned long pathlen);
+
+static void fhdb_index_free(void);
+
+static char *fhdb_fetch(char *buf,
+			pious_offt *bstart,
+			pious_offt *bend,
+			pious_offt offset);
+
+static void fhdb_compact(void);
+
 static int fildes_alloc(fic_entryt *fic_entry,
 			int cflag,
 			pious_modet mode);
 
 static void fildes_free(fic_entryt *fic_entry);
+
+static void fildes_touch(fic_entryt *fic_entry);
+
+static int direct_aligned(pious_offt offset,
+			  pious_sizet nbyte,
+			  char *buf);
+
+static int direct_alignedv(pious_offt offset,
+			   struct FS_iovec *iov,
+			   int iovcnt);
 #else
 static int path2fhandle();
 static int fhandle_locate();
@@ -385,10 +525,21 @@ static fic_entryt *fic_insert();
 static void fic_invalidate();
 static void fic_make_mru();
 static void fic_make_lru();
+static void fic_grow();
+static long table_size();
 static int fhandle_db_write();
 static int fhandle_db_read();
+static void fhdb_index_build();
+static fhdb_ixentryt *fhdb_index_locate();
+static int fhdb_index_update();
+static void fhdb_index_free();
+static char *fhdb_fetch();
+static void fhdb_compact();
 static int fildes_alloc();
 static void fildes_free();
+static void fildes_touch();
+static int direct_aligned();
+static int direct_alignedv();
 #endif
 
 
@@ -424,15 +575,16 @@ int SS_init(logpath)
    *       testing at the Abort_Init label.
    */
 
-  FHDBinfo.path = TLOGinfo.path = ERRLOGinfo.path = NULL;
+  FHDBinfo.path = TLOGinfo.path = ERRLOGinfo.path = WARMinfo.path = NULL;
   fildes_table  = NULL;
+  fh_table      = NULL;
 
   FHDBinfo.fildes = TLOGinfo.fildes = ERRLOGinfo.fildes = FILDES_INVALID;
 
 
   /* set stable storage status flags */
 
-  SS_recover = SS_checkpoint = FHDBfull = FALSE;
+  SS_recover = SS_checkpoint = FHDBfull = FHDBunsync = FALSE;
 
 
   /* check that a log file directory has been provided */
@@ -477,6 +629,21 @@ int SS_init(logpath)
 	    logpath, ERRLOG_NAME, myuid, myhostid);
 
 
+  /* set up cache warm-up manifest file name
+   *
+   *   note: SS_warmsave() and SS_warmload() handle case WARMinfo.path == NULL,
+   *         so no need to abort on failure to allocate pathname space.
+   */
+
+  if ((WARMinfo.path = malloc((unsigned)(strlen(logpath) +
+					 strlen(WARM_NAME) +
+					 (2 * idwidth) +
+					 4))) != NULL)
+
+    sprintf(WARMinfo.path, "%s/%s.%lx.%lx",
+	    logpath, WARM_NAME, myuid, myhostid);
+
+
 
   /* initialize file information cache (FIC) as doubly linked circular list */
 
@@ -511,6 +678,30 @@ int SS_init(logpath)
   fic_mru = fic_cache;
   fic_lru = fic_cache + (SS_FIC_SZ - 1);
 
+  fic_sz     = SS_FIC_SZ;
+  fic_nvalid = 0;
+
+  /* allocate and initialize file handle hash table for FIC */
+
+  fh_table_sz = table_size(fic_sz);
+
+  fh_table = (fic_entryt **)malloc((unsigned)
+				   (fh_table_sz * sizeof(fic_entryt *)));
+
+  if (fh_table != NULL)
+    { /* table allocated; initialize */
+      for (idx = 0; idx < fh_table_sz; idx++)
+	fh_table[idx] = NULL;
+    }
+
+  else
+    { /* unable to allocate storage for hash table; log error and abort */
+      SS_errlog("pds_sstorage_manager", "SS_init()", PIOUS_EINSUF,
+		"can not allocate file handle hash table");
+
+      goto Abort_Init;
+    }
+
   /* initialize FHDB record template flag fields */
 
   fhdb_template.f[F_EORMARKER_0] ^= fhdb_template.f[F_EORMARKER_0];
@@ -526,9 +717,16 @@ int SS_init(logpath)
 
 
 
-  /* initialize file descriptor mapping table for number of available descrp */
+  /* initialize file descriptor mapping table for number of available descrp;
+   * the host limit on open files is first raised as permitted, and the
+   * descriptor pool sized from the result.
+   */
+
+  fildes_total = FS_open_limit((long)SS_FILDES_MAX + SS_FILDES_RESERVE);
 
-  fildes_total = FS_open_max();
+  fildes_max   = Max(fildes_total - SS_FILDES_RESERVE, fildes_total / 2);
+  fildes_nopen = 0;
+  fd_mru       = fd_lru = NULL;
 
   fildes_table = (fic_entryt **)malloc((unsigned)
 				       (fildes_total * sizeof(fic_entryt *)));
@@ -565,10 +763,7 @@ int SS_init(logpath)
   sprintf(TLOGinfo.path, "%s/%s.%lx.%lx",
 	  logpath, TLOG_NAME, myuid, myhostid);
 
-  /* WARNING: hacked log file open to truncate; see implementation notes */
-
-  ocode = FS_open(TLOGinfo.path,
-		  PIOUS_RDWR | PIOUS_CREAT | PIOUS_TRUNC, TLOG_PERM);
+  ocode = FS_open(TLOGinfo.path, PIOUS_RDWR | PIOUS_CREAT, TLOG_PERM);
 
   if (ocode >=0 )
     /* successfully opened TLOG file */
@@ -675,6 +870,10 @@ int SS_init(logpath)
       goto Abort_Init;
     }
 
+  /* construct FHDB index; FHDB is only non-empty if recovery is required */
+
+  fhdb_index_build(fstatus.size);
+
   /* initialization completed without error; enable stable storage manager */
 
   SS_fatalerror = FALSE;
@@ -708,13 +907,23 @@ int SS_init(logpath)
   if (ERRLOGinfo.path != NULL)
     free(ERRLOGinfo.path);
 
-  ERRLOGinfo.path = TLOGinfo.path = FHDBinfo.path = NULL;
+  if (WARMinfo.path != NULL)
+    free(WARMinfo.path);
+
+  ERRLOGinfo.path = TLOGinfo.path = FHDBinfo.path = WARMinfo.path = NULL;
 
   if (fildes_table != NULL)
     free((char *)fildes_table);
 
   fildes_table = NULL;
 
+  if (fh_table != NULL)
+    free((char *)fh_table);
+
+  fh_table = NULL;
+
+  fhdb_index_free();
+
   /* set result codes and exit */
   SS_fatalerror = TRUE;
   return(PIOUS_EFATAL);
@@ -723,6 +932,23 @@ int SS_init(logpath)
 
 
 
+/*
+ * SS_direct() - See pds_sstorage_manager.h for description
+ */
+
+#ifdef __STDC__
+void SS_direct(int on)
+#else
+void SS_direct(on)
+     int on;
+#endif
+{
+  ss_direct = on;
+}
+
+
+
+
 /*
  * SS_lookup() - See pds_sstorage_manager.h for description.
  */
@@ -878,7 +1104,7 @@ pious_ssizet SS_read(fhandle, offset, nbyte, buf)
 {
   pious_ssizet rcode, acode;
   int fcode;
-  int fd_valid;
+  int fd_valid, buffered;
   fic_entryt *fic_entry;
 
   /* check for previous fatal errors */
@@ -926,10 +1152,127 @@ pious_ssizet SS_read(fhandle, offset, nbyte, buf)
 		}
 
 	      if (fd_valid)
-		{ /* valid file descriptor; attempt to read from file */
+		{ /* valid file descriptor; direct I/O requires an aligned
+		   * transfer, so perform buffered I/O for any other
+		   */
+		  buffered = (fic_entry->direct &&
+			      !direct_aligned(offset, nbyte, buf));
+
+		  if (buffered)
+		    FS_direct(fic_entry->fildes, FALSE);
+
+		  /* attempt to read from file */
 		  acode = FS_read(fic_entry->fildes, offset, PIOUS_SEEK_SET,
 				  nbyte, buf);
 
+		  if (buffered &&
+		      FS_direct(fic_entry->fildes, TRUE) != PIOUS_OK)
+		    fic_entry->direct = FALSE;
+
+		  if (acode >= 0)
+		    /* read from file without error */
+		    rcode = acode;
+		  else
+		    /* error reading file; set rcode appropriately */
+		    switch(acode)
+		      {
+		      case PIOUS_EINVAL:
+			rcode = PIOUS_EINVAL;
+			break;
+		      default:
+			rcode = PIOUS_EUNXP;
+			break;
+		      }
+		}
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * SS_readv() - See pds_sstorage_manager.h for description.
+ */
+
+#ifdef __STDC__
+pious_ssizet SS_readv(pds_fhandlet fhandle,
+		      pious_offt offset,
+		      struct FS_iovec *iov,
+		      int iovcnt)
+#else
+pious_ssizet SS_readv(fhandle, offset, iov, iovcnt)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     struct FS_iovec *iov;
+     int iovcnt;
+#endif
+{
+  pious_ssizet rcode, acode;
+  int fcode;
+  int fd_valid, buffered;
+  fic_entryt *fic_entry;
+
+  /* check for previous fatal errors */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  else
+    { /* locate 'fhandle' */
+      fcode = fhandle_locate(fhandle, &fic_entry);
+
+      if (fcode != PIOUS_OK)
+	/* 'fhandle' not located or error occured in accessing FHDB */
+	rcode = fcode; /* PIOUS_EBADF or PIOUS_EINSUF or PIOUS_EFATAL */
+
+      else
+	{ /* 'fhandle' located and now in FIC; validate access mode */
+
+	  if (!(fic_entry->amode & PIOUS_R_OK))
+	    /* read not a valid access mode */
+	    rcode = PIOUS_EACCES;
+	  else
+	    {
+	      /* read is valid access mode; obtain file descriptor */
+
+	      fd_valid = TRUE;
+
+	      if (fic_entry->fildes == FILDES_INVALID)
+		{ /* allocate a file descriptor */
+		  acode = fildes_alloc(fic_entry, PIOUS_NOCREAT,
+				       (pious_modet)0);
+
+		  if (acode != PIOUS_OK)
+		    { /* error allocating file descriptor */
+		      fd_valid = FALSE;
+
+		      if (acode == PIOUS_EINSUF)
+			rcode = PIOUS_EINSUF;
+		      else
+			rcode = PIOUS_EUNXP;
+		    }
+		}
+
+	      if (fd_valid)
+		{ /* valid file descriptor; direct I/O requires an aligned
+		   * transfer, so perform buffered I/O for any other
+		   */
+		  buffered = (fic_entry->direct &&
+			      !direct_alignedv(offset, iov, iovcnt));
+
+		  if (buffered)
+		    FS_direct(fic_entry->fildes, FALSE);
+
+		  /* attempt to read from file */
+		  acode = FS_readv(fic_entry->fildes, offset, iov, iovcnt);
+
+		  if (buffered &&
+		      FS_direct(fic_entry->fildes, TRUE) != PIOUS_OK)
+		    fic_entry->direct = FALSE;
+
 		  if (acode >= 0)
 		    /* read from file without error */
 		    rcode = acode;
@@ -976,7 +1319,7 @@ pious_ssizet SS_write(fhandle, offset, nbyte, buf, faultmode)
 {
   pious_ssizet rcode, acode;
   int fcode;
-  int fd_valid;
+  int fd_valid, buffered;
   fic_entryt *fic_entry;
 
   /* check for previous fatal errors */
@@ -1028,10 +1371,23 @@ pious_ssizet SS_write(fhandle, offset, nbyte, buf, faultmode)
 		}
 
 	      if (fd_valid)
-		{ /* valid file descriptor; attempt to write to file */
+		{ /* valid file descriptor; direct I/O requires an aligned
+		   * transfer, so perform buffered I/O for any other
+		   */
+		  buffered = (fic_entry->direct &&
+			      !direct_aligned(offset, nbyte, buf));
+
+		  if (buffered)
+		    FS_direct(fic_entry->fildes, FALSE);
+
+		  /* attempt to write to file */
 		  acode = FS_write(fic_entry->fildes, offset, PIOUS_SEEK_SET,
 				   nbyte, buf);
 
+		  if (buffered &&
+		      FS_direct(fic_entry->fildes, TRUE) != PIOUS_OK)
+		    fic_entry->direct = FALSE;
+
 		  if (acode >= 0)
 		    /* file written without error */
 		    if (faultmode == PIOUS_VOLATILE)
@@ -1069,73 +1425,244 @@ pious_ssizet SS_write(fhandle, offset, nbyte, buf, faultmode)
 
 
 /*
- * SS_faccess() - See pds_sstorage_manager.h for description
+ * SS_writev() - See pds_sstorage_manager.h for description.
  */
 
 #ifdef __STDC__
-int SS_faccess(pds_fhandlet fhandle,
-	       int *amode)
+pious_ssizet SS_writev(pds_fhandlet fhandle,
+		       pious_offt offset,
+		       struct FS_iovec *iov,
+		       int iovcnt,
+		       int faultmode)
 #else
-int SS_faccess(fhandle, amode)
+pious_ssizet SS_writev(fhandle, offset, iov, iovcnt, faultmode)
      pds_fhandlet fhandle;
-     int *amode;
+     pious_offt offset;
+     struct FS_iovec *iov;
+     int iovcnt;
+     int faultmode;
 #endif
 {
-  int rcode;
+  pious_ssizet rcode, acode;
+  int fcode;
+  int fd_valid, buffered;
   fic_entryt *fic_entry;
 
   /* check for previous fatal errors */
   if (SS_fatalerror)
     rcode = PIOUS_EFATAL;
 
-  /* locate 'fhandle'; set 'amode' if found */
-  else if ((rcode = fhandle_locate(fhandle, &fic_entry)) == PIOUS_OK)
-    *amode = fic_entry->amode;
+  /* validate 'faultmode' argument */
+  else if (faultmode != PIOUS_VOLATILE && faultmode != PIOUS_STABLE)
+    rcode = PIOUS_EINVAL;
 
-  return rcode;
-}
+  else
+    { /* locate 'fhandle' */
+      fcode = fhandle_locate(fhandle, &fic_entry);
 
+      if (fcode != PIOUS_OK)
+	/* 'fhandle' not located or error occured in accessing FHDB */
+	rcode = fcode; /* PIOUS_EBADF or PIOUS_EINSUF or PIOUS_EFATAL */
 
+      else
+	{ /* 'fhandle' located and now in FIC; validate access mode */
 
+	  if (!(fic_entry->amode & PIOUS_W_OK))
+	    /* write not a valid access mode */
+	    rcode = PIOUS_EACCES;
+	  else
+	    {
+	      /* write is valid access mode; obtain file descriptor */
 
-/*
- * SS_stat() - See pds_sstorage_manager.h for description
- */
+	      fd_valid = TRUE;
 
-#ifdef __STDC__
-int SS_stat(char *path,
-	    pious_modet *mode)
-#else
-int SS_stat(path, mode)
-     char *path;
-     pious_modet *mode;
-#endif
-{
-  int rcode;
-  struct FS_stat fstatus;
+	      if (fic_entry->fildes == FILDES_INVALID)
+		{ /* allocate a file descriptor */
+		  acode = fildes_alloc(fic_entry, PIOUS_NOCREAT,
+				       (pious_modet)0);
 
-  /* check for previous fatal errors */
-  if (SS_fatalerror)
-    rcode = PIOUS_EFATAL;
+		  if (acode != PIOUS_OK)
+		    { /* error allocating descriptor */
+		      fd_valid = FALSE;
 
-  /* determine file mode */
-  else if ((rcode = FS_stat(path, &fstatus)) == PIOUS_OK)
-    *mode = fstatus.mode;
+		      /* PIOUS_EINSUF only possible error unless file status
+		       * or path modified by entity other than PDS
+		       */
 
-  return rcode;
-}
+		      if (acode == PIOUS_EINSUF)
+			rcode = PIOUS_EINSUF;
+		      else
+			rcode = PIOUS_EUNXP;
+		    }
+		}
 
+	      if (fd_valid)
+		{ /* valid file descriptor; direct I/O requires an aligned
+		   * transfer, so perform buffered I/O for any other
+		   */
+		  buffered = (fic_entry->direct &&
+			      !direct_alignedv(offset, iov, iovcnt));
 
+		  if (buffered)
+		    FS_direct(fic_entry->fildes, FALSE);
 
+		  /* attempt to write to file */
+		  acode = FS_writev(fic_entry->fildes, offset, iov, iovcnt);
 
-/*
- * SS_chmod() - See pds_sstorage_manager.h for description.
- */
+		  if (buffered &&
+		      FS_direct(fic_entry->fildes, TRUE) != PIOUS_OK)
+		    fic_entry->direct = FALSE;
 
-#ifdef __STDC__
-int SS_chmod(char *path,
-	     pious_modet mode,
-	     int *amode)
+		  if (acode >= 0)
+		    /* file written without error */
+		    if (faultmode == PIOUS_VOLATILE)
+		      /* VOLATILE write; do not force to disk */
+		      rcode = acode;
+		    else
+		      /* STABLE write; force to disk */
+		      if (FS_fsync(fic_entry->fildes) == PIOUS_OK)
+			rcode = acode;
+		      else
+			rcode = PIOUS_EUNXP;
+
+		  else
+		    /* error writting file; set rcode appropriately */
+		    switch(acode)
+		      {
+		      case PIOUS_EINVAL:
+		      case PIOUS_EFBIG:
+		      case PIOUS_ENOSPC:
+			rcode = acode;
+			break;
+		      default:
+			rcode = PIOUS_EUNXP;
+			break;
+		      }
+		}
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+
+/*
+ * SS_faccess() - See pds_sstorage_manager.h for description
+ */
+
+#ifdef __STDC__
+int SS_faccess(pds_fhandlet fhandle,
+	       int *amode)
+#else
+int SS_faccess(fhandle, amode)
+     pds_fhandlet fhandle;
+     int *amode;
+#endif
+{
+  int rcode;
+  fic_entryt *fic_entry;
+
+  /* check for previous fatal errors */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  /* locate 'fhandle'; set 'amode' if found */
+  else if ((rcode = fhandle_locate(fhandle, &fic_entry)) == PIOUS_OK)
+    *amode = fic_entry->amode;
+
+  return rcode;
+}
+
+
+
+
+/*
+ * SS_fsize() - See pds_sstorage_manager.h for description
+ */
+
+#ifdef __STDC__
+int SS_fsize(pds_fhandlet fhandle,
+	     pious_offt *fsize)
+#else
+int SS_fsize(fhandle, fsize)
+     pds_fhandlet fhandle;
+     pious_offt *fsize;
+#endif
+{
+  int rcode, acode;
+  fic_entryt *fic_entry;
+  struct FS_stat status;
+
+  /* check for previous fatal errors */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  /* locate 'fhandle' */
+  else if ((rcode = fhandle_locate(fhandle, &fic_entry)) == PIOUS_OK)
+    { /* 'fhandle' located and now in FIC; obtain file descriptor */
+      if (fic_entry->fildes == FILDES_INVALID &&
+	  (acode = fildes_alloc(fic_entry, PIOUS_NOCREAT,
+				(pious_modet)0)) != PIOUS_OK)
+	/* PIOUS_EINSUF only possible error unless file status or path
+	 * modified by entity other than PDS
+	 */
+	rcode = ((acode == PIOUS_EINSUF) ? PIOUS_EINSUF : PIOUS_EUNXP);
+
+      else if (FS_fstat(fic_entry->fildes, &status) != PIOUS_OK)
+	rcode = PIOUS_EUNXP;
+
+      else
+	*fsize = status.size;
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * SS_stat() - See pds_sstorage_manager.h for description
+ */
+
+#ifdef __STDC__
+int SS_stat(char *path,
+	    pious_modet *mode)
+#else
+int SS_stat(path, mode)
+     char *path;
+     pious_modet *mode;
+#endif
+{
+  int rcode;
+  struct FS_stat fstatus;
+
+  /* check for previous fatal errors */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  /* determine file mode */
+  else if ((rcode = FS_stat(path, &fstatus)) == PIOUS_OK)
+    *mode = fstatus.mode;
+
+  return rcode;
+}
+
+
+
+
+/*
+ * SS_chmod() - See pds_sstorage_manager.h for description.
+ */
+
+#ifdef __STDC__
+int SS_chmod(char *path,
+	     pious_modet mode,
+	     int *amode)
 #else
 int SS_chmod(path, mode, amode)
      char *path;
@@ -1464,8 +1991,16 @@ int SS_logsync()
     rcode = PIOUS_EFATAL;
 
   else
-    { /* attempt to force writes to disk */
-      scode = FS_fsync(TLOGinfo.fildes);
+    { /* attempt to force writes to disk; FHDB records first, so that file
+       * handles recorded in the log are mapped for recovery
+       */
+      scode = PIOUS_OK;
+
+      if (FHDBunsync && (scode = FS_fsync(FHDBinfo.fildes)) == PIOUS_OK)
+	FHDBunsync = FALSE;
+
+      if (scode == PIOUS_OK)
+	scode = FS_fsync(TLOGinfo.fildes);
 
       switch(scode)
 	{
@@ -1530,7 +2065,7 @@ int SS_logtrunc()
 
 	  /* WARNING: hack to prevent FHDB trunc; see implementation notes */
 
-	  if (TRUE /* !FHDBfull */)
+	  if (!SS_recover /* && !FHDBfull */)
 	    /* FHDB does not require truncation */
 	    rcode = PIOUS_OK;
 
@@ -1557,7 +2092,16 @@ int SS_logtrunc()
 		{ /* successfully re-opened/truncated FHDB file */
 		  FHDBinfo.fildes = ocode;
 		  FHDBfull        = FALSE;
+		  FHDBunsync      = FALSE;
 		  rcode           = PIOUS_OK;
+
+		  fhdb_index_build((pious_offt)0);
+
+		  /* invalidate FIC, as file handles are no longer mapped;
+		   * invalid entries are always least recently used.
+		   */
+		  while (fic_nvalid > 0)
+		    fic_invalidate(fic_mru);
 		}
 	    }
 	}
@@ -1570,122 +2114,418 @@ int SS_logtrunc()
 
 
 /*
- * SS_errlog() - See pds_sstorage_manager.h for description
+ * SS_warmsave() - See pds_sstorage_manager.h for description
+ *
+ * The warm-up manifest is a text file.  A header line, containing WARM_NAME
+ * and the data block size, is followed by a record for each file.  A record
+ * consists of a line containing the run count and path name of the file,
+ * followed by a line for each run of contiguous data blocks containing the
+ * first data block number and the data block count of the run.
  */
 
 #ifdef __STDC__
-void SS_errlog(char *module,
-	       char *func,
-	       int errno,
-	       char *errmsg)
+int SS_warmsave(struct SS_warmblk *blk,
+		long cnt,
+		pious_sizet dblk_sz)
 #else
-void SS_errlog(module, func, errno, errmsg)
-     char *module;
-     char *func;
-     int errno;
-     char *errmsg;
+int SS_warmsave(blk, cnt, dblk_sz)
+     struct SS_warmblk *blk;
+     long cnt;
+     pious_sizet dblk_sz;
 #endif
 {
-  char *errnotxt, *errtxt, msgout[512];
-  long caltime;
-  int errlen, errlogged;
+  int rcode, ocode;
+  long i, j, k, nrun;
+  pious_offt offset;
+  pious_sizet nbyte;
+  char *tmppath, *record;
+  char header[sizeof(WARM_NAME) + WARM_FIELD_MAX];
+  fic_entryt *fic_entry;
 
-  /* define complete error message for output */
+  tmppath = NULL;
+
+  /* check for previous fatal errors */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  /* allocate temporary file name space */
+  else if (WARMinfo.path == NULL ||
+	   (tmppath = malloc((unsigned)(strlen(WARMinfo.path) + 5))) == NULL)
+    rcode = PIOUS_EINSUF;
 
-  if (errno == 0)
-    { /* no error code text required */
-      errnotxt = "";
-      errtxt   = "no error code provided";
-    }
   else
-    /* generate error code text */
-    UTIL_errno2errtxt(errno, &errnotxt, &errtxt);
+    { /* write manifest to temporary file */
+      sprintf(tmppath, "%s.tmp", WARMinfo.path);
 
-  caltime = time(NULL);
+      ocode = FS_open(tmppath,
+		      PIOUS_WRONLY | PIOUS_CREAT | PIOUS_TRUNC, WARM_PERM);
 
-  sprintf(msgout, "\n%s\n%.25s/%.20s: %.20s\n\t[%.60s]\n\t%.60s\n",
-	  ctime(&caltime), module, func, errnotxt, errtxt, errmsg);
+      if (ocode < 0)
+	rcode = ((ocode == PIOUS_EINSUF) ? PIOUS_EINSUF : PIOUS_EUNXP);
 
+      else
+	{ /* write header */
+	  sprintf(header, "%s %lu\n", WARM_NAME, (unsigned long)dblk_sz);
 
-  /* If ERRLOGinfo.path is defined, attempt to open file and write error
-   * message.  If ERRLOGinfo.path is undefined, or if the file can not
-   * be opened for writing, write error message to stderr.
-   */
+	  nbyte  = strlen(header);
+	  offset = 0;
 
-  errlogged = FALSE;
-  errlen    = strlen(msgout);
+	  if (FS_write(ocode, offset, PIOUS_SEEK_SET, nbyte, header) == nbyte)
+	    rcode = PIOUS_OK;
+	  else
+	    rcode = PIOUS_EUNXP;
 
-  if (ERRLOGinfo.path != NULL)
-    { /* open/creat error log; set-up pseudo FIC entry */
-      ERRLOGinfo.amode  = PIOUS_W_OK;
-      ERRLOGinfo.fildes = FILDES_INVALID;
+	  offset += nbyte;
 
-      /* allocate a descriptor for ERRLOGinfo with creation specified */
+	  /* write record for each file; blocks [i, j) belong to file */
 
-      if (fildes_alloc(&ERRLOGinfo, PIOUS_CREAT, ERRLOG_PERM) == PIOUS_OK)
-	{ /* descriptor allocated; attempt write */
-	  if (FS_write(ERRLOGinfo.fildes, (pious_offt)0, PIOUS_SEEK_END,
-		       (pious_sizet)errlen, msgout) == errlen)
-	    errlogged = TRUE;
+	  for (i = 0; i < cnt && rcode == PIOUS_OK; i = j)
+	    { /* determine extent of file blocks and run count */
+	      nrun = 1;
 
-	  /* deallocate descriptor */
-	  fildes_free(&ERRLOGinfo);
-	}
-    }
+	      for (j = i + 1;
+		   j < cnt && fhandle_eq(blk[j].fhandle, blk[i].fhandle);
+		   j++)
+		if (blk[j].db_nmbr != blk[j - 1].db_nmbr + 1)
+		  nrun++;
 
-  /* output msgout to stderr, if necessary */
-  if (!errlogged)
-    {
-      fprintf(stderr, "%s", msgout);
-      fflush(stderr);
-    }
-}
+	      /* locate path name; omit file if not located or if path
+	       * name can not be represented in a line of text
+	       */
+
+	      if (fhandle_locate(blk[i].fhandle, &fic_entry) != PIOUS_OK ||
+		  strchr(fic_entry->path, '\n') != NULL)
+		continue;
+
+	      if ((record = malloc((unsigned)(strlen(fic_entry->path) +
+					      ((nrun + 1) *
+					       (2 * WARM_FIELD_MAX))))) ==
+		  NULL)
+		{ /* can not alloc record space */
+		  rcode = PIOUS_EINSUF;
+		}
 
+	      else
+		{ /* format and write record */
+		  sprintf(record, "%ld %s\n", nrun, fic_entry->path);
+		  nbyte = strlen(record);
+
+		  for (k = i; k < j; k++)
+		    if (k == j - 1 || blk[k + 1].db_nmbr != blk[k].db_nmbr + 1)
+		      { /* end of run; runs begin at 'i' and follow a gap */
+			sprintf(record + nbyte, "%ld %ld\n",
+				(long)blk[i].db_nmbr,
+				(long)(blk[k].db_nmbr - blk[i].db_nmbr + 1));
+
+			nbyte += strlen(record + nbyte);
+			i      = k + 1;
+		      }
 
+		  if (FS_write(ocode, offset, PIOUS_SEEK_SET,
+			       nbyte, record) != nbyte)
+		    rcode = PIOUS_EUNXP;
 
+		  offset += nbyte;
 
-/*
- * Function Definitions - Local Functions
- */
+		  free(record);
+		}
+	    }
+
+	  FS_close(ocode);
+
+	  /* replace manifest with temporary file */
+
+	  if (rcode == PIOUS_OK && FS_rename(tmppath, WARMinfo.path) != PIOUS_OK)
+	    rcode = PIOUS_EUNXP;
+
+	  if (rcode != PIOUS_OK)
+	    FS_unlink(tmppath);
+	}
+    }
+
+  if (tmppath != NULL)
+    free(tmppath);
+
+  return rcode;
+}
 
 
 
 
 /*
- * path2fhandle()
- *
- * Parameters:
- *
- *   path    - file path name
- *   fhandle - file handle
- *
- * Map file 'path' to corresponding file handle and place in 'fhandle'.
- *
- * NOTE: To assign values of type pds_fhandlet, path2fhandle() must violate
- *       the pds_fhandlet type abstraction.  As discussed in
- *       pds/pds_fhandlet.h, pds_sstorage_manager.c is a "friend" of the
- *       pds_fhandlet ADT in the C++ sense.
- *
- * Returns:
- *
- *   PIOUS_OK (0) - successfully mapped path to file handle
- *   < 0          - error code defined in pious_errno.h; possible codes are:
- *
- *       PIOUS_EACCES       - path search permission denied
- *       PIOUS_ENOENT       - file does not exist
- *       PIOUS_ENAMETOOLONG - path or path component name too long
- *       PIOUS_ENOTDIR      - a component of the path prefix not a directory
- *       PIOUS_ENOTREG      - file is not a regular file
- *       PIOUS_EUNXP        - unexpected error encountered
+ * SS_warmload() - See pds_sstorage_manager.h for description
  */
 
 #ifdef __STDC__
-static int path2fhandle(char *path,
-			pds_fhandlet *fhandle)
+long SS_warmload(pious_sizet dblk_sz,
+		 long max,
+		 struct SS_warmblk **blk)
 #else
-static int path2fhandle(path, fhandle)
-     char *path;
-     pds_fhandlet *fhandle;
+long SS_warmload(dblk_sz, max, blk)
+     pious_sizet dblk_sz;
+     long max;
+     struct SS_warmblk **blk;
+#endif
+{
+  long rcode, nrun, db_cnt, k;
+  int ocode, done, valid;
+  pious_offt db_nmbr;
+  pds_fhandlet fhandle;
+  struct FS_stat fstatus;
+  char *manifest, *pos, *end, *path;
+
+  *blk     = NULL;
+  manifest = NULL;
+
+  /* check for previous fatal errors */
+  if (SS_fatalerror)
+    rcode = PIOUS_EFATAL;
+
+  /* open manifest; no manifest is equivalent to an empty manifest */
+  else if (WARMinfo.path == NULL || max <= 0 ||
+	   (ocode = FS_open(WARMinfo.path,
+			    PIOUS_RDONLY, (pious_modet)0)) < 0)
+    rcode = 0;
+
+  else
+    { /* read manifest and allocate data block vector */
+      rcode = 0;
+
+      if (FS_fstat(ocode, &fstatus) != PIOUS_OK ||
+	  !(fstatus.mode & PIOUS_ISREG))
+	{ /* manifest not a regular file; ignore */
+	}
+
+      else if ((manifest =
+		malloc((unsigned)(fstatus.size + 1))) == NULL ||
+	       (*blk = (struct SS_warmblk *)
+		malloc((unsigned)(max * sizeof(struct SS_warmblk)))) == NULL)
+	{ /* can not alloc manifest or vector space */
+	  rcode = PIOUS_EINSUF;
+	}
+
+      else if (FS_read(ocode, (pious_offt)0, PIOUS_SEEK_SET,
+		       (pious_sizet)fstatus.size, manifest) == fstatus.size)
+	{ /* manifest read; parse if data block size matches */
+	  manifest[fstatus.size] = '\0';
+
+	  pos  = manifest + strlen(WARM_NAME);
+	  done = (strncmp(manifest, WARM_NAME, strlen(WARM_NAME)) != 0 ||
+		  strtol(pos, &end, 10) != (long)dblk_sz || *end != '\n');
+
+	  pos = end + 1;
+
+	  while (!done && *pos != '\0' && rcode < max)
+	    { /* parse file record: run count and path name */
+	      nrun = strtol(pos, &end, 10);
+
+	      if (end == pos || *end != ' ' || nrun <= 0 ||
+		  (pos = strchr((path = end + 1), '\n')) == NULL)
+		done = TRUE;
+
+	      else
+		{ /* look up file; blocks of inaccessible files are omitted */
+		  *pos++ = '\0';
+
+		  valid = (SS_lookup(path, &fhandle, PIOUS_NOCREAT,
+				     (pious_modet)0) == PIOUS_OK);
+
+		  /* parse runs: first data block number and block count */
+
+		  for (; nrun > 0 && !done; nrun--)
+		    {
+		      db_nmbr = strtol(pos, &end, 10);
+
+		      if (end == pos || *end != ' ' || db_nmbr < 0)
+			done = TRUE;
+
+		      else
+			{
+			  pos    = end + 1;
+			  db_cnt = strtol(pos, &end, 10);
+
+			  if (end == pos || *end != '\n' || db_cnt <= 0)
+			    done = TRUE;
+
+			  else
+			    { /* record data blocks of run */
+			      pos = end + 1;
+
+			      for (k = 0; valid && k < db_cnt && rcode < max; k++)
+				{
+				  (*blk)[rcode].fhandle = fhandle;
+				  (*blk)[rcode].db_nmbr = db_nmbr + k;
+				  rcode++;
+				}
+			    }
+			}
+		    }
+		}
+	    }
+	}
+
+      FS_close(ocode);
+    }
+
+  /* deallocate manifest and, if empty, data block vector */
+
+  if (manifest != NULL)
+    free(manifest);
+
+  if (rcode <= 0 && *blk != NULL)
+    {
+      free((char *)*blk);
+      *blk = NULL;
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * SS_stats() - See pds_sstorage_manager.h for description
+ */
+
+#ifdef __STDC__
+void SS_stats(struct SS_stats *stats)
+#else
+void SS_stats(stats)
+     struct SS_stats *stats;
+#endif
+{
+  /* activity counters */
+  *stats = ss_stat;
+
+  /* state */
+  stats->fic_sz       = fic_sz;
+  stats->fic_max      = SS_FIC_MAX;
+  stats->fic_nvalid   = fic_nvalid;
+  stats->fildes_max   = fildes_max;
+  stats->fildes_nopen = fildes_nopen;
+}
+
+
+
+
+/*
+ * SS_errlog() - See pds_sstorage_manager.h for description
+ */
+
+#ifdef __STDC__
+void SS_errlog(char *module,
+	       char *func,
+	       int errno,
+	       char *errmsg)
+#else
+void SS_errlog(module, func, errno, errmsg)
+     char *module;
+     char *func;
+     int errno;
+     char *errmsg;
+#endif
+{
+  char *errnotxt, *errtxt, msgout[512];
+  long caltime;
+  int errlen, errlogged;
+
+  /* define complete error message for output */
+
+  if (errno == 0)
+    { /* no error code text required */
+      errnotxt = "";
+      errtxt   = "no error code provided";
+    }
+  else
+    /* generate error code text */
+    UTIL_errno2errtxt(errno, &errnotxt, &errtxt);
+
+  caltime = time(NULL);
+
+  sprintf(msgout, "\n%s\n%.25s/%.20s: %.20s\n\t[%.60s]\n\t%.60s\n",
+	  ctime(&caltime), module, func, errnotxt, errtxt, errmsg);
+
+
+  /* If ERRLOGinfo.path is defined, attempt to open file and write error
+   * message.  If ERRLOGinfo.path is undefined, or if the file can not
+   * be opened for writing, write error message to stderr.
+   */
+
+  errlogged = FALSE;
+  errlen    = strlen(msgout);
+
+  if (ERRLOGinfo.path != NULL)
+    { /* open/creat error log; set-up pseudo FIC entry */
+      ERRLOGinfo.amode  = PIOUS_W_OK;
+      ERRLOGinfo.fildes = FILDES_INVALID;
+
+      /* allocate a descriptor for ERRLOGinfo with creation specified */
+
+      if (fildes_alloc(&ERRLOGinfo, PIOUS_CREAT, ERRLOG_PERM) == PIOUS_OK)
+	{ /* descriptor allocated; attempt write */
+	  if (FS_write(ERRLOGinfo.fildes, (pious_offt)0, PIOUS_SEEK_END,
+		       (pious_sizet)errlen, msgout) == errlen)
+	    errlogged = TRUE;
+
+	  /* deallocate descriptor */
+	  fildes_free(&ERRLOGinfo);
+	}
+    }
+
+  /* output msgout to stderr, if necessary */
+  if (!errlogged)
+    {
+      fprintf(stderr, "%s", msgout);
+      fflush(stderr);
+    }
+}
+
+
+
+
+/*
+ * Function Definitions - Local Functions
+ */
+
+
+
+
+/*
+ * path2fhandle()
+ *
+ * Parameters:
+ *
+ *   path    - file path name
+ *   fhandle - file handle
+ *
+ * Map file 'path' to corresponding file handle and place in 'fhandle'.
+ *
+ * NOTE: To assign values of type pds_fhandlet, path2fhandle() must violate
+ *       the pds_fhandlet type abstraction.  As discussed in
+ *       pds/pds_fhandlet.h, pds_sstorage_manager.c is a "friend" of the
+ *       pds_fhandlet ADT in the C++ sense.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - successfully mapped path to file handle
+ *   < 0          - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EACCES       - path search permission denied
+ *       PIOUS_ENOENT       - file does not exist
+ *       PIOUS_ENAMETOOLONG - path or path component name too long
+ *       PIOUS_ENOTDIR      - a component of the path prefix not a directory
+ *       PIOUS_ENOTREG      - file is not a regular file
+ *       PIOUS_EUNXP        - unexpected error encountered
+ */
+
+#ifdef __STDC__
+static int path2fhandle(char *path,
+			pds_fhandlet *fhandle)
+#else
+static int path2fhandle(path, fhandle)
+     char *path;
+     pds_fhandlet *fhandle;
 #endif
 {
   int rcode, scode;
@@ -1828,14 +2668,17 @@ static fic_entryt *fic_locate(fhandle)
   register fic_entryt *fic_pos;
 
   /* search file information cache for 'fhandle' */
-  fic_pos = fh_table[fhandle_hash(fhandle, FH_TABLE_SZ)];
+  fic_pos = fh_table[fhandle_hash(fhandle, fh_table_sz)];
 
   while (fic_pos != NULL && !fhandle_eq(fic_pos->fhandle, fhandle))
     fic_pos = fic_pos->fhnext;
 
-  /* if 'fhandle' located, move cache entry to MRU position */
+  /* if 'fhandle' located, move cache entry, and descriptor, to MRU position */
   if (fic_pos != NULL)
-    fic_make_mru(fic_pos);
+    {
+      fic_make_mru(fic_pos);
+      fildes_touch(fic_pos);
+    }
 
   return fic_pos;
 }
@@ -1853,8 +2696,9 @@ static fic_entryt *fic_locate(fhandle)
  *   amode     - file accessibility
  *
  * Place file status information into file information cache as the MRU entry;
- * the LRU cache entry is deallocated, if necessary. The new MRU entry is
- * placed at the head of the appropriate file handle hash chain.
+ * the cache is grown if full, and otherwise the LRU cache entry is
+ * deallocated, if necessary. The new MRU entry is placed at the head of the
+ * appropriate file handle hash chain.
  *
  * Note: fic_insert() does NOT check the file information cache to see
  *       if an entry for 'fhandle' already exists.  Duplicates must be
@@ -1876,6 +2720,13 @@ static fic_entryt *fic_insert(fhandle, path, amode)
      int amode;
 #endif
 {
+  /* grow cache rather than replace a valid LRU entry, if permitted */
+  if (fic_lru->valid && fic_sz < SS_FIC_MAX)
+    fic_grow();
+
+  if (fic_lru->valid)
+    ss_stat.fic_replace++;
+
   /* invalidate LRU entry */
   fic_invalidate(fic_lru);
 
@@ -1887,12 +2738,14 @@ static fic_entryt *fic_insert(fhandle, path, amode)
   fic_lru->fildes    = FILDES_INVALID;
   fic_lru->valid     = TRUE;
 
+  fic_nvalid++;
+
   /* put LRU entry at head of appropriate file handle hash chain */
   fic_lru->fhprev = NULL;
 
-  fic_lru->fhnext = fh_table[fhandle_hash(fhandle, FH_TABLE_SZ)];
+  fic_lru->fhnext = fh_table[fhandle_hash(fhandle, fh_table_sz)];
 
-  fh_table[fhandle_hash(fhandle, FH_TABLE_SZ)] = fic_lru;
+  fh_table[fhandle_hash(fhandle, fh_table_sz)] = fic_lru;
 
   if (fic_lru->fhnext != NULL)
     fic_lru->fhnext->fhprev = fic_lru;
@@ -1943,7 +2796,7 @@ static void fic_invalidate(fic_entry)
 	fic_entry->fhprev->fhnext = fic_entry->fhnext;
       else
 	/* first in chain, reset file handle hash table entry */
-	fh_table[fhandle_hash(fic_entry->fhandle, FH_TABLE_SZ)] =
+	fh_table[fhandle_hash(fic_entry->fhandle, fh_table_sz)] =
 	  fic_entry->fhnext;
 
       /* deallocate path name storage */
@@ -1955,6 +2808,8 @@ static void fic_invalidate(fic_entry)
 
       /* mark entry as invalid */
       fic_entry->valid = FALSE;
+
+      fic_nvalid--;
     }
 
   /* make LRU cache entry */
@@ -2069,6 +2924,157 @@ static void fic_make_lru(fic_entry)
 
 
 
+
+/*
+ * fic_grow()
+ *
+ * Parameters:
+ *
+ * Grow the file information cache (FIC), doubling its size to at most
+ * SS_FIC_MAX entries.  New entries are invalid and placed in the LRU
+ * positions; the file handle hash table is resized for the new cache size.
+ * The cache is not altered if storage can not be allocated for new entries,
+ * and the hash table is retained if storage can not be allocated for a
+ * resized table.
+ *
+ * NOTE: global fic_lru and fic_mru are altered; these values
+ *       must be treated as volatile by any routine that calls
+ *       fic_grow().
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void fic_grow(void)
+#else
+static void fic_grow()
+#endif
+{
+  long nentry, tsize, idx, hindex;
+  fic_entryt *fic_new, *fic_pos, **table_new;
+
+  nentry = Min(fic_sz, SS_FIC_MAX - fic_sz);
+
+  fic_new = (fic_entryt *)malloc((unsigned)(nentry * sizeof(fic_entryt)));
+
+  if (fic_new != NULL)
+    { /* link new entries between LRU and MRU entries; last is now LRU */
+      for (idx = 0; idx < nentry; idx++)
+	{
+	  fic_new[idx].valid  = FALSE;
+	  fic_new[idx].path   = NULL;
+	  fic_new[idx].fildes = FILDES_INVALID;
+
+	  fic_new[idx].cprev = ((idx == 0) ? fic_lru : fic_new + (idx - 1));
+	  fic_new[idx].cnext = ((idx == nentry - 1) ?
+				fic_mru : fic_new + (idx + 1));
+	}
+
+      fic_lru->cnext = fic_new;
+      fic_mru->cprev = fic_new + (nentry - 1);
+      fic_lru        = fic_new + (nentry - 1);
+
+      fic_sz += nentry;
+
+      /* resize file handle hash table, rehashing valid entries */
+      tsize = table_size(fic_sz);
+
+      if (tsize > fh_table_sz &&
+	  (table_new = (fic_entryt **)
+	   malloc((unsigned)(tsize * sizeof(fic_entryt *)))) != NULL)
+	{
+	  for (idx = 0; idx < tsize; idx++)
+	    table_new[idx] = NULL;
+
+	  fic_pos = fic_mru;
+
+	  for (idx = 0; idx < fic_sz; idx++)
+	    {
+	      if (fic_pos->valid)
+		{ /* place entry at head of file handle hash chain */
+		  hindex = fhandle_hash(fic_pos->fhandle, tsize);
+
+		  fic_pos->fhprev = NULL;
+		  fic_pos->fhnext = table_new[hindex];
+
+		  if (table_new[hindex] != NULL)
+		    table_new[hindex]->fhprev = fic_pos;
+
+		  table_new[hindex] = fic_pos;
+		}
+
+	      fic_pos = fic_pos->cnext;
+	    }
+
+	  free((char *)fh_table);
+
+	  fh_table    = table_new;
+	  fh_table_sz = tsize;
+	}
+    }
+}
+
+
+
+
+/*
+ * table_size()
+ *
+ * Parameters:
+ *
+ *   nentry - expected number of hash table entries
+ *
+ * Determine a file handle hash table size for 'nentry' entries, for either
+ * the FIC or the FHDB index; the size is the smallest prime, not near a power
+ * of 2, that is greater than or equal to Max(nentry, FH_TABLE_SZ).
+ *
+ * Returns:
+ *
+ *   long - hash table size
+ */
+
+#ifdef __STDC__
+static long table_size(long nentry)
+#else
+static long table_size(nentry)
+     long nentry;
+#endif
+{
+  long tsize, pow2, div;
+  int prime;
+
+  tsize = Max(nentry, FH_TABLE_SZ);
+
+  /* avoid sizes within 1/8 of a power of 2 */
+  for (pow2 = 1; pow2 < tsize; pow2 *= 2);
+
+  if (tsize > pow2 - (pow2 / 8))
+    tsize = pow2 + (pow2 / 8);
+  else if (tsize < (pow2 / 2) + (pow2 / 16))
+    tsize = (pow2 / 2) + (pow2 / 16);
+
+  /* locate next prime; trial division is adequate for an infrequent cost */
+  if (tsize % 2 == 0)
+    tsize++;
+
+  do
+    {
+      prime = TRUE;
+
+      for (div = 3; div * div <= tsize && prime; div += 2)
+	if (tsize % div == 0)
+	  prime = FALSE;
+
+      if (!prime)
+	tsize += 2;
+    }
+  while (!prime);
+
+  return tsize;
+}
+
+
+
 	  
 /*
  * fhandle_db_write()
@@ -2115,6 +3121,7 @@ static int fhandle_db_write(fhandle, path)
 #endif
 {
   pious_ssizet acode;
+  pious_offt offset;
   int rcode, ic_transfer;
   struct fhdb_templatet tmp_rec;
 
@@ -2122,6 +3129,9 @@ static int fhandle_db_write(fhandle, path)
   if (FHDBfull)
     return(PIOUS_EINSUF);
 
+  /* record path name offset for FHDB index */
+  offset = fhdb_size;
+
   /* Set-up record to write */
 
   tmp_rec                  = fhdb_template;
@@ -2195,6 +3205,23 @@ static int fhandle_db_write(fhandle, path)
 	  }
     }
 
+  /* update FHDB size and index; compact FHDB if superseded records dominate */
+
+  if (rcode == PIOUS_OK)
+    {
+      fhdb_size += tmp_rec.f[F_PATHLEN] + sizeof(fhdb_recordt);
+      FHDBunsync = TRUE;
+
+      if (fhdb_table != NULL &&
+	  fhdb_index_update(fhandle, offset, tmp_rec.f[F_PATHLEN]) != PIOUS_OK)
+	/* can not extend index; revert to scanning FHDB */
+	fhdb_index_free();
+
+      if (fhdb_table != NULL &&
+	  fhdb_size >= fhdb_compact_sz && fhdb_live <= fhdb_size / 2)
+	fhdb_compact();
+    }
+
   if (rcode == PIOUS_EFATAL)
     SS_fatalerror = TRUE;
   else if (rcode == PIOUS_EINSUF)
@@ -2216,7 +3243,9 @@ static int fhandle_db_write(fhandle, path)
  *
  * Locates MOST RECENTLY written file handle database record mapping
  * 'fhandle' to a pathname. If a valid mapping is found, storage is
- * allocated and 'path' is set to point to that pathname.
+ * allocated and 'path' is set to point to that pathname.  The record is
+ * located via the FHDB index if extant, and otherwise by reading the FHDB
+ * backwards.
  *
  * NOTE:  Tolerates AT MOST corruption of last file handle data base record;
  *        further corruption may generate an error condition.
@@ -2261,12 +3290,49 @@ static int fhandle_db_read(fhandle, path)
   int rcode, done, found;
 
   struct FS_stat fhdb_status;
+  fhdb_ixentryt *ix_entry;
+
+  if (fhdb_table != NULL)
+    { /* locate most recent record for 'fhandle' via FHDB index */
+      ix_entry = fhdb_index_locate(fhandle);
+
+      if (ix_entry == NULL || ix_entry->pathlen == 0)
+	/* no FHDB record or FHDB record indicates "unmapping" */
+	rcode = PIOUS_EBADF;
 
-  /* determine size of file handle data base; used to detect db corruption
-   * beyond the expected potentially corrupt last record.
+      else if ((tmp_path = malloc((unsigned)ix_entry->pathlen + 1)) == NULL)
+	/* unable to allocate storage */
+	rcode = PIOUS_EINSUF;
+
+      else
+	{ /* read pathname from FHDB */
+	  *(tmp_path + ix_entry->pathlen) = '\0';
+
+	  acode = FS_read(FHDBinfo.fildes, ix_entry->offset, PIOUS_SEEK_SET,
+			  (pious_sizet)ix_entry->pathlen,
+			  tmp_path);
+
+	  if (acode != ix_entry->pathlen)
+	    { /* error reading path name; FHDB corrupted */
+	      SS_errlog("pds_sstorage_manager", "fhandle_db_read()", 0,
+			"detected file handle db (FHDB) corruption");
+
+	      rcode = PIOUS_EFATAL;
+	      free(tmp_path);
+	    }
+	  else
+	    { /* pathname successfully read */
+	      *path = tmp_path;
+	      rcode = PIOUS_OK;
+	    }
+	}
+    }
+
+  /* no FHDB index; determine size of file handle data base, used to detect
+   * db corruption beyond the expected potentially corrupt last record.
    */
 
-  if ((acode = FS_fstat(FHDBinfo.fildes, &fhdb_status)) != PIOUS_OK)
+  else if ((acode = FS_fstat(FHDBinfo.fildes, &fhdb_status)) != PIOUS_OK)
     { /* error accessing FHDB */
       SS_errlog("pds_sstorage_manager", "fhandle_db_read()", (int)acode,
 		"unable to status file handle database (FHDB)");
@@ -2411,6 +3477,604 @@ static int fhandle_db_read(fhandle, path)
 
 
 
+/*
+ * fhdb_index_build()
+ *
+ * Parameters:
+ *
+ *   size - FHDB size in bytes
+ *
+ * Construct FHDB index from an FHDB of 'size' bytes, discarding any existing
+ * index.  The FHDB is read backwards once, in FHDB_BUF_SZ byte blocks, such
+ * that the first record located for a file handle is the most recent.
+ *
+ * Note: as with fhandle_db_read(), tolerates corruption of the last FHDB
+ *       record only.  If the FHDB is otherwise corrupt, or storage for the
+ *       index can not be allocated, then no index is constructed and
+ *       fhandle_db_read() reverts to scanning the FHDB.
+ *
+ *       To read values of type pds_fhandlet, fhdb_index_build() must
+ *       violate the pds_fhandlet type abstraction.  As discussed in
+ *       pds/pds_fhandlet.h, pds_sstorage_manager.c is a "friend" of the
+ *       pds_fhandlet ADT in the C++ sense.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void fhdb_index_build(pious_offt size)
+#else
+static void fhdb_index_build(size)
+     pious_offt size;
+#endif
+{
+  int rcode, found;
+  long idx;
+  char *buf, *rec;
+  pious_offt bstart, bend, end, offset;
+  struct fhdb_templatet tmp_rec;
+  pds_fhandlet tmp_fhandle;
+
+  /* discard existing index and allocate hash table, sized for FHDB */
+
+  fhdb_index_free();
+
+  fhdb_size       = size;
+  fhdb_live       = 0;
+  fhdb_compact_sz = Max(FHDB_COMPACT_MIN, 2 * size);
+
+  fhdb_table_sz = table_size((long)(size / (2 * sizeof(fhdb_recordt))));
+
+  fhdb_table = (fhdb_ixentryt **)malloc((unsigned)
+					(fhdb_table_sz *
+					 sizeof(fhdb_ixentryt *)));
+
+  if (fhdb_table != NULL)
+    { /* table allocated; initialize */
+      for (idx = 0; idx < fhdb_table_sz; idx++)
+	fhdb_table[idx] = NULL;
+
+      rcode = PIOUS_OK;
+    }
+  else
+    rcode = PIOUS_EINSUF;
+
+  if (rcode == PIOUS_OK && size > 0)
+    { /* index FHDB records */
+      if ((buf = malloc((unsigned)FHDB_BUF_SZ)) == NULL)
+	rcode = PIOUS_EINSUF;
+
+      else
+	{ /* search BACKWARDS for first complete record, as signified by a
+	   * complete EOR marker
+	   */
+	  bstart = bend = 0;
+	  found  = FALSE;
+
+	  for (end = size; !found && end >= sizeof(fhdb_recordt); end--)
+	    {
+	      if ((rec = fhdb_fetch(buf, &bstart, &bend,
+				    end - sizeof(fhdb_recordt))) == NULL)
+		break;
+
+	      memcpy((char *)tmp_rec.f, rec, sizeof(fhdb_recordt));
+
+	      if (!((tmp_rec.f[F_EORMARKER_0] ^
+		     fhdb_template.f[F_EORMARKER_0]) ||
+		    (tmp_rec.f[F_EORMARKER_1] ^
+		     fhdb_template.f[F_EORMARKER_1]) ||
+		    (tmp_rec.f[F_EORMARKER_2] ^
+		     fhdb_template.f[F_EORMARKER_2])))
+		found = TRUE;
+	    }
+
+	  if (!found)
+	    /* unable to locate a complete record */
+	    rcode = PIOUS_EFATAL;
+	  else
+	    /* loop decremented 'end' past last complete record */
+	    end++;
+
+	  /* index records from last complete record to beginning of FHDB;
+	   * 'tmp_rec' contains record ending at 'end'
+	   */
+
+	  while (rcode == PIOUS_OK && end > 0)
+	    {
+	      if (end < sizeof(fhdb_recordt) ||
+		  (rec = fhdb_fetch(buf, &bstart, &bend,
+				    end - sizeof(fhdb_recordt))) == NULL)
+		/* FHDB corrupted */
+		rcode = PIOUS_EFATAL;
+
+	      else
+		{
+		  memcpy((char *)tmp_rec.f, rec, sizeof(fhdb_recordt));
+
+		  if (tmp_rec.f[F_PATHLEN] > end - sizeof(fhdb_recordt))
+		    /* FHDB corrupted */
+		    rcode = PIOUS_EFATAL;
+
+		  else
+		    { /* index record if first (most recent) for file handle */
+		      offset = (end - sizeof(fhdb_recordt) -
+				tmp_rec.f[F_PATHLEN]);
+
+		      tmp_fhandle.dev = tmp_rec.f[F_FHANDLE_DEV];
+		      tmp_fhandle.ino = tmp_rec.f[F_FHANDLE_INO];
+
+		      if (fhdb_index_locate(tmp_fhandle) == NULL)
+			rcode = fhdb_index_update(tmp_fhandle, offset,
+						  tmp_rec.f[F_PATHLEN]);
+
+		      end = offset;
+		    }
+		}
+	    }
+
+	  free(buf);
+	}
+    }
+
+  if (rcode != PIOUS_OK)
+    { /* unable to construct index */
+      if (rcode == PIOUS_EFATAL)
+	SS_errlog("pds_sstorage_manager", "fhdb_index_build()", 0,
+		  "detected file handle db (FHDB) corruption; not indexed");
+
+      fhdb_index_free();
+    }
+}
+
+
+
+
+/*
+ * fhdb_index_locate()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *
+ * Locate FHDB index entry for 'fhandle'.
+ *
+ * Returns:
+ *
+ *   fhdb_ixentryt * - FHDB index entry for 'fhandle'
+ *   NULL            - 'fhandle' not indexed
+ */
+
+#ifdef __STDC__
+static fhdb_ixentryt *fhdb_index_locate(pds_fhandlet fhandle)
+#else
+static fhdb_ixentryt *fhdb_index_locate(fhandle)
+     pds_fhandlet fhandle;
+#endif
+{
+  register fhdb_ixentryt *ix_entry;
+
+  ix_entry = fhdb_table[fhandle_hash(fhandle, fhdb_table_sz)];
+
+  while (ix_entry != NULL && !fhandle_eq(ix_entry->fhandle, fhandle))
+    ix_entry = ix_entry->hnext;
+
+  return ix_entry;
+}
+
+
+
+
+/*
+ * fhdb_index_update()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   offset  - FHDB offset of record path name
+ *   pathlen - record path name length; 0 (zero) if "unmapping"
+ *
+ * Record in the FHDB index that the most recent FHDB record for 'fhandle'
+ * is located at 'offset', adding an index entry as required.  The hash
+ * table is enlarged as entries are added, if storage permits.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - successfully updated FHDB index
+ *   < 0          - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINSUF - insufficient system resources; unable to allocate
+ *                      storage for index entry
+ */
+
+#ifdef __STDC__
+static int fhdb_index_update(pds_fhandlet fhandle,
+			     pious_offt offset,
+			     unsigned long pathlen)
+#else
+static int fhdb_index_update(fhandle, offset, pathlen)
+     pds_fhandlet fhandle;
+     pious_offt offset;
+     unsigned long pathlen;
+#endif
+{
+  int rcode;
+  long tsize, idx, hindex;
+  fhdb_ixentryt *ix_entry, *ix_pos, *ix_next, **table_new;
+  fhdb_ixblkt *ix_blk;
+
+  rcode = PIOUS_OK;
+
+  if ((ix_entry = fhdb_index_locate(fhandle)) != NULL)
+    { /* entry extant; prior record superseded */
+      if (ix_entry->pathlen != 0)
+	fhdb_live -= ix_entry->pathlen + sizeof(fhdb_recordt);
+    }
+
+  else
+    { /* allocate entry, and entry block if required */
+      if (fhdb_blk == NULL || fhdb_blk_nused == FHDB_IX_BLK)
+	{
+	  if ((ix_blk = (fhdb_ixblkt *)malloc((unsigned)
+					      sizeof(fhdb_ixblkt))) == NULL)
+	    rcode = PIOUS_EINSUF;
+
+	  else
+	    {
+	      ix_blk->next   = fhdb_blk;
+	      fhdb_blk       = ix_blk;
+	      fhdb_blk_nused = 0;
+	    }
+	}
+
+      if (rcode == PIOUS_OK)
+	{ /* place entry at head of hash chain */
+	  ix_entry          = fhdb_blk->entry + fhdb_blk_nused++;
+	  ix_entry->fhandle = fhandle;
+
+	  hindex = fhandle_hash(fhandle, fhdb_table_sz);
+
+	  ix_entry->hnext    = fhdb_table[hindex];
+	  fhdb_table[hindex] = ix_entry;
+
+	  fhdb_nentry++;
+
+	  /* resize hash table, rehashing entries, if entries exceed size */
+	  if (fhdb_nentry > fhdb_table_sz)
+	    {
+	      tsize = table_size(2 * fhdb_nentry);
+
+	      if ((table_new = (fhdb_ixentryt **)
+		   malloc((unsigned)(tsize * sizeof(fhdb_ixentryt *)))) !=
+		  NULL)
+		{
+		  for (idx = 0; idx < tsize; idx++)
+		    table_new[idx] = NULL;
+
+		  for (idx = 0; idx < fhdb_table_sz; idx++)
+		    for (ix_pos = fhdb_table[idx]; ix_pos != NULL;
+			 ix_pos = ix_next)
+		      {
+			ix_next = ix_pos->hnext;
+			hindex  = fhandle_hash(ix_pos->fhandle, tsize);
+
+			ix_pos->hnext     = table_new[hindex];
+			table_new[hindex] = ix_pos;
+		      }
+
+		  free((char *)fhdb_table);
+
+		  fhdb_table    = table_new;
+		  fhdb_table_sz = tsize;
+		}
+	    }
+	}
+    }
+
+  if (rcode == PIOUS_OK)
+    { /* record location of most recent record */
+      ix_entry->offset  = offset;
+      ix_entry->pathlen = pathlen;
+
+      if (pathlen != 0)
+	fhdb_live += pathlen + sizeof(fhdb_recordt);
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * fhdb_index_free()
+ *
+ * Parameters:
+ *
+ * Deallocate FHDB index storage; fhandle_db_read() reverts to scanning the
+ * FHDB.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void fhdb_index_free(void)
+#else
+static void fhdb_index_free()
+#endif
+{
+  fhdb_ixblkt *ix_blk;
+
+  if (fhdb_table != NULL)
+    free((char *)fhdb_table);
+
+  while (fhdb_blk != NULL)
+    {
+      ix_blk   = fhdb_blk;
+      fhdb_blk = fhdb_blk->next;
+
+      free((char *)ix_blk);
+    }
+
+  fhdb_table     = NULL;
+  fhdb_table_sz  = 0;
+  fhdb_nentry    = 0;
+  fhdb_blk_nused = 0;
+}
+
+
+
+
+/*
+ * fhdb_fetch()
+ *
+ * Parameters:
+ *
+ *   buf    - FHDB buffer of FHDB_BUF_SZ bytes
+ *   bstart - FHDB offset of first byte in buffer
+ *   bend   - FHDB offset of byte following last byte in buffer
+ *   offset - FHDB offset of record fixed length fields
+ *
+ * Locate the fixed length fields of the FHDB record at 'offset' in 'buf',
+ * first reading into 'buf' the FHDB_BUF_SZ bytes (or fewer, if at the
+ * beginning of the FHDB) ending with the record fields if not present.
+ * 'bstart' and 'bend' are updated to reflect the buffer contents.
+ *
+ * Note: reading the buffer so that it ends with the fields requested
+ *       allows the FHDB to be read backwards efficiently.
+ *
+ * Returns:
+ *
+ *   char * - location of record fixed length fields in 'buf'
+ *   NULL   - unable to read record fixed length fields
+ */
+
+#ifdef __STDC__
+static char *fhdb_fetch(char *buf,
+			pious_offt *bstart,
+			pious_offt *bend,
+			pious_offt offset)
+#else
+static char *fhdb_fetch(buf, bstart, bend, offset)
+     char *buf;
+     pious_offt *bstart;
+     pious_offt *bend;
+     pious_offt offset;
+#endif
+{
+  char *rec;
+  pious_sizet nbyte;
+
+  rec = NULL;
+
+  if (offset >= *bstart && offset + sizeof(fhdb_recordt) <= *bend)
+    /* record fields in buffer */
+    rec = buf + (offset - *bstart);
+
+  else
+    { /* read buffer ending with record fields */
+      *bend   = offset + sizeof(fhdb_recordt);
+      *bstart = Max(*bend - FHDB_BUF_SZ, 0);
+
+      nbyte = *bend - *bstart;
+
+      if (FS_read(FHDBinfo.fildes, *bstart, PIOUS_SEEK_SET, nbyte, buf) ==
+	  nbyte)
+	rec = buf + (offset - *bstart);
+      else
+	*bstart = *bend = 0;
+    }
+
+  return rec;
+}
+
+
+
+
+/*
+ * fhdb_compact()
+ *
+ * Parameters:
+ *
+ * Compact the FHDB such that it contains only the most recent mapping for
+ * each file handle; superseded records and "unmapping" records are omitted.
+ * The compacted FHDB is written to a temporary file, in the same record
+ * format, which then replaces the FHDB; the FHDB index is updated to
+ * locate records in the compacted FHDB.
+ *
+ * If the FHDB can not be compacted, it is left unaltered.  In either case
+ * compaction is not again considered until the FHDB has doubled in size.
+ *
+ * Note: To write values of type pds_fhandlet, fhdb_compact() must
+ *       violate the pds_fhandlet type abstraction.  As discussed in
+ *       pds/pds_fhandlet.h, pds_sstorage_manager.c is a "friend" of the
+ *       pds_fhandlet ADT in the C++ sense.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void fhdb_compact(void)
+#else
+static void fhdb_compact()
+#endif
+{
+  int rcode, ocode, direct;
+  long idx;
+  pious_offt offset;
+  pious_sizet nbuf, reclen;
+  char *tmppath, *buf, *rbuf;
+  fhdb_ixentryt *ix_pos;
+  struct fhdb_templatet tmp_rec;
+
+  buf = NULL;
+
+  /* allocate temporary file name space and write buffer */
+  if ((tmppath = malloc((unsigned)(strlen(FHDBinfo.path) + 5))) == NULL ||
+      (buf = malloc((unsigned)FHDB_BUF_SZ)) == NULL)
+    rcode = PIOUS_EINSUF;
+
+  else
+    { /* write most recent mappings to temporary file */
+      sprintf(tmppath, "%s.tmp", FHDBinfo.path);
+
+      ocode = FS_open(tmppath,
+		      PIOUS_RDWR | PIOUS_CREAT | PIOUS_TRUNC, FHDB_PERM);
+
+      if (ocode < 0)
+	rcode = ((ocode == PIOUS_EINSUF) ? PIOUS_EINSUF : PIOUS_EUNXP);
+
+      else
+	{ /* write records in hash table order, buffering records */
+	  rcode  = PIOUS_OK;
+	  nbuf   = 0;
+	  offset = 0;
+
+	  for (idx = 0; idx < fhdb_table_sz && rcode == PIOUS_OK; idx++)
+	    for (ix_pos = fhdb_table[idx];
+		 ix_pos != NULL && rcode == PIOUS_OK;
+		 ix_pos = ix_pos->hnext)
+	      if (ix_pos->pathlen != 0)
+		{
+		  reclen = ix_pos->pathlen + sizeof(fhdb_recordt);
+
+		  /* flush buffer if record does not fit */
+		  if (nbuf > 0 && nbuf + reclen > FHDB_BUF_SZ)
+		    {
+		      if (FS_write(ocode, offset, PIOUS_SEEK_SET,
+				   nbuf, buf) != nbuf)
+			rcode = PIOUS_EUNXP;
+
+		      offset += nbuf;
+		      nbuf    = 0;
+		    }
+
+		  /* a record larger than the buffer is written directly */
+		  direct = (reclen > FHDB_BUF_SZ);
+
+		  if (rcode != PIOUS_OK)
+		    rbuf = NULL;
+		  else if (!direct)
+		    rbuf = buf + nbuf;
+		  else if ((rbuf = malloc((unsigned)reclen)) == NULL)
+		    rcode = PIOUS_EINSUF;
+
+		  if (rbuf != NULL)
+		    { /* copy path name and set-up record fields */
+		      if (FS_read(FHDBinfo.fildes, ix_pos->offset,
+				  PIOUS_SEEK_SET,
+				  (pious_sizet)ix_pos->pathlen,
+				  rbuf) != ix_pos->pathlen)
+			rcode = PIOUS_EUNXP;
+
+		      else
+			{
+			  tmp_rec                  = fhdb_template;
+
+			  tmp_rec.f[F_PATHLEN]     = ix_pos->pathlen;
+			  tmp_rec.f[F_FHANDLE_DEV] = ix_pos->fhandle.dev;
+			  tmp_rec.f[F_FHANDLE_INO] = ix_pos->fhandle.ino;
+
+			  memcpy(rbuf + ix_pos->pathlen, (char *)tmp_rec.f,
+				 sizeof(fhdb_recordt));
+
+			  if (!direct)
+			    nbuf += reclen;
+
+			  else
+			    {
+			      if (FS_write(ocode, offset, PIOUS_SEEK_SET,
+					   reclen, rbuf) != reclen)
+				rcode = PIOUS_EUNXP;
+
+			      offset += reclen;
+			    }
+			}
+
+		      if (direct)
+			free(rbuf);
+		    }
+		}
+
+	  /* flush buffer and force writes to disk prior to replacing FHDB */
+
+	  if (rcode == PIOUS_OK && nbuf > 0)
+	    {
+	      if (FS_write(ocode, offset, PIOUS_SEEK_SET, nbuf, buf) != nbuf)
+		rcode = PIOUS_EUNXP;
+
+	      offset += nbuf;
+	    }
+
+	  if (rcode == PIOUS_OK && FS_fsync(ocode) != PIOUS_OK)
+	    rcode = PIOUS_EUNXP;
+
+	  /* replace FHDB; descriptor for temporary file remains valid */
+
+	  if (rcode == PIOUS_OK &&
+	      FS_rename(tmppath, FHDBinfo.path) != PIOUS_OK)
+	    rcode = PIOUS_EUNXP;
+
+	  if (rcode == PIOUS_OK)
+	    { /* FHDB compacted; update index to locate records */
+	      FS_close(FHDBinfo.fildes);
+	      FHDBinfo.fildes = ocode;
+
+	      fhdb_size = fhdb_live = offset;
+	      offset    = 0;
+
+	      for (idx = 0; idx < fhdb_table_sz; idx++)
+		for (ix_pos = fhdb_table[idx];
+		     ix_pos != NULL;
+		     ix_pos = ix_pos->hnext)
+		  if (ix_pos->pathlen != 0)
+		    {
+		      ix_pos->offset = offset;
+		      offset += ix_pos->pathlen + sizeof(fhdb_recordt);
+		    }
+	    }
+
+	  else
+	    { /* unable to compact FHDB; discard temporary file */
+	      FS_close(ocode);
+	      FS_unlink(tmppath);
+	    }
+	}
+    }
+
+  /* deallocate storage */
+  if (tmppath != NULL)
+    free(tmppath);
+
+  if (buf != NULL)
+    free(buf);
+
+  /* consider compaction again when FHDB has doubled in size */
+  fhdb_compact_sz = Max(FHDB_COMPACT_MIN, 2 * fhdb_size);
+}
+
+
+
+
 /*
  * fildes_alloc()
  *
@@ -2421,6 +4085,8 @@ static int fhandle_db_read(fhandle, path)
  *   mode      - file creation access control (permission) bits
  *
  * Allocates file descriptor to specified file information cache (FIC) entry.
+ * If the descriptor pool is exhausted, or the host refuses to open another
+ * file, the least recently used descriptor is first reclaimed.
  *
  * 'cflag' is the inclusive OR of:
  *    exactly one of: PIOUS_NOCREAT, PIOUS_CREAT and
@@ -2478,7 +4144,7 @@ static int fildes_alloc(fic_entry, cflag, mode)
 #endif
 {
   int rcode, ocode, oflag;
-  int done, fd_idx;
+  int done;
 
   /* validate 'cflag' argument */
 
@@ -2501,7 +4167,13 @@ static int fildes_alloc(fic_entry, cflag, mode)
       oflag |= cflag;
 
       done    = FALSE;
-      fd_idx  = 0;
+
+      /* reclaim LRU descriptor if descriptor pool exhausted */
+      if (fildes_nopen >= fildes_max && fd_lru != NULL)
+	{
+	  fildes_free(fd_lru);
+	  ss_stat.fildes_close++;
+	}
 
       while (!done)
 	{
@@ -2514,19 +4186,36 @@ static int fildes_alloc(fic_entry, cflag, mode)
 	      fic_entry->fildes   = ocode;
 	      fildes_table[ocode] = fic_entry;
 
+	      /* place entry at head of descriptor list */
+	      fic_entry->fdprev = NULL;
+	      fic_entry->fdnext = fd_mru;
+
+	      if (fd_mru != NULL)
+		fd_mru->fdprev = fic_entry;
+	      else
+		fd_lru = fic_entry;
+
+	      fd_mru = fic_entry;
+
+	      fildes_nopen++;
+	      ss_stat.fildes_open++;
+
+	      /* enable direct I/O if configured and supported by the host */
+	      fic_entry->direct = (ss_direct &&
+				   FS_direct(ocode, TRUE) == PIOUS_OK);
+
 	      done  = TRUE;
 	      rcode = PIOUS_OK;
 	    }
 
 	  /* case: too many file descriptors open */
 	  else if (ocode == PIOUS_EINSUF)
-	    { /* search fildes table for descriptor to deallocate */
-	      while (fd_idx < fildes_total && fildes_table[fd_idx] == NULL)
-		fd_idx++;
-
-	      if (fd_idx < fildes_total)
-		/* deallocate descriptor and try to open again */
-		fildes_free(fildes_table[fd_idx]);
+	    { /* reclaim LRU descriptor, if any */
+	      if (fd_lru != NULL)
+		{ /* deallocate descriptor and try to open again */
+		  fildes_free(fd_lru);
+		  ss_stat.fildes_close++;
+		}
 	      else
 		{ /* none to deallocate */
 		  done  = TRUE;
@@ -2594,7 +4283,140 @@ static void fildes_free(fic_entry)
       /* reset corresponding file descriptor table entry */
       fildes_table[fic_entry->fildes] = NULL;
 
+      /* remove from descriptor list */
+      if (fic_entry->fdprev != NULL)
+	fic_entry->fdprev->fdnext = fic_entry->fdnext;
+      else
+	fd_mru = fic_entry->fdnext;
+
+      if (fic_entry->fdnext != NULL)
+	fic_entry->fdnext->fdprev = fic_entry->fdprev;
+      else
+	fd_lru = fic_entry->fdprev;
+
+      fildes_nopen--;
+
       /* indicate that file descriptor is now invalid */
       fic_entry->fildes = FILDES_INVALID;
     }
 }
+
+
+
+
+/*
+ * fildes_touch()
+ *
+ * Parameters:
+ *
+ *   fic_entry - file information cache entry
+ *
+ * Make the file descriptor associated with the specified file information
+ * cache (FIC) entry, if any, the MRU descriptor; the LRU descriptor is the
+ * first reclaimed when the descriptor pool is exhausted.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void fildes_touch(fic_entryt *fic_entry)
+#else
+static void fildes_touch(fic_entry)
+     fic_entryt *fic_entry;
+#endif
+{
+  if (fic_entry->fildes != FILDES_INVALID && fic_entry != fd_mru)
+    { /* remove from descriptor list; not MRU so has predecessor */
+      fic_entry->fdprev->fdnext = fic_entry->fdnext;
+
+      if (fic_entry->fdnext != NULL)
+	fic_entry->fdnext->fdprev = fic_entry->fdprev;
+      else
+	fd_lru = fic_entry->fdprev;
+
+      /* place at head of descriptor list */
+      fic_entry->fdprev = NULL;
+      fic_entry->fdnext = fd_mru;
+      fd_mru->fdprev    = fic_entry;
+      fd_mru            = fic_entry;
+    }
+}
+
+
+
+
+/*
+ * direct_aligned()
+ *
+ * Parameters:
+ *
+ *   offset  - starting offset
+ *   nbyte   - byte count
+ *   buf     - buffer
+ *
+ * Determine if a transfer of 'nbyte' bytes at file 'offset' to/from buffer
+ * 'buf' meets the alignment required for direct I/O.
+ *
+ * Returns:
+ *
+ *   TRUE  - transfer is aligned for direct I/O
+ *   FALSE - transfer is not aligned for direct I/O
+ */
+
+#ifdef __STDC__
+static int direct_aligned(pious_offt offset,
+			  pious_sizet nbyte,
+			  char *buf)
+#else
+static int direct_aligned(offset, nbyte, buf)
+     pious_offt offset;
+     pious_sizet nbyte;
+     char *buf;
+#endif
+{
+  return (offset % FS_DIRECT_ALIGN == 0 &&
+	  nbyte % FS_DIRECT_ALIGN == 0 &&
+	  (unsigned long)buf % FS_DIRECT_ALIGN == 0);
+}
+
+
+
+
+/*
+ * direct_alignedv()
+ *
+ * Parameters:
+ *
+ *   offset  - starting offset
+ *   iov     - I/O vector
+ *   iovcnt  - I/O vector element count
+ *
+ * Determine if a transfer of the 'iovcnt' buffers of I/O vector 'iov'
+ * at file 'offset' meets the alignment required for direct I/O.
+ *
+ * Returns:
+ *
+ *   TRUE  - transfer is aligned for direct I/O
+ *   FALSE - transfer is not aligned for direct I/O
+ */
+
+#ifdef __STDC__
+static int direct_alignedv(pious_offt offset,
+			   struct FS_iovec *iov,
+			   int iovcnt)
+#else
+static int direct_alignedv(offset, iov, iovcnt)
+     pious_offt offset;
+     struct FS_iovec *iov;
+     int iovcnt;
+#endif
+{
+  register int i, aligned;
+
+  aligned = (offset % FS_DIRECT_ALIGN == 0);
+
+  for (i = 0; i < iovcnt && aligned; i++)
+    aligned = direct_aligned((pious_offt)0, iov[i].len, iov[i].base);
+
+  return aligned;
+}
@@ -34,11 +34,15 @@
  * Function Summary:
  *
  *   SS_init();
+ *   SS_direct();
  *
  *   SS_lookup();
  *   SS_read();
+ *   SS_readv();
  *   SS_write();
+ *   SS_writev();
  *   SS_faccess();
+ *   SS_fsize();
  *   SS_stat();
  *   SS_rename();    [not implemented]
  *   SS_chmod();
@@ -52,6 +56,11 @@
  *   SS_logsync();
  *   SS_logtrunc();
  *
+ *   SS_warmsave();
+ *   SS_warmload();
+ *
+ *   SS_stats();
+ *
  *   SS_errlog();
  *
  */
@@ -97,6 +106,36 @@ int SS_init();
 
 
 
+/*
+ * SS_direct()
+ *
+ * Parameters:
+ *
+ *   on - direct I/O flag
+ *
+ * Enable ('on' TRUE) or disable ('on' FALSE) direct I/O for regular file
+ * data, such that data transferred by SS_read(), SS_readv(), SS_write(),
+ * and SS_writev() bypasses the host file system cache.  Direct I/O is
+ * disabled by default, and the setting applies to files subsequently opened
+ * for access; the log files are not affected.
+ *
+ * Only transfers with offset, byte count(s), and buffer address(es) aligned
+ * to FS_DIRECT_ALIGN (see pfs/pfs.h) are performed via direct I/O; all
+ * others, and all transfers for files on a file system that does not
+ * support direct I/O, are performed via the host file system cache.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+void SS_direct(int on);
+#else
+void SS_direct();
+#endif
+
+
+
+
 /*
  * SS_lookup()
  *
@@ -198,6 +237,52 @@ pious_ssizet SS_read();
 
 
 
+/*
+ * SS_readv()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   offset  - starting offset
+ *   iov     - I/O vector
+ *   iovcnt  - I/O vector element count
+ *
+ * Read file 'fhandle' starting at 'offset' bytes from the beginning
+ * and proceeding for the total byte count specified by the I/O vector 'iov';
+ * place results in the 'iovcnt' buffers of 'iov', in order.  The I/O vector
+ * type is defined in pfs/pfs.h.
+ *
+ * SS_readv() is semantically equivalent to a single SS_read() of the
+ * concatenated buffers.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes read and placed in buffers
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - read is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - file offset or byte count is not a proper value
+ *                      or exceeds SYSTEM constraints
+ *       PIOUS_EINSUF - insufficient system resources to perform operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+struct FS_iovec;           /* see pfs/pfs.h */
+
+#ifdef __STDC__
+pious_ssizet SS_readv(pds_fhandlet fhandle,
+		      pious_offt offset,
+		      struct FS_iovec *iov,
+		      int iovcnt);
+#else
+pious_ssizet SS_readv();
+#endif
+
+
+
+
 /*
  * SS_write()
  *
@@ -245,6 +330,54 @@ pious_ssizet SS_write();
 
 
 
+/*
+ * SS_writev()
+ *
+ * Parameters:
+ *
+ *   fhandle   - file handle
+ *   offset    - starting offset
+ *   iov       - I/O vector
+ *   iovcnt    - I/O vector element count
+ *   faultmode - PIOUS_VOLATILE or PIOUS_STABLE
+ *
+ * Write file 'fhandle' starting at 'offset' bytes from the beginning
+ * the data in the 'iovcnt' buffers of I/O vector 'iov', in order.  The I/O
+ * vector type is defined in pfs/pfs.h.
+ *
+ * SS_writev() is semantically equivalent to a single SS_write() of the
+ * concatenated buffers; in particular, a PIOUS_STABLE update forces data
+ * to disk once for the entire I/O vector.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes written
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EACCES - write is invalid access mode for 'fhandle'
+ *       PIOUS_EINVAL - file offset or byte count is not a proper value
+ *                      or exceeds SYSTEM constraints, or 'faultmode' not valid
+ *       PIOUS_EFBIG  - write would cause file size to exceed SYSTEM constraint
+ *       PIOUS_ENOSPC - no free space remains on device
+ *       PIOUS_EINSUF - insufficient system resources to perform operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+pious_ssizet SS_writev(pds_fhandlet fhandle,
+		       pious_offt offset,
+		       struct FS_iovec *iov,
+		       int iovcnt,
+		       int faultmode);
+#else
+pious_ssizet SS_writev();
+#endif
+
+
+
+
 /*
  * SS_faccess()
  *
@@ -278,6 +411,37 @@ int SS_faccess();
 
 
 
+/*
+ * SS_fsize()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   fsize   - file size in bytes
+ *
+ * Determine the size of file 'fhandle' and place in 'fsize'.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - 'fsize' is file size
+ *   < 0          - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - invalid/stale 'fhandle' argument
+ *       PIOUS_EINSUF - insufficient system resources to perform operation
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+int SS_fsize(pds_fhandlet fhandle,
+	     pious_offt *fsize);
+#else
+int SS_fsize();
+#endif
+
+
+
+
 /*
  * SS_stat()
  *
@@ -566,7 +730,8 @@ pious_ssizet SS_logwrite();
  * Parameters:
  *
  * Force the result of all update operations generated by SS_logwrite() to
- * stable storage (disk).
+ * stable storage (disk), along with file handle mappings recorded by
+ * SS_lookup() such that file handles in the log remain valid for recovery.
  *
  * Returns:
  *
@@ -592,7 +757,8 @@ int SS_logsync();
  * Parameters:
  *
  * Truncates transaction log file; for use in performing check-pointing
- * and recovery.
+ * and recovery.  If recovery is required (SS_recover), i.e. on completing
+ * recovery, file handle mappings are discarded as well.
  *
  * NOTE: Prior to calling SS_logtrunc(), must insure that cached data from
  *       ALL files is flushed AND invalidated; invalidation is required
@@ -616,6 +782,130 @@ int SS_logtrunc();
 
 
 
+/*
+ * SS_warmsave()
+ *
+ * Parameters:
+ *
+ *   blk     - data block vector
+ *   cnt     - data block vector element count
+ *   dblk_sz - data block size in bytes
+ *
+ * Replace the cache warm-up manifest, stored in the log directory, with a
+ * manifest listing the 'cnt' data blocks, of size 'dblk_sz', in vector
+ * 'blk'.  'blk' must be ordered by file handle and data block number.
+ * Files are recorded by path name, so that the manifest remains valid
+ * across PDS restarts; blocks of files whose path name can not be
+ * determined are omitted.
+ *
+ * The manifest is written to a temporary file that then replaces the
+ * existing manifest, such that a failure does not leave a partial manifest.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - warm-up manifest written without error
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINSUF - insufficient system resources to complete
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+struct SS_warmblk{
+  pds_fhandlet fhandle;   /* file handle */
+  pious_offt db_nmbr;     /* data block number */
+};
+
+#ifdef __STDC__
+int SS_warmsave(struct SS_warmblk *blk,
+		long cnt,
+		pious_sizet dblk_sz);
+#else
+int SS_warmsave();
+#endif
+
+
+
+
+/*
+ * SS_warmload()
+ *
+ * Parameters:
+ *
+ *   dblk_sz - data block size in bytes
+ *   max     - maximum data block count
+ *   blk     - data block vector
+ *
+ * Read the cache warm-up manifest written by SS_warmsave(), looking up each
+ * file listed, and place up to 'max' of the data blocks listed in a vector
+ * allocated for the purpose; a pointer to the vector is placed in 'blk'.
+ * The vector is ordered by file and data block number, as written.
+ *
+ * A manifest written for a data block size other than 'dblk_sz' is ignored,
+ * as are files listed that can no longer be accessed.
+ *
+ * NOTE: The storage allocated for 'blk' must be deallocated by the caller
+ *       via free(); 'blk' is set to NULL if no data blocks are listed.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of data blocks placed in vector 'blk' (<= max)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINSUF - insufficient system resources to complete
+ *       PIOUS_EFATAL - fatal error; check PDS error log
+ */
+
+#ifdef __STDC__
+long SS_warmload(pious_sizet dblk_sz,
+		 long max,
+		 struct SS_warmblk **blk);
+#else
+long SS_warmload();
+#endif
+
+
+
+
+/*
+ * SS_stats()
+ *
+ * Parameters:
+ *
+ *   stats - stable storage statistics
+ *
+ * Obtain statistics describing the file information cache and the file
+ * descriptor pool since initialization; results are placed in 'stats'.
+ *
+ * The file information cache grows on demand, to at most 'fic_max' entries,
+ * rather than replace entries; entries replaced thereafter are counted.  A
+ * descriptor is closed to reclaim it for another file when 'fildes_max'
+ * descriptors are open, or when the host refuses to open another; such
+ * closes are counted, together with all file opens, as descriptor churn.
+ *
+ * Returns:
+ */
+
+struct SS_stats{
+  long fic_sz;                /* file information cache entries */
+  long fic_max;               /* file information cache entry limit */
+  long fic_nvalid;            /* valid file information cache entries */
+  long fildes_max;            /* file descriptor pool size */
+  long fildes_nopen;          /* file descriptors open */
+  unsigned long fic_replace;  /* file information cache entries replaced */
+  unsigned long fildes_open;  /* files opened */
+  unsigned long fildes_close; /* descriptors closed to reclaim */
+};
+
+#ifdef __STDC__
+void SS_stats(struct SS_stats *stats);
+#else
+void SS_stats();
+#endif
+
+
+
+
 /*
  * SS_errlog()
  *
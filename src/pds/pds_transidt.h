@@ -151,7 +151,9 @@ int transid_gt(pds_transidt transid_1,
  *   transid - transaction id
  *   maxval  - hash value bound
  *
- * Calculates hash value for transid in the range 0..(maxval - 1).
+ * Calculates hash value for transid in the range 0..(maxval - 1).  All
+ * fields contribute, such that transactions of distinct processes hash
+ * apart even if time stamps coincide.
  *
  * Returns:
  *
@@ -165,7 +167,11 @@ int transid_hash(pds_transidt transid,
 */
 
 #define transid_hash(transid, maxval) \
-(((int)(maxval) <= 0) ? (int)0 : (int)(((transid).usec) % (int)(maxval)))
+(((int)(maxval) <= 0) ? (int)0 : \
+ (int)((((unsigned long)(transid).usec) ^ \
+	(((unsigned long)(transid).procid) * 0x9e3779b1UL) ^ \
+	(((unsigned long)(transid).sec) * 0x85ebca6bUL) ^ \
+	((transid).hostid)) % (unsigned long)(maxval)))
 
 
 
@@ -48,12 +48,16 @@
  *   FS_open();
  *   FS_write();
  *   FS_read();
+ *   FS_readv();
+ *   FS_writev();
+ *   FS_direct();
  *   FS_close();
  *   FS_fsync();
  *   FS_stat();
  *   FS_fstat();
  *   FS_access();
  *   FS_open_max();
+ *   FS_open_limit();
  *   FS_rename();
  *   FS_chmod();
  *   FS_unlink();
@@ -65,8 +69,9 @@
  * Implementation Notes:
  * 
  *   1) This implementation of the PFS interface conforms to the
- *      IEEE POSIX 1003.1-1988/1990. The single exception is the
- *      FS_fsync() operation; see function documentation for details.
+ *      IEEE POSIX 1003.1-1988/1990. The exceptions are the FS_fsync(),
+ *      FS_direct(), and FS_open_limit() operations; see function
+ *      documentation for details.
  */
 
 
@@ -75,6 +80,12 @@
 
 #define _POSIX_SOURCE 1
 
+/* Definition required to get the O_DIRECT open flag on GNU/Linux hosts */
+
+#ifdef __linux__
+#define _GNU_SOURCE 1
+#endif
+
 
 /* Include Files */
 
@@ -87,10 +98,16 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
 
+#ifdef __linux__
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
 #include "gpmacro.h"
 
 #include "pious_types.h"
@@ -100,6 +117,12 @@
 #include "pfs.h"
 
 
+/* Local constants */
+
+/* maximum I/O vector elements passed to readv(); POSIX minimum IOV_MAX */
+#define IOVEC_MAX  16
+
+
 /* Local function declarations */
 
 #ifdef __STDC__
@@ -406,6 +429,288 @@ pious_ssizet FS_read(fildes, offset, whence, nbyte, buf)
 
 
 
+/*
+ * FS_readv() - See pfs.h for description.
+ */
+
+#ifdef __STDC__
+pious_ssizet FS_readv(int fildes,
+		      pious_offt offset,
+		      struct FS_iovec *iov,
+		      int iovcnt)
+#else
+pious_ssizet FS_readv(fildes, offset, iov, iovcnt)
+     int fildes;
+     pious_offt offset;
+     struct FS_iovec *iov;
+     int iovcnt;
+#endif
+{
+  pious_ssizet rcode, acode;
+  pious_sizet vcount;
+  int i, vcnt, done;
+  off_t pos;
+  struct iovec vec[IOVEC_MAX];
+
+  /* validate 'offset' and 'iovcnt' arguments */
+  if (offset < 0 || iovcnt < 0)
+    return (PIOUS_EINVAL);
+
+  /* attempt seek to starting offset -- guard against signal interrupts */
+  while ((pos = lseek(fildes, (off_t)offset, SEEK_SET)) == -1 &&
+	 errno == EINTR);
+
+  if (pos == -1)
+    /* error occured during seek */
+    switch (errno)
+      {
+      case EBADF:
+	rcode = PIOUS_EBADF;
+	break;
+      case EINVAL:
+	rcode = PIOUS_EINVAL;
+	break;
+      default:
+	rcode = PIOUS_EUNXP;
+	break;
+      }
+
+  else
+    { /* read data IOVEC_MAX vector elements at a time; during readv()
+       * operation guard against partial transfers of data resulting from
+       * signal interrupt.  a short read indicates EOF.
+       */
+
+      rcode = 0;
+      done  = (iovcnt == 0);
+
+      while (!done)
+	{ /* set up next portion of I/O vector */
+	  vcnt   = Min(iovcnt, IOVEC_MAX);
+	  vcount = 0;
+
+	  for (i = 0; i < vcnt; i++)
+	    {
+	      vec[i].iov_base = iov[i].base;
+	      vec[i].iov_len  = (size_t)iov[i].len;
+	      vcount         += iov[i].len;
+	    }
+
+	  while ((acode = readv(fildes, vec, vcnt)) == -1 && errno == EINTR)
+	    lseek(fildes, pos, SEEK_SET);
+
+	  if (acode == -1)
+	    { /* error - set rcode appropriately */
+	      switch (errno)
+		{
+		case EBADF:
+		  rcode = PIOUS_EBADF;
+		  break;
+		case EINVAL:
+		  rcode = PIOUS_EINVAL;
+		  break;
+		default:
+		  rcode = PIOUS_EUNXP;
+		  break;
+		}
+
+	      done = TRUE;
+	    }
+
+	  else
+	    { /* no error; continue with remaining vector if not at EOF */
+	      rcode  += acode;
+	      pos    += acode;
+	      iov    += vcnt;
+	      iovcnt -= vcnt;
+
+	      if ((pious_sizet)acode < vcount || iovcnt == 0)
+		done = TRUE;
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * FS_writev() - See pfs.h for description.
+ */
+
+#ifdef __STDC__
+pious_ssizet FS_writev(int fildes,
+		       pious_offt offset,
+		       struct FS_iovec *iov,
+		       int iovcnt)
+#else
+pious_ssizet FS_writev(fildes, offset, iov, iovcnt)
+     int fildes;
+     pious_offt offset;
+     struct FS_iovec *iov;
+     int iovcnt;
+#endif
+{
+  pious_ssizet rcode, acode;
+  pious_sizet vcount;
+  int i, vcnt, done;
+  off_t pos;
+  struct iovec vec[IOVEC_MAX];
+
+  /* validate 'offset' and 'iovcnt' arguments */
+  if (offset < 0 || iovcnt < 0)
+    return (PIOUS_EINVAL);
+
+  /* attempt seek to starting offset -- guard against signal interrupts */
+  while ((pos = lseek(fildes, (off_t)offset, SEEK_SET)) == -1 &&
+	 errno == EINTR);
+
+  if (pos == -1)
+    /* error occured during seek */
+    switch (errno)
+      {
+      case EBADF:
+	rcode = PIOUS_EBADF;
+	break;
+      case EINVAL:
+	rcode = PIOUS_EINVAL;
+	break;
+      default:
+	rcode = PIOUS_EUNXP;
+	break;
+      }
+
+  else
+    { /* write data IOVEC_MAX vector elements at a time; during writev()
+       * operation guard against partial transfers of data resulting from
+       * signal interrupt.  a short write terminates the transfer.
+       */
+
+      rcode = 0;
+      done  = (iovcnt == 0);
+
+      while (!done)
+	{ /* set up next portion of I/O vector */
+	  vcnt   = Min(iovcnt, IOVEC_MAX);
+	  vcount = 0;
+
+	  for (i = 0; i < vcnt; i++)
+	    {
+	      vec[i].iov_base = iov[i].base;
+	      vec[i].iov_len  = (size_t)iov[i].len;
+	      vcount         += iov[i].len;
+	    }
+
+	  while ((acode = writev(fildes, vec, vcnt)) == -1 && errno == EINTR)
+	    lseek(fildes, pos, SEEK_SET);
+
+	  if (acode == -1)
+	    { /* error - set rcode appropriately */
+	      switch (errno)
+		{
+		case EBADF:
+		  rcode = PIOUS_EBADF;
+		  break;
+		case EINVAL:
+		  rcode = PIOUS_EINVAL;
+		  break;
+		case EFBIG:
+		  rcode = PIOUS_EFBIG;
+		  break;
+		case ENOSPC:
+		  rcode = PIOUS_ENOSPC;
+		  break;
+		default:
+		  rcode = PIOUS_EUNXP;
+		  break;
+		}
+
+	      done = TRUE;
+	    }
+
+	  else
+	    { /* no error; continue with remaining vector if not short */
+	      rcode  += acode;
+	      pos    += acode;
+	      iov    += vcnt;
+	      iovcnt -= vcnt;
+
+	      if ((pious_sizet)acode < vcount || iovcnt == 0)
+		done = TRUE;
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * FS_direct() - See pfs.h for description.
+ *
+ * WARNING: NOT POSIX 1003.1-19xx compliant. This implementation is based on
+ *          the O_DIRECT file status flag, where available; otherwise direct
+ *          I/O is not supported.
+ */
+
+#ifdef __STDC__
+int FS_direct(int fildes,
+	      int on)
+#else
+int FS_direct(fildes, on)
+     int fildes;
+     int on;
+#endif
+{
+#ifdef O_DIRECT
+  int rcode, fcode, fflag;
+
+  /* obtain file status flags -- guard against signal interrupts */
+  while ((fflag = fcntl(fildes, F_GETFL)) == -1 && errno == EINTR);
+
+  if (fflag == -1)
+    fcode = -1;
+
+  else
+    { /* set or clear O_DIRECT as requested, if not already so */
+      fcode = 0;
+
+      if ((on && !(fflag & O_DIRECT)) || (!on && (fflag & O_DIRECT)))
+	while ((fcode = fcntl(fildes, F_SETFL, fflag ^ O_DIRECT)) == -1 &&
+	       errno == EINTR);
+    }
+
+  if (fcode != -1) /* no error */
+    rcode = PIOUS_OK;
+
+  else /* error - set rcode appropriately */
+    switch (errno)
+      {
+      case EBADF:
+	rcode = PIOUS_EBADF;
+	break;
+      case EINVAL:
+	rcode = PIOUS_EINVAL;
+	break;
+      default:
+	rcode = PIOUS_EUNXP;
+	break;
+      }
+
+  return rcode;
+#else
+  /* direct I/O not supported; disabling is trivially successful */
+  return (on ? PIOUS_EINVAL : PIOUS_OK);
+#endif
+}
+
+
+
+
 /*
  * FS_close() - See pfs.h for description.
  */
@@ -696,6 +1001,40 @@ return (sysconf(_SC_OPEN_MAX));
 
 
 
+/*
+ * FS_open_limit() - See pfs.h for description
+ *
+ *   Not a POSIX 1003.1-1990 function; the RLIMIT_NOFILE resource limit is
+ *   set, where available, and otherwise the limit is left unchanged.
+ */
+
+#ifdef __STDC__
+long FS_open_limit(long nmax)
+#else
+long FS_open_limit(nmax)
+     long nmax;
+#endif
+{
+#ifdef RLIMIT_NOFILE
+  struct rlimit rl;
+
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0)
+    { /* set soft limit to 'nmax', bounded by the hard limit */
+      if (rl.rlim_max == RLIM_INFINITY || (long)rl.rlim_max > nmax)
+	rl.rlim_cur = nmax;
+      else
+	rl.rlim_cur = rl.rlim_max;
+
+      setrlimit(RLIMIT_NOFILE, &rl);
+    }
+#endif
+
+  return (FS_open_max());
+}
+
+
+
+
 /*
  * FS_rename() - See pfs.h for description.
  */
@@ -43,12 +43,16 @@
  *   FS_open();
  *   FS_write();
  *   FS_read();
+ *   FS_readv();
+ *   FS_writev();
+ *   FS_direct();
  *   FS_close();
  *   FS_fsync();
  *   FS_stat();
  *   FS_fstat();
  *   FS_access();
  *   FS_open_max();
+ *   FS_open_limit();
  *   FS_rename();
  *   FS_chmod();
  *   FS_unlink();
@@ -211,6 +215,140 @@ pious_ssizet FS_read();
 
 
 
+/*
+ * FS_readv()
+ *
+ * Parameters:
+ *
+ *   fildes  - file descriptor
+ *   offset  - starting offset
+ *   iov     - I/O vector
+ *   iovcnt  - I/O vector element count
+ *
+ * Read file 'fildes' starting at 'offset' bytes from the beginning of file
+ * and proceeding for the total byte count specified by the I/O vector 'iov';
+ * place result in the 'iovcnt' buffers of 'iov', in order, filling each
+ * buffer completely before proceeding to the next.
+ *
+ * FS_readv() is semantically equivalent to a single FS_read() of the
+ * concatenated buffers, but permits data to be placed directly into
+ * non-contiguous buffers.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes read (<= total I/O vector byte count)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - 'fildes' not valid file dscrp open for reading
+ *       PIOUS_EINVAL - resulting file offset or byte count is not a proper
+ *                      value or exceeds SYSTEM constraints
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *
+ */
+
+struct FS_iovec{
+  char *base;             /* buffer */
+  pious_sizet len;        /* buffer byte count */
+};
+
+#ifdef __STDC__
+pious_ssizet FS_readv(int fildes,
+		      pious_offt offset,
+		      struct FS_iovec *iov,
+		      int iovcnt);
+#else
+pious_ssizet FS_readv();
+#endif
+
+
+
+
+/*
+ * FS_writev()
+ *
+ * Parameters:
+ *
+ *   fildes  - file descriptor
+ *   offset  - starting offset
+ *   iov     - I/O vector
+ *   iovcnt  - I/O vector element count
+ *
+ * Write file 'fildes' starting at 'offset' bytes from the beginning of file
+ * the data in the 'iovcnt' buffers of I/O vector 'iov', in order, writing
+ * each buffer completely before proceeding to the next.
+ *
+ * FS_writev() is semantically equivalent to a single FS_write() of the
+ * concatenated buffers, but permits data to be taken directly from
+ * non-contiguous buffers.
+ *
+ * Returns:
+ *
+ *   >= 0 - number of bytes written (<= total I/O vector byte count)
+ *   <  0 - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - 'fildes' not valid file dscrp open for writing
+ *       PIOUS_EINVAL - resulting file offset or byte count is not a proper
+ *                      value or exceeds SYSTEM constraints
+ *       PIOUS_EFBIG  - write would cause file size to exceed SYSTEM constraint
+ *       PIOUS_ENOSPC - no free space remains on device
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *
+ */
+
+#ifdef __STDC__
+pious_ssizet FS_writev(int fildes,
+		       pious_offt offset,
+		       struct FS_iovec *iov,
+		       int iovcnt);
+#else
+pious_ssizet FS_writev();
+#endif
+
+
+
+
+/*
+ * FS_direct()
+ *
+ * Parameters:
+ *
+ *   fildes  - file descriptor
+ *   on      - direct I/O flag
+ *
+ * Enable ('on' TRUE) or disable ('on' FALSE) direct I/O for file 'fildes'.
+ * Data transferred via a descriptor with direct I/O enabled is not held
+ * in the host file system cache.
+ *
+ * While direct I/O is enabled, the file offset, byte count, and buffer
+ * address of each FS_read()/FS_write() transfer, and the buffer address and
+ * byte count of each FS_readv()/FS_writev() I/O vector element, must be a
+ * multiple of FS_DIRECT_ALIGN; otherwise the transfer may fail with
+ * PIOUS_EINVAL.  Callers are expected to disable direct I/O for the
+ * duration of an unaligned transfer.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - direct I/O enabled/disabled as requested
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF  - 'fildes' not a valid file descriptor
+ *       PIOUS_EINVAL - direct I/O not supported by the host or file system
+ *       PIOUS_EUNXP  - unexpected error condition encountered
+ *
+ */
+
+#define FS_DIRECT_ALIGN  4096
+
+#ifdef __STDC__
+int FS_direct(int fildes,
+	      int on);
+#else
+int FS_direct();
+#endif
+
+
+
+
 /*
  * FS_close()
  *
@@ -383,6 +521,33 @@ long FS_open_max();
 
 
 
+/*
+ * FS_open_limit()
+ *
+ * Parameters:
+ *
+ *   nmax - requested limit on open files
+ *
+ * Set the maximum number of files that the process can have open
+ * simultaneously to 'nmax', or to the greatest value the host permits if
+ * less; descriptors already open are not affected.  If the host does not
+ * permit the limit to be altered then it is left unchanged.
+ *
+ * Returns:
+ *
+ *   long - the resulting maximum number of files that the process can have
+ *          open simultaneously
+ */
+
+#ifdef __STDC__
+long FS_open_limit(long nmax);
+#else
+long FS_open_limit();
+#endif
+
+
+
+
 /*
  * FS_rename()
  *
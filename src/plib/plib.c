@@ -73,6 +73,7 @@
  * pious_{s}popen()
  * pious_close()
  * pious_fstat()
+ * pious_advise()
  * pious_sysinfo()
  *
  * pious_read()
@@ -333,6 +334,13 @@ static int abort_all(pds_transidt transid,
 static int ping_all(trans_statet **tsv,
 		    int cnt);
 
+static int seg_range(ftable_entryt *ftable,
+		     int seg,
+		     pious_offt offset,
+		     pious_sizet nbyte,
+		     pious_offt *seg_offset,
+		     pious_sizet *seg_nbyte);
+
 static int dsv2dsinfo(struct pious_dsvec *dsv,
 		      int dsvcnt,
 		      struct PSC_dsinfo **dsinfo);
@@ -364,6 +372,8 @@ static int abort_all();
 
 static int ping_all();
 
+static int seg_range();
+
 static int dsv2dsinfo();
 
 static int tstate_insert();
@@ -772,6 +782,114 @@ int pious_fstat(fd, buf)
 
 
 
+/*
+ * pious_advise() - See plib.h for description.
+ */
+
+#ifdef __STDC__
+int pious_advise(int fd,
+		 pious_offt offset,
+		 pious_sizet len,
+		 int advice)
+#else
+int pious_advise(fd, offset, len, advice)
+     int fd;
+     pious_offt offset;
+     pious_sizet len;
+     int advice;
+#endif
+{
+  int rcode, acode, cntrlid, pds_cnt, seg_cnt, seg_base, i;
+  pious_offt seg_offset;
+  pious_sizet seg_nbyte;
+  ftable_entryt *ftable;
+  trans_statet **tsv;
+
+  /* check for inconsistent system state */
+
+  if (badstate)
+    rcode = PIOUS_EUNXP;
+
+  /* validate 'fd' argument */
+
+  else if (fd < 0 || fd >= PLIB_OPEN_MAX || !file_table[fd].valid)
+    rcode = PIOUS_EBADF;
+
+  /* validate 'offset' and 'advice' arguments */
+
+  else if (offset < 0 ||
+	   advice < PIOUS_ADV_NORMAL || advice > PIOUS_ADV_NOREUSE)
+    rcode = PIOUS_EINVAL;
+
+  /* advise data server of each parafile data segment spanned by range.
+   * segment i resides on data server (i mod pds_cnt), so advice is sent
+   * to pds_cnt segments at a time to keep one request outstanding at a
+   * given data server.
+   */
+
+  else
+    {
+      ftable  = &file_table[fd];
+      tsv     = ftable->trans_state;
+      pds_cnt = ftable->pfinfo->pds_cnt;
+      seg_cnt = ftable->pfinfo->seg_cnt;
+
+      cntrlid = CntrlIdNext;
+      acode   = PIOUS_OK;
+
+      for (seg_base = 0;
+	   seg_base < seg_cnt && acode == PIOUS_OK;
+	   seg_base += pds_cnt)
+	{
+	  /* send advise request for each segment spanned by range */
+
+	  for (i = 0; i < pds_cnt && seg_base + i < seg_cnt; i++)
+	    if (seg_range(ftable, seg_base + i, offset, len,
+			  &seg_offset, &seg_nbyte))
+	      tsv[i]->rcode =
+		PDS_advise_send(tsv[i]->pdsid, cntrlid,
+				ftable->pfinfo->seg_fhandle[seg_base + i],
+				seg_offset, seg_nbyte, advice);
+	    else
+	      tsv[i]->rcode = 1;
+
+	  /* receive advise reply for each request sent */
+
+	  for (i = 0; i < pds_cnt && seg_base + i < seg_cnt; i++)
+	    if (tsv[i]->rcode == PIOUS_OK)
+	      tsv[i]->rcode = PDS_advise_recv(tsv[i]->pdsid, cntrlid);
+
+	  /* set result code to first error encountered, if extant */
+
+	  for (i = 0; i < pds_cnt && seg_base + i < seg_cnt; i++)
+	    if (tsv[i]->rcode < 0 && acode == PIOUS_OK)
+	      acode = tsv[i]->rcode;
+	}
+
+      switch(acode)
+	{
+	case PIOUS_OK:
+	case PIOUS_EINSUF:
+	case PIOUS_ETPORT:
+	  rcode = acode;
+	  break;
+	case PIOUS_ESRCDEST:
+	  /* should never occur; inconsistent system state (bug in PIOUS) */
+	  rcode    = PIOUS_EUNXP;
+	  badstate = TRUE;
+	  break;
+	default:
+	  rcode = PIOUS_EUNXP;
+	  break;
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
 /*
  * pious_sysinfo() - See plib.h for description.
  */
@@ -802,7 +920,15 @@ long pious_sysinfo(name)
       if (!psc_config_valid)
 	{
 	  if ((psccode = PSC_config(&psc_config)) == PIOUS_OK)
-	    { /* successfully obtained configuration info */
+	    { /* successfully obtained configuration info; spawned PDS ids
+	       * are not required
+	       */
+	      if (psc_config.pds_id != NULL)
+		{
+		  free((char *)psc_config.pds_id);
+		  psc_config.pds_id = NULL;
+		}
+
 	      psc_config_valid = TRUE;
 	    }
 
@@ -4271,6 +4397,114 @@ static int ping_all(tsv, cnt)
 
 
 
+/*
+ * seg_range()
+ *
+ * Parameters:
+ *
+ *   ftable     - file table entry
+ *   seg        - parafile data segment number
+ *   offset     - starting offset in file view
+ *   nbyte      - byte count; zero (0) specifies through end of file
+ *   seg_offset - starting offset in data segment file
+ *   seg_nbyte  - byte count in data segment file; zero (0) specifies
+ *                through end of file
+ *
+ * Determine the range of data segment file 'seg' spanned by the range
+ * of file 'ftable', in its file view, starting at 'offset' and proceeding
+ * for 'nbyte' bytes.  For a linear file view the range is that covering
+ * all striping units of 'seg' accessed, and hence may include data of
+ * segment 'seg' not within the file view range.
+ *
+ * Returns:
+ *
+ *   TRUE  - range spans segment 'seg'; 'seg_offset' and 'seg_nbyte' are set
+ *   FALSE - range does not span segment 'seg'
+ */
+
+#ifdef __STDC__
+static int seg_range(ftable_entryt *ftable,
+		     int seg,
+		     pious_offt offset,
+		     pious_sizet nbyte,
+		     pious_offt *seg_offset,
+		     pious_sizet *seg_nbyte)
+#else
+static int seg_range(ftable, seg, offset, nbyte, seg_offset, seg_nbyte)
+     ftable_entryt *ftable;
+     int seg;
+     pious_offt offset;
+     pious_sizet nbyte;
+     pious_offt *seg_offset;
+     pious_sizet *seg_nbyte;
+#endif
+{
+  int rcode, seg_cnt;
+  pious_offt su_sz, last, su_first, su_last, su_seg_first, su_seg_last;
+
+  /* a range extending past the maximum file offset is through end of file */
+
+  if (nbyte > (pious_sizet)(PIOUS_OFFT_MAX - offset))
+    nbyte = 0;
+
+  if (ftable->view == PIOUS_SEGMENTED)
+    { /* range is of a specified parafile data segment file */
+      rcode       = ((pious_sizet)seg == ftable->map);
+      *seg_offset = offset;
+      *seg_nbyte  = nbyte;
+    }
+
+  else /* view == PIOUS_INDEPENDENT || view == PIOUS_GLOBAL */
+    { /* linear file view; striping across segments round-robin from low to
+       * high.  determine first striping unit (SU) of range in 'seg'.
+       */
+      seg_cnt  = ftable->pfinfo->seg_cnt;
+      su_sz    = (pious_offt)ftable->map;
+      su_first = offset / su_sz;
+
+      su_seg_first = su_first + (seg - su_first % seg_cnt + seg_cnt) % seg_cnt;
+
+      if (su_seg_first == su_first)
+	*seg_offset = (su_first / seg_cnt) * su_sz + offset % su_sz;
+      else
+	*seg_offset = (su_seg_first / seg_cnt) * su_sz;
+
+      if (nbyte == 0)
+	{ /* range is through end of file; spans every segment */
+	  rcode      = TRUE;
+	  *seg_nbyte = 0;
+	}
+
+      else
+	{ /* determine last SU of range in 'seg', if any */
+	  last    = offset + (pious_offt)(nbyte - 1);
+	  su_last = last / su_sz;
+
+	  if (su_seg_first > su_last)
+	    rcode = FALSE;
+
+	  else
+	    {
+	      su_seg_last = su_last - (su_last % seg_cnt - seg + seg_cnt) %
+		seg_cnt;
+
+	      if (su_seg_last == su_last)
+		last = (su_last / seg_cnt) * su_sz + last % su_sz;
+	      else
+		last = (su_seg_last / seg_cnt) * su_sz + (su_sz - 1);
+
+	      rcode      = TRUE;
+	      *seg_nbyte = last - *seg_offset + 1;
+	    }
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
 /*
  * dsv2dsinfo()
  *
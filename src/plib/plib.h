@@ -114,6 +114,7 @@
  * pious_{s}popen()
  * pious_close()
  * pious_fstat()
+ * pious_advise()
  * pious_sysinfo()
  *
  * pious_read()
@@ -351,6 +352,57 @@ int pious_fstat();
 
 
 
+/*
+ * pious_advise()
+ *
+ * Parameters:
+ *
+ *   fd     - file descriptor
+ *   offset - starting offset
+ *   len    - byte count; zero (0) specifies through end of file
+ *   advice - expected access pattern
+ *
+ * Advise PIOUS of the expected pattern of access to the file referenced by
+ * descriptor 'fd', starting at 'offset' bytes from the beginning and
+ * proceeding for 'len' bytes, such that data servers may manage their
+ * caches accordingly.  Valid values of 'advice' are:
+ *
+ *   PIOUS_ADV_NORMAL     - no particular pattern; the default
+ *   PIOUS_ADV_SEQUENTIAL - file is read sequentially
+ *   PIOUS_ADV_RANDOM     - file is read randomly
+ *   PIOUS_ADV_WILLNEED   - data in range will be accessed soon
+ *   PIOUS_ADV_DONTNEED   - data in range will not be accessed soon
+ *   PIOUS_ADV_NOREUSE    - file data is accessed once
+ *
+ * SEQUENTIAL, RANDOM, and NOREUSE advice applies to the underlying parafile
+ * as a whole, regardless of 'offset' and 'len', and remains in effect until
+ * superseded.  Advice does not alter file contents and is not subject to
+ * transaction semantics.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - advice successfully applied
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EBADF   - invalid file descriptor
+ *       PIOUS_EINVAL  - 'offset' or 'advice' is not a proper value
+ *       PIOUS_EINSUF  - insufficient system resources to complete; retry
+ *       PIOUS_ETPORT  - error condition in underlying transport system
+ *       PIOUS_EUNXP   - unexpected error condition encountered
+ */
+
+#ifdef __STDC__
+int pious_advise(int fd,
+		 pious_offt offset,
+		 pious_sizet len,
+		 int advice);
+#else
+int pious_advise();
+#endif
+
+
+
+
 /*
  * pious_sysinfo()
  *
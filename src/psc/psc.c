@@ -698,6 +698,8 @@ int PSC_config(buf)
 	  if ((rcode = replymsg.rcode) == PIOUS_OK)
 	    { /* function results valid */
 	      buf->def_pds_cnt = replymsg.body.config.def_pds_cnt;
+	      buf->pds_cnt     = replymsg.body.config.pds_cnt;
+	      buf->pds_id      = replymsg.body.config.pds_id;
 	    }
 	}
     }
@@ -614,6 +614,11 @@ PSC_schmoddir((struct PSC_dsinfo *)NULL, path, mode)
  *
  * Query service coordinator configuration information.
  *
+ * The message passing ids of all data servers spawned by the service
+ * coordinator are returned in the 'pds_cnt' element array 'pds_id', which
+ * is allocated via malloc() and must be deallocated by the caller; if no
+ * data servers have been spawned then 'pds_id' is NULL.
+ *
  * Returns:
  *
  *   PIOUS_OK (0) - configuration information successfully returned
@@ -627,6 +632,8 @@ PSC_schmoddir((struct PSC_dsinfo *)NULL, path, mode)
 
 struct PSC_configinfo {
   int def_pds_cnt;       /* default PDS count */
+  int pds_cnt;           /* spawned PDS count */
+  dce_srcdestt *pds_id;  /* spawned PDS message passing ids */
 };
 
 #ifdef __STDC__
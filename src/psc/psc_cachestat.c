@@ -0,0 +1,342 @@
+/* PIOUS1 Parallel Input/OUtput System
+ * Copyright (C) 1994,1995 by Steven A. Moyer and V. S. Sunderam
+ *
+ * PIOUS1 is a software system distributed under the terms of the
+ * GNU Library General Public License Version 2.  All PIOUS1 software,
+ * including PIOUS1 code that is not intended to be directly linked with
+ * non PIOUS1 code, is considered to be part of a single logical software
+ * library for the purposes of licensing and distribution.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License Version 2 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+
+
+
+/* PIOUS Service Coordinator (PSC): Data Server Cache Statistics Utility
+ *
+ * The psc_cachestat utility obtains the set of data servers spawned from
+ * the PSC, queries each for cache statistics via PDS_cachestat(), and
+ * reports the results on standard output.  Requests are pipelined, such that
+ * all data servers are queried before any reply is received.
+ *
+ * Usage: pious1stat
+ *
+ * The PIOUS system must be running.
+ */
+
+
+
+
+/* Include Files */
+
+#ifdef __STDC__
+#include <stddef.h>
+#include <stdlib.h>
+#else
+#include "nonansi.h"
+#endif
+
+#include <stdio.h>
+
+#include "gpmacro.h"
+#include "gputil.h"
+
+#include "pious_types.h"
+#include "pious_errno.h"
+
+#include "pds_transidt.h"
+#include "pds_fhandlet.h"
+
+#include "pdce_srcdestt.h"
+#include "pdce_msgtagt.h"
+#include "pdce.h"
+
+#include "pds_sstorage_manager.h"
+#include "pds_cache_manager.h"
+#include "pds.h"
+
+#include "psc.h"
+
+
+
+
+/*
+ * Private Declaration - Types, Constants, and Macros
+ */
+
+
+/* PDS control operation request state */
+
+struct cntrlop_state{
+  int code;    /* result code of request send/recv */
+  int id;      /* control message id */
+};
+
+
+/* ratio of part to whole as a percentage; zero if whole is zero */
+
+#define Pct(part, whole) \
+((whole) == 0 ? 0.0 : (100.0 * (double)(part)) / (double)(whole))
+
+
+
+
+/*
+ * Local Function Declarations
+ */
+
+#ifdef __STDC__
+static void stats_print(dce_srcdestt pdsid,
+			struct CM_stats *stats,
+			struct SS_stats *ss_stats,
+			struct PDS_abortstats *abort_stats);
+#else
+static void stats_print();
+#endif
+
+
+
+
+/*
+ * Function Definitions
+ */
+
+
+/*
+ * main() - pious1stat
+ */
+
+#ifdef __STDC__
+int main(int argc, char **argv)
+#else
+int main(argc, argv)
+     int argc;
+     char **argv;
+#endif
+{
+  int rcode, i;
+  struct PSC_configinfo config;
+  struct cntrlop_state *cntrlop;
+  struct CM_stats stats;
+  struct SS_stats ss_stats;
+  struct PDS_abortstats abort_stats;
+  char *errnotxt, *errtxt;
+
+  rcode         = 0;
+  config.pds_id = NULL;
+
+  if (argc != 1)
+    { /* incorrect number of arguments */
+      fprintf(stderr, "\nUsage: pious1stat\n");
+      rcode = 1;
+    }
+
+  /* obtain message passing ids of all data servers from PSC */
+
+  else if ((i = PSC_config(&config)) != PIOUS_OK)
+    {
+      UTIL_errno2errtxt(i, &errnotxt, &errtxt);
+
+      fprintf(stderr, "\npious1stat: unable to query PSC; %s (%s)\n",
+	      errnotxt, errtxt);
+      rcode = 1;
+    }
+
+  else if (config.pds_cnt == 0)
+    {
+      printf("pious1stat: no data servers\n");
+    }
+
+  else if ((cntrlop = (struct cntrlop_state *)
+	    malloc((unsigned)
+		   (config.pds_cnt * sizeof(struct cntrlop_state)))) == NULL)
+    {
+      fprintf(stderr, "\npious1stat: insufficient memory\n");
+      rcode = 1;
+    }
+
+  else
+    { /* perform pipelined PDS cache statistics queries */
+      for (i = 0; i < config.pds_cnt; i++)
+	{
+	  cntrlop[i].id   = i;
+	  cntrlop[i].code = PDS_cachestat_send(config.pds_id[i], i);
+	}
+
+      for (i = 0; i < config.pds_cnt; i++)
+	{
+	  if (cntrlop[i].code == PIOUS_OK)
+	    cntrlop[i].code =
+	      PDS_cachestat_recv(config.pds_id[i], cntrlop[i].id,
+				 &stats, &ss_stats, &abort_stats);
+
+	  if (cntrlop[i].code == PIOUS_OK)
+	    stats_print(config.pds_id[i], &stats, &ss_stats, &abort_stats);
+
+	  else
+	    {
+	      UTIL_errno2errtxt(cntrlop[i].code, &errnotxt, &errtxt);
+
+	      printf("PDS %x: unable to obtain statistics; %s (%s)\n\n",
+		     config.pds_id[i], errnotxt, errtxt);
+	      rcode = 1;
+	    }
+	}
+
+      /* deallocate extraneous storage */
+      free((char *)cntrlop);
+    }
+
+  if (config.pds_id != NULL)
+    free((char *)config.pds_id);
+
+  DCE_exit();
+
+  return rcode;
+}
+
+
+
+
+/*
+ * stats_print()
+ *
+ * Parameters:
+ *
+ *   pdsid       - PDS id
+ *   stats       - cache statistics
+ *   ss_stats    - stable storage statistics
+ *   abort_stats - transaction abort counts
+ *
+ * Print cache statistics 'stats', stable storage statistics 'ss_stats', and
+ * transaction abort counts 'abort_stats' of data server 'pdsid' on standard
+ * output.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void stats_print(dce_srcdestt pdsid,
+			struct CM_stats *stats,
+			struct SS_stats *ss_stats,
+			struct PDS_abortstats *abort_stats)
+#else
+static void stats_print(pdsid, stats, ss_stats, abort_stats)
+     dce_srcdestt pdsid;
+     struct CM_stats *stats;
+     struct SS_stats *ss_stats;
+     struct PDS_abortstats *abort_stats;
+#endif
+{
+  int i;
+  unsigned long hits, refs;
+
+  hits = stats->hit_pt + stats->hit_pb + stats->hit_ra + stats->hit_sm +
+    stats->hit_lg;
+  refs = hits + stats->miss + stats->lg_blks;
+
+  printf("PDS %x:\n", pdsid);
+
+  printf("  cache    %ld blocks of %ld bytes, %s policy%s%s\n",
+	 stats->cache_sz, stats->dblk_sz,
+	 (stats->policy == CM_POLICY_ARC ? "arc" : "slru"),
+	 (stats->admit ? ", admission filter" : ""),
+	 (stats->writeback ? ", write-back" : ""));
+
+  if (stats->sm_cnt > 0)
+    printf("  small    %ld blocks of %ld bytes\n",
+	   stats->sm_cnt, stats->sm_sz);
+
+  if (stats->lg_cnt > 0)
+    printf("  large    %ld blocks of %ld bytes\n",
+	   stats->lg_cnt, stats->lg_sz);
+
+  printf("  state    %ld valid, %ld dirty (%ld write-back), "
+	 "protected %ld (target %ld)\n",
+	 stats->nvalid, stats->ndirty, stats->wb_ndirty,
+	 stats->prot_sz, stats->prot_target);
+
+  if (stats->sm_cnt > 0)
+    printf("  state    %ld small blocks valid\n", stats->sm_nvalid);
+
+  if (stats->lg_cnt > 0)
+    printf("  state    %ld large blocks valid\n", stats->lg_nvalid);
+
+  printf("  reads    %lu refs, %.1f%% hit: protected %lu, "
+	 "probationary %lu, readahead %lu, small %lu, miss %lu\n",
+	 refs, Pct(hits, refs),
+	 stats->hit_pt, stats->hit_pb, stats->hit_ra, stats->hit_sm,
+	 stats->miss);
+
+  if (stats->sm_cnt > 0)
+    printf("  small    %lu blocks placed in small blocks\n",
+	   stats->sm_blks);
+
+  if (stats->lg_cnt > 0)
+    printf("  large    %lu large block hits, %lu large blocks loaded\n",
+	   stats->hit_lg, stats->lg_blks);
+
+  printf("  bypass   %lu readahead blocks loaded, "
+	 "%lu extent blocks not cached\n",
+	 stats->ra_blks, stats->lr_blks);
+
+  printf("  eof      %lu incomplete block hits served, %lu re-read\n",
+	 stats->eof_hit, stats->eof_reload);
+
+  printf("  warm-up  %lu blocks loaded\n", stats->warm_blks);
+
+  printf("  admit    %lu missed blocks not admitted\n", stats->adm_reject);
+
+  printf("  evict    %lu blocks, %lu dirty\n",
+	 stats->evict, stats->evict_dirty);
+
+  printf("  flush    %lu writes, %lu blocks, %lu bytes\n",
+	 stats->flush_ops, stats->flush_blks, stats->flush_bytes);
+
+  printf("  files    %ld of %ld entries (limit %ld), %lu replaced; "
+	 "%ld of %ld descriptors open\n",
+	 ss_stats->fic_nvalid, ss_stats->fic_sz, ss_stats->fic_max,
+	 ss_stats->fic_replace, ss_stats->fildes_nopen, ss_stats->fildes_max);
+
+  printf("  churn    %lu files opened, %lu descriptors reclaimed\n",
+	 ss_stats->fildes_open, ss_stats->fildes_close);
+
+  printf("  aborts   %lu deadlock, %lu time-out, %lu prepare, %lu client\n",
+	 abort_stats->deadlock, abort_stats->timeout, abort_stats->prepare,
+	 abort_stats->client);
+
+  if (stats->part_cnt > 0)
+    for (i = 0; i <= stats->part_cnt; i++)
+      {
+	printf("  part %-3d %ld blocks (%.1f%%), reserve %ld, max %ld",
+	       i, stats->part_nblk[i],
+	       Pct(stats->part_nblk[i], stats->cache_sz),
+	       stats->part_min[i], stats->part_max[i]);
+
+	if (stats->lg_cnt > 0)
+	  printf("; %ld large blocks", stats->part_lgnblk[i]);
+
+	printf("\n");
+      }
+
+  for (i = 0; i < stats->nfile; i++)
+    printf("  file     dev %lu ino %lu: %ld blocks (%.1f%%), %ld dirty\n",
+	   stats->file[i].fhandle.dev, stats->file[i].fhandle.ino,
+	   stats->file[i].nblk, Pct(stats->file[i].nblk, stats->cache_sz),
+	   stats->file[i].ndirty);
+
+  printf("\n");
+}
@@ -34,13 +34,18 @@
  * The grammar that defines the configuration file syntax is:
  *
  *   PDS_SPEC   --> HOSTNAME OPT_LIST
- *   OPT_LIST   --> sp= PATHNAME |
- *                  sp= PATHNAME lp= PATHNAME |
- *                  lp= PATHNAME |
- *                  lp= PATHNAME sp= PATHNAME |
+ *   OPT_LIST   --> sp= PATHNAME OPT_LIST |
+ *                  lp= PATHNAME OPT_LIST |
+ *                  op= OPTIONS OPT_LIST |
  *                  (null production)
  *   HOSTNAME   --> any whitespace delimited string
  *   PATHNAME   --> any whitespace delimited string where first char is '/'
+ *   OPTIONS    --> any whitespace delimited string
+ *
+ * where each of sp=, lp=, and op= may appear at most once per entry.
+ *
+ * The OPTIONS string is passed uninterpreted to the PDS as a start-up
+ * option list; see pds/pds_daemon.c for the option list format.
  *
  *
  * Function Summary:
@@ -87,6 +92,7 @@
 #define SPathToken     1         /* PDS host search root path */
 #define IdentToken     2         /* identifier string */
 #define EofToken       3         /* end of file */
+#define OptsToken      4         /* PDS start-up option list */
 
 /* PDS host information record */
 
@@ -94,6 +100,7 @@ typedef struct hinfo_entry{
   char *hname;                 /* PDS host name */
   char *spath;                 /* PDS host search root path */
   char *lpath;                 /* PDS host log directory path */
+  char *dsopt;                 /* PDS start-up option list */
   struct hinfo_entry *next;    /* next host info entry */
 } hinfo_entryt;
 
@@ -113,7 +120,7 @@ static int  lookahead_token;
 static char lookahead_buf[PSC_INPUTBUF_MAX + 1];
 
 /* OPT_LIST flags */
-int sp_found, lp_found;
+int sp_found, lp_found, op_found;
 
 
 
@@ -161,18 +168,21 @@ int CF_parse(char *psc_hostfile,
 	     int *pds_cnt,
 	     char ***pds_hname,
 	     char ***pds_spath,
-	     char ***pds_lpath)
+	     char ***pds_lpath,
+	     char ***pds_dsopt)
 #else
-int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
+int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath,
+	     pds_dsopt)
      char *psc_hostfile;
      int *pds_cnt;
      char ***pds_hname;
      char ***pds_spath;
      char ***pds_lpath;
+     char ***pds_dsopt;
 #endif
 {
   int rcode, pcode, idx, semantic_err;
-  char *def_spath, *def_lpath;
+  char *def_spath, *def_lpath, *def_dsopt;
   hinfo_entryt *pds_hosts, *host_entry, *host_entry_next;
 
 
@@ -181,7 +191,7 @@ int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
   pds_hosts = NULL;
   *pds_cnt  = 0;
 
-  def_spath = def_lpath = NULL;
+  def_spath = def_lpath = def_dsopt = NULL;
 
   /* open PSC configuration file for reading */
 
@@ -194,15 +204,16 @@ int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
   /* allocate storage for default path parameters */
 
   else if ((def_spath = malloc((unsigned)(PSC_INPUTBUF_MAX + 1))) == NULL ||
-	   (def_lpath = malloc((unsigned)(PSC_INPUTBUF_MAX + 1))) == NULL)
+	   (def_lpath = malloc((unsigned)(PSC_INPUTBUF_MAX + 1))) == NULL ||
+	   (def_dsopt = malloc((unsigned)(PSC_INPUTBUF_MAX + 1))) == NULL)
 
     rcode = PIOUS_EINSUF;
 
   /* parse configuration file */
 
   else
-    { /* set default host search-root and log-directory paths to null */
-      *def_spath = *def_lpath = '\0';
+    { /* set default host search-root, log-directory paths, and options null */
+      *def_spath = *def_lpath = *def_dsopt = '\0';
 
       /* parse each file entry and insert into PDS host info list */
       lookahead_token = lexan(lookahead_buf);
@@ -239,6 +250,17 @@ int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
 		      free(host_entry->lpath);
 		    }
 
+		  /* set new default PDS start-up option list */
+		  if (*host_entry->dsopt != '\0')
+		    {
+		      free(def_dsopt);
+		      def_dsopt = host_entry->dsopt;
+		    }
+		  else
+		    {
+		      free(host_entry->dsopt);
+		    }
+
 		  free(host_entry->hname);
 		  free((char *)host_entry);
 		}
@@ -264,6 +286,10 @@ int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
 			strcpy(host_entry->lpath, def_lpath);
 		    }
 
+		  /* if start-up option list not defined then set to default */
+		  if (*host_entry->dsopt == '\0')
+		    strcpy(host_entry->dsopt, def_dsopt);
+
 		  /* insert entry into list in lexicographic order, checking
 		   * for duplicate host names.
 		   */
@@ -282,6 +308,7 @@ int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
 		      free(host_entry->hname);
 		      free(host_entry->spath);
 		      free(host_entry->lpath);
+		      free(host_entry->dsopt);
 
 		      free((char *)host_entry);
 
@@ -309,15 +336,24 @@ int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
 	  else if ((*pds_spath = (char **)
 		    malloc((unsigned)((*pds_cnt) * sizeof(char *)))) == NULL)
 	    {
-	      free((char *)pds_hname);
+	      free((char *)*pds_hname);
 	      rcode = PIOUS_EINSUF;
 	    }
 
 	  else if ((*pds_lpath = (char **)
 		    malloc((unsigned)((*pds_cnt) * sizeof(char *)))) == NULL)
 	    {
-	      free((char *)pds_hname);
-	      free((char *)pds_spath);
+	      free((char *)*pds_hname);
+	      free((char *)*pds_spath);
+	      rcode = PIOUS_EINSUF;
+	    }
+
+	  else if ((*pds_dsopt = (char **)
+		    malloc((unsigned)((*pds_cnt) * sizeof(char *)))) == NULL)
+	    {
+	      free((char *)*pds_hname);
+	      free((char *)*pds_spath);
+	      free((char *)*pds_lpath);
 	      rcode = PIOUS_EINSUF;
 	    }
 
@@ -330,6 +366,7 @@ int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
 		  (*pds_hname)[idx] = host_entry->hname;
 		  (*pds_spath)[idx] = host_entry->spath;
 		  (*pds_lpath)[idx] = host_entry->lpath;
+		  (*pds_dsopt)[idx] = host_entry->dsopt;
 		}
 
 	      rcode = PIOUS_OK;
@@ -369,6 +406,9 @@ int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
   if (def_lpath != NULL)
     free(def_lpath);
 
+  if (def_dsopt != NULL)
+    free(def_dsopt);
+
   for (host_entry =  pds_hosts;
        host_entry != NULL;
        host_entry =  host_entry_next)
@@ -381,6 +421,7 @@ int CF_parse(psc_hostfile, pds_cnt, pds_hname, pds_spath, pds_lpath)
 	  free(host_entry->hname);
 	  free(host_entry->spath);
 	  free(host_entry->lpath);
+	  free(host_entry->dsopt);
 	}
 
       free((char *)host_entry);
@@ -509,6 +550,7 @@ static int pds_spec(host_entry)
       (*host_entry)->hname = NULL;
       (*host_entry)->spath = NULL;
       (*host_entry)->lpath = NULL;
+      (*host_entry)->dsopt = NULL;
 
       if (((*host_entry)->hname =
 	   malloc((unsigned)(PSC_INPUTBUF_MAX + 1))) == NULL ||
@@ -517,6 +559,9 @@ static int pds_spec(host_entry)
 	   malloc((unsigned)(PSC_INPUTBUF_MAX + 1))) == NULL ||
 
 	  ((*host_entry)->lpath =
+	   malloc((unsigned)(PSC_INPUTBUF_MAX + 1))) == NULL ||
+
+	  ((*host_entry)->dsopt =
 	   malloc((unsigned)(PSC_INPUTBUF_MAX + 1))) == NULL)
 
 	rcode = PIOUS_EINSUF;
@@ -532,12 +577,13 @@ static int pds_spec(host_entry)
 	  strcpy((*host_entry)->hname, lookahead_buf);
 
 	  *(*host_entry)->spath = *(*host_entry)->lpath = '\0';
+	  *(*host_entry)->dsopt = '\0';
 
 	  /* consume token */
 	  lookahead_token = lexan(lookahead_buf);
 
-	  /* mark log directory and search root paths as not defined */
-	  lp_found = sp_found = FALSE;
+	  /* mark log directory, search root paths, and options not defined */
+	  lp_found = sp_found = op_found = FALSE;
 
 	  /* parse opt_list non-terminal */
 	  rcode = opt_list(*host_entry);
@@ -562,6 +608,9 @@ static int pds_spec(host_entry)
 	if ((*host_entry)->lpath != NULL)
 	  free((*host_entry)->lpath);
 
+	if ((*host_entry)->dsopt != NULL)
+	  free((*host_entry)->dsopt);
+
 	free((char *)(*host_entry));
 
 	*host_entry = NULL;
@@ -677,6 +726,43 @@ static int opt_list(host_entry)
 	}
     }
 
+  /* case: OptsToken */
+
+  else if (lookahead_token == OptsToken)
+    {
+      if (op_found)
+	{ /* redefined PDS start-up option list */
+	  rcode = PIOUS_EINVAL;
+	}
+
+      else
+	{ /* consume token */
+
+	  lookahead_token = lexan(lookahead_buf);
+
+	  /* match IdentToken (option list) */
+
+	  if (lookahead_token == IdentToken)
+	    { /* set PDS start-up option list */
+	      strcpy(host_entry->dsopt, lookahead_buf);
+
+	      /* consume token */
+	      lookahead_token = lexan(lookahead_buf);
+
+	      /* mark option list as defined */
+	      op_found = TRUE;
+
+	      /* parse remainder of opt_list non-terminal */
+	      rcode = opt_list(host_entry);
+	    }
+
+	  else
+	    { /* invalid option list */
+	      rcode = PIOUS_EINVAL;
+	    }
+	}
+    }
+
   /* case: empty production */
 
   else
@@ -751,7 +837,7 @@ static int lexan(tokenval)
   if (nextchar == EOF)
     token = EofToken;
 
-  /* case: LPathToken || SPathToken || IdentToken */
+  /* case: LPathToken || SPathToken || OptsToken || IdentToken */
   else
     { /* put 'nextchar' into buffer and begin checking rest of string */
       *tokenval = nextchar;
@@ -768,6 +854,9 @@ static int lexan(tokenval)
       else if (!strcmp(tokenval, "sp="))
 	token = SPathToken;
 
+      else if (!strcmp(tokenval, "op="))
+	token = OptsToken;
+
       else
 	{ /* read rest of identifier, if applicable */
 	  if (charcnt == 3)
@@ -50,6 +50,7 @@
  *   pds_hname    - PDS host names
  *   pds_spath    - PDS host search root paths
  *   pds_lpath    - PDS host log directory paths
+ *   pds_dsopt    - PDS host start-up option lists
  *
  * Parse the PSC configuration file containing PDS host information entries.
  * PDS host information is returned in a set of corresponding arrays,
@@ -57,7 +58,8 @@
  *
  * Parser guarantees that all host names are unique and non-null, and that
  * all host search root and log directory paths are non-empty with '/' as
- * the first character.
+ * the first character.  A host start-up option list is empty if no options
+ * are specified.
  *
  *
  * NOTE: if the configuration file can not be accessed or contains a syntax
@@ -77,7 +79,8 @@ int CF_parse(char *psc_hostfile,
 	     int *pds_cnt,
 	     char ***pds_hname,
 	     char ***pds_spath,
-	     char ***pds_lpath);
+	     char ***pds_lpath,
+	     char ***pds_dsopt);
 #else
 int CF_parse();
 #endif
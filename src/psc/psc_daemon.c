@@ -327,6 +327,16 @@ static char VersionID[] = "@(#)psc_daemon.c	2.2  28 Apr 1995  Moyer";
 static server_infot def_pds;
 
 
+/* Default Data Server Start-up Options
+ *
+ *   start-up option lists for the default set of PIOUS data servers, as
+ *   supplied via the PSC configuration file; def_pds_dsopt[i] is the
+ *   (possibly empty) option list for host def_pds.hname[i].
+ */
+
+static char **def_pds_dsopt;
+
+
 /* Parafile File Table
  *
  *   Table of open file descriptions for PIOUS parafiles.  The variable
@@ -467,6 +477,8 @@ static int chmoddir_all(server_infot *pds,
 
 static int spawn_servers(server_infot *pds);
 
+static char *dsopt_lookup(char *hname);
+
 static int sptr_zero(dce_srcdestt pdsid,
 		     pds_fhandlet fhandle,
 		     pious_offt offset);
@@ -550,6 +562,8 @@ static int chmoddir_all();
 
 static int spawn_servers();
 
+static char *dsopt_lookup();
+
 static int sptr_zero();
 
 static int request_eq();
@@ -622,7 +636,8 @@ int main(argc, argv)
   else if ((rcode = CF_parse(argv[1],
 			     &def_pds.cnt,
 			     &def_pds.hname,
-			     &def_pds.spath, &def_pds.lpath)) != PIOUS_OK)
+			     &def_pds.spath, &def_pds.lpath,
+			     &def_pds_dsopt)) != PIOUS_OK)
     { /* unable to parse configuration file; syntax/access errors reported */
       if (rcode == PIOUS_EINSUF)
 	fprintf(stderr, "\npious: insufficient memory\n");
@@ -658,7 +673,8 @@ int main(argc, argv)
 
       for (i = 0; i < def_pds.cnt; i++)
 	if (SM_add_pds(def_pds.hname[i],
-		       def_pds.lpath[i], &def_pds.id[i]) != PIOUS_OK)
+		       def_pds.lpath[i],
+		       def_pds_dsopt[i], &def_pds.id[i]) != PIOUS_OK)
 	  { /* unable to spawn data server */
 	    fprintf(stderr, "\npious: unable to spawn data server on %s\n",
 		    def_pds.hname[i]);
@@ -2176,8 +2192,15 @@ static void PSC_config_(clientid, reqop, reqmsg)
   replymsg.rcode                   = PIOUS_OK;
   replymsg.body.config.def_pds_cnt = def_pds.cnt;
 
+  if (SM_list_pds(&replymsg.body.config.pds_cnt,
+		  &replymsg.body.config.pds_id) != PIOUS_OK)
+    replymsg.rcode = PIOUS_EINSUF;
+
   /* reply to client; inability to send is equivalent to a lost message */
   PSCMSG_reply_send(clientid, reqop, &replymsg);
+
+  /* deallocate extraneous reply storage */
+  reply_dealloc(reqop, &replymsg);
 }
 
 
@@ -4530,6 +4553,7 @@ static int spawn_servers(pds)
   for (i = 0; i < pds->cnt && rcode == PIOUS_OK; i++)
     if ((scode = SM_add_pds(pds->hname[i],
 			    pds->lpath[i],
+			    dsopt_lookup(pds->hname[i]),
 			    &pds->id[i])) != PIOUS_OK)
       { /* unable to spawn data server */
 	switch(scode)
@@ -4551,6 +4575,46 @@ static int spawn_servers(pds)
 
 
 
+/*
+ * dsopt_lookup()
+ *
+ * Parameters:
+ *
+ *   hname - PDS host name
+ *
+ * Locate the start-up option list for a data server on host 'hname', as
+ * specified in the PSC configuration file.  Data servers on hosts not
+ * listed in the configuration file are started with default options.
+ *
+ * Returns:
+ *
+ *   char * - PDS start-up option list
+ *   NULL   - no start-up options specified for host
+ */
+
+#ifdef __STDC__
+static char *dsopt_lookup(char *hname)
+#else
+static char *dsopt_lookup(hname)
+     char *hname;
+#endif
+{
+  int i;
+  char *dsopt;
+
+  /* search default data server host names; list is small */
+  dsopt = NULL;
+
+  for (i = 0; i < def_pds.cnt && dsopt == NULL; i++)
+    if (!strcmp(def_pds.hname[i], hname))
+      dsopt = def_pds_dsopt[i];
+
+  return dsopt;
+}
+
+
+
+
 /*
  * sptr_zero()
  *
@@ -5200,6 +5264,15 @@ static void reply_dealloc(replyop, replymsg)
       replymsg->body.open.seg_fhandle = NULL;
       replymsg->body.open.pds_id      = NULL;
       break;
+
+    case PSC_CONFIG_OP:
+      /* deallocate spawned PDS id list (see PSC_config()) */
+      if (replymsg->body.config.pds_id != NULL)
+	{
+	  free((char *)replymsg->body.config.pds_id);
+	  replymsg->body.config.pds_id = NULL;
+	}
+      break;
     }
 }
 
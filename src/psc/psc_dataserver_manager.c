@@ -36,6 +36,7 @@
  * Function Summary:
  *
  *   SM_add_pds();
+ *   SM_list_pds();
  *   SM_reset_pds();
  *   SM_shutdown_pds();
  */
@@ -147,17 +148,19 @@ static void hlist_insert();
 #ifdef __STDC__
 int SM_add_pds(char *pds_hname,
 	       char *pds_lpath,
+	       char *pds_dsopt,
 	       dce_srcdestt *pds_id)
 #else
-int SM_add_pds(pds_hname, pds_lpath, pds_id)
+int SM_add_pds(pds_hname, pds_lpath, pds_dsopt, pds_id)
      char *pds_hname;
      char *pds_lpath;
+     char *pds_dsopt;
      dce_srcdestt *pds_id;
 #endif
 {
   int rcode, scode;
   hinfo_entryt *host_entry;
-  char *pds_argv[2];
+  char *pds_argv[3];
 
   /* spawn PDS on specified host */
 
@@ -171,7 +174,14 @@ int SM_add_pds(pds_hname, pds_lpath, pds_id)
     { /* set PDS arguments */
 
       pds_argv[0] = pds_lpath;
-      pds_argv[1] = NULL;
+
+      if (pds_dsopt != NULL && *pds_dsopt != '\0')
+	{
+	  pds_argv[1] = pds_dsopt;
+	  pds_argv[2] = NULL;
+	}
+      else
+	pds_argv[1] = NULL;
 
       /* allocate a host information record */
 
@@ -232,6 +242,52 @@ int SM_add_pds(pds_hname, pds_lpath, pds_id)
 
 
 
+/*
+ * SM_list_pds() - See psc_dataserver_manager.h for description
+ */
+
+#ifdef __STDC__
+int SM_list_pds(int *pds_cnt,
+		dce_srcdestt **pds_id)
+#else
+int SM_list_pds(pds_cnt, pds_id)
+     int *pds_cnt;
+     dce_srcdestt **pds_id;
+#endif
+{
+  int rcode, i;
+  hinfo_entryt *host_entry;
+
+  rcode    = PIOUS_OK;
+  *pds_cnt = 0;
+  *pds_id  = NULL;
+
+  if (pds_hostcnt > 0)
+    { /* allocate id array and fill from PDS host list */
+      if ((*pds_id = (dce_srcdestt *)
+	   malloc((unsigned)(pds_hostcnt * sizeof(dce_srcdestt)))) == NULL)
+	{ /* unable to allocate storage */
+	  rcode = PIOUS_EINSUF;
+	}
+
+      else
+	{
+	  for (host_entry =  pds_hosts, i = 0;
+	       i < pds_hostcnt;
+	       host_entry =  host_entry->next, i++)
+
+	    (*pds_id)[i] = host_entry->id;
+
+	  *pds_cnt = pds_hostcnt;
+	}
+    }
+
+  return rcode;
+}
+
+
+
+
 /*
  * SM_reset_pds() - See psc_dataserver_manager.h for description
  *
@@ -36,6 +36,7 @@
  * Function Summary:
  *
  *   SM_add_pds();
+ *   SM_list_pds();
  *   SM_reset_pds();
  *   SM_shutdown_pds();
  */
@@ -50,11 +51,15 @@
  *
  *   pds_hname    - PDS host name
  *   pds_lpath    - PDS host log directory path
+ *   pds_dsopt    - PDS start-up option list
  *   pds_id       - PDS message passing id
  *
  * Spawn a PIOUS data server on host 'pds_hname', where the log file
- * directory path is 'pds_lpath'.  The PDS message passing id is returned
- * in 'pds_id'.
+ * directory path is 'pds_lpath' and the start-up option list is 'pds_dsopt'.
+ * The PDS message passing id is returned in 'pds_id'.
+ *
+ * If 'pds_dsopt' is NULL or empty then the data server is started with
+ * default options.
  *
  * NOTE: if a data server was previously spawned on host 'pds_hname',
  *       then the message passing id of that data server is returned;
@@ -73,6 +78,7 @@
 #ifdef __STDC__
 int SM_add_pds(char *pds_hname,
 	       char *pds_lpath,
+	       char *pds_dsopt,
 	       dce_srcdestt *pds_id);
 #else
 int SM_add_pds();
@@ -81,6 +87,38 @@ int SM_add_pds();
 
 
 
+/*
+ * SM_list_pds()
+ *
+ * Parameters:
+ *
+ *   pds_cnt - PDS count
+ *   pds_id  - PDS message passing ids
+ *
+ * Obtain the message passing ids of all PIOUS data servers spawned.  The
+ * number of data servers is returned in 'pds_cnt' and the ids in the
+ * 'pds_cnt' element array 'pds_id', which is allocated via malloc() and
+ * must be deallocated by the caller; if no data servers have been spawned
+ * then 'pds_id' is NULL.
+ *
+ * Returns:
+ *
+ *   PIOUS_OK (0) - data server ids returned without error
+ *   <  0         - error code defined in pious_errno.h; possible codes are:
+ *
+ *       PIOUS_EINSUF - insufficient system resources to complete
+ */
+
+#ifdef __STDC__
+int SM_list_pds(int *pds_cnt,
+		dce_srcdestt **pds_id);
+#else
+int SM_list_pds();
+#endif
+
+
+
+
 /*
  * SM_reset_pds()
  *
@@ -649,8 +649,18 @@ int PSCMSG_reply_send(clientid, replyop, replymsg)
 	  case PSC_CONFIG_OP:
 	    /* determine if data is returned */
 	    if (replymsg->rcode == PIOUS_OK)
-	      tcode = DCE_pkint(&replymsg->body.config.def_pds_cnt, 1);
+	      {
+		if ((tcode = DCE_pkint(&replymsg->body.config.def_pds_cnt,
+				       1)) == PIOUS_OK &&
+
+		    (tcode = DCE_pkint(&replymsg->body.config.pds_cnt,
+				       1)) == PIOUS_OK &&
+
+		    replymsg->body.config.pds_cnt > 0)
 
+		  tcode = DCE_pksrcdestt(replymsg->body.config.pds_id,
+					 replymsg->body.config.pds_cnt);
+	      }
 	    break;
 	  }
 
@@ -798,7 +808,39 @@ int PSCMSG_reply_recv(replyop, replymsg)
 	      case PSC_CONFIG_OP:
 		/* determine if data is returned */
 		if (replymsg->rcode == PIOUS_OK)
-		  tcode = DCE_upkint(&replymsg->body.config.def_pds_cnt, 1);
+		  {
+		    replymsg->body.config.pds_id = NULL;
+
+		    if ((tcode =
+			 DCE_upkint(&replymsg->body.config.def_pds_cnt,
+				    1)) == PIOUS_OK &&
+
+			(tcode =
+			 DCE_upkint(&replymsg->body.config.pds_cnt,
+				    1)) == PIOUS_OK &&
+
+			replymsg->body.config.pds_cnt > 0)
+		      {
+			if (/* allocate storage for the message id array */
+			    (tcode =
+			     ((replymsg->body.config.pds_id = (dce_srcdestt *)
+			       malloc((unsigned)
+				      (replymsg->body.config.pds_cnt *
+				       sizeof(dce_srcdestt)))) == NULL ?
+			      PIOUS_EINSUF : PIOUS_OK)) != PIOUS_OK ||
+
+			    (tcode =
+			     DCE_upksrcdestt(replymsg->body.config.pds_id,
+					     replymsg->body.config.pds_cnt))
+			    != PIOUS_OK)
+			  { /* error; deallocate storage */
+			    if (replymsg->body.config.pds_id != NULL)
+			      free((char *)replymsg->body.config.pds_id);
+
+			    replymsg->body.config.pds_id = NULL;
+			  }
+		      }
+		  }
 		break;
 	      }
 	}
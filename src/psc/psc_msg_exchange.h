@@ -171,6 +171,8 @@ typedef struct {
     /* config reply */
     struct{
       int def_pds_cnt;           /* default PDS count */
+      int pds_cnt;               /* spawned PDS count */
+      dce_srcdestt *pds_id;      /* spawned PDS message passing ids */
     } config;
 
   } body;
@@ -39,6 +39,8 @@
  *   SYS_getpid();
  *   SYS_getuid();
  *   SYS_gettimeofday();
+ *   SYS_arena_alloc();
+ *   SYS_arena_free();
  */
 
 
@@ -49,6 +51,7 @@
 #include <sys/time.h>
 #include <sys/utsname.h>
 #include <sys/socket.h>
+#include <sys/mman.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <unistd.h>
@@ -62,6 +65,21 @@
 
 
 
+/*
+ * Private Declarations - Constants
+ */
+
+/* anonymous mapping flag; older systems only define MAP_ANON */
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/* huge page size in bytes; huge page arenas are a multiple of this size */
+#define HUGEPAGE_SZ  (2L * 1024L * 1024L)
+
+
+
+
 /*
  * Private Variable Definitions
  */
@@ -186,3 +204,78 @@ int SYS_gettimeofday(seconds, useconds)
 
   return rcode;
 }
+
+
+
+
+/*
+ * SYS_arena_alloc() - See psys.h for description.
+ */
+
+#ifdef __STDC__
+char *SYS_arena_alloc(unsigned long nbyte,
+		      int hugepage)
+#else
+char *SYS_arena_alloc(nbyte, hugepage)
+     unsigned long nbyte;
+     int hugepage;
+#endif
+{
+  char *arena;
+
+  /* huge page mappings must be a multiple of the huge page size */
+  if (hugepage)
+    nbyte = ((nbyte + HUGEPAGE_SZ - 1) / HUGEPAGE_SZ) * HUGEPAGE_SZ;
+
+  arena = (char *)MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+  /* attempt to map arena from the huge page pool */
+  if (hugepage)
+    arena = (char *)mmap(NULL, (size_t)nbyte, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+  if (arena == (char *)MAP_FAILED)
+    { /* map arena from regular pages; mmap() results are page aligned */
+      arena = (char *)mmap(NULL, (size_t)nbyte, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+#ifdef MADV_HUGEPAGE
+      /* request transparent huge pages, if available */
+      if (arena != (char *)MAP_FAILED && hugepage)
+	madvise(arena, (size_t)nbyte, MADV_HUGEPAGE);
+#endif
+    }
+
+  if (arena == (char *)MAP_FAILED)
+    arena = NULL;
+
+  return arena;
+}
+
+
+
+
+/*
+ * SYS_arena_free() - See psys.h for description.
+ */
+
+#ifdef __STDC__
+void SYS_arena_free(char *arena,
+		    unsigned long nbyte,
+		    int hugepage)
+#else
+void SYS_arena_free(arena, nbyte, hugepage)
+     char *arena;
+     unsigned long nbyte;
+     int hugepage;
+#endif
+{
+  /* compute mapped size exactly as in SYS_arena_alloc() */
+  if (hugepage)
+    nbyte = ((nbyte + HUGEPAGE_SZ - 1) / HUGEPAGE_SZ) * HUGEPAGE_SZ;
+
+  if (arena != NULL)
+    munmap(arena, (size_t)nbyte);
+}
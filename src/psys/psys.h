@@ -39,6 +39,8 @@
  *   SYS_getpid();
  *   SYS_getuid();
  *   SYS_gettimeofday();
+ *   SYS_arena_alloc();
+ *   SYS_arena_free();
  */
 
 
@@ -140,3 +142,57 @@ int SYS_gettimeofday(long *seconds,
 #else
 int SYS_gettimeofday();
 #endif
+
+
+
+
+/*
+ * SYS_arena_alloc()
+ *
+ * Parameters:
+ *
+ *   nbyte    - arena size in bytes
+ *   hugepage - back arena with huge pages flag
+ *
+ * Allocate a memory arena of 'nbyte' bytes aligned on a page boundary.
+ * If 'hugepage' is TRUE then an attempt is made to back the arena with
+ * huge pages; if huge pages are unavailable then regular pages are used.
+ *
+ * Returns:
+ *
+ *   char * - pointer to arena
+ *   NULL   - insufficient system resources to allocate arena
+ */
+
+#ifdef __STDC__
+char *SYS_arena_alloc(unsigned long nbyte,
+		      int hugepage);
+#else
+char *SYS_arena_alloc();
+#endif
+
+
+
+
+/*
+ * SYS_arena_free()
+ *
+ * Parameters:
+ *
+ *   arena    - arena pointer
+ *   nbyte    - arena size in bytes
+ *   hugepage - back arena with huge pages flag
+ *
+ * Deallocate a memory arena previously allocated by SYS_arena_alloc(),
+ * where 'nbyte' and 'hugepage' are the values specified at allocation.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+void SYS_arena_free(char *arena,
+		    unsigned long nbyte,
+		    int hugepage);
+#else
+void SYS_arena_free();
+#endif
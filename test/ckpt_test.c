@@ -0,0 +1,428 @@
+/*
+ * ckpt_test.c - PDS transaction log checkpoint test
+ *
+ * Links the PDS daemon standalone, with its message exchange replaced by a
+ * scripted sequence of client requests, and checks that the transaction
+ * log is checkpointed such that its size remains bounded.
+ *
+ * Phase I : client 1 runs stable transactions of one write each; the log
+ *           must be checkpointed whenever it reaches the checkpoint size.
+ *
+ * Phase II: client 2 prepares a transaction and does not commit it, so
+ *           that the log can not be checkpointed; client 1 runs stable
+ *           transactions until a prepare votes to abort, which must occur
+ *           once the log reaches four times the checkpoint size.  client 2
+ *           then commits, after which the log must be checkpointed and
+ *           client 1 transactions prepare again.
+ *
+ * Log and data files are placed in directory 'dir', which must exist.
+ *
+ * Usage: ckpt_test dir
+ */
+
+
+#ifdef __STDC__
+#include <stddef.h>
+#include <stdlib.h>
+#else
+#include "nonansi.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gpmacro.h"
+
+#include "pious_types.h"
+#include "pious_errno.h"
+#include "pious_std.h"
+
+#include "pds_transidt.h"
+#include "pds_fhandlet.h"
+
+#include "pdce_srcdestt.h"
+
+#include "pds_sstorage_manager.h"
+#include "pds_cache_manager.h"
+#include "pds_recovery_manager.h"
+#include "pds.h"
+#include "pds_msg_exchange.h"
+
+
+
+#define CKPTSZ      65536   /* checkpoint size; see options in main() */
+#define WRITESZ      4096   /* bytes written per transaction */
+#define TRANSCNT      256   /* phase I transaction count */
+#define TRANSMAX     1024   /* phase II transaction count limit */
+#define BLKCNT         64   /* client 1 data file size in write blocks */
+#define HELDID    1000000   /* transaction number of client 2 */
+#define FILENAME "ckpt_test.dat"
+
+/* test phase, and client 1 transaction operation next requested */
+#define PHASE_I      1
+#define PHASE_II     2
+#define PHASE_III    3
+
+#define OP_WRITE     0
+#define OP_PREPARE   1
+#define OP_COMMIT    2
+
+
+#ifdef __STDC__
+int pds_main(int argc, char **argv);
+static void test_transop(pdsmsg_reqt *reqmsg, long trans, int transsn);
+static void test_write(pdsmsg_reqt *reqmsg, long trans, long blk);
+static void test_fail(char *msg);
+#else
+int pds_main();
+static void test_transop();
+static void test_write();
+static void test_fail();
+#endif
+
+
+static char test_path[1024];
+static pds_fhandlet test_fhandle;
+static int test_init;
+
+/* script state */
+static int phase = PHASE_I;
+static int op    = OP_WRITE;
+static long trans;              /* client 1 transaction number */
+static long trans_iii;          /* client 1 transaction starting phase III */
+static int held;                /* client 2 transaction requests made */
+static int voted_abort;         /* client 1 prepare voted to abort */
+static pious_offt logmax;       /* maximum log size observed in phase I */
+
+/* result of last prepare reply received by each client */
+static long prepare_rcode[3];
+
+
+
+#ifdef __STDC__
+int main(int argc, char **argv)
+#else
+int main(argc, argv)
+     int argc;
+     char **argv;
+#endif
+{
+  static char options[] = "gcwait=0,ckptsz=64k";
+  char *pds_argv[4];
+
+  if (argc != 2 ||
+      strlen(argv[1]) + sizeof(FILENAME) + 1 > sizeof(test_path))
+    {
+      printf("usage: ckpt_test dir\n");
+      exit(1);
+    }
+
+  sprintf(test_path, "%s/%s", argv[1], FILENAME);
+
+  pds_argv[0] = "pds_daemon";
+  pds_argv[1] = argv[1];
+  pds_argv[2] = options;
+  pds_argv[3] = NULL;
+
+  return pds_main(3, pds_argv);
+}
+
+
+
+
+/*
+ * PDSMSG_req_recv() - See pds_msg_exchange.h for description
+ *
+ * Returns the next request of the test script, checking the results of
+ * prior requests; once the script completes, reports and exits.
+ */
+
+#ifdef __STDC__
+int PDSMSG_req_recv(dce_srcdestt *clientid,
+		    int *reqop,
+		    pdsmsg_reqt *reqmsg,
+		    int timeout)
+#else
+int PDSMSG_req_recv(clientid, reqop, reqmsg, timeout)
+     dce_srcdestt *clientid;
+     int *reqop;
+     pdsmsg_reqt *reqmsg;
+     int timeout;
+#endif
+{
+  /* create data file on first request */
+  if (!test_init)
+    {
+      if (SS_lookup(test_path, &test_fhandle, PIOUS_CREAT | PIOUS_TRUNC,
+		    (pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR)) != PIOUS_OK)
+	test_fail("unable to create data file");
+
+      test_init = TRUE;
+    }
+
+  /* phase I: log size must remain below the checkpoint size, allowing for
+   * records of the transaction that reaches it
+   */
+  if (phase == PHASE_I && op == OP_WRITE)
+    {
+      logmax = Max(logmax, RM_logsize());
+
+      if (trans == TRANSCNT)
+	{
+	  if (logmax >= CKPTSZ + 2 * WRITESZ)
+	    test_fail("log not checkpointed at checkpoint size");
+
+	  phase = PHASE_II;
+	}
+    }
+
+  /* client 1 prepare replied; a vote to abort is expected only in phase II
+   * while client 2 is prepared, once the log reaches four times the
+   * checkpoint size.  the transaction is then complete.
+   */
+  if (op == OP_COMMIT && prepare_rcode[1] != PIOUS_OK)
+    {
+      if (phase != PHASE_II || held != 2 || prepare_rcode[1] != PIOUS_EABORT)
+	test_fail("unexpected client 1 prepare result");
+
+      if (RM_logsize() < 4 * CKPTSZ)
+	test_fail("prepare voted to abort below log size limit");
+
+      voted_abort = TRUE;
+      op          = OP_WRITE;
+      trans++;
+    }
+
+  /* phase II: client 2 writes and prepares, then commits once a client 1
+   * prepare votes to abort
+   */
+  if (phase == PHASE_II && (held < 2 || (held == 2 && voted_abort)))
+    {
+      *clientid = 2;
+
+      switch (held++)
+	{
+	case 0:
+	  *reqop = PDS_WRITE_OP;
+	  test_write(reqmsg, (long)HELDID, (long)BLKCNT);
+	  break;
+	case 1:
+	  *reqop = PDS_PREPARE_OP;
+	  test_transop(reqmsg, (long)HELDID, 1);
+	  break;
+	default:
+	  if (prepare_rcode[2] != PIOUS_OK)
+	    test_fail("client 2 prepare failed");
+
+	  *reqop = PDS_COMMIT_OP;
+	  test_transop(reqmsg, (long)HELDID, 2);
+	  break;
+	}
+
+      return PIOUS_OK;
+    }
+
+  if (phase == PHASE_II && op == OP_WRITE)
+    {
+      if (held == 3)
+	{ /* client 2 committed; log must now be checkpointed */
+	  if (RM_logsize() >= CKPTSZ)
+	    test_fail("log not checkpointed once no transaction prepared");
+
+	  phase     = PHASE_III;
+	  trans_iii = trans;
+	}
+
+      else if (trans == TRANSCNT + TRANSMAX)
+	test_fail("prepare never voted to abort at log size limit");
+    }
+
+  /* phase III: a client 1 transaction must prepare and commit */
+  if (phase == PHASE_III && op == OP_WRITE && trans > trans_iii)
+    {
+      printf("ckpt_test: maximum log size %ld bytes in phase I; "
+	     "checkpoint size %d\n", (long)logmax, CKPTSZ);
+      printf("ckpt_test: client 1 prepare voted to abort at log size limit\n");
+      printf("ckpt_test: PASSED\n");
+
+      SS_unlink(test_path);
+      exit(0);
+    }
+
+  *clientid = 1;
+
+  switch (op)
+    {
+    case OP_WRITE:
+      *reqop = PDS_WRITE_OP;
+      test_write(reqmsg, trans, trans % BLKCNT);
+      op = OP_PREPARE;
+      break;
+    case OP_PREPARE:
+      *reqop = PDS_PREPARE_OP;
+      test_transop(reqmsg, trans, 1);
+      op = OP_COMMIT;
+      break;
+    case OP_COMMIT:
+      *reqop = PDS_COMMIT_OP;
+      test_transop(reqmsg, trans, 2);
+      op = OP_WRITE;
+      trans++;
+      break;
+    }
+
+  return PIOUS_OK;
+}
+
+
+
+
+/*
+ * PDSMSG_reply_send() - See pds_msg_exchange.h for description
+ *
+ * Records the result of prepare replies; other operations must succeed.
+ */
+
+#ifdef __STDC__
+int PDSMSG_reply_send(dce_srcdestt clientid,
+		      int replyop,
+		      pdsmsg_replyt *replymsg)
+#else
+int PDSMSG_reply_send(clientid, replyop, replymsg)
+     dce_srcdestt clientid;
+     int replyop;
+     pdsmsg_replyt *replymsg;
+#endif
+{
+  if (clientid < 1 || clientid > 2)
+    test_fail("reply to unknown client");
+
+  if (replyop == PDS_PREPARE_OP)
+    prepare_rcode[clientid] = replymsg->TransopHead.rcode;
+
+  else if (replymsg->TransopHead.rcode < 0)
+    test_fail("write or commit failed");
+
+  return PIOUS_OK;
+}
+
+
+
+
+/*
+ * DCE_exit() - See pdce.h for description
+ */
+
+#ifdef __STDC__
+int DCE_exit(void)
+#else
+int DCE_exit()
+#endif
+{
+  return PIOUS_OK;
+}
+
+
+
+
+/*
+ * test_transop()
+ *
+ * Parameters:
+ *
+ *   reqmsg  - request message
+ *   trans   - transaction number
+ *   transsn - transaction sequence number
+ *
+ * Initialize transaction operation request 'reqmsg' header for transaction
+ * 'trans' with sequence number 'transsn'.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_transop(pdsmsg_reqt *reqmsg,
+			 long trans,
+			 int transsn)
+#else
+static void test_transop(reqmsg, trans, transsn)
+     pdsmsg_reqt *reqmsg;
+     long trans;
+     int transsn;
+#endif
+{
+  reqmsg->TransopHead.transid.hostid = 1;
+  reqmsg->TransopHead.transid.procid = trans;
+  reqmsg->TransopHead.transid.sec    = 0;
+  reqmsg->TransopHead.transid.usec   = 0;
+  reqmsg->TransopHead.transsn        = transsn;
+}
+
+
+
+
+/*
+ * test_write()
+ *
+ * Parameters:
+ *
+ *   reqmsg - request message
+ *   trans  - transaction number
+ *   blk    - data file block number
+ *
+ * Initialize 'reqmsg' as the write request beginning transaction 'trans',
+ * writing WRITESZ bytes to block 'blk' of the data file.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_write(pdsmsg_reqt *reqmsg,
+		       long trans,
+		       long blk)
+#else
+static void test_write(reqmsg, trans, blk)
+     pdsmsg_reqt *reqmsg;
+     long trans;
+     long blk;
+#endif
+{
+  test_transop(reqmsg, trans, 0);
+
+  if ((reqmsg->WriteBody.buf = malloc((unsigned)WRITESZ)) == NULL)
+    test_fail("insufficient memory");
+
+  memset(reqmsg->WriteBody.buf, (int)trans, WRITESZ);
+
+  reqmsg->WriteBody.fhandle = test_fhandle;
+  reqmsg->WriteBody.offset  = (pious_offt)(blk * WRITESZ);
+  reqmsg->WriteBody.nbyte   = (pious_sizet)WRITESZ;
+}
+
+
+
+
+/*
+ * test_fail()
+ *
+ * Parameters:
+ *
+ *   msg - failure description
+ *
+ * Report test failure described by 'msg' and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_fail(char *msg)
+#else
+static void test_fail(msg)
+     char *msg;
+#endif
+{
+  printf("ckpt_test: %s (transaction %ld, log size %ld)\n",
+	 msg, trans, (long)RM_logsize());
+  printf("ckpt_test: FAILED\n");
+  exit(1);
+}
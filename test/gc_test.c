@@ -0,0 +1,326 @@
+/*
+ * gc_test.c - PDS group commit abort test
+ *
+ * Links the PDS daemon standalone, with its message exchange replaced by a
+ * scripted sequence of client requests, and checks that a transaction that
+ * aborts while its prepare reply is deferred for group commit is removed
+ * from the group: the client receives the abort reply but no prepare reply,
+ * and a transaction that prepares subsequently is replied to as usual.
+ *
+ * Transaction 1 prepares while transaction 2 is active, so that its prepare
+ * reply is deferred until the group commit window expires; transaction 1
+ * then aborts, and transaction 2 prepares.
+ *
+ * Log and data files are placed in directory 'dir', which must exist.
+ *
+ * Usage: gc_test dir
+ */
+
+
+#ifdef __STDC__
+#include <stddef.h>
+#include <stdlib.h>
+#else
+#include "nonansi.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include "gpmacro.h"
+
+#include "pious_types.h"
+#include "pious_errno.h"
+#include "pious_std.h"
+
+#include "pds_transidt.h"
+#include "pds_fhandlet.h"
+
+#include "pdce_srcdestt.h"
+
+#include "pds_sstorage_manager.h"
+#include "pds_cache_manager.h"
+#include "pds.h"
+#include "pds_msg_exchange.h"
+
+
+
+#define CLIENTCNT       2   /* client count; client i runs transaction i */
+#define WRITESZ       100   /* bytes written per transaction */
+#define FILENAME "gc_test.dat"
+
+
+#ifdef __STDC__
+int pds_main(int argc, char **argv);
+static void test_transop(pdsmsg_reqt *reqmsg, int trans, int transsn);
+static void test_check(void);
+#else
+int pds_main();
+static void test_transop();
+static void test_check();
+#endif
+
+
+static char test_path[1024];
+static pds_fhandlet test_fhandle;
+static int test_step;
+
+/* replies received by each client, indexed by client id */
+static int write_cnt[CLIENTCNT + 1];
+static int prepare_cnt[CLIENTCNT + 1];
+static int abort_cnt[CLIENTCNT + 1];
+static long prepare_rcode[CLIENTCNT + 1];
+
+
+
+#ifdef __STDC__
+int main(int argc, char **argv)
+#else
+int main(argc, argv)
+     int argc;
+     char **argv;
+#endif
+{
+  static char options[] = "gcwait=1000";
+  char *pds_argv[4];
+
+  if (argc != 2 || strlen(argv[1]) + sizeof(FILENAME) + 1 > sizeof(test_path))
+    {
+      printf("usage: gc_test dir\n");
+      exit(1);
+    }
+
+  sprintf(test_path, "%s/%s", argv[1], FILENAME);
+
+  /* run PDS daemon with a group commit window longer than the test */
+  pds_argv[0] = "pds_daemon";
+  pds_argv[1] = argv[1];
+  pds_argv[2] = options;
+  pds_argv[3] = NULL;
+
+  return pds_main(3, pds_argv);
+}
+
+
+
+
+/*
+ * PDSMSG_req_recv() - See pds_msg_exchange.h for description
+ *
+ * Returns the next request of the test script; once the script completes,
+ * checks replies received and exits.
+ */
+
+#ifdef __STDC__
+int PDSMSG_req_recv(dce_srcdestt *clientid,
+		    int *reqop,
+		    pdsmsg_reqt *reqmsg,
+		    int timeout)
+#else
+int PDSMSG_req_recv(clientid, reqop, reqmsg, timeout)
+     dce_srcdestt *clientid;
+     int *reqop;
+     pdsmsg_reqt *reqmsg;
+     int timeout;
+#endif
+{
+  int rcode;
+
+  rcode = PIOUS_OK;
+
+  switch (test_step++)
+    {
+    case 0:
+    case 1:
+      /* transactions 1 and 2 write; create data file on first request */
+      if (test_step == 1 &&
+	  SS_lookup(test_path, &test_fhandle, PIOUS_CREAT | PIOUS_TRUNC,
+		    (pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR)) != PIOUS_OK)
+	{
+	  printf("gc_test: unable to create data file %s\n", test_path);
+	  exit(1);
+	}
+
+      *clientid = test_step;
+      *reqop    = PDS_WRITE_OP;
+
+      test_transop(reqmsg, test_step, 0);
+
+      if ((reqmsg->WriteBody.buf = malloc((unsigned)WRITESZ)) == NULL)
+	{
+	  printf("gc_test: insufficient memory\n");
+	  exit(1);
+	}
+
+      memset(reqmsg->WriteBody.buf, 'a' + test_step, WRITESZ);
+
+      reqmsg->WriteBody.fhandle = test_fhandle;
+      reqmsg->WriteBody.offset  = (pious_offt)(test_step * WRITESZ);
+      reqmsg->WriteBody.nbyte   = (pious_sizet)WRITESZ;
+      break;
+
+    case 2:
+      /* transaction 1 prepares; reply deferred as transaction 2 is active */
+      *clientid = 1;
+      *reqop    = PDS_PREPARE_OP;
+
+      test_transop(reqmsg, 1, 1);
+      break;
+
+    case 3:
+      /* transaction 1 aborts before its log records are forced */
+      *clientid = 1;
+      *reqop    = PDS_ABORT_OP;
+
+      test_transop(reqmsg, 1, 2);
+      break;
+
+    case 4:
+      /* transaction 2 prepares; as no transaction is active, group forced */
+      *clientid = 2;
+      *reqop    = PDS_PREPARE_OP;
+
+      test_transop(reqmsg, 2, 1);
+      break;
+
+    case 5:
+      /* time-out, as for an expired group commit window */
+      rcode = PIOUS_ETIMEOUT;
+      break;
+
+    default:
+      test_check();
+    }
+
+  return rcode;
+}
+
+
+
+
+/*
+ * PDSMSG_reply_send() - See pds_msg_exchange.h for description
+ *
+ * Records the reply for checking by test_check().
+ */
+
+#ifdef __STDC__
+int PDSMSG_reply_send(dce_srcdestt clientid,
+		      int replyop,
+		      pdsmsg_replyt *replymsg)
+#else
+int PDSMSG_reply_send(clientid, replyop, replymsg)
+     dce_srcdestt clientid;
+     int replyop;
+     pdsmsg_replyt *replymsg;
+#endif
+{
+  if (clientid < 1 || clientid > CLIENTCNT)
+    {
+      printf("gc_test: reply to unknown client %d\n", (int)clientid);
+      exit(1);
+    }
+
+  switch (replyop)
+    {
+    case PDS_WRITE_OP:
+      write_cnt[clientid]++;
+      break;
+    case PDS_PREPARE_OP:
+      prepare_cnt[clientid]++;
+      prepare_rcode[clientid] = replymsg->TransopHead.rcode;
+      break;
+    case PDS_ABORT_OP:
+      abort_cnt[clientid]++;
+      break;
+    }
+
+  return PIOUS_OK;
+}
+
+
+
+
+/*
+ * DCE_exit() - See pdce.h for description
+ */
+
+#ifdef __STDC__
+int DCE_exit(void)
+#else
+int DCE_exit()
+#endif
+{
+  return PIOUS_OK;
+}
+
+
+
+
+/*
+ * test_transop()
+ *
+ * Parameters:
+ *
+ *   reqmsg  - request message
+ *   trans   - transaction number
+ *   transsn - transaction sequence number
+ *
+ * Initialize transaction operation request 'reqmsg' header for transaction
+ * 'trans' with sequence number 'transsn'.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_transop(pdsmsg_reqt *reqmsg,
+			 int trans,
+			 int transsn)
+#else
+static void test_transop(reqmsg, trans, transsn)
+     pdsmsg_reqt *reqmsg;
+     int trans;
+     int transsn;
+#endif
+{
+  reqmsg->TransopHead.transid.hostid = 1;
+  reqmsg->TransopHead.transid.procid = trans;
+  reqmsg->TransopHead.transid.sec    = 0;
+  reqmsg->TransopHead.transid.usec   = 0;
+  reqmsg->TransopHead.transsn        = transsn;
+}
+
+
+
+
+/*
+ * test_check()
+ *
+ * Parameters:
+ *
+ * Check replies received against those expected, report, and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_check(void)
+#else
+static void test_check()
+#endif
+{
+  int pass;
+
+  pass = (write_cnt[1] == 1 && prepare_cnt[1] == 0 && abort_cnt[1] == 1 &&
+	  write_cnt[2] == 1 && prepare_cnt[2] == 1 &&
+	  prepare_rcode[2] == PIOUS_OK);
+
+  printf("gc_test: transaction 1 - %d write, %d prepare, %d abort replies\n",
+	 write_cnt[1], prepare_cnt[1], abort_cnt[1]);
+  printf("gc_test: transaction 2 - %d write, %d prepare replies (%ld)\n",
+	 write_cnt[2], prepare_cnt[2], prepare_rcode[2]);
+  printf("gc_test: %s\n", (pass ? "PASSED" : "FAILED"));
+
+  SS_unlink(test_path);
+  exit(pass ? 0 : 1);
+}
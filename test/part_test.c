@@ -0,0 +1,780 @@
+/*
+ * part_test.c - PDS cache manager partition reservation test
+ *
+ * Links the PDS cache and stable storage managers standalone and checks
+ * that the reserved share of a cache partition survives a scan of a file
+ * in another partition, in both the cache proper and the large data block
+ * slab, and that the admission filter applies to large data blocks.
+ *
+ * Test I : a file in the default partition is read twice, such that its
+ *          data blocks fill the protected segment, and a file in partition
+ *          1, reserved and limited to the size of the probationary
+ *          segment, is read once to fill that segment.  a scan of a
+ *          second file in the default partition must then replace data
+ *          blocks of the protected segment rather than those of partition
+ *          1, all of which must remain cached.
+ *
+ * Test II: a file in partition 1, reserved the entire cache, is read to
+ *          fill both segments of the cache.  a scan of a file in the
+ *          default partition, with volatile writes under the write-back
+ *          policy, must be read and written without caching, and return
+ *          the data written, while all data blocks of partition 1 remain
+ *          cached.
+ *
+ * Test III: as for test I, but in the large data block slab; a file of the
+ *          large class in partition 1, reserved and limited to half the
+ *          slab, is read to fill its share.  a scan of a second large
+ *          class file in the default partition must not replace large data
+ *          blocks of partition 1, and further reads of the file in
+ *          partition 1 must replace its own large data blocks.
+ *
+ * Test IV: a file of the large class is read three times to fill half the
+ *          large data block slab.  a scan of a second large class file of
+ *          four times the slab size, with the admission filter on, must
+ *          replace at most one of its large data blocks.
+ *
+ * Test V : more files than the initial file state pool holds are each
+ *          assigned to partition 1, reserved half the cache; the data
+ *          blocks of the files least recently assigned must be cached in
+ *          partition 1 when read.
+ *
+ * Data files are placed in directory 'dir', which must exist.
+ *
+ * Usage: part_test dir
+ */
+
+
+#ifdef __STDC__
+#include <stddef.h>
+#include <stdlib.h>
+#else
+#include "nonansi.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gpmacro.h"
+
+#include "pious_types.h"
+#include "pious_errno.h"
+#include "pious_std.h"
+
+#include "pds_fhandlet.h"
+#include "pds_sstorage_manager.h"
+#include "pds_cache_manager.h"
+
+
+
+#define CACHESZ        64   /* cache size in data blocks */
+#define DBLKSZ       4096   /* data block size */
+#define SCANBLKS     1024   /* data blocks scanned */
+#define LGCNT           8   /* large data block count */
+#define LGBLKSZ     16384   /* large data block size */
+#define LGSCANBLKS     32   /* large data blocks scanned with admission */
+#define NFILES        768   /* files assigned to partition 1 in test V */
+
+#define RESNAME  "part_test.res"
+#define HOTNAME  "part_test.hot"
+#define SCANNAME "part_test.scan"
+#define FILENAME "part_test.f"
+
+
+#ifdef __STDC__
+static void test_protected(pds_fhandlet res, pds_fhandlet hot,
+			   pds_fhandlet scan);
+static void test_bypass(pds_fhandlet res, pds_fhandlet scan);
+static void test_large(pds_fhandlet res, pds_fhandlet scan);
+static void test_admit(pds_fhandlet hot, pds_fhandlet scan);
+static void test_many(pds_fhandlet *fhandle);
+static void test_init(int prot_pct, int part_min, int part_max,
+		      int writeback, long lg_cnt, int admit);
+static void test_fill(pds_fhandlet fhandle, long nblk);
+static void test_read(pds_fhandlet fhandle, long blk, int fill);
+static void test_lread(pds_fhandlet fhandle, long blk);
+static void test_fail(char *test, char *msg);
+#else
+static void test_protected();
+static void test_bypass();
+static void test_large();
+static void test_admit();
+static void test_many();
+static void test_init();
+static void test_fill();
+static void test_read();
+static void test_lread();
+static void test_fail();
+#endif
+
+
+static char test_buf[LGBLKSZ];
+static pds_fhandlet test_fh[NFILES];
+
+
+
+#ifdef __STDC__
+int main(int argc, char **argv)
+#else
+int main(argc, argv)
+     int argc;
+     char **argv;
+#endif
+{
+  int status, t, i;
+  char respath[1024], hotpath[1024], scanpath[1024], fpath[1024];
+  pds_fhandlet res, hot, scan;
+
+  if (argc != 2 || strlen(argv[1]) > 1000)
+    {
+      printf("usage: part_test dir\n");
+      exit(1);
+    }
+
+  /* initialize stable storage and create data files */
+  sprintf(respath, "%s/%s", argv[1], RESNAME);
+  sprintf(hotpath, "%s/%s", argv[1], HOTNAME);
+  sprintf(scanpath, "%s/%s", argv[1], SCANNAME);
+
+  if (SS_init(argv[1]) != PIOUS_OK ||
+      SS_lookup(respath, &res, PIOUS_CREAT | PIOUS_TRUNC,
+		(pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR)) != PIOUS_OK ||
+      SS_lookup(hotpath, &hot, PIOUS_CREAT | PIOUS_TRUNC,
+		(pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR)) != PIOUS_OK ||
+      SS_lookup(scanpath, &scan, PIOUS_CREAT | PIOUS_TRUNC,
+		(pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR)) != PIOUS_OK)
+    {
+      printf("part_test: unable to initialize stable storage in %s\n",
+	     argv[1]);
+      exit(1);
+    }
+
+  for (i = 0; i < NFILES; i++)
+    {
+      sprintf(fpath, "%s/%s%d", argv[1], FILENAME, i);
+
+      if (SS_lookup(fpath, &test_fh[i], PIOUS_CREAT | PIOUS_TRUNC,
+		    (pious_modet)(PIOUS_IRUSR | PIOUS_IWUSR)) != PIOUS_OK)
+	{
+	  printf("part_test: unable to create data file %s\n", fpath);
+	  exit(1);
+	}
+
+      test_fill(test_fh[i], 1L);
+    }
+
+  test_fill(res, (long)CACHESZ);
+  test_fill(hot, (long)CACHESZ);
+  test_fill(scan, (long)SCANBLKS);
+
+  /* run each test in a child process with its own cache */
+  for (t = 0; t < 5; t++)
+    {
+      fflush(stdout);
+
+      if (fork() == 0)
+	{
+	  if (t == 0)
+	    test_protected(res, hot, scan);
+	  else if (t == 1)
+	    test_bypass(res, scan);
+	  else if (t == 2)
+	    test_large(res, scan);
+	  else if (t == 3)
+	    test_admit(hot, scan);
+	  else
+	    test_many(test_fh);
+	}
+
+      if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+	{
+	  printf("part_test: FAILED\n");
+	  exit(1);
+	}
+    }
+
+  SS_unlink(respath);
+  SS_unlink(hotpath);
+  SS_unlink(scanpath);
+
+  for (i = 0; i < NFILES; i++)
+    {
+      sprintf(fpath, "%s/%s%d", argv[1], FILENAME, i);
+      SS_unlink(fpath);
+    }
+
+  printf("part_test: PASSED\n");
+  exit(0);
+}
+
+
+
+
+/*
+ * test_protected()
+ *
+ * Parameters:
+ *
+ *   res  - partition 1 file handle
+ *   hot  - default partition file handle read twice
+ *   scan - default partition file handle scanned
+ *
+ * Run test I, report result, and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_protected(pds_fhandlet res,
+			   pds_fhandlet hot,
+			   pds_fhandlet scan)
+#else
+static void test_protected(res, hot, scan)
+     pds_fhandlet res;
+     pds_fhandlet hot;
+     pds_fhandlet scan;
+#endif
+{
+  long i, nres, miss;
+  struct CM_stats stats;
+
+  /* protected and probationary segments, and partition 1, of equal size */
+  test_init(50, 50, 50, FALSE, 0L, FALSE);
+
+  nres = CACHESZ / 2;
+
+  CM_fpartition(res, 1);
+
+  for (i = 0; i < nres; i++)
+    test_read(hot, i, 'c');
+
+  for (i = 0; i < nres; i++)
+    test_read(hot, i, 'c');
+
+  for (i = 0; i < nres; i++)
+    test_read(res, i, 'c');
+
+  CM_stats(&stats);
+
+  if (stats.part_nblk[1] != nres)
+    test_fail("I", "partition 1 not filled");
+
+  /* scan; partition 1 is at its reserved share throughout */
+  for (i = 0; i < SCANBLKS; i++)
+    test_read(scan, i, 'c');
+
+  CM_stats(&stats);
+
+  if (stats.part_nblk[1] != nres)
+    test_fail("I", "partition 1 data blocks replaced by scan");
+
+  /* data blocks of partition 1 must all hit */
+  miss = stats.miss;
+
+  for (i = 0; i < nres; i++)
+    test_read(res, i, 'c');
+
+  CM_stats(&stats);
+
+  if (stats.miss != miss)
+    test_fail("I", "partition 1 data blocks missed after scan");
+
+  printf("part_test: test I   partition 1 %ld of %ld blocks cached "
+	 "after %d block scan\n", stats.part_nblk[1], nres, SCANBLKS);
+
+  exit(0);
+}
+
+
+
+
+/*
+ * test_bypass()
+ *
+ * Parameters:
+ *
+ *   res  - partition 1 file handle
+ *   scan - default partition file handle scanned
+ *
+ * Run test II, report result, and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_bypass(pds_fhandlet res,
+			pds_fhandlet scan)
+#else
+static void test_bypass(res, scan)
+     pds_fhandlet res;
+     pds_fhandlet scan;
+#endif
+{
+  long i;
+  struct CM_stats stats;
+
+  /* partition 1 reserved the entire cache */
+  test_init(50, 100, 100, TRUE, 0L, FALSE);
+
+  CM_fpartition(res, 1);
+
+  for (i = 0; i < CACHESZ / 2; i++)
+    test_read(res, i, 'c');
+
+  for (i = 0; i < CACHESZ; i++)
+    test_read(res, i, 'c');
+
+  CM_stats(&stats);
+
+  if (stats.part_nblk[1] != CACHESZ)
+    test_fail("II", "partition 1 not filled");
+
+  /* scan; write each data block, then read it back */
+  memset(test_buf, 'w', DBLKSZ);
+
+  for (i = 0; i < SCANBLKS; i++)
+    {
+      if (CM_write(scan, (pious_offt)i * DBLKSZ, (pious_sizet)DBLKSZ,
+		   test_buf, PIOUS_VOLATILE) != PIOUS_OK)
+	test_fail("II", "write failed");
+
+      test_read(scan, i, 'w');
+    }
+
+  CM_stats(&stats);
+
+  if (stats.part_nblk[1] != CACHESZ)
+    test_fail("II", "partition 1 data blocks replaced by scan");
+
+  if (stats.part_nblk[0] != 0 || stats.part_bypass == 0)
+    test_fail("II", "default partition data blocks cached");
+
+  printf("part_test: test II  partition 1 %ld of %d blocks cached, "
+	 "%lu blocks not cached\n", stats.part_nblk[1], CACHESZ,
+	 stats.part_bypass);
+
+  exit(0);
+}
+
+
+
+
+/*
+ * test_large()
+ *
+ * Parameters:
+ *
+ *   res  - partition 1 file handle
+ *   scan - default partition file handle scanned
+ *
+ * Run test III, report result, and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_large(pds_fhandlet res,
+		       pds_fhandlet scan)
+#else
+static void test_large(res, scan)
+     pds_fhandlet res;
+     pds_fhandlet scan;
+#endif
+{
+  long i, nres;
+  unsigned long loaded;
+  struct CM_stats stats;
+
+  /* partition 1 reserved and limited to half the large data block slab;
+   * scan file re-written, as written by test II
+   */
+  test_init(50, 50, 50, FALSE, (long)LGCNT, FALSE);
+  test_fill(scan, (long)SCANBLKS);
+
+  nres = LGCNT / 2;
+
+  CM_fpartition(res, 1);
+
+  if (CM_fclass(res, TRUE) != PIOUS_OK || CM_fclass(scan, TRUE) != PIOUS_OK)
+    test_fail("III", "class assignment failed");
+
+  for (i = 0; i < nres; i++)
+    test_lread(res, i);
+
+  CM_stats(&stats);
+
+  if (stats.part_lgnblk[1] != nres)
+    test_fail("III", "partition 1 not filled");
+
+  /* scan; partition 1 is at its reserved share throughout */
+  for (i = 0; i < (SCANBLKS * DBLKSZ) / LGBLKSZ; i++)
+    test_lread(scan, i);
+
+  CM_stats(&stats);
+
+  if (stats.part_lgnblk[1] != nres)
+    test_fail("III", "partition 1 large data blocks replaced by scan");
+
+  /* large data blocks of partition 1 must all hit */
+  loaded = stats.lg_blks;
+
+  for (i = 0; i < nres; i++)
+    test_lread(res, i);
+
+  CM_stats(&stats);
+
+  if (stats.lg_blks != loaded)
+    test_fail("III", "partition 1 large data blocks missed after scan");
+
+  /* partition 1 at its maximum share replaces its own large data blocks */
+  for (i = nres; i < 2 * nres; i++)
+    test_lread(res, i);
+
+  CM_stats(&stats);
+
+  if (stats.part_lgnblk[1] != nres || stats.part_lgnblk[0] != LGCNT - nres)
+    test_fail("III", "partition 1 exceeded maximum share");
+
+  printf("part_test: test III partition 1 %ld of %ld large blocks cached "
+	 "after %d large block scan\n", stats.part_lgnblk[1], nres,
+	 (SCANBLKS * DBLKSZ) / LGBLKSZ);
+
+  exit(0);
+}
+
+
+
+
+/*
+ * test_admit()
+ *
+ * Parameters:
+ *
+ *   hot  - file handle read three times
+ *   scan - file handle scanned
+ *
+ * Run test IV, report result, and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_admit(pds_fhandlet hot,
+		       pds_fhandlet scan)
+#else
+static void test_admit(hot, scan)
+     pds_fhandlet hot;
+     pds_fhandlet scan;
+#endif
+{
+  long i, j, nhot;
+  unsigned long loaded;
+  struct CM_stats stats;
+
+  /* admission filter on, partition 1 unused; scan file re-written, as
+   * written by test II
+   */
+  test_init(50, 0, 100, FALSE, (long)LGCNT, TRUE);
+  test_fill(scan, (long)SCANBLKS);
+
+  nhot = LGCNT / 2;
+
+  if (CM_fclass(hot, TRUE) != PIOUS_OK || CM_fclass(scan, TRUE) != PIOUS_OK)
+    test_fail("IV", "class assignment failed");
+
+  for (j = 0; j < 3; j++)
+    for (i = 0; i < nhot; i++)
+      test_lread(hot, i);
+
+  /* scan, short enough that frequency estimates are exact; each large
+   * data block is referenced once
+   */
+  for (i = 0; i < LGSCANBLKS; i++)
+    test_lread(scan, i);
+
+  CM_stats(&stats);
+
+  if (stats.adm_reject == 0)
+    test_fail("IV", "scan large data blocks all admitted");
+
+  /* at most one large data block of hot file replaced */
+  loaded = stats.lg_blks;
+
+  for (i = 0; i < nhot; i++)
+    test_lread(hot, i);
+
+  CM_stats(&stats);
+
+  if (stats.lg_blks - loaded > 1)
+    test_fail("IV", "large data blocks replaced by scan");
+
+  printf("part_test: test IV  %lu of %ld large blocks replaced "
+	 "after %d large block scan, %lu not admitted\n",
+	 stats.lg_blks - loaded, nhot, LGSCANBLKS, stats.adm_reject);
+
+  exit(0);
+}
+
+
+
+
+/*
+ * test_many()
+ *
+ * Parameters:
+ *
+ *   fhandle - partition 1 file handles; NFILES entries
+ *
+ * Run test V, report result, and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_many(pds_fhandlet *fhandle)
+#else
+static void test_many(fhandle)
+     pds_fhandlet *fhandle;
+#endif
+{
+  long i;
+  struct CM_stats stats;
+
+  /* partition 1 reserved half the cache */
+  test_init(50, 50, 100, FALSE, 0L, FALSE);
+
+  for (i = 0; i < NFILES; i++)
+    CM_fpartition(fhandle[i], 1);
+
+  /* read files least recently assigned */
+  for (i = 0; i < CACHESZ / 2; i++)
+    test_read(fhandle[i], 0L, 'c');
+
+  CM_stats(&stats);
+
+  if (stats.part_nblk[1] != CACHESZ / 2 || stats.part_nblk[0] != 0)
+    test_fail("V", "partition assignment not retained");
+
+  printf("part_test: test V   %d files assigned, %ld of %d blocks cached "
+	 "in partition 1\n", NFILES, stats.part_nblk[1], CACHESZ / 2);
+
+  exit(0);
+}
+
+
+
+
+/*
+ * test_init()
+ *
+ * Parameters:
+ *
+ *   prot_pct  - protected segment percentage of cache size
+ *   part_min  - partition 1 reserved percentage of cache size
+ *   part_max  - partition 1 maximum percentage of cache size
+ *   writeback - volatile write-back policy flag
+ *   lg_cnt    - large data block count
+ *   admit     - admission filter flag
+ *
+ * Initialize a cache of CACHESZ data blocks with one partition, a slab of
+ * 'lg_cnt' large data blocks of LGBLKSZ bytes, and the admission filter as
+ * specified, and with readahead and the small data block slab off.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_init(int prot_pct,
+		      int part_min,
+		      int part_max,
+		      int writeback,
+		      long lg_cnt,
+		      int admit)
+#else
+static void test_init(prot_pct, part_min, part_max, writeback, lg_cnt, admit)
+     int prot_pct;
+     int part_min;
+     int part_max;
+     int writeback;
+     long lg_cnt;
+     int admit;
+#endif
+{
+  struct CM_param param;
+
+  CM_defparam(&param);
+
+  param.cache_sz    = CACHESZ;
+  param.dblk_sz     = DBLKSZ;
+  param.sm_cnt      = 0;
+  param.lg_cnt      = lg_cnt;
+  param.lg_sz       = LGBLKSZ;
+  param.lg_min      = 0;
+  param.direct      = FALSE;
+  param.prot_pct    = prot_pct;
+  param.ra_max      = 0;
+  param.lr_min      = 0;
+  param.policy      = CM_POLICY_SLRU;
+  param.admit       = admit;
+  param.writeback   = writeback;
+  param.part_cnt    = 1;
+  param.part_min[0] = part_min;
+  param.part_max[0] = part_max;
+
+  if (CM_init(&param) != PIOUS_OK)
+    {
+      printf("part_test: unable to initialize cache\n");
+      exit(1);
+    }
+}
+
+
+
+
+/*
+ * test_fill()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   nblk    - data block count
+ *
+ * Write 'nblk' data blocks to file 'fhandle' directly to stable storage.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_fill(pds_fhandlet fhandle,
+		      long nblk)
+#else
+static void test_fill(fhandle, nblk)
+     pds_fhandlet fhandle;
+     long nblk;
+#endif
+{
+  long i;
+
+  memset(test_buf, 'c', DBLKSZ);
+
+  for (i = 0; i < nblk; i++)
+    if (SS_write(fhandle, (pious_offt)i * DBLKSZ, (pious_sizet)DBLKSZ,
+		 test_buf, PIOUS_VOLATILE) != DBLKSZ)
+      {
+	printf("part_test: unable to write data file\n");
+	exit(1);
+      }
+}
+
+
+
+
+/*
+ * test_read()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   blk     - data block number
+ *   fill    - expected data byte value
+ *
+ * Read data block 'blk' of file 'fhandle' via the cache and check that
+ * each byte read is 'fill'.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_read(pds_fhandlet fhandle,
+		      long blk,
+		      int fill)
+#else
+static void test_read(fhandle, blk, fill)
+     pds_fhandlet fhandle;
+     long blk;
+     int fill;
+#endif
+{
+  long i;
+
+  memset(test_buf, 0, DBLKSZ);
+
+  if (CM_read(fhandle, (pious_offt)blk * DBLKSZ, (pious_sizet)DBLKSZ,
+	      test_buf) != DBLKSZ)
+    test_fail("", "read failed");
+
+  for (i = 0; i < DBLKSZ; i++)
+    if (test_buf[i] != fill)
+      test_fail("", "data read is incorrect");
+}
+
+
+
+
+/*
+ * test_lread()
+ *
+ * Parameters:
+ *
+ *   fhandle - file handle
+ *   blk     - large data block number
+ *
+ * Read large data block 'blk' of file 'fhandle' via the cache and check
+ * that each byte read is as written by test_fill().
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_lread(pds_fhandlet fhandle,
+		       long blk)
+#else
+static void test_lread(fhandle, blk)
+     pds_fhandlet fhandle;
+     long blk;
+#endif
+{
+  long i;
+
+  memset(test_buf, 0, LGBLKSZ);
+
+  if (CM_read(fhandle, (pious_offt)blk * LGBLKSZ, (pious_sizet)LGBLKSZ,
+	      test_buf) != LGBLKSZ)
+    test_fail("", "large read failed");
+
+  for (i = 0; i < LGBLKSZ; i++)
+    if (test_buf[i] != 'c')
+      test_fail("", "large data read is incorrect");
+}
+
+
+
+
+/*
+ * test_fail()
+ *
+ * Parameters:
+ *
+ *   test - test number
+ *   msg  - failure description
+ *
+ * Report failure of test 'test' described by 'msg' and exit.
+ *
+ * Returns:
+ */
+
+#ifdef __STDC__
+static void test_fail(char *test,
+		      char *msg)
+#else
+static void test_fail(test, msg)
+     char *test;
+     char *msg;
+#endif
+{
+  printf("part_test: test %s %s\n", test, msg);
+  exit(1);
+}